@@ -1240,6 +1240,7 @@ tsapi TSAction TSContScheduleEveryOnThread(TSCont contp, TSHRTime every /* milli
 tsapi TSReturnCode TSContThreadAffinitySet(TSCont contp, TSEventThread ethread);
 tsapi TSEventThread TSContThreadAffinityGet(TSCont contp);
 tsapi void TSContThreadAffinityClear(TSCont contp);
+tsapi void TSContThreadStealableSet(TSCont contp, bool stealable);
 tsapi TSAction TSHttpSchedule(TSCont contp, TSHttpTxn txnp, TSHRTime timeout);
 tsapi int TSContCall(TSCont contp, TSEvent event, void *edata);
 tsapi TSMutex TSContMutexGet(TSCont contp);
@@ -1990,6 +1991,18 @@ tsapi TSAction TSCacheRemove(TSCont contp, TSCacheKey key);
 tsapi TSReturnCode TSCacheReady(int *is_ready);
 tsapi TSAction TSCacheScan(TSCont contp, TSCacheKey key, int KB_per_second);
 
+/**
+    Removes every object whose response carried @a tag in the header
+    named by proxy.config.cache.surrogate_key.header. The removals are
+    scheduled and complete after this returns.
+
+    @param tag the surrogate key.
+    @param tag_len length of @a tag, or -1 if it is null terminated.
+    @return the number of objects removed.
+
+ */
+tsapi int64_t TSCacheInvalidateTag(const char *tag, int tag_len);
+
 /* --------------------------------------------------------------------------
    VIOs */
 tsapi void TSVIOReenable(TSVIO viop);
@@ -149,12 +149,6 @@ CryptoContextBase::finalize(CryptoHash *hash)
 class CryptoContext : public CryptoContextBase
 {
 public:
-  CryptoContext();
-  /// Update the hash with @a data of @a length bytes.
-  bool update(void const *data, int length) override;
-  /// Finalize and extract the @a hash.
-  bool finalize(CryptoHash &hash) override;
-
   enum HashType {
     UNSPECIFIED,
 #if TS_ENABLE_FIPS == 0
@@ -162,9 +156,19 @@ public:
     MMH,
 #endif
     SHA256,
+    SIPHASH,
   }; ///< What type of hash we really are.
   static HashType Setting;
 
+  /// A context of the global @c Setting type.
+  CryptoContext();
+  /// A context of a specific @a type.
+  explicit CryptoContext(HashType type);
+  /// Update the hash with @a data of @a length bytes.
+  bool update(void const *data, int length) override;
+  /// Finalize and extract the @a hash.
+  bool finalize(CryptoHash &hash) override;
+
   /// Size of storage for placement @c new of hashing context.
   static size_t const OBJ_SIZE = 256;
 
@@ -22,6 +22,7 @@
 #pragma once
 
 #include "tscore/Hash.h"
+#include "tscore/CryptoHash.h"
 #include <cstdint>
 
 /*
@@ -53,3 +54,49 @@ private:
   std::size_t total_len         = 0;
   bool finalized                = false;
 };
+
+/*
+  The 128 bit output variant of SipHash-2-4.
+ */
+
+struct ATSHash128Sip24 : ATSHash {
+  ATSHash128Sip24();
+  ATSHash128Sip24(std::uint64_t key0, std::uint64_t key1);
+  void update(const void *data, std::size_t len) override;
+  void final() override;
+  const void *get() const override;
+  std::size_t size() const override;
+  void clear() override;
+
+private:
+  void compress(std::uint64_t m);
+
+  unsigned char block_buffer[8] = {0};
+  std::uint8_t block_buffer_len = 0;
+  std::uint64_t k0              = 0;
+  std::uint64_t k1              = 0;
+  std::uint64_t v0              = 0;
+  std::uint64_t v1              = 0;
+  std::uint64_t v2              = 0;
+  std::uint64_t v3              = 0;
+  std::uint64_t hfinal[2]       = {0, 0};
+  std::size_t total_len         = 0;
+  bool finalized                = false;
+};
+
+/*
+  SipHash-2-4-128 as a cache key hash.  It is not a cryptographic hash but is much cheaper than
+  MD5 for the short strings which make up URLs.
+ */
+
+class SipHashContext : public ats::CryptoContextBase
+{
+protected:
+  ATSHash128Sip24 _hash;
+
+public:
+  /// Update the hash with @a data of @a length bytes.
+  bool update(void const *data, int length) override;
+  /// Finalize and extract the @a hash.
+  bool finalize(CryptoHash &hash) override;
+};
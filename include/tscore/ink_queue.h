@@ -167,12 +167,24 @@ union head_p {
 #error "unsupported processor"
 #endif
 
+/*
+ * Maximum number of NUMA nodes the freelists keep apart.
+ */
+#define INK_FREELIST_NODES 8
+
+// Free items of one NUMA node, each on its own cache line.
+struct _InkFreeListNode {
+  alignas(64) head_p head;
+};
+
 struct _InkFreeList {
   head_p head;
   const char *name;
   uint32_t type_size, chunk_size, used, allocated, alignment;
   uint32_t allocated_base, used_base;
   int advice;
+  uint32_t remote_frees; // items freed by a thread of another NUMA node
+  struct _InkFreeListNode nodes[INK_FREELIST_NODES];
 };
 
 typedef struct ink_freelist_ops InkFreeListOps;
@@ -197,6 +209,38 @@ void ink_freelists_dump(FILE *f);
 void ink_freelists_dump_baselinerel(FILE *f);
 void ink_freelists_snap_baseline();
 
+/*
+ * NUMA node arenas. When enabled, freelist chunks are carved out of an arena per node and the items of
+ * a node are kept on their own list, so a thread bound to a node only gets memory of that node.
+ *
+ * nodes is the number of arenas, 0 for one per NUMA node of the machine, and arena_size the address
+ * space reserved for each, 0 for the memory of the largest node. Returns the number of arenas, which is
+ * 0 (disabled) for less than two. This *MUST* only be called once, before any thread sets its node.
+ */
+int ink_freelist_numa_init(int nodes, size_t arena_size);
+/*
+ * Set the node the calling thread allocates from, -1 for none.
+ */
+void ink_freelist_set_thread_node(int node);
+int ink_freelist_thread_node();
+/*
+ * The node of the arena item is in, -1 if it is not in one.
+ */
+int ink_freelist_node_of(const void *item);
+int ink_freelist_numa_is_remote(const void *item);
+uint64_t ink_freelists_numa_remote_frees();
+
+extern int ink_freelist_numa_nodes;
+
+/*
+ * True if item is memory of a node other than the one of the calling thread.
+ */
+static inline int
+ink_freelist_numa_remote(const void *item)
+{
+  return ink_freelist_numa_nodes && ink_freelist_numa_is_remote(item);
+}
+
 struct InkAtomicList {
   InkAtomicList() {}
   head_p head{};
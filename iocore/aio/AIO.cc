@@ -29,7 +29,13 @@
 
 #include "P_AIO.h"
 
-#if AIO_MODE == AIO_MODE_NATIVE
+#if AIO_MODE == AIO_MODE_IO_URING
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#endif
+
+#if AIO_MODE == AIO_MODE_NATIVE || AIO_MODE == AIO_MODE_IO_URING
 #define AIO_PERIOD -HRTIME_MSECONDS(10)
 #else
 
@@ -48,9 +54,10 @@ int num_filedes = 1;
 static ink_mutex insert_mutex;
 
 int thread_is_created = 0;
-#endif // AIO_MODE == AIO_MODE_NATIVE
+#endif // AIO_MODE == AIO_MODE_NATIVE || AIO_MODE == AIO_MODE_IO_URING
 RecInt cache_config_threads_per_disk = 12;
 RecInt api_config_threads_per_disk   = 12;
+RecInt aio_config_io_uring_entries   = 1024;
 
 RecRawStatBlock *aio_rsb      = nullptr;
 Continuation *aio_err_callbck = nullptr;
@@ -158,7 +165,7 @@ ink_aio_init(ts::ModuleVersion v)
                      (int)AIO_STAT_KB_READ_PER_SEC, aio_stats_cb);
   RecRegisterRawStat(aio_rsb, RECT_PROCESS, "proxy.process.cache.KB_write_per_sec", RECD_FLOAT, RECP_PERSISTENT,
                      (int)AIO_STAT_KB_WRITE_PER_SEC, aio_stats_cb);
-#if AIO_MODE != AIO_MODE_NATIVE
+#if AIO_MODE == AIO_MODE_THREAD
   memset(&aio_reqs, 0, MAX_DISKS_POSSIBLE * sizeof(AIO_Reqs *));
   ink_mutex_init(&insert_mutex);
 #endif
@@ -166,6 +173,10 @@ ink_aio_init(ts::ModuleVersion v)
 #if TS_USE_LINUX_NATIVE_AIO
   Warning("Running with Linux AIO, there are known issues with this feature");
 #endif
+#if TS_USE_LINUX_IO_URING
+  REC_ReadConfigInteger(aio_config_io_uring_entries, "proxy.config.aio.io_uring.entries");
+  Note("Running with Linux io_uring AIO, %" PRId64 " submission entries per thread", aio_config_io_uring_entries);
+#endif
 }
 
 int
@@ -178,7 +189,7 @@ ink_aio_start()
   return 0;
 }
 
-#if AIO_MODE != AIO_MODE_NATIVE
+#if AIO_MODE == AIO_MODE_THREAD
 
 static void *aio_thread_main(void *arg);
 
@@ -491,7 +502,17 @@ aio_thread_main(void *arg)
   }
   return nullptr;
 }
-#else
+
+void
+ink_aio_register_fixed_buffer(void * /* buf ATS_UNUSED */, size_t /* len ATS_UNUSED */)
+{
+}
+
+void
+ink_aio_unregister_fixed_buffer(void * /* buf ATS_UNUSED */)
+{
+}
+#elif AIO_MODE == AIO_MODE_NATIVE
 int
 DiskHandler::startAIOEvent(int /* event ATS_UNUSED */, Event *e)
 {
@@ -647,4 +668,327 @@ ink_aio_writev(AIOCallback *op, int /* fromAPI ATS_UNUSED */)
   }
   return 1;
 }
-#endif // AIO_MODE != AIO_MODE_NATIVE
+
+void
+ink_aio_register_fixed_buffer(void * /* buf ATS_UNUSED */, size_t /* len ATS_UNUSED */)
+{
+}
+
+void
+ink_aio_unregister_fixed_buffer(void * /* buf ATS_UNUSED */)
+{
+}
+#else // AIO_MODE == AIO_MODE_IO_URING
+
+namespace
+{
+/// The kernel refuses to register a single buffer larger than this.
+constexpr size_t MAX_FIXED_BUFFER_SIZE = 1 << 30;
+/// The kernel limit on the number of buffers in one registration call.
+constexpr size_t MAX_FIXED_BUFFERS = 1024;
+
+/// Buffers to register with every ring, sorted by address.
+std::vector<iovec> fixed_buffer_set;
+std::mutex fixed_buffer_mutex;
+/// Bumped on every change to @c fixed_buffer_set so the rings know to re-register.
+std::atomic<uint32_t> fixed_buffer_generation{0};
+
+bool
+iovec_base_less(iovec const &lhs, iovec const &rhs)
+{
+  return lhs.iov_base < rhs.iov_base;
+}
+
+} // namespace
+
+void
+ink_aio_register_fixed_buffer(void *buf, size_t len)
+{
+  if (buf == nullptr || len == 0 || len > MAX_FIXED_BUFFER_SIZE) {
+    return;
+  }
+
+  std::lock_guard<std::mutex> lock(fixed_buffer_mutex);
+  iovec iov{buf, len};
+  fixed_buffer_set.insert(std::upper_bound(fixed_buffer_set.begin(), fixed_buffer_set.end(), iov, &iovec_base_less), iov);
+  ++fixed_buffer_generation;
+}
+
+void
+ink_aio_unregister_fixed_buffer(void *buf)
+{
+  std::lock_guard<std::mutex> lock(fixed_buffer_mutex);
+  iovec iov{buf, 0};
+  auto spot = std::lower_bound(fixed_buffer_set.begin(), fixed_buffer_set.end(), iov, &iovec_base_less);
+  if (spot != fixed_buffer_set.end() && spot->iov_base == buf) {
+    fixed_buffer_set.erase(spot);
+    ++fixed_buffer_generation;
+  }
+}
+
+DiskHandler::DiskHandler()
+{
+  SET_HANDLER(&DiskHandler::startAIOEvent);
+  int ret = io_uring_queue_init(static_cast<unsigned>(aio_config_io_uring_entries), &ring, 0);
+  if (ret < 0) {
+    Fatal("io_uring_queue_init(%" PRId64 ") failed: %s (%d)", aio_config_io_uring_entries, strerror(-ret), -ret);
+  }
+  ring_ready = true;
+}
+
+DiskHandler::~DiskHandler()
+{
+  if (ring_ready) {
+    io_uring_queue_exit(&ring);
+  }
+}
+
+int
+DiskHandler::startAIOEvent(int /* event ATS_UNUSED */, Event *e)
+{
+  SET_HANDLER(&DiskHandler::mainAIOEvent);
+#ifdef HAVE_EVENTFD
+  // Completions poke the thread's eventfd so a sleeping event loop wakes up to reap them.
+  int ret = io_uring_register_eventfd(&ring, e->ethread->evfd);
+  if (ret < 0) {
+    Debug("aio", "io_uring_register_eventfd failed: %s (%d)", strerror(-ret), -ret);
+  }
+#endif
+  e->schedule_every(AIO_PERIOD);
+  trigger_event = e;
+  return EVENT_CONT;
+}
+
+/** Bring the ring's registered buffers up to date with the global set.
+
+    Registration can only be changed while nothing is in flight, otherwise a submitted operation
+    could refer to a stale buffer index. Registration is all or nothing, so if it fails (typically
+    RLIMIT_MEMLOCK) the largest buffer is dropped and the rest tried again. Transfers in buffers that
+    are not registered use ordinary operations.
+ */
+void
+DiskHandler::refresh_fixed_buffers()
+{
+  uint32_t generation = fixed_buffer_generation.load(std::memory_order_acquire);
+  if (generation == fixed_buffers_generation || in_flight > 0) {
+    return;
+  }
+
+  if (!fixed_buffers.empty()) {
+    io_uring_unregister_buffers(&ring);
+    fixed_buffers.clear();
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(fixed_buffer_mutex);
+    generation = fixed_buffer_generation.load(std::memory_order_relaxed);
+    fixed_buffers.assign(fixed_buffer_set.begin(),
+                         fixed_buffer_set.begin() + std::min(fixed_buffer_set.size(), MAX_FIXED_BUFFERS));
+  }
+  fixed_buffers_generation = generation;
+
+  while (!fixed_buffers.empty()) {
+    int ret = io_uring_register_buffers(&ring, fixed_buffers.data(), fixed_buffers.size());
+    if (ret >= 0) {
+      break;
+    }
+    auto largest = std::max_element(fixed_buffers.begin(), fixed_buffers.end(),
+                                    [](iovec const &lhs, iovec const &rhs) { return lhs.iov_len < rhs.iov_len; });
+    Debug("aio", "io_uring_register_buffers(%zu) failed: %s (%d), dropping a %zu byte buffer", fixed_buffers.size(),
+          strerror(-ret), -ret, largest->iov_len);
+    fixed_buffers.erase(largest);
+  }
+}
+
+/** @return The registered buffer index containing all of [ @a buf, @a buf + @a len ), or -1.
+
+    Nothing is returned while the global set has changed since the last registration, because a
+    buffer that was unregistered and freed may have been reallocated at the same address.
+ */
+int
+DiskHandler::find_fixed_buffer(const void *buf, size_t len) const
+{
+  if (fixed_buffers_generation != fixed_buffer_generation.load(std::memory_order_acquire)) {
+    return -1;
+  }
+  iovec iov{const_cast<void *>(buf), len};
+  auto spot = std::upper_bound(fixed_buffers.begin(), fixed_buffers.end(), iov, &iovec_base_less);
+  if (spot == fixed_buffers.begin()) {
+    return -1;
+  }
+  --spot;
+  const char *base = static_cast<const char *>(spot->iov_base);
+  const char *p    = static_cast<const char *>(buf);
+  if (p + len <= base + spot->iov_len) {
+    return spot - fixed_buffers.begin();
+  }
+  return -1;
+}
+
+void
+DiskHandler::submit_ready()
+{
+  int queued = 0;
+  io_uring_sqe *sqe;
+
+  while (ready_list.head && (sqe = io_uring_get_sqe(&ring)) != nullptr) {
+    AIOCallback *op = ready_list.dequeue();
+    ink_aiocb *a    = &op->aiocb;
+    // aio_result holds the bytes already transferred if this is the remainder of a short transfer.
+    char *buf   = static_cast<char *>(a->aio_buf) + op->aio_result;
+    size_t len  = a->aio_nbytes - op->aio_result;
+    off_t where = a->aio_offset + op->aio_result;
+    int idx     = find_fixed_buffer(buf, len);
+
+    if (a->aio_lio_opcode == LIO_READ) {
+      if (idx >= 0) {
+        io_uring_prep_read_fixed(sqe, a->aio_fildes, buf, len, where, idx);
+      } else {
+        io_uring_prep_read(sqe, a->aio_fildes, buf, len, where);
+      }
+    } else {
+      if (idx >= 0) {
+        io_uring_prep_write_fixed(sqe, a->aio_fildes, buf, len, where, idx);
+      } else {
+        io_uring_prep_write(sqe, a->aio_fildes, buf, len, where);
+      }
+    }
+    io_uring_sqe_set_data(sqe, op);
+    ++queued;
+  }
+
+  if (queued > 0) {
+    in_flight += queued;
+    // Anything not accepted here stays in the submission queue and goes out with the next batch.
+    int ret = io_uring_submit(&ring);
+    if (ret < 0 && ret != -EAGAIN && ret != -EBUSY && ret != -EINTR) {
+      Warning("io_uring_submit failed: %s (%d)", strerror(-ret), -ret);
+    }
+  }
+}
+
+void
+DiskHandler::reap_complete()
+{
+  io_uring_cqe *cqe;
+  unsigned head;
+  unsigned count = 0;
+
+  io_uring_for_each_cqe(&ring, head, cqe)
+  {
+    AIOCallback *op = static_cast<AIOCallback *>(io_uring_cqe_get_data(cqe));
+    ink_aiocb *a    = &op->aiocb;
+    ++count;
+    if (cqe->res < 0) {
+      Warning("cache disk operation failed %s %d %d", (a->aio_lio_opcode == LIO_READ) ? "READ" : "WRITE", cqe->res, -cqe->res);
+      op->aio_result = cqe->res;
+    } else {
+      op->aio_result += cqe->res;
+      if (cqe->res > 0 && op->aio_result < static_cast<int64_t>(a->aio_nbytes)) {
+        // Short transfer, send the remainder with the next batch.
+        ready_list.enqueue(op);
+        continue;
+      }
+    }
+    if (a->aio_lio_opcode == LIO_WRITE) {
+      aio_num_write++;
+      aio_bytes_written += a->aio_nbytes;
+    } else {
+      aio_num_read++;
+      aio_bytes_read += a->aio_nbytes;
+    }
+    ink_assert(op->action.continuation);
+    complete_list.enqueue(op);
+  }
+  io_uring_cq_advance(&ring, count);
+  in_flight -= count;
+}
+
+int
+DiskHandler::mainAIOEvent(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+{
+  AIOCallback *op = nullptr;
+  EThread *t      = trigger_event->ethread;
+
+  reap_complete();
+
+  while ((op = complete_list.dequeue()) != nullptr) {
+    op->mutex = op->action.mutex;
+    if (op->thread != AIO_CALLBACK_THREAD_ANY && op->thread != AIO_CALLBACK_THREAD_AIO && op->thread != t) {
+      op->thread->schedule_imm(op);
+      continue;
+    }
+    MUTEX_TRY_LOCK(lock, op->mutex, t);
+    if (!lock.is_locked()) {
+      t->schedule_imm(op);
+    } else {
+      op->handleEvent(EVENT_NONE, nullptr);
+    }
+  }
+
+  // Submit after the callbacks so that any follow up I/O they issued goes out in this batch.
+  refresh_fixed_buffers();
+  submit_ready();
+  return EVENT_CONT;
+}
+
+static void
+aio_queue_op(AIOCallback *op, int opcode)
+{
+  EThread *t = this_ethread();
+  ink_assert(t->diskHandler);
+  op->aiocb.aio_lio_opcode = opcode;
+  op->aio_result           = 0;
+  t->diskHandler->ready_list.enqueue(op);
+}
+
+static void
+aio_queue_chain(AIOCallback *op, int opcode)
+{
+  AIOCallback *io = op;
+  int sz          = 0;
+
+  while (io) {
+    aio_queue_op(io, opcode);
+    ++sz;
+    io = io->then;
+  }
+
+  if (sz > 1) {
+    ink_assert(op->action.continuation);
+    AIOVec *vec = new AIOVec(sz, op);
+    while (--sz >= 0) {
+      op->action = vec;
+      op         = op->then;
+    }
+  }
+}
+
+int
+ink_aio_read(AIOCallback *op, int /* fromAPI ATS_UNUSED */)
+{
+  aio_queue_op(op, LIO_READ);
+  return 1;
+}
+
+int
+ink_aio_write(AIOCallback *op, int /* fromAPI ATS_UNUSED */)
+{
+  aio_queue_op(op, LIO_WRITE);
+  return 1;
+}
+
+int
+ink_aio_readv(AIOCallback *op, int /* fromAPI ATS_UNUSED */)
+{
+  aio_queue_chain(op, LIO_READ);
+  return 1;
+}
+
+int
+ink_aio_writev(AIOCallback *op, int /* fromAPI ATS_UNUSED */)
+{
+  aio_queue_chain(op, LIO_WRITE);
+  return 1;
+}
+#endif // AIO_MODE == AIO_MODE_IO_URING
@@ -40,9 +40,12 @@ static constexpr ts::ModuleVersion AIO_MODULE_PUBLIC_VERSION(1, 0, ts::ModuleVer
 
 #define AIO_MODE_THREAD 0
 #define AIO_MODE_NATIVE 1
+#define AIO_MODE_IO_URING 2
 
 #if TS_USE_LINUX_NATIVE_AIO
 #define AIO_MODE AIO_MODE_NATIVE
+#elif TS_USE_LINUX_IO_URING
+#define AIO_MODE AIO_MODE_IO_URING
 #else
 #define AIO_MODE AIO_MODE_THREAD
 #endif
@@ -77,10 +80,21 @@ struct ink_aiocb {
   int aio__pad[1];        /* extension padding */
 };
 
+#if AIO_MODE == AIO_MODE_IO_URING
+
+#include <vector>
+#include <liburing.h>
+
+#define MAX_AIO_EVENTS 1024
+
+#else
+
 bool ink_aio_thread_num_set(int thread_num);
 
 #endif
 
+#endif
+
 // AIOCallback::thread special values
 #define AIO_CALLBACK_THREAD_ANY ((EThread *)0) // any regular event thread
 #define AIO_CALLBACK_THREAD_AIO ((EThread *)-1)
@@ -93,12 +107,14 @@ struct AIOCallback : public Continuation {
   AIOCallback *then = nullptr;
   // set on return from aio_read/aio_write
   int64_t aio_result = 0;
+  // free for the submitter, e.g. to time the operation
+  ink_hrtime submit_time = 0;
 
   int ok();
   AIOCallback() {}
 };
 
-#if AIO_MODE == AIO_MODE_NATIVE
+#if AIO_MODE == AIO_MODE_NATIVE || AIO_MODE == AIO_MODE_IO_URING
 
 struct AIOVec : public Continuation {
   Action action;
@@ -114,7 +130,9 @@ struct AIOVec : public Continuation {
 
   int mainEvent(int event, Event *e);
 };
+#endif
 
+#if AIO_MODE == AIO_MODE_NATIVE
 struct DiskHandler : public Continuation {
   Event *trigger_event;
   io_context_t ctx;
@@ -135,6 +153,41 @@ struct DiskHandler : public Continuation {
 };
 #endif
 
+#if AIO_MODE == AIO_MODE_IO_URING
+
+/** Per EThread io_uring submission and completion handler.
+
+    Operations queued by @c ink_aio_read et al. are collected on @a ready_list and submitted as one
+    batch each time the event loop runs this handler. Completions are reaped from the same ring, which
+    is tied to the thread's eventfd so that the event loop wakes up when I/O finishes.
+ */
+struct DiskHandler : public Continuation {
+  Event *trigger_event = nullptr;
+  struct io_uring ring;
+  bool ring_ready = false;
+  int in_flight   = 0; ///< Operations submitted to the kernel and not yet reaped.
+  Que(AIOCallback, link) ready_list;
+  Que(AIOCallback, link) complete_list;
+
+  /// Registered fixed buffers, sorted by address, as last registered with @a ring.
+  std::vector<iovec> fixed_buffers;
+  /// Generation of the global fixed buffer set that @a fixed_buffers reflects.
+  uint32_t fixed_buffers_generation = 0;
+
+  int startAIOEvent(int event, Event *e);
+  int mainAIOEvent(int event, Event *e);
+
+  DiskHandler();
+  ~DiskHandler() override;
+
+private:
+  void submit_ready();
+  void reap_complete();
+  void refresh_fixed_buffers();
+  int find_fixed_buffer(const void *buf, size_t len) const;
+};
+#endif
+
 void ink_aio_init(ts::ModuleVersion version);
 int ink_aio_start();
 void ink_aio_set_callback(Continuation *error_callback);
@@ -146,3 +199,13 @@ int ink_aio_readv(AIOCallback *op,
                   int fromAPI = 0); // fromAPI is a boolean to indicate if this is from a API call such as upload proxy feature
 int ink_aio_writev(AIOCallback *op, int fromAPI = 0);
 AIOCallback *new_AIOCallback();
+
+/** Register @a buf as a long lived I/O buffer.
+
+    Backends that support pre-registered buffers (io_uring) pin the memory and use fixed buffer
+    operations for any transfer that lies entirely within it. This is only a hint, it is a no-op for
+    the other backends and registration failures fall back to ordinary transfers.
+ */
+void ink_aio_register_fixed_buffer(void *buf, size_t len);
+/// Remove a buffer previously registered with @c ink_aio_register_fixed_buffer.
+void ink_aio_unregister_fixed_buffer(void *buf);
@@ -149,6 +149,15 @@ struct AIO_Device : public Continuation {
     }
     return 0;
   }
+  void
+  check_result()
+  {
+    if (!io->ok()) {
+      fprintf(stderr, "%s: aio operation failed, %" PRId64 " of %zu bytes at offset %jd\n", path, io->aio_result,
+              static_cast<size_t>(io->aiocb.aio_nbytes), static_cast<intmax_t>(io->aiocb.aio_offset));
+      exit(1);
+    }
+  }
   int do_hotset(int event, Event *e);
   int do_fd(int event, Event *e);
 };
@@ -223,7 +232,8 @@ dump_summary()
 int
 AIO_Device::do_hotset(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
 {
-  off_t max_offset         = (static_cast<off_t>(disk_size)) * 1024 * 1024;
+  off_t max_offset = (static_cast<off_t>(disk_size)) * 1024 * 1024;
+  check_result();
   io->aiocb.aio_lio_opcode = LIO_WRITE;
   io->aiocb.aio_fildes     = fd;
   io->aiocb.aio_offset     = MIN_OFFSET + hotset_idx * max_size;
@@ -273,6 +283,7 @@ AIO_Device::do_fd(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
     seq_write_point = MIN_OFFSET;
   }
 
+  check_result();
   if (io->aiocb.aio_lio_opcode == LIO_READ) {
     ink_assert(!do_check_data(io->aiocb.aio_nbytes, io->aiocb.aio_offset));
   }
@@ -421,13 +432,10 @@ main(int /* argc ATS_UNUSED */, char *argv[])
   Thread *main_thread = new EThread;
   main_thread->set_specific();
 
-#if AIO_MODE == AIO_MODE_NATIVE
-  int etype            = ET_NET;
-  int n_netthreads     = eventProcessor.n_threads_for_type[etype];
-  EThread **netthreads = eventProcessor.eventthread[etype];
-  for (int i = 0; i < n_netthreads; ++i) {
-    netthreads[i]->diskHandler = new DiskHandler();
-    netthreads[i]->schedule_imm(netthreads[i]->diskHandler);
+#if AIO_MODE == AIO_MODE_NATIVE || AIO_MODE == AIO_MODE_IO_URING
+  for (EThread *et : eventProcessor.active_group_threads(ET_NET)) {
+    et->diskHandler = new DiskHandler();
+    et->schedule_imm(et->diskHandler);
   }
 #endif
 
@@ -465,6 +473,7 @@ main(int /* argc ATS_UNUSED */, char *argv[])
         exit(1);
       }
       dev[n_accessors]->buf = static_cast<char *>(valloc(max_size));
+      ink_aio_register_fixed_buffer(dev[n_accessors]->buf, max_size);
       eventProcessor.schedule_imm(dev[n_accessors]);
       n_accessors++;
     }
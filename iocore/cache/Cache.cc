@@ -63,25 +63,41 @@ int cache_config_ram_cache_algorithm           = 1;
 int cache_config_ram_cache_compress            = 0;
 int cache_config_ram_cache_compress_percent    = 90;
 int cache_config_ram_cache_use_seen_filter     = 1;
+int cache_config_ram_cache_lock_free_entries   = 0;
+int cache_config_ram_cache_persist_entries     = 0;
+int cache_config_ram_cache_persist_frequency   = 300;
+int cache_config_ram_cache_preload_rate        = 1000;
 int cache_config_http_max_alts                 = 3;
 int cache_config_dir_sync_frequency            = 60;
 int cache_config_permit_pinning                = 0;
 int cache_config_select_alternate              = 1;
+int cache_config_key_hash                      = CACHE_KEY_HASH_DEFAULT;
 int cache_config_max_doc_size                  = 0;
 int cache_config_min_average_object_size       = ESTIMATED_OBJECT_SIZE;
 int64_t cache_config_ram_cache_cutoff          = AGG_SIZE;
 int cache_config_max_disk_errors               = 5;
 int cache_config_hit_evacuate_percent          = 10;
 int cache_config_hit_evacuate_size_limit       = 0;
+int cache_config_scrub_rate                    = 0;
+int cache_config_scrub_heat_threshold          = 4;
+int cache_config_hot_replica_copies            = 0;
+int cache_config_hot_replica_threshold         = 1000;
+char *cache_config_surrogate_key_header        = nullptr;
+int cache_config_buffer_pool_hugepages         = 0;
+int64_t cache_config_buffer_pool_thread_cache  = 4 * 1024 * 1024;
 int cache_config_force_sector_size             = 0;
 int cache_config_target_fragment_size          = DEFAULT_TARGET_FRAGMENT_SIZE;
 int cache_config_agg_write_backlog             = AGG_SIZE * 2;
+int cache_config_agg_write_in_flight           = 1;
+int cache_config_io_max_writes_in_flight       = 4;
 int cache_config_enable_checksum               = 0;
 int cache_config_alt_rewrite_max_size          = 4096;
 int cache_config_read_while_writer             = 0;
 int cache_config_mutex_retry_delay             = 2;
+int cache_config_init_stripes_per_disk         = 0;
 int cache_read_while_writer_retry_delay        = 50;
 int cache_config_read_while_writer_max_retries = 10;
+int cache_config_read_while_writer_fragment_ring = 4;
 
 // Globals
 
@@ -133,7 +149,6 @@ struct VolInitInfo {
   }
 };
 
-#if AIO_MODE == AIO_MODE_NATIVE
 struct VolInit : public Continuation {
   Vol *vol;
   char *path;
@@ -156,6 +171,37 @@ struct VolInit : public Continuation {
   }
 };
 
+/* Stripes are brought online from the event threads so that reading and
+   recovering their directories proceeds in parallel. With
+   proxy.config.cache.init.stripes_per_disk set, only that many stripes per
+   disk are in progress at once and the rest wait their turn, which keeps a
+   spindle from seeking between every stripe it holds.
+ */
+static void
+vol_init_start(CacheDisk *d, VolInit *init)
+{
+  SCOPED_MUTEX_LOCK(lock, d->mutex, this_ethread());
+  if (cache_config_init_stripes_per_disk > 0 && d->vol_init_active >= cache_config_init_stripes_per_disk) {
+    d->vol_init_wait.enqueue(init);
+    return;
+  }
+  ++d->vol_init_active;
+  eventProcessor.schedule_imm(init, ET_CALL);
+}
+
+static void
+vol_init_finish(CacheDisk *d)
+{
+  SCOPED_MUTEX_LOCK(lock, d->mutex, this_ethread());
+  Continuation *next = d->vol_init_wait.dequeue();
+  if (next) {
+    eventProcessor.schedule_imm(next, ET_CALL);
+  } else {
+    --d->vol_init_active;
+  }
+}
+
+#if AIO_MODE == AIO_MODE_NATIVE || AIO_MODE == AIO_MODE_IO_URING
 struct DiskInit : public Continuation {
   CacheDisk *disk;
   char *s;
@@ -188,6 +234,7 @@ int cplist_reconfigure();
 static int create_volume(int volume_number, off_t size_in_blocks, int scheme, CacheVol *cp);
 static void rebuild_host_table(Cache *cache);
 void register_cache_stats(RecRawStatBlock *rsb, const char *prefix);
+static void register_cache_disk_io_stats(RecRawStatBlock *rsb, const char *prefix);
 
 // Global list of the volumes created
 Queue<CacheVol> cp_list;
@@ -249,6 +296,33 @@ cache_stats_bytes_used_cb(const char *name, RecDataT data_type, RecData *data, R
   return 1;
 }
 
+int
+cache_stats_buffer_pool_cb(const char *name, RecDataT data_type, RecData *data, RecRawStatBlock *rsb, int id)
+{
+  AlignedBufferPoolStats stats = aligned_buffer_pool_stats();
+  int64_t value                = 0;
+
+  switch (id) {
+  case cache_buffer_pool_reserved_bytes_stat:
+    value = stats.reserved;
+    break;
+  case cache_buffer_pool_hugepage_bytes_stat:
+    value = stats.hugepage;
+    break;
+  case cache_buffer_pool_in_use_bytes_stat:
+    value = stats.in_use;
+    break;
+  case cache_buffer_pool_allocs_stat:
+    value = stats.allocs;
+    break;
+  case cache_buffer_pool_thread_cache_hits_stat:
+    value = stats.cache_hits;
+    break;
+  }
+  RecSetGlobalRawStatSum(rsb, id, value);
+  return RecRawStatSyncSum(name, data_type, data, rsb, id);
+}
+
 static int
 validate_rww(int new_value)
 {
@@ -350,6 +424,34 @@ CacheVC::do_io_write(Continuation *c, int64_t nbytes, IOBufferReader *abuf, bool
   return &vio;
 }
 
+static_assert(HTTPInfo::SPARSE_MAX_FRAG_SIZE <= MAX_FRAG_SIZE, "a sparse fragment must fit in a cache fragment");
+
+// do_io_pwrite writes part of a sparse object, set_http_info must be called with a sparse
+// alternate first. The range must start on a fragment boundary and end on one or at the end
+// of the object. An update fills in fragments of the existing object.
+VIO *
+CacheVC::do_io_pwrite(Continuation *c, int64_t nbytes, IOBufferReader *abuf, int64_t offset)
+{
+  ink_assert(vio.op == VIO::WRITE);
+  ink_assert(alternate.valid() && alternate.is_sparse());
+  ink_assert(!total_len && !fragment);
+  int64_t frag_size = alternate.sparse_frag_size_get();
+  ink_assert(frag_size <= static_cast<int64_t>(MAX_FRAG_SIZE));
+  ink_assert(offset % frag_size == 0);
+  ink_assert((offset + nbytes) % frag_size == 0 || offset + nbytes == alternate.object_size_get());
+  f.sparse = 1;
+  if (f.update) {
+    earliest_key = update_key;
+  }
+  key = earliest_key;
+  for (fragment = 0; fragment < offset / frag_size; ++fragment) {
+    next_CacheKey(&key, &key);
+  }
+  write_pos = offset;
+  DDebug("cache_sparse", "pwrite %" PRId64 " bytes @ %" PRId64 " from fragment %d", nbytes, offset, fragment);
+  return do_io_write(c, nbytes, abuf);
+}
+
 void
 CacheVC::do_io_close(int alerrno)
 {
@@ -574,13 +676,10 @@ CacheProcessor::start_internal(int flags)
   ink_assert((int)TS_EVENT_CACHE_SCAN_OPERATION_FAILED == (int)CACHE_EVENT_SCAN_OPERATION_FAILED);
   ink_assert((int)TS_EVENT_CACHE_SCAN_DONE == (int)CACHE_EVENT_SCAN_DONE);
 
-#if AIO_MODE == AIO_MODE_NATIVE
-  int etype            = ET_NET;
-  int n_netthreads     = eventProcessor.n_threads_for_type[etype];
-  EThread **netthreads = eventProcessor.eventthread[etype];
-  for (int i = 0; i < n_netthreads; ++i) {
-    netthreads[i]->diskHandler = new DiskHandler();
-    netthreads[i]->schedule_imm(netthreads[i]->diskHandler);
+#if AIO_MODE == AIO_MODE_NATIVE || AIO_MODE == AIO_MODE_IO_URING
+  for (EThread *et : eventProcessor.active_group_threads(ET_NET)) {
+    et->diskHandler = new DiskHandler();
+    et->schedule_imm(et->diskHandler);
   }
 #endif
 
@@ -739,7 +838,7 @@ CacheProcessor::start_internal(int flags)
     ink_release_assert(sds[j] != nullptr); // Defeat clang-analyzer
     off_t skip     = ROUND_TO_STORE_BLOCK((sd->offset < START_POS ? START_POS + sd->alignment : sd->offset));
     int64_t blocks = sd->blocks - (skip >> STORE_BLOCK_SHIFT);
-#if AIO_MODE == AIO_MODE_NATIVE
+#if AIO_MODE == AIO_MODE_NATIVE || AIO_MODE == AIO_MODE_IO_URING
     eventProcessor.schedule_imm(new DiskInit(gdisks[j], paths[j], blocks, skip, sector_sizes[j], fds[j], clear));
 #else
     gdisks[j]->open(paths[j], blocks, skip, sector_sizes[j], fds[j], clear);
@@ -822,6 +921,12 @@ CacheProcessor::diskInitialized()
       snprintf(vol_stat_str_prefix, sizeof(vol_stat_str_prefix), "proxy.process.cache.volume_%d", cp->vol_number);
       register_cache_stats(cp->vol_rsb, vol_stat_str_prefix);
     }
+    for (i = 0; i < gndisks; i++) {
+      gdisks[i]->io_rsb = RecAllocateRawStatBlock(static_cast<int>(cache_disk_io_stat_count));
+      char disk_stat_str_prefix[256];
+      snprintf(disk_stat_str_prefix, sizeof(disk_stat_str_prefix), "proxy.process.cache.span_%d.io", i);
+      register_cache_disk_io_stats(gdisks[i]->io_rsb, disk_stat_str_prefix);
+    }
   }
 
   gvol = static_cast<Vol **>(ats_malloc(gnvol * sizeof(Vol *)));
@@ -858,6 +963,22 @@ CacheProcessor::diskInitialized()
   }
 }
 
+// The share of a volume's ram_cache_size given to one of its stripes, in proportion to the stripe length.
+static int64_t
+vol_ram_cache_size(Vol *v)
+{
+  int64_t vol_len = 0;
+  for (int i = 0; i < gnvol; i++) {
+    if (gvol[i]->cache_vol == v->cache_vol) {
+      vol_len += gvol[i]->len;
+    }
+  }
+  int64_t size = vol_len ? static_cast<int64_t>(v->cache_vol->ram_cache_size * (static_cast<double>(v->len) / vol_len)) : 0;
+  Debug("cache_init", "CacheProcessor::cacheInitialized - volume %d stripe %s ram_cache_size = %" PRId64, v->cache_vol->vol_number,
+        v->hash_text.get(), size);
+  return size;
+}
+
 void
 CacheProcessor::cacheInitialized()
 {
@@ -929,6 +1050,12 @@ CacheProcessor::cacheInitialized()
         case RAM_CACHE_ALGORITHM_LRU:
           gvol[i]->ram_cache = new_RamCacheLRU();
           break;
+        case RAM_CACHE_ALGORITHM_TINYLFU:
+          gvol[i]->ram_cache = new_RamCacheTinyLFU();
+          break;
+        }
+        if (cache_config_ram_cache_lock_free_entries > 0) {
+          gvol[i]->ram_cache_hot = new RamCacheHotIndex(cache_config_ram_cache_lock_free_entries);
         }
       }
       // let us calculate the Size
@@ -937,7 +1064,12 @@ CacheProcessor::cacheInitialized()
         for (i = 0; i < gnvol; i++) {
           vol = gvol[i];
 
-          if (gvol[i]->cache_vol->ramcache_enabled) {
+          if (gvol[i]->cache_vol->ramcache_enabled && gvol[i]->cache_vol->ram_cache_size) {
+            int64_t ram_size = vol_ram_cache_size(vol);
+            gvol[i]->ram_cache->init(ram_size, vol);
+            ram_cache_bytes += ram_size;
+            CACHE_VOL_SUM_DYN_STAT(cache_ram_cache_bytes_total_stat, ram_size);
+          } else if (gvol[i]->cache_vol->ramcache_enabled) {
             gvol[i]->ram_cache->init(vol->dirlen() * DEFAULT_RAM_CACHE_MULTIPLIER, vol);
             ram_cache_bytes += gvol[i]->dirlen();
             Debug("cache_init", "CacheProcessor::cacheInitialized - ram_cache_bytes = %" PRId64 " = %" PRId64 "Mb", ram_cache_bytes,
@@ -975,6 +1107,16 @@ CacheProcessor::cacheInitialized()
         Debug("cache_init", "CacheProcessor::cacheInitialized - stream_ram_cache_size = %" PRId64 " = %" PRId64 "Mb",
               stream_ram_cache_size, stream_ram_cache_size / (1024 * 1024));
 
+        // Volumes with their own ram_cache_size are taken out of the shared pool.
+        int64_t shared_cache_size = theCache ? theCache->cache_size : 0;
+        for (i = 0; i < gnvol; i++) {
+          if (gvol[i]->cache == theCache && gvol[i]->cache_vol->ramcache_enabled && gvol[i]->cache_vol->ram_cache_size) {
+            http_ram_cache_size -= vol_ram_cache_size(gvol[i]);
+            shared_cache_size -= gvol[i]->len >> STORE_BLOCK_SHIFT;
+          }
+        }
+        http_ram_cache_size = std::max(http_ram_cache_size, static_cast<int64_t>(0));
+
         // Dump some ram_cache size information in debug mode.
         Debug("ram_cache", "config: size = %" PRId64 ", cutoff = %" PRId64 "", cache_config_ram_cache_size,
               cache_config_ram_cache_cutoff);
@@ -982,9 +1124,14 @@ CacheProcessor::cacheInitialized()
         for (i = 0; i < gnvol; i++) {
           vol = gvol[i];
           double factor;
-          if (gvol[i]->cache == theCache && gvol[i]->cache_vol->ramcache_enabled) {
+          if (gvol[i]->cache == theCache && gvol[i]->cache_vol->ramcache_enabled && gvol[i]->cache_vol->ram_cache_size) {
+            int64_t ram_size = vol_ram_cache_size(vol);
+            gvol[i]->ram_cache->init(ram_size, vol);
+            ram_cache_bytes += ram_size;
+            CACHE_VOL_SUM_DYN_STAT(cache_ram_cache_bytes_total_stat, ram_size);
+          } else if (gvol[i]->cache == theCache && gvol[i]->cache_vol->ramcache_enabled) {
             ink_assert(gvol[i]->cache != nullptr);
-            factor = static_cast<double>(static_cast<int64_t>(gvol[i]->len >> STORE_BLOCK_SHIFT)) / theCache->cache_size;
+            factor = static_cast<double>(static_cast<int64_t>(gvol[i]->len >> STORE_BLOCK_SHIFT)) / shared_cache_size;
             Debug("cache_init", "CacheProcessor::cacheInitialized - factor = %f", factor);
             gvol[i]->ram_cache->init(static_cast<int64_t>(http_ram_cache_size * factor), vol);
             ram_cache_bytes += static_cast<int64_t>(http_ram_cache_size * factor);
@@ -1033,6 +1180,18 @@ CacheProcessor::cacheInitialized()
       GLOBAL_CACHE_SET_DYN_STAT(cache_direntries_used_stat, used_direntries);
       if (!check) {
         dir_sync_init();
+        if (cache_config_ram_cache_persist_entries > 0) {
+          ram_cache_persist_init();
+        }
+        if (cache_config_scrub_rate > 0) {
+          cache_scrub_init();
+        }
+        if (cache_config_hot_replica_copies > 0) {
+          cache_replica_init();
+        }
+        if (cache_config_surrogate_key_header) {
+          cache_surrogate_key_init();
+        }
       }
       cache_init_ok = 1;
     } else {
@@ -1109,6 +1268,15 @@ CacheProcessor::remove(Continuation *cont, const CacheKey *key, CacheFragType fr
   return caches[frag_type]->remove(cont, key, frag_type, hostname, host_len);
 }
 
+int64_t
+CacheProcessor::invalidate_tag(const char *tag, int tag_len)
+{
+  if (!cache_config_surrogate_key_header) {
+    return 0;
+  }
+  return cache_surrogate_key_invalidate(std::string_view(tag, tag_len));
+}
+
 Action *
 CacheProcessor::lookup(Continuation *cont, const HttpCacheKey *key, CacheFragType frag_type)
 {
@@ -1158,7 +1326,7 @@ static void
 vol_init_data_internal(Vol *d)
 {
   // step1: calculate the number of entries.
-  off_t total_entries = (d->len - (d->start - d->skip)) / cache_config_min_average_object_size;
+  off_t total_entries = (d->len - (d->start - d->skip)) / d->average_object_size();
   // step2: calculate the number of buckets
   off_t total_buckets = total_entries / DIR_DEPTH;
   // step3: calculate the number of segments, no segment has more than 16384 buckets
@@ -1210,8 +1378,10 @@ vol_clear_init(Vol *d)
   d->header->cycle                                        = 0;
   d->header->create_time                                  = time(nullptr);
   d->header->dirty                                        = 0;
+  d->header->key_hash                                     = cache_config_key_hash;
   d->sector_size = d->header->sector_size = d->disk->hw_sector_size;
   *d->footer                              = *d->header;
+  d->dir_mark_all_dirty();
 }
 
 int
@@ -1259,6 +1429,8 @@ Vol::init(char *s, off_t blocks, off_t dir_skip, bool clear)
            static_cast<uint64_t>(dir_skip), static_cast<uint64_t>(blocks));
   CryptoContext().hash_immediate(hash_id, hash_text, strlen(hash_text));
 
+  init_start = Thread::get_hrtime();
+
   dir_skip = ROUND_TO_STORE_BLOCK((dir_skip < START_POS ? START_POS : dir_skip));
   path     = ats_strdup(s);
   len      = blocks * STORE_BLOCK_SIZE;
@@ -1276,6 +1448,9 @@ Vol::init(char *s, off_t blocks, off_t dir_skip, bool clear)
   int evac_len  = evacuate_size * sizeof(DLL<EvacuationBlock>);
   evacuate      = static_cast<DLL<EvacuationBlock> *>(ats_malloc(evac_len));
   memset(static_cast<void *>(evacuate), 0, evac_len);
+  if (cache_config_scrub_rate > 0) {
+    heat.assign(direntries(), 0);
+  }
 
   Debug("cache_init", "Vol %s: allocating %zu directory bytes for a %lld byte volume (%lf%%)", hash_text.get(), dirlen(),
         (long long)this->len, (double)dirlen() / (double)this->len * 100.0);
@@ -1291,6 +1466,9 @@ Vol::init(char *s, off_t blocks, off_t dir_skip, bool clear)
   dir    = reinterpret_cast<Dir *>(raw_dir + this->headerlen());
   header = reinterpret_cast<VolHeaderFooter *>(raw_dir);
   footer = reinterpret_cast<VolHeaderFooter *>(raw_dir + this->dirlen() - ROUND_TO_STORE_BLOCK(sizeof(VolHeaderFooter)));
+  // Whatever is on disk may not match either copy, so everything starts out dirty.
+  size_t dir_blocks = ROUND_TO_STORE_BLOCK(static_cast<size_t>(buckets) * DIR_DEPTH * segments * SIZEOF_DIR) / STORE_BLOCK_SIZE;
+  dir_dirty_blocks.assign(dir_blocks, 0x3);
 
   if (clear) {
     Note("clearing cache directory '%s'", hash_text.get());
@@ -1320,7 +1498,7 @@ Vol::init(char *s, off_t blocks, off_t dir_skip, bool clear)
     aio->thread           = AIO_CALLBACK_THREAD_ANY;
     aio->then             = (i < 3) ? &(init_info->vol_aio[i + 1]) : nullptr;
   }
-#if AIO_MODE == AIO_MODE_NATIVE
+#if AIO_MODE == AIO_MODE_NATIVE || AIO_MODE == AIO_MODE_IO_URING
   ink_assert(ink_aio_readv(init_info->vol_aio));
 #else
   ink_assert(ink_aio_read(init_info->vol_aio));
@@ -1385,6 +1563,15 @@ Vol::handle_dir_read(int event, void *data)
   }
   CHECK_DIR(this);
 
+  // Stripes from before the key hash was recorded were all made with the default.
+  uint32_t key_hash = header->version < ts::VersionNumber(24, 3) ? CACHE_KEY_HASH_DEFAULT : header->key_hash;
+  if (key_hash != static_cast<uint32_t>(cache_config_key_hash)) {
+    Note("cache directory '%s' has keys from hash %u, proxy.config.cache.key_hash is %d, clearing", hash_text.get(), key_hash,
+         cache_config_key_hash);
+    clear_dir();
+    return EVENT_DONE;
+  }
+
   sector_size = header->sector_size;
 
   return this->recover_data();
@@ -1465,6 +1652,8 @@ Vol::handle_recover_from_data(int event, void * /* data ATS_UNUSED */)
       disk->incrErrors(&io);
       goto Lclear;
     }
+    Vol *vol = this; // must be named "vol" to make STAT macros work.
+    CACHE_SUM_GLOBAL_DYN_STAT(cache_init_recovery_bytes_stat, io.aio_result);
     if (io.aiocb.aio_offset == header->last_write_pos) {
       /* check that we haven't wrapped around without syncing
          the directory. Start from last_write_serial (write pos the documents
@@ -1472,7 +1661,8 @@ Vol::handle_recover_from_data(int event, void * /* data ATS_UNUSED */)
          that all documents have write_serial <= header->write_serial.
        */
       uint32_t to_check = header->write_pos - header->last_write_pos;
-      ink_assert(to_check && to_check < (uint32_t)io.aiocb.aio_nbytes);
+      // a failed aggregation write at the end leaves nothing to check
+      ink_assert(to_check < (uint32_t)io.aiocb.aio_nbytes);
       uint32_t done = 0;
       s             = static_cast<char *>(io.aiocb.aio_buf);
       while (done < to_check) {
@@ -1681,7 +1871,7 @@ Ldone : {
   init_info->vol_aio[2].aiocb.aio_offset = ss + dirlen - footerlen;
 
   SET_HANDLER(&Vol::handle_recover_write_dir);
-#if AIO_MODE == AIO_MODE_NATIVE
+#if AIO_MODE == AIO_MODE_NATIVE || AIO_MODE == AIO_MODE_IO_URING
   ink_assert(ink_aio_writev(init_info->vol_aio));
 #else
   ink_assert(ink_aio_write(init_info->vol_aio));
@@ -1781,6 +1971,11 @@ Vol::dir_init_done(int /* event ATS_UNUSED */, void * /* data ATS_UNUSED */)
     ink_assert(!gvol[vol_no]);
     gvol[vol_no] = this;
     SET_HANDLER(&Vol::aggWrite);
+    Vol *vol = this; // must be named "vol" to make STAT macros work.
+    CACHE_SUM_GLOBAL_DYN_STAT(cache_init_stripes_pending_stat, -1);
+    Debug("cache_init", "Vol %s: online after %" PRId64 " ms", hash_text.get(),
+          ink_hrtime_to_msec(Thread::get_hrtime() - init_start));
+    vol_init_finish(disk);
     if (fd == -1) {
       cache->vol_initialized(false);
     } else {
@@ -2105,11 +2300,9 @@ Cache::open(bool clear, bool /* fix ATS_UNUSED */)
             blocks                      = q->b->len;
 
             bool vol_clear = clear || d->cleared || q->new_block;
-#if AIO_MODE == AIO_MODE_NATIVE
-            eventProcessor.schedule_imm(new VolInit(cp->vols[vol_no], d->path, blocks, q->b->offset, vol_clear));
-#else
-            cp->vols[vol_no]->init(d->path, blocks, q->b->offset, vol_clear);
-#endif
+            Vol *vol       = cp->vols[vol_no]; // must be named "vol" to make STAT macros work.
+            CACHE_SUM_GLOBAL_DYN_STAT(cache_init_stripes_pending_stat, 1);
+            vol_init_start(d, new VolInit(vol, d->path, blocks, q->b->offset, vol_clear));
             vol_no++;
             cache_size += blocks;
           }
@@ -2144,6 +2337,42 @@ CacheVC::is_pread_capable()
   return !f.read_from_writer_called;
 }
 
+int64_t
+CacheVC::get_cached_length(int64_t offset)
+{
+  int64_t size = doc_len;
+  if (offset >= size) {
+    return 0;
+  }
+  if (!f.sparse) {
+    return size - offset;
+  }
+  int64_t frag_size = alternate.sparse_frag_size_get();
+  int64_t i         = offset / frag_size;
+  while (i * frag_size < size && (sparse_map[i / 8] & (1 << (i % 8)))) {
+    ++i;
+  }
+  return std::max(std::min(i * frag_size, size) - offset, static_cast<int64_t>(0));
+}
+
+void
+CacheVC::load_sparse_map()
+{
+  int n = alternate.get_frag_offset_count() + 1;
+  CacheKey k;
+  Dir d;
+  ink_assert(vol->mutex->thread_holding == this_ethread());
+  sparse_map = static_cast<uint8_t *>(ats_calloc((n + 7) / 8, 1));
+  alternate.object_key_get(&k);
+  for (int i = 0; i < n; ++i) {
+    Dir *lc = nullptr;
+    if (dir_probe(&k, vol, &d, &lc)) {
+      sparse_map[i / 8] |= 1 << (i % 8);
+    }
+    next_CacheKey(&k, &k);
+  }
+}
+
 #define STORE_COLLISION 1
 
 static void
@@ -2183,6 +2412,7 @@ CacheVC::handleReadDone(int event, Event *e)
   Doc *doc = nullptr;
   if (event == AIO_EVENT_DONE) {
     set_io_not_in_progress();
+    vol->disk->io_read_done(&io);
   } else if (is_io_in_progress()) {
     return EVENT_CONT;
   }
@@ -2275,7 +2505,11 @@ CacheVC::handleReadDone(int event, Event *e)
            (doc_len && static_cast<int64_t>(doc_len) < cache_config_ram_cache_cutoff) || !cache_config_ram_cache_cutoff);
         if (cutoff_check && !f.doc_from_ram_cache) {
           uint64_t o = dir_offset(&dir);
-          vol->ram_cache->put(read_key, buf.get(), doc->len, http_copy_hdr, o);
+          if (f.ram_cache_preload) {
+            vol->ram_cache->warm(read_key, buf.get(), doc->len, http_copy_hdr, o);
+          } else {
+            vol->ram_cache->put(read_key, buf.get(), doc->len, http_copy_hdr, o);
+          }
         }
         if (!doc_len) {
           // keep a pointer to it. In case the state machine decides to
@@ -2313,6 +2547,15 @@ CacheVC::handleRead(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
     goto LramHit;
   }
 
+  // check if the writer of this object has it in its fragment ring
+  if (write_vc) {
+    OpenDirEntry *cod = vol->open_read(&first_key);
+    if (cod && cod->frag_ring_get(read_key, &buf)) {
+      CACHE_INCREMENT_DYN_STAT(cache_read_writer_fragment_hits_stat);
+      goto LmemHit;
+    }
+  }
+
   // check if it was read in the last open_read call
   if (*read_key == vol->first_fragment_key && dir_offset(&dir) == vol->first_fragment_offset) {
     buf = vol->first_fragment_data;
@@ -2321,7 +2564,7 @@ CacheVC::handleRead(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
   // see if its in the aggregation buffer
   if (dir_agg_buf_valid(vol, &dir)) {
     int agg_offset = vol->vol_offset(&dir) - vol->header->write_pos;
-    buf            = new_IOBufferData(iobuffer_size_to_index(io.aiocb.aio_nbytes, MAX_BUFFER_SIZE_INDEX), MEMALIGNED);
+    buf            = new_IOBufferData(iobuffer_size_to_index(io.aiocb.aio_nbytes, MAX_BUFFER_SIZE_INDEX), POOL_ALIGNED);
     ink_assert((agg_offset + io.aiocb.aio_nbytes) <= (unsigned)vol->agg_buf_pos);
     char *doc = buf->data();
     char *agg = vol->agg_buffer + agg_offset;
@@ -2336,12 +2579,12 @@ CacheVC::handleRead(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
   if (static_cast<off_t>(io.aiocb.aio_offset + io.aiocb.aio_nbytes) > static_cast<off_t>(vol->skip + vol->len)) {
     io.aiocb.aio_nbytes = vol->skip + vol->len - io.aiocb.aio_offset;
   }
-  buf              = new_IOBufferData(iobuffer_size_to_index(io.aiocb.aio_nbytes, MAX_BUFFER_SIZE_INDEX), MEMALIGNED);
+  buf              = new_IOBufferData(iobuffer_size_to_index(io.aiocb.aio_nbytes, MAX_BUFFER_SIZE_INDEX), POOL_ALIGNED);
   io.aiocb.aio_buf = buf->data();
   io.action        = this;
   io.thread        = mutex->thread_holding->tt == DEDICATED ? AIO_CALLBACK_THREAD_ANY : mutex->thread_holding;
   SET_HANDLER(&CacheVC::handleReadDone);
-  ink_assert(ink_aio_read(&io) >= 0);
+  vol->disk->io_read(&io);
   CACHE_DEBUG_INCREMENT_DYN_STAT(cache_pread_count_stat);
   return EVENT_CONT;
 
@@ -2481,14 +2724,23 @@ Cache::remove(Continuation *cont, const CacheKey *key, CacheFragType type, const
     return ACTION_RESULT_DONE;
   }
 
+  return remove_in_vol(cont, key, type, key_to_vol(key, hostname, host_len));
+}
+
+// Remove from a known stripe, for callers which kept the stripe rather than the hostname.
+Action *
+Cache::remove_in_vol(Continuation *cont, const CacheKey *key, CacheFragType type, Vol *vol)
+{
   Ptr<ProxyMutex> mutex;
   if (!cont) {
     cont = new_CacheRemoveCont();
   }
+  if (cache_config_hot_replica_copies > 0) {
+    cache_replica_retire(key);
+  }
 
   CACHE_TRY_LOCK(lock, cont->mutex, this_ethread());
   ink_assert(lock.is_locked());
-  Vol *vol = key_to_vol(key, hostname, host_len);
   // coverity[var_decl]
   Dir result;
   dir_clear(&result); // initialized here, set result empty so we can recognize missed lock
@@ -2556,6 +2808,17 @@ cplist_init()
 
 static int fillExclusiveDisks(CacheVol *cp);
 
+/* copy the per volume settings from volume.config */
+static void
+cplist_configure(CacheVol *cp, ConfigVol *config_vol)
+{
+  cp->ramcache_enabled = config_vol->ramcache_enabled;
+  cp->avg_obj_size     = config_vol->avg_obj_size;
+  cp->fragment_size    = config_vol->fragment_size;
+  cp->ram_cache_size   = config_vol->ram_cache_size;
+  config_vol->cachep   = cp;
+}
+
 void
 cplist_update()
 {
@@ -2567,8 +2830,7 @@ cplist_update()
     for (config_vol = config_volumes.cp_queue.head; config_vol; config_vol = config_vol->link.next) {
       if (config_vol->number == cp->vol_number) {
         if (cp->scheme == config_vol->scheme) {
-          cp->ramcache_enabled = config_vol->ramcache_enabled;
-          config_vol->cachep   = cp;
+          cplist_configure(cp, config_vol);
         } else {
           /* delete this volume from all the disks */
           int d_no;
@@ -2577,8 +2839,8 @@ cplist_update()
           for (d_no = 0; d_no < gndisks; d_no++) {
             if (cp->disk_vols[d_no]) {
               if (cp->disk_vols[d_no]->disk->forced_volume_num == cp->vol_number) {
-                clearCV            = 0;
-                config_vol->cachep = cp;
+                clearCV = 0;
+                cplist_configure(cp, config_vol);
               } else {
                 cp->disk_vols[d_no]->disk->delete_volume(cp->vol_number);
                 cp->disk_vols[d_no] = nullptr;
@@ -2635,7 +2897,7 @@ cplist_update()
             memset(new_cp->disk_vols, 0, gndisks * sizeof(DiskVol *));
             new_cp->vol_number = config_vol->number;
             new_cp->scheme     = config_vol->scheme;
-            config_vol->cachep = new_cp;
+            cplist_configure(new_cp, config_vol);
             fillExclusiveDisks(config_vol->cachep);
             cp_list.enqueue(new_cp);
           } else {
@@ -2852,7 +3114,7 @@ cplist_reconfigure()
         }
         cp_list.enqueue(new_cp);
         cp_list_len++;
-        config_vol->cachep = new_cp;
+        cplist_configure(new_cp, config_vol);
         gnvol += new_cp->num_vols;
         continue;
       }
@@ -3073,6 +3335,23 @@ reg_int(const char *str, int stat, RecRawStatBlock *rsb, const char *prefix, Rec
 }
 #define REG_INT(_str, _stat) reg_int(_str, (int)_stat, rsb, prefix)
 
+static void
+register_cache_disk_io_stats(RecRawStatBlock *rsb, const char *prefix)
+{
+  static const char *buckets[CACHE_DISK_IO_LATENCY_BUCKETS] = {"1ms", "4ms", "16ms", "64ms", "256ms", "max"};
+  char name[64];
+
+  REG_INT("reads_in_flight", cache_disk_io_reads_in_flight_stat);
+  REG_INT("writes_in_flight", cache_disk_io_writes_in_flight_stat);
+  REG_INT("writes_queued", cache_disk_io_writes_queued_stat);
+  for (int i = 0; i < CACHE_DISK_IO_LATENCY_BUCKETS; ++i) {
+    snprintf(name, sizeof(name), "read_latency.%s", buckets[i]);
+    REG_INT(name, cache_disk_io_read_latency_stat + i);
+    snprintf(name, sizeof(name), "write_latency.%s", buckets[i]);
+    REG_INT(name, cache_disk_io_write_latency_stat + i);
+  }
+}
+
 // Register Stats
 void
 register_cache_stats(RecRawStatBlock *rsb, const char *prefix)
@@ -3085,6 +3364,8 @@ register_cache_stats(RecRawStatBlock *rsb, const char *prefix)
   REG_INT("ram_cache.bytes_used", cache_ram_cache_bytes_stat);
   REG_INT("ram_cache.hits", cache_ram_cache_hits_stat);
   REG_INT("ram_cache.misses", cache_ram_cache_misses_stat);
+  REG_INT("ram_cache.admission_rejects", cache_ram_cache_admission_rejects_stat);
+  REG_INT("ram_cache.lock_free_hits", cache_ram_cache_lock_free_hits_stat);
   REG_INT("pread_count", cache_pread_count_stat);
   REG_INT("percent_full", cache_percent_full_stat);
   REG_INT("lookup.active", cache_lookup_active_stat);
@@ -3126,6 +3407,29 @@ register_cache_stats(RecRawStatBlock *rsb, const char *prefix)
   REG_INT("wrap_count", cache_directory_wrap_stat);
   REG_INT("sync.count", cache_directory_sync_count_stat);
   REG_INT("sync.bytes", cache_directory_sync_bytes_stat);
+  REG_INT("sync.bytes_skipped", cache_directory_sync_skipped_bytes_stat);
+  REG_INT("sync.last_bytes", cache_directory_sync_last_bytes_stat);
+  REG_INT("init.stripes_pending", cache_init_stripes_pending_stat);
+  REG_INT("init.recovery_bytes", cache_init_recovery_bytes_stat);
+  REG_INT("read.lock_contention", cache_read_lock_contention_stat);
+  REG_INT("read.writer_fragment_hits", cache_read_writer_fragment_hits_stat);
+  REG_INT("scrub.evacuations", cache_scrub_evacuate_stat);
+  REG_INT("hot_replica.objects", cache_hot_replica_objects_stat);
+  REG_INT("hot_replica.reads", cache_hot_replica_reads_stat);
+  REG_INT("hot_replica.retired", cache_hot_replica_retired_stat);
+  REG_INT("hot_replica.writes", cache_hot_replica_writes_stat);
+  REG_INT("surrogate_key.documents", cache_surrogate_key_documents_stat);
+  REG_INT("surrogate_key.invalidated", cache_surrogate_key_invalidated_stat);
+  REG_INT("surrogate_key.tags", cache_surrogate_key_tags_stat);
+  reg_int("buffer_pool.reserved_bytes", cache_buffer_pool_reserved_bytes_stat, rsb, prefix, cache_stats_buffer_pool_cb);
+  reg_int("buffer_pool.hugepage_bytes", cache_buffer_pool_hugepage_bytes_stat, rsb, prefix, cache_stats_buffer_pool_cb);
+  reg_int("buffer_pool.in_use_bytes", cache_buffer_pool_in_use_bytes_stat, rsb, prefix, cache_stats_buffer_pool_cb);
+  reg_int("buffer_pool.allocations", cache_buffer_pool_allocs_stat, rsb, prefix, cache_stats_buffer_pool_cb);
+  reg_int("buffer_pool.thread_cache_hits", cache_buffer_pool_thread_cache_hits_stat, rsb, prefix, cache_stats_buffer_pool_cb);
+  REG_INT("agg_write_size.64k", cache_agg_write_size_64k_stat);
+  REG_INT("agg_write_size.256k", cache_agg_write_size_256k_stat);
+  REG_INT("agg_write_size.1m", cache_agg_write_size_1m_stat);
+  REG_INT("agg_write_size.4m", cache_agg_write_size_4m_stat);
   REG_INT("sync.time", cache_directory_sync_time_stat);
   REG_INT("span.errors.read", cache_span_errors_read_stat);
   REG_INT("span.errors.write", cache_span_errors_write_stat);
@@ -3161,6 +3465,10 @@ ink_cache_init(ts::ModuleVersion v)
   REC_EstablishStaticConfigInt32(cache_config_ram_cache_compress, "proxy.config.cache.ram_cache.compress");
   REC_EstablishStaticConfigInt32(cache_config_ram_cache_compress_percent, "proxy.config.cache.ram_cache.compress_percent");
   REC_ReadConfigInt32(cache_config_ram_cache_use_seen_filter, "proxy.config.cache.ram_cache.use_seen_filter");
+  REC_EstablishStaticConfigInt32(cache_config_ram_cache_lock_free_entries, "proxy.config.cache.ram_cache.lock_free_entries");
+  REC_EstablishStaticConfigInt32(cache_config_ram_cache_persist_entries, "proxy.config.cache.ram_cache.persist_entries");
+  REC_EstablishStaticConfigInt32(cache_config_ram_cache_persist_frequency, "proxy.config.cache.ram_cache.persist_frequency");
+  REC_EstablishStaticConfigInt32(cache_config_ram_cache_preload_rate, "proxy.config.cache.ram_cache.preload_rate");
 
   REC_EstablishStaticConfigInt32(cache_config_http_max_alts, "proxy.config.cache.limits.http.max_alts");
   Debug("cache_init", "proxy.config.cache.limits.http.max_alts = %d", cache_config_http_max_alts);
@@ -3178,6 +3486,14 @@ ink_cache_init(ts::ModuleVersion v)
   REC_EstablishStaticConfigInt32(cache_config_select_alternate, "proxy.config.cache.select_alternate");
   Debug("cache_init", "proxy.config.cache.select_alternate = %d", cache_config_select_alternate);
 
+  REC_EstablishStaticConfigInt32(cache_config_key_hash, "proxy.config.cache.key_hash");
+  Debug("cache_init", "proxy.config.cache.key_hash = %d", cache_config_key_hash);
+  if (cache_config_key_hash == CACHE_KEY_HASH_SIPHASH) {
+    URLHashContext::Setting = URLHashContext::SIPHASH;
+  } else {
+    cache_config_key_hash = CACHE_KEY_HASH_DEFAULT;
+  }
+
   REC_EstablishStaticConfigInt32(cache_config_max_doc_size, "proxy.config.cache.max_doc_size");
   Debug("cache_init", "proxy.config.cache.max_doc_size = %d = %dMb", cache_config_max_doc_size,
         cache_config_max_doc_size / (1024 * 1024));
@@ -3185,18 +3501,50 @@ ink_cache_init(ts::ModuleVersion v)
   REC_EstablishStaticConfigInt32(cache_config_mutex_retry_delay, "proxy.config.cache.mutex_retry_delay");
   Debug("cache_init", "proxy.config.cache.mutex_retry_delay = %dms", cache_config_mutex_retry_delay);
 
+  REC_EstablishStaticConfigInt32(cache_config_init_stripes_per_disk, "proxy.config.cache.init.stripes_per_disk");
+  Debug("cache_init", "proxy.config.cache.init.stripes_per_disk = %d", cache_config_init_stripes_per_disk);
+
   REC_EstablishStaticConfigInt32(cache_config_read_while_writer_max_retries, "proxy.config.cache.read_while_writer.max_retries");
   Debug("cache_init", "proxy.config.cache.read_while_writer.max_retries = %d", cache_config_read_while_writer_max_retries);
 
   REC_EstablishStaticConfigInt32(cache_read_while_writer_retry_delay, "proxy.config.cache.read_while_writer_retry.delay");
   Debug("cache_init", "proxy.config.cache.read_while_writer_retry.delay = %dms", cache_read_while_writer_retry_delay);
 
+  REC_EstablishStaticConfigInt32(cache_config_read_while_writer_fragment_ring, "proxy.config.cache.read_while_writer.fragment_ring");
+  Debug("cache_init", "proxy.config.cache.read_while_writer.fragment_ring = %d", cache_config_read_while_writer_fragment_ring);
+
   REC_EstablishStaticConfigInt32(cache_config_hit_evacuate_percent, "proxy.config.cache.hit_evacuate_percent");
   Debug("cache_init", "proxy.config.cache.hit_evacuate_percent = %d", cache_config_hit_evacuate_percent);
 
   REC_EstablishStaticConfigInt32(cache_config_hit_evacuate_size_limit, "proxy.config.cache.hit_evacuate_size_limit");
   Debug("cache_init", "proxy.config.cache.hit_evacuate_size_limit = %d", cache_config_hit_evacuate_size_limit);
 
+  REC_EstablishStaticConfigInt32(cache_config_scrub_rate, "proxy.config.cache.scrub.rate");
+  Debug("cache_init", "proxy.config.cache.scrub.rate = %d", cache_config_scrub_rate);
+
+  REC_EstablishStaticConfigInt32(cache_config_scrub_heat_threshold, "proxy.config.cache.scrub.heat_threshold");
+  Debug("cache_init", "proxy.config.cache.scrub.heat_threshold = %d", cache_config_scrub_heat_threshold);
+
+  REC_EstablishStaticConfigInt32(cache_config_hot_replica_copies, "proxy.config.cache.hot_replica.copies");
+  Debug("cache_init", "proxy.config.cache.hot_replica.copies = %d", cache_config_hot_replica_copies);
+
+  REC_EstablishStaticConfigInt32(cache_config_hot_replica_threshold, "proxy.config.cache.hot_replica.threshold");
+  Debug("cache_init", "proxy.config.cache.hot_replica.threshold = %d", cache_config_hot_replica_threshold);
+
+  REC_ReadConfigStringAlloc(cache_config_surrogate_key_header, "proxy.config.cache.surrogate_key.header");
+  if (cache_config_surrogate_key_header && !*cache_config_surrogate_key_header) {
+    ats_free(cache_config_surrogate_key_header);
+    cache_config_surrogate_key_header = nullptr;
+  }
+  Debug("cache_init", "proxy.config.cache.surrogate_key.header = %s",
+        cache_config_surrogate_key_header ? cache_config_surrogate_key_header : "");
+
+  REC_ReadConfigInt32(cache_config_buffer_pool_hugepages, "proxy.config.cache.buffer_pool.hugepages");
+  REC_ReadConfigInteger(cache_config_buffer_pool_thread_cache, "proxy.config.cache.buffer_pool.thread_cache_size");
+  Debug("cache_init", "proxy.config.cache.buffer_pool.hugepages = %d, thread_cache_size = %" PRId64,
+        cache_config_buffer_pool_hugepages, cache_config_buffer_pool_thread_cache);
+  init_aligned_buffer_pool(cache_config_buffer_pool_hugepages != 0, cache_config_buffer_pool_thread_cache);
+
   REC_EstablishStaticConfigInt32(cache_config_force_sector_size, "proxy.config.cache.force_sector_size");
 
   ink_assert(REC_RegisterConfigUpdateFunc("proxy.config.cache.target_fragment_size", FragmentSizeUpdateCb, nullptr) !=
@@ -3213,6 +3561,12 @@ ink_cache_init(ts::ModuleVersion v)
   REC_EstablishStaticConfigInt32(cache_config_agg_write_backlog, "proxy.config.cache.agg_write_backlog");
   Debug("cache_init", "proxy.config.cache.agg_write_backlog = %d", cache_config_agg_write_backlog);
 
+  REC_EstablishStaticConfigInt32(cache_config_agg_write_in_flight, "proxy.config.cache.agg_write_in_flight");
+  Debug("cache_init", "proxy.config.cache.agg_write_in_flight = %d", cache_config_agg_write_in_flight);
+
+  REC_EstablishStaticConfigInt32(cache_config_io_max_writes_in_flight, "proxy.config.cache.io.max_writes_in_flight");
+  Debug("cache_init", "proxy.config.cache.io.max_writes_in_flight = %d", cache_config_io_max_writes_in_flight);
+
   REC_EstablishStaticConfigInt32(cache_config_enable_checksum, "proxy.config.cache.enable_checksum");
   Debug("cache_init", "proxy.config.cache.enable_checksum = %d", cache_config_enable_checksum);
 
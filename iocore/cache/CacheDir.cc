@@ -88,6 +88,10 @@ OpenDir::open_write(CacheVC *cont, int allow_if_writers, int max_writers)
     }
     return 0;
   }
+  // lock free reads must not be served while the document is being written
+  if (cont->vol->ram_cache_hot) {
+    cont->vol->ram_cache_hot->remove(&cont->first_key);
+  }
   OpenDirEntry *od = THREAD_ALLOC(openDirEntryAllocator, cont->mutex->thread_holding);
   od->readers.head = nullptr;
   od->writers.push(cont);
@@ -98,6 +102,7 @@ OpenDir::open_write(CacheVC *cont, int allow_if_writers, int max_writers)
   od->move_resident_alt     = false;
   od->reading_vec           = false;
   od->writing_vec           = false;
+  od->frag_ring_next        = 0;
   dir_clear(&od->first_dir);
   cont->od           = od;
   cont->write_vector = &od->vector;
@@ -144,6 +149,7 @@ OpenDir::close_write(CacheVC *cont)
     delayed_readers.append(cont->od->readers);
     signal_readers(0, nullptr);
     cont->od->vector.clear();
+    cont->od->frag_ring_clear();
     THREAD_FREE(cont->od, openDirEntryAllocator, cont->mutex->thread_holding);
   }
   cont->od = nullptr;
@@ -174,6 +180,43 @@ OpenDirEntry::wait(CacheVC *cont, int msec)
   return EVENT_CONT;
 }
 
+// One copy of each fragment, however many readers there are. A reader which falls further
+// behind than the ring reads from disk, the writer never waits for readers.
+void
+OpenDirEntry::frag_ring_put(const Doc *doc)
+{
+  int n = std::min(cache_config_read_while_writer_fragment_ring, OPEN_DIR_FRAG_RING_SIZE);
+  if (n <= 0) {
+    return;
+  }
+  int i             = frag_ring_next % n;
+  frag_ring_key[i]  = doc->key;
+  frag_ring_data[i] = new_IOBufferData(iobuffer_size_to_index(doc->len, MAX_BUFFER_SIZE_INDEX), POOL_ALIGNED);
+  memcpy(frag_ring_data[i]->data(), doc, doc->len);
+  frag_ring_next = (i + 1) % n;
+}
+
+bool
+OpenDirEntry::frag_ring_get(const CacheKey *key, Ptr<IOBufferData> *data) const
+{
+  for (int i = 0; i < OPEN_DIR_FRAG_RING_SIZE; ++i) {
+    if (frag_ring_data[i] && frag_ring_key[i] == *key) {
+      *data = frag_ring_data[i];
+      return true;
+    }
+  }
+  return false;
+}
+
+void
+OpenDirEntry::frag_ring_clear()
+{
+  for (auto &data : frag_ring_data) {
+    data.clear();
+  }
+  frag_ring_next = 0;
+}
+
 //
 // Cache Directory
 //
@@ -218,6 +261,7 @@ dir_init_segment(int s, Vol *d)
   Dir *seg               = d->dir_segment(s);
   int l, b;
   memset(static_cast<void *>(seg), 0, SIZEOF_DIR * DIR_DEPTH * d->buckets);
+  d->dir_mark_dirty(seg, DIR_DEPTH * d->buckets);
   for (l = 1; l < DIR_DEPTH; l++) {
     for (b = 0; b < d->buckets; b++) {
       Dir *bucket = dir_bucket(b, seg);
@@ -305,12 +349,14 @@ unlink_from_freelist(Dir *e, int s, Vol *d)
   Dir *p   = dir_from_offset(dir_prev(e), seg);
   if (p) {
     dir_set_next(p, dir_next(e));
+    d->dir_mark_dirty(p);
   } else {
     d->header->freelist[s] = dir_next(e);
   }
   Dir *n = dir_from_offset(dir_next(e), seg);
   if (n) {
     dir_set_prev(n, dir_prev(e));
+    d->dir_mark_dirty(n);
   }
 }
 
@@ -320,14 +366,17 @@ dir_delete_entry(Dir *e, Dir *p, int s, Vol *d)
   Dir *seg         = d->dir_segment(s);
   int no           = dir_next(e);
   d->header->dirty = 1;
+  d->dir_mark_dirty(e);
   if (p) {
     unsigned int fo = d->header->freelist[s];
     unsigned int eo = dir_to_offset(e, seg);
     dir_clear(e);
     dir_set_next(p, no);
+    d->dir_mark_dirty(p);
     dir_set_next(e, fo);
     if (fo) {
       dir_set_prev(dir_from_offset(fo, seg), eo);
+      d->dir_mark_dirty(dir_from_offset(fo, seg));
     }
     d->header->freelist[s] = eo;
   } else {
@@ -403,6 +452,7 @@ dir_clear_range(off_t start, off_t end, Vol *vol)
     if (!dir_token(e) && dir_offset(e) >= static_cast<int64_t>(start) && dir_offset(e) < static_cast<int64_t>(end)) {
       CACHE_DEC_DIR_USED(vol->mutex);
       dir_set_offset(e, 0); // delete
+      vol->dir_mark_dirty(e);
     }
   }
   dir_clean_vol(vol);
@@ -438,6 +488,7 @@ freelist_clean(int s, Vol *vol)
       if (dir_head(e) && !(n++ % 10)) {
         CACHE_DEC_DIR_USED(vol->mutex);
         dir_set_offset(e, 0); // delete
+        vol->dir_mark_dirty(e);
       }
     }
   }
@@ -462,6 +513,7 @@ freelist_pop(int s, Vol *d)
   Dir *h = dir_from_offset(d->header->freelist[s], seg);
   if (h) {
     dir_set_prev(h, 0);
+    d->dir_mark_dirty(h);
   }
   return e;
 }
@@ -526,8 +578,10 @@ dir_free_entry(Dir *e, int s, Vol *d)
   unsigned int fo = d->header->freelist[s];
   unsigned int eo = dir_to_offset(e, seg);
   dir_set_next(e, fo);
+  d->dir_mark_dirty(e);
   if (fo) {
     dir_set_prev(dir_from_offset(fo, seg), eo);
+    d->dir_mark_dirty(dir_from_offset(fo, seg));
   }
   d->header->freelist[s] = eo;
 }
@@ -540,6 +594,8 @@ dir_probe(const CacheKey *key, Vol *d, Dir *result, Dir **last_collision)
   int b    = key->slice32(1) % d->buckets;
   Dir *seg = d->dir_segment(s);
   Dir *e = nullptr, *p = nullptr, *collision = *last_collision;
+  Dir *bucket = dir_bucket(b, seg);
+  uint32_t match;
   Vol *vol = d;
   CHECK_DIR(d);
 #ifdef LOOP_CHECK_MODE
@@ -547,10 +603,11 @@ dir_probe(const CacheKey *key, Vol *d, Dir *result, Dir **last_collision)
     return 0;
 #endif
 Lagain:
-  e = dir_bucket(b, seg);
+  e     = bucket;
+  match = dir_bucket_match(bucket, key);
   if (dir_offset(e)) {
     do {
-      if (dir_compare_tag(e, key)) {
+      if (dir_compare_tag(e, key, bucket, match)) {
         ink_assert(dir_offset(e));
         // Bug: 51680. Need to check collision before checking
         // dir_valid(). In case of a collision, if !dir_valid(), we
@@ -577,7 +634,8 @@ Lagain:
           return 1;
         } else { // delete the invalid entry
           CACHE_DEC_DIR_USED(d->mutex);
-          e = dir_delete_entry(e, p, s, d);
+          e     = dir_delete_entry(e, p, s, d);
+          match = dir_bucket_match(bucket, key); // the delete may have moved entries
           continue;
         }
       } else {
@@ -603,6 +661,9 @@ int
 dir_insert(const CacheKey *key, Vol *d, Dir *to_part)
 {
   ink_assert(d->mutex->thread_holding == this_ethread());
+  if (d->ram_cache_hot) {
+    d->ram_cache_hot->remove(key);
+  }
   int s  = key->slice32(0) % d->segments, l;
   int bi = key->slice32(1) % d->buckets;
   ink_assert(dir_approx_size(to_part) <= MAX_FRAG_SIZE + sizeof(Doc));
@@ -644,6 +705,8 @@ Llink:
 Lfill:
   dir_assign_data(e, to_part);
   dir_set_tag(e, key->slice32(2));
+  d->dir_mark_dirty(e);
+  d->dir_mark_dirty(b);
   ink_assert(d->vol_offset(e) < (d->skip + d->len));
   DDebug("dir_insert", "insert %p %X into vol %d bucket %d at %p tag %X %X boffset %" PRId64 "", e, key->slice32(0), d->fd, bi, e,
          key->slice32(1), dir_tag(e), dir_offset(e));
@@ -657,6 +720,9 @@ int
 dir_overwrite(const CacheKey *key, Vol *d, Dir *dir, Dir *overwrite, bool must_overwrite)
 {
   ink_assert(d->mutex->thread_holding == this_ethread());
+  if (d->ram_cache_hot) {
+    d->ram_cache_hot->remove(key);
+  }
   int s          = key->slice32(0) % d->segments, l;
   int bi         = key->slice32(1) % d->buckets;
   Dir *seg       = d->dir_segment(s);
@@ -676,6 +742,7 @@ Lagain:
   // find entry to overwrite
   e = b;
   if (dir_offset(e)) {
+    uint32_t match = dir_bucket_match(b, key);
     do {
 #ifdef LOOP_CHECK_MODE
       loop_count++;
@@ -686,7 +753,7 @@ Lagain:
         }
       }
 #endif
-      if (dir_tag(e) == t && dir_offset(e) == dir_offset(overwrite)) {
+      if (dir_compare_tag(e, key, b, match) && dir_offset(e) == dir_offset(overwrite)) {
         goto Lfill;
       }
       e = next_dir(e, seg);
@@ -721,6 +788,8 @@ Llink:
 Lfill:
   dir_assign_data(e, dir);
   dir_set_tag(e, t);
+  d->dir_mark_dirty(e);
+  d->dir_mark_dirty(b);
   ink_assert(d->vol_offset(e) < d->skip + d->len);
   DDebug("dir_overwrite", "overwrite %p %X into vol %d bucket %d at %p tag %X %X boffset %" PRId64 "", e, key->slice32(0), d->fd,
          bi, e, t, dir_tag(e), dir_offset(e));
@@ -733,6 +802,9 @@ int
 dir_delete(const CacheKey *key, Vol *d, Dir *del)
 {
   ink_assert(d->mutex->thread_holding == this_ethread());
+  if (d->ram_cache_hot) {
+    d->ram_cache_hot->remove(key);
+  }
   int s    = key->slice32(0) % d->segments;
   int b    = key->slice32(1) % d->buckets;
   Dir *seg = d->dir_segment(s);
@@ -743,8 +815,10 @@ dir_delete(const CacheKey *key, Vol *d, Dir *del)
   Vol *vol = d;
   CHECK_DIR(d);
 
-  e = dir_bucket(b, seg);
+  Dir *bucket = dir_bucket(b, seg);
+  e           = bucket;
   if (dir_offset(e)) {
+    uint32_t match = dir_bucket_match(bucket, key);
     do {
 #ifdef LOOP_CHECK_MODE
       loop_count++;
@@ -753,7 +827,7 @@ dir_delete(const CacheKey *key, Vol *d, Dir *del)
           return 0;
       }
 #endif
-      if (dir_compare_tag(e, key) && dir_offset(e) == dir_offset(del)) {
+      if (dir_compare_tag(e, key, bucket, match) && dir_offset(e) == dir_offset(del)) {
         CACHE_DEC_DIR_USED(d->mutex);
         dir_delete_entry(e, p, s, d);
         CHECK_DIR(d);
@@ -896,7 +970,55 @@ CacheSync::aio_write(int fd, char *b, int n, off_t o)
   io.aiocb.aio_buf    = b;
   io.action           = this;
   io.thread           = AIO_CALLBACK_THREAD_ANY;
-  ink_assert(ink_aio_write(&io) >= 0);
+  gvol[vol_idx]->disk->io_write(&io);
+}
+
+// Replace the sync buffer with one of at least len bytes. The buffer
+// is registered for fixed buffer AIO, as all sync writes come from it,
+// and is kept for the life of the process. It only grows, up to the
+// largest stripe directory.
+void
+CacheSync::alloc_buf(size_t len)
+{
+  free_buf();
+  buflen = len;
+  if (ats_hugepage_enabled()) {
+    buf      = static_cast<char *>(ats_alloc_hugepage(buflen));
+    buf_huge = true;
+  }
+  if (buf == nullptr) {
+    buf      = static_cast<char *>(ats_memalign(ats_pagesize(), buflen));
+    buf_huge = false;
+  }
+  ink_aio_register_fixed_buffer(buf, buflen);
+}
+
+void
+CacheSync::free_buf()
+{
+  if (buf) {
+    ink_aio_unregister_fixed_buffer(buf);
+    if (buf_huge) {
+      ats_free_hugepage(buf, buflen);
+    } else {
+      ats_memalign_free(buf);
+    }
+  }
+  buflen   = 0;
+  buf      = nullptr;
+  buf_huge = false;
+}
+
+// Offset of the first directory block at or after pos which is part of
+// the current sync, or the footer offset if there are none left.
+off_t
+CacheSync::next_sync_block(off_t pos, off_t headerlen)
+{
+  size_t i = (pos - headerlen) / STORE_BLOCK_SIZE;
+  while (i < sync_blocks.size() && !sync_blocks[i]) {
+    ++i;
+  }
+  return headerlen + i * STORE_BLOCK_SIZE;
 }
 
 uint64_t
@@ -979,8 +1101,10 @@ sync_cache_dir_on_shutdown()
       d->header->last_write_pos = d->header->write_pos;
       d->header->write_pos += d->agg_buf_pos;
       ink_assert(d->header->write_pos == d->header->agg_pos);
-      d->agg_buf_pos = 0;
-      d->header->write_serial++;
+      d->agg_buf_pos     = 0;
+      d->agg_buf_written = 0;
+      // the buffer may hold documents for every write in flight
+      d->header->write_serial += d->agg_writes_in_flight + 1;
     }
 
     if (buflen < dirlen) {
@@ -1040,16 +1164,7 @@ CacheSync::mainEvent(int event, Event *e)
 Lrestart:
   if (vol_idx >= gnvol) {
     vol_idx = 0;
-    if (buf) {
-      if (buf_huge) {
-        ats_free_hugepage(buf, buflen);
-      } else {
-        ats_memalign_free(buf);
-      }
-      buflen   = 0;
-      buf      = nullptr;
-      buf_huge = false;
-    }
+    // The buffer stays registered for the next cycle, re-registering it stalls fixed buffer AIO on every ring.
     Debug("cache_dir_sync", "sync done");
     if (event == EVENT_INTERVAL) {
       trigger = e->ethread->schedule_in(this, HRTIME_SECONDS(cache_config_dir_sync_frequency));
@@ -1063,15 +1178,18 @@ Lrestart:
 
   if (event == AIO_EVENT_DONE) {
     // AIO Thread
+    vol->disk->io_write_done(&io);
     if (io.aio_result != static_cast<int64_t>(io.aiocb.aio_nbytes)) {
       Warning("vol write error during directory sync '%s'", gvol[vol_idx]->hash_text.get());
-      event = EVENT_NONE;
-      goto Ldone;
-    }
-    CACHE_SUM_DYN_STAT(cache_directory_sync_bytes_stat, io.aio_result);
+      // The blocks in this write are no longer marked dirty, that has to be undone under the vol lock.
+      write_failed = true;
+    } else {
+      CACHE_SUM_DYN_STAT(cache_directory_sync_bytes_stat, io.aio_result);
+      sync_bytes += io.aio_result;
 
-    trigger = eventProcessor.schedule_in(this, SYNC_DELAY);
-    return EVENT_CONT;
+      trigger = eventProcessor.schedule_in(this, SYNC_DELAY);
+      return EVENT_CONT;
+    }
   }
   {
     CACHE_TRY_LOCK(lock, gvol[vol_idx]->mutex, mutex->thread_holding);
@@ -1080,6 +1198,18 @@ Lrestart:
       return EVENT_CONT;
     }
 
+    if (write_failed) {
+      // This copy is now inconsistent on disk, rewrite all of it the next time around.
+      uint8_t mask = 1 << (vol->header->sync_serial & 1);
+      for (auto &block : vol->dir_dirty_blocks) {
+        block |= mask;
+      }
+      vol->header->dirty = 1;
+      write_failed       = false;
+      event              = EVENT_NONE;
+      goto Ldone;
+    }
+
     if (!vol->dir_sync_in_progress) {
       start_time = Thread::get_hrtime();
     }
@@ -1091,8 +1221,10 @@ Lrestart:
       goto Ldone;
     }
 
-    int headerlen = ROUND_TO_STORE_BLOCK(sizeof(VolHeaderFooter));
-    size_t dirlen = vol->dirlen();
+    int headerlen   = vol->headerlen();
+    int footerlen   = ROUND_TO_STORE_BLOCK(sizeof(VolHeaderFooter));
+    size_t dirlen   = vol->dirlen();
+    off_t footerpos = dirlen - footerlen;
     if (!writepos) {
       // start
       Debug("cache_dir_sync", "sync started");
@@ -1117,28 +1249,34 @@ Lrestart:
       Debug("cache_dir_sync", "pos: %" PRIu64 " Dir %s dirty...syncing to disk", vol->header->write_pos, vol->hash_text.get());
       vol->header->dirty = 0;
       if (buflen < dirlen) {
-        if (buf) {
-          if (buf_huge) {
-            ats_free_hugepage(buf, buflen);
-          } else {
-            ats_memalign_free(buf);
-          }
-          buf = nullptr;
-        }
-        buflen = dirlen;
-        if (ats_hugepage_enabled()) {
-          buf      = static_cast<char *>(ats_alloc_hugepage(buflen));
-          buf_huge = true;
-        }
-        if (buf == nullptr) {
-          buf      = static_cast<char *>(ats_memalign(ats_pagesize(), buflen));
-          buf_huge = false;
-        }
+        alloc_buf(dirlen);
       }
       vol->header->sync_serial++;
       vol->footer->sync_serial = vol->header->sync_serial;
       CHECK_DIR(d);
-      memcpy(buf, vol->raw_dir, dirlen);
+      /* Only the directory blocks changed since this copy was last written
+         are snapshot and written. The header (with the freelists) goes first
+         and the footer last, so a partial sync still leaves the serials
+         mismatched and recovery falls back to the other copy.
+       */
+      uint8_t mask    = 1 << (vol->header->sync_serial & 1);
+      size_t nblocks  = vol->dir_dirty_blocks.size();
+      int64_t skipped = 0;
+      memcpy(buf, vol->raw_dir, headerlen);
+      sync_blocks.assign(nblocks, false);
+      for (size_t i = 0; i < nblocks; i++) {
+        if (vol->dir_dirty_blocks[i] & mask) {
+          size_t pos = headerlen + i * STORE_BLOCK_SIZE;
+          memcpy(buf + pos, vol->raw_dir + pos, STORE_BLOCK_SIZE);
+          vol->dir_dirty_blocks[i] &= ~mask;
+          sync_blocks[i] = true;
+        } else {
+          skipped += STORE_BLOCK_SIZE;
+        }
+      }
+      memcpy(buf + footerpos, vol->raw_dir + footerpos, footerlen);
+      CACHE_SUM_DYN_STAT(cache_directory_sync_skipped_bytes_stat, skipped);
+      sync_bytes                = 0;
       vol->dir_sync_in_progress = true;
     }
     size_t B    = vol->header->sync_serial & 1;
@@ -1147,24 +1285,26 @@ Lrestart:
     if (!writepos) {
       // write header
       aio_write(vol->fd, buf + writepos, headerlen, start + writepos);
-      writepos += headerlen;
-    } else if (writepos < static_cast<off_t>(dirlen) - headerlen) {
-      // write part of body
-      int l = SYNC_MAX_WRITE;
-      if (writepos + l > static_cast<off_t>(dirlen) - headerlen) {
-        l = dirlen - headerlen - writepos;
+      writepos = next_sync_block(headerlen, headerlen);
+    } else if (writepos < footerpos) {
+      // write the run of dirty blocks at writepos
+      off_t end = writepos + STORE_BLOCK_SIZE;
+      while (end < footerpos && end - writepos < SYNC_MAX_WRITE && sync_blocks[(end - headerlen) / STORE_BLOCK_SIZE]) {
+        end += STORE_BLOCK_SIZE;
       }
-      aio_write(vol->fd, buf + writepos, l, start + writepos);
-      writepos += l;
+      aio_write(vol->fd, buf + writepos, end - writepos, start + writepos);
+      writepos = next_sync_block(end, headerlen);
     } else if (writepos < static_cast<off_t>(dirlen)) {
-      ink_assert(writepos == (off_t)dirlen - headerlen);
+      ink_assert(writepos == footerpos);
       // write footer
-      aio_write(vol->fd, buf + writepos, headerlen, start + writepos);
-      writepos += headerlen;
+      aio_write(vol->fd, buf + writepos, footerlen, start + writepos);
+      writepos += footerlen;
     } else {
+      Debug("cache_dir_sync", "Dir %s: wrote %" PRId64 " of %zu bytes", vol->hash_text.get(), sync_bytes, dirlen);
       vol->dir_sync_in_progress = false;
       CACHE_INCREMENT_DYN_STAT(cache_directory_sync_count_stat);
       CACHE_SUM_DYN_STAT(cache_directory_sync_time_stat, Thread::get_hrtime() - start_time);
+      CACHE_SET_DYN_STAT(cache_directory_sync_last_bytes_stat, sync_bytes);
       start_time = 0;
       goto Ldone;
     }
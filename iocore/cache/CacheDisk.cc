@@ -52,6 +52,92 @@ CacheDisk::incrErrors(const AIOCallback *io)
   Warning("failed operation: %s (opcode=%d), span: %s (fd=%d)", opname, opcode, path, fd);
 }
 
+static void
+io_stat_incr(RecRawStatBlock *rsb, int stat, int64_t incr)
+{
+  if (rsb) {
+    RecIncrGlobalRawStatSum(rsb, stat, incr);
+  }
+}
+
+static void
+io_stat_latency(RecRawStatBlock *rsb, int stat, ink_hrtime latency)
+{
+  int bucket = 0;
+  for (ink_hrtime bound = HRTIME_MSECONDS(1); bucket < CACHE_DISK_IO_LATENCY_BUCKETS - 1 && latency >= bound; bound *= 4) {
+    ++bucket;
+  }
+  io_stat_incr(rsb, stat + bucket, 1);
+}
+
+/* Stripe I/O goes through these so that reads for clients are not stuck behind the writes. A read
+   is handed to the AIO layer at once, a write only while the disk has fewer than
+   proxy.config.cache.io.max_writes_in_flight writes outstanding, otherwise it waits for one of them
+   to complete. The completion handler of every operation started here must call io_read_done() or io_write_done().
+*/
+void
+CacheDisk::io_read(AIOCallback *op)
+{
+  op->submit_time = Thread::get_hrtime_updated();
+  io_stat_incr(io_rsb, cache_disk_io_reads_in_flight_stat, 1);
+  ink_assert(ink_aio_read(op) >= 0);
+}
+
+void
+CacheDisk::io_write(AIOCallback *op)
+{
+  op->submit_time = Thread::get_hrtime_updated();
+  {
+    std::lock_guard<std::mutex> lock(io_mutex);
+    if (cache_config_io_max_writes_in_flight && io_writes_in_flight >= cache_config_io_max_writes_in_flight) {
+      io_write_wait.enqueue(op);
+      io_stat_incr(io_rsb, cache_disk_io_writes_queued_stat, 1);
+      return;
+    }
+    ++io_writes_in_flight;
+  }
+  io_stat_incr(io_rsb, cache_disk_io_writes_in_flight_stat, 1);
+  ink_assert(ink_aio_write(op) >= 0);
+}
+
+// Does nothing for an operation which was not started by io_read() or is already done.
+void
+CacheDisk::io_read_done(AIOCallback *op)
+{
+  if (!op->submit_time) {
+    return;
+  }
+  io_stat_latency(io_rsb, cache_disk_io_read_latency_stat, Thread::get_hrtime_updated() - op->submit_time);
+  op->submit_time = 0;
+  io_stat_incr(io_rsb, cache_disk_io_reads_in_flight_stat, -1);
+}
+
+// Does nothing for an operation which was not started by io_write() or is already done.
+void
+CacheDisk::io_write_done(AIOCallback *op)
+{
+  if (!op->submit_time) {
+    return;
+  }
+  io_stat_latency(io_rsb, cache_disk_io_write_latency_stat, Thread::get_hrtime_updated() - op->submit_time);
+  op->submit_time = 0;
+
+  // start the next waiting write in this one's place
+  AIOCallback *next = nullptr;
+  {
+    std::lock_guard<std::mutex> lock(io_mutex);
+    if (!(next = io_write_wait.dequeue())) {
+      --io_writes_in_flight;
+    }
+  }
+  if (next) {
+    io_stat_incr(io_rsb, cache_disk_io_writes_queued_stat, -1);
+    ink_assert(ink_aio_write(next) >= 0);
+  } else {
+    io_stat_incr(io_rsb, cache_disk_io_writes_in_flight_stat, -1);
+  }
+}
+
 int
 CacheDisk::open(char *s, off_t blocks, off_t askip, int ahw_sector_size, int fildes, bool clear)
 {
@@ -652,13 +652,16 @@ ConfigVolumes::BuildListFromString(char *config_file_path, char *file_buf)
     line_num++;
 
     char *end;
-    char *line_end        = nullptr;
-    const char *err       = nullptr;
-    int volume_number     = 0;
-    CacheType scheme      = CACHE_NONE_TYPE;
-    int size              = 0;
-    int in_percent        = 0;
-    bool ramcache_enabled = true;
+    char *line_end         = nullptr;
+    const char *err        = nullptr;
+    int volume_number      = 0;
+    CacheType scheme       = CACHE_NONE_TYPE;
+    int size               = 0;
+    int in_percent         = 0;
+    bool ramcache_enabled  = true;
+    int64_t avg_obj_size   = 0;
+    int64_t fragment_size  = 0;
+    int64_t ram_cache_size = 0;
 
     while (true) {
       // skip all blank spaces at beginning of line
@@ -758,6 +761,30 @@ ConfigVolumes::BuildListFromString(char *config_file_path, char *file_buf)
           err = "Unexpected end of line";
           break;
         }
+      } else if (strcasecmp(tmp, "avg_obj_size") == 0) { // match avg_obj_size
+        tmp += 13;
+        avg_obj_size = ink_atoi64(tmp);
+        if (avg_obj_size <= 0 || avg_obj_size > INT_MAX) {
+          err = "Bad avg_obj_size";
+          break;
+        }
+        tmp = end;
+      } else if (strcasecmp(tmp, "fragment_size") == 0) { // match fragment_size
+        tmp += 14;
+        fragment_size = ink_atoi64(tmp);
+        if (fragment_size <= static_cast<int64_t>(sizeof(Doc)) || fragment_size - sizeof(Doc) > MAX_FRAG_SIZE) {
+          err = "Bad fragment_size";
+          break;
+        }
+        tmp = end;
+      } else if (strcasecmp(tmp, "ram_cache_size") == 0) { // match ram_cache_size
+        tmp += 15;
+        ram_cache_size = ink_atoi64(tmp);
+        if (ram_cache_size <= 0) {
+          err = "Bad ram_cache_size";
+          break;
+        }
+        tmp = end;
       }
 
       // ends here
@@ -784,6 +811,9 @@ ConfigVolumes::BuildListFromString(char *config_file_path, char *file_buf)
       configp->size             = size;
       configp->cachep           = nullptr;
       configp->ramcache_enabled = ramcache_enabled;
+      configp->avg_obj_size     = avg_obj_size;
+      configp->fragment_size    = fragment_size;
+      configp->ram_cache_size   = ram_cache_size;
       cp_queue.enqueue(configp);
       num_volumes++;
       if (scheme == CACHE_HTTP_TYPE) {
@@ -791,8 +821,10 @@ ConfigVolumes::BuildListFromString(char *config_file_path, char *file_buf)
       } else {
         ink_release_assert(!"Unexpected non-HTTP cache volume");
       }
-      Debug("cache_hosting", "added volume=%d, scheme=%d, size=%d percent=%d, ramcache enabled=%d", volume_number, scheme, size,
-            in_percent, ramcache_enabled);
+      Debug("cache_hosting",
+            "added volume=%d, scheme=%d, size=%d percent=%d, ramcache enabled=%d, avg_obj_size=%" PRId64 ", fragment_size=%" PRId64
+            ", ram_cache_size=%" PRId64,
+            volume_number, scheme, size, in_percent, ramcache_enabled, avg_obj_size, fragment_size, ram_cache_size);
     }
 
     tmp = bufTok.iterNext(&i_state);
@@ -25,6 +25,23 @@
 
 #include "HttpCacheSM.h" //Added to get the scope of HttpCacheSM object.
 
+// A lock free entry is only good until the write cursor comes around to
+// its fragments. The header is read without the stripe mutex, so the
+// agg variant is used to leave room for a write that is in progress.
+static bool
+ram_cache_hot_valid(Vol *vol, RamCacheHotIndex::Entry const &hot)
+{
+  if (vol->header->cycle - hot.cycle > 1) {
+    return false;
+  }
+  Dir dir = hot.dir;
+  if (!dir_agg_valid(vol, &dir)) {
+    return false;
+  }
+  dir = hot.earliest_dir;
+  return !hot.earliest_data || dir_agg_valid(vol, &dir);
+}
+
 Action *
 Cache::open_read(Continuation *cont, const CacheKey *key, CacheFragType type, const char *hostname, int host_len)
 {
@@ -56,6 +73,7 @@ Cache::open_read(Continuation *cont, const CacheKey *key, CacheFragType type, co
       goto Lmiss;
     }
     if (!lock.is_locked()) {
+      CACHE_INCREMENT_DYN_STAT(cache_read_lock_contention_stat);
       CONT_SCHED_LOCK_RETRY(c);
       return &c->_action;
     }
@@ -100,15 +118,63 @@ Cache::open_read(Continuation *cont, const CacheKey *key, CacheHTTPHdr *request,
   }
   ink_assert(caches[type] == this);
 
+  const CacheKey *original = key;
+  CacheKey replica;
+  if (cache_config_hot_replica_copies > 0) {
+    key = cache_replica_select(key, &replica, request, params, hostname, host_len);
+  }
   Vol *vol = key_to_vol(key, hostname, host_len);
   Dir result, *last_collision = nullptr;
   ProxyMutex *mutex = cont->mutex.get();
   OpenDirEntry *od  = nullptr;
   CacheVC *c        = nullptr;
+  RamCacheHotIndex::Entry hot;
+
+Lretry:
+  // hot documents can be served without touching the stripe mutex
+  if (vol->ram_cache_hot && vol->ram_cache_hot->get(key, &hot) && ram_cache_hot_valid(vol, hot)) {
+    if (key != original) {
+      CACHE_INCREMENT_DYN_STAT(cache_hot_replica_reads_stat);
+    }
+    c            = new_CacheVC(cont);
+    c->first_key = c->key = c->earliest_key = *key;
+    c->vol                                  = vol;
+    c->vio.op                               = VIO::READ;
+    c->base_stat                            = cache_read_active_stat;
+    CACHE_INCREMENT_DYN_STAT(c->base_stat + CACHE_STAT_ACTIVE);
+    CACHE_INCREMENT_DYN_STAT(cache_ram_cache_lock_free_hits_stat);
+    c->request.copy_shallow(request);
+    c->frag_type            = CACHE_FRAG_TYPE_HTTP;
+    c->params               = params;
+    c->first_dir            = hot.dir;
+    c->dir                  = hot.dir;
+    c->buf                  = hot.data;
+    c->io.aiocb.aio_nbytes  = dir_approx_size(&hot.dir);
+    c->io.aio_result        = c->io.aiocb.aio_nbytes;
+    c->f.doc_from_ram_cache = true;
+    c->f.ram_lock_free      = true;
+    SET_CONTINUATION_HANDLER(c, &CacheVC::openReadStartHead);
+    goto Lcallreturn;
+  }
 
   {
     CACHE_TRY_LOCK(lock, vol->mutex, mutex->thread_holding);
-    if (!lock.is_locked() || (od = vol->open_read(key)) || dir_probe(key, vol, &result, &last_collision)) {
+    if (key != original) {
+      // a copy which is busy or was evicted is passed over for the original
+      bool busy = !lock.is_locked() || vol->open_read(key);
+      if (busy || !dir_probe(key, vol, &result, &last_collision)) {
+        if (!busy) {
+          cache_replica_miss(original, key);
+        }
+        key            = original;
+        vol            = key_to_vol(key, hostname, host_len);
+        last_collision = nullptr;
+        goto Lretry;
+      }
+      CACHE_INCREMENT_DYN_STAT(cache_hot_replica_reads_stat);
+    }
+    // the copy was probed above
+    if (!lock.is_locked() || (od = vol->open_read(key)) || key != original || dir_probe(key, vol, &result, &last_collision)) {
       c            = new_CacheVC(cont);
       c->first_key = c->key = c->earliest_key = *key;
       c->vol                                  = vol;
@@ -121,6 +187,7 @@ Cache::open_read(Continuation *cont, const CacheKey *key, CacheHTTPHdr *request,
       c->od        = od;
     }
     if (!lock.is_locked()) {
+      CACHE_INCREMENT_DYN_STAT(cache_read_lock_contention_stat);
       SET_CONTINUATION_HANDLER(c, &CacheVC::openReadStartHead);
       CONT_SCHED_LOCK_RETRY(c);
       return &c->_action;
@@ -149,8 +216,10 @@ Lmiss:
   cont->handleEvent(CACHE_EVENT_OPEN_READ_FAILED, (void *)-ECACHE_NO_DOC);
   return ACTION_RESULT_DONE;
 Lwriter:
-  // this is a horrible violation of the interface and should be fixed (FIXME)
-  ((HttpCacheSM *)cont)->set_readwhilewrite_inprogress(true);
+  // Other callers, plugins and the cache tests among them, are not an HttpCacheSM.
+  if (auto cache_sm = dynamic_cast<HttpCacheSM *>(cont); cache_sm) {
+    cache_sm->set_readwhilewrite_inprogress(true);
+  }
   SET_CONTINUATION_HANDLER(c, &CacheVC::openReadFromWriter);
   if (c->handleEvent(EVENT_IMMEDIATE, nullptr) == EVENT_DONE) {
     return ACTION_RESULT_DONE;
@@ -252,7 +321,8 @@ CacheVC::openReadChooseWriter(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSE
           continue;
         }
       }
-      if (w->alternate.valid()) {
+      // a sparse object can't be read from its writer, the fragments are not written in order
+      if (w->alternate.valid() && !w->alternate.is_sparse()) {
         vector.insert(&w->alternate, alt_ndx);
       }
     }
@@ -531,6 +601,9 @@ CacheVC::openReadClose(int event, Event * /* e ATS_UNUSED */)
     }
     set_io_not_in_progress();
   }
+  if (f.ram_lock_free) { // never registered with the stripe
+    return free_CacheVC(this);
+  }
   CACHE_TRY_LOCK(lock, vol->mutex, mutex->thread_holding);
   if (!lock.is_locked()) {
     VC_SCHED_LOCK_RETRY();
@@ -560,6 +633,7 @@ CacheVC::openReadReadDone(int event, Event *e)
   {
     CACHE_TRY_LOCK(lock, vol->mutex, mutex->thread_holding);
     if (!lock.is_locked()) {
+      CACHE_INCREMENT_DYN_STAT(cache_read_lock_contention_stat);
       VC_SCHED_LOCK_RETRY();
     }
     if (event == AIO_EVENT_DONE && !io.ok()) {
@@ -613,6 +687,9 @@ CacheVC::openReadReadDone(int event, Event *e)
         goto Ldone;
       }
     }
+    if (f.sparse) { // the fragment is gone, that is not a truncation
+      goto Ldone;
+    }
     // fall through for truncated documents
   }
 Lerror : {
@@ -662,7 +739,18 @@ CacheVC::openReadMain(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
        they can appear to the VC as multi-fragment when they are not really.
        The essential difference is the existence of a fragment table.
     */
-    if (frags) {
+    if (f.sparse) {
+      // sparse fragments all have the same size
+      int target = seek_to / alternate.sparse_frag_size_get();
+      if (target != fragment) {
+        key = earliest_key;
+        for (fragment = -1; fragment < target - 1; ++fragment) {
+          next_CacheKey(&key, &key);
+        }
+        Debug("cache_seek", "Seek sparse @ %" PRId64 " -> #%d", seek_to, target);
+        goto Lread;
+      }
+    } else if (frags) {
       int target                    = 0;
       HTTPInfo::FragOffset next_off = frags[target];
       int lfi                       = static_cast<int>(alternate.get_frag_offset_count()) - 1;
@@ -804,6 +892,7 @@ Lread : {
   CACHE_TRY_LOCK(lock, vol->mutex, mutex->thread_holding);
   if (!lock.is_locked()) {
     SET_HANDLER(&CacheVC::openReadMain);
+    CACHE_INCREMENT_DYN_STAT(cache_read_lock_contention_stat);
     VC_SCHED_LOCK_RETRY();
   }
   if (dir_probe(&key, vol, &dir, &last_collision)) {
@@ -830,6 +919,10 @@ Lread : {
     SET_HANDLER(&CacheVC::openReadMain);
     VC_SCHED_WRITER_RETRY();
   }
+  if (f.sparse) {
+    DDebug("cache_sparse", "%p: key: %X missing fragment %d at %d", this, first_key.slice32(1), fragment + 1, (int)vio.ndone);
+    goto Leos;
+  }
   if (is_action_tag_set("cache")) {
     ink_release_assert(false);
   }
@@ -863,6 +956,7 @@ CacheVC::openReadStartEarliest(int /* event ATS_UNUSED */, Event * /* e ATS_UNUS
   {
     CACHE_TRY_LOCK(lock, vol->mutex, mutex->thread_holding);
     if (!lock.is_locked()) {
+      CACHE_INCREMENT_DYN_STAT(cache_read_lock_contention_stat);
       VC_SCHED_LOCK_RETRY();
     }
     if (!buf) {
@@ -907,9 +1001,21 @@ CacheVC::openReadStartEarliest(int /* event ATS_UNUSED */, Event * /* e ATS_UNUS
     earliest_key = key;
     doc_pos      = doc->prefix_len();
     next_CacheKey(&key, &doc->key);
+    // publish alternates which keep hitting in the RAM cache for lock free reads
+    if (vol->ram_cache_hot && f.doc_from_ram_cache && frag_type == CACHE_FRAG_TYPE_HTTP && !write_vc && first_buf &&
+        doc->single_fragment() && !vol->open_read(&first_key)) {
+      RamCacheHotIndex::Entry hot;
+      hot.key           = first_key;
+      hot.dir           = first_dir;
+      hot.cycle         = vol->header->cycle;
+      hot.data          = first_buf;
+      hot.earliest_key  = earliest_key;
+      hot.earliest_dir  = earliest_dir;
+      hot.earliest_data = buf;
+      vol->ram_cache_hot->put(hot);
+    }
     vol->begin_read(this);
-    if (vol->within_hit_evacuate_window(&earliest_dir) &&
-        (!cache_config_hit_evacuate_size_limit || doc_len <= static_cast<uint64_t>(cache_config_hit_evacuate_size_limit))) {
+    if (vol->hit_evacuate(&earliest_dir, doc_len)) {
       DDebug("cache_hit_evac", "dir: %" PRId64 ", write: %" PRId64 ", phase: %d", dir_offset(&earliest_dir),
              vol->offset_to_vol_offset(vol->header->write_pos), vol->header->phase);
       f.hit_evacuate = 1;
@@ -1064,8 +1170,10 @@ CacheVC::openReadStartHead(int event, Event *e)
     return free_CacheVC(this);
   }
   {
-    CACHE_TRY_LOCK(lock, vol->mutex, mutex->thread_holding);
+    // a lock free RAM hit only takes the VC mutex, which is already held
+    CACHE_TRY_LOCK(lock, f.ram_lock_free ? mutex : vol->mutex, mutex->thread_holding);
     if (!lock.is_locked()) {
+      CACHE_INCREMENT_DYN_STAT(cache_read_lock_contention_stat);
       VC_SCHED_LOCK_RETRY();
     }
     if (!buf) {
@@ -1076,7 +1184,7 @@ CacheVC::openReadStartHead(int event, Event *e)
     }
     // an object needs to be outside the aggregation window in order to be
     // be evacuated as it is read
-    if (!dir_agg_valid(vol, &dir)) {
+    if (!f.ram_lock_free && !dir_agg_valid(vol, &dir)) {
       // a directory entry which is no longer valid may have been overwritten
       if (!dir_valid(vol, &dir)) {
         last_collision = nullptr;
@@ -1084,6 +1192,9 @@ CacheVC::openReadStartHead(int event, Event *e)
       goto Lread;
     }
     doc = reinterpret_cast<Doc *>(buf->data());
+    if (f.ram_lock_free && (doc->magic != DOC_MAGIC || !(doc->first_key == key))) {
+      goto Llocked;
+    }
     if (doc->magic != DOC_MAGIC) {
       char tmpstring[CRYPTO_HEX_SIZE];
       if (is_action_tag_set("cache")) {
@@ -1118,6 +1229,9 @@ CacheVC::openReadStartHead(int event, Event *e)
         goto Ldone;
       }
       if ((uml = this->load_http_info(&vector, doc)) != doc->hlen) {
+        if (f.ram_lock_free) {
+          goto Llocked;
+        }
         if (buf) {
           HTTPCacheAlt *alt  = reinterpret_cast<HTTPCacheAlt *>(doc->hdr());
           int32_t alt_length = 0;
@@ -1154,6 +1268,9 @@ CacheVC::openReadStartHead(int event, Event *e)
       }
       alternate_tmp = vector.get(alternate_index);
       if (!alternate_tmp->valid()) {
+        if (f.ram_lock_free) {
+          goto Llocked;
+        }
         if (buf) {
           Note("OpenReadHead failed for cachekey %X : alternate inconsistency", key.slice32(0));
           dir_delete(&key, vol, &dir);
@@ -1186,20 +1303,54 @@ CacheVC::openReadStartHead(int event, Event *e)
             doc->key.toHexStr(xt), key.toHexStr(yt), f.single_fragment ? "single" : "multi", doc->len, doc->total_len,
             alternate.get_frag_offset_count());
     }
+    // fragments of a sparse object are looked up independently, any of them
+    // may be missing
+    if (alternate.valid() && alternate.is_sparse()) {
+      if (f.ram_lock_free) {
+        goto Llocked;
+      }
+      f.sparse = 1;
+      load_sparse_map();
+      goto Lsparse;
+    }
     // the first fragment might have been gc'ed. Make sure the first
     // fragment is there before returning CACHE_EVENT_OPEN_READ
     if (!f.single_fragment) {
+      RamCacheHotIndex::Entry hot;
+      if (f.ram_lock_free && vol->ram_cache_hot->get(&first_key, &hot) && hot.earliest_data && hot.earliest_key == key &&
+          dir_offset(&hot.dir) == dir_offset(&first_dir) && ram_cache_hot_valid(vol, hot)) {
+        first_buf    = buf;
+        buf          = hot.earliest_data;
+        earliest_key = key;
+        earliest_dir = hot.earliest_dir;
+        dir          = hot.earliest_dir;
+        doc_pos      = reinterpret_cast<Doc *>(buf->data())->prefix_len();
+        next_CacheKey(&key, &earliest_key);
+        goto Lsuccess;
+      }
       goto Learliest;
     }
 
-    if (vol->within_hit_evacuate_window(&dir) &&
-        (!cache_config_hit_evacuate_size_limit || doc_len <= static_cast<uint64_t>(cache_config_hit_evacuate_size_limit))) {
+    first_buf = buf;
+    if (f.ram_lock_free) {
+      goto Lsuccess;
+    }
+
+    if (vol->hit_evacuate(&dir, doc_len)) {
       DDebug("cache_hit_evac", "dir: %" PRId64 ", write: %" PRId64 ", phase: %d", dir_offset(&dir),
              vol->offset_to_vol_offset(vol->header->write_pos), vol->header->phase);
       f.hit_evacuate = 1;
     }
 
-    first_buf = buf;
+    // publish documents which keep hitting in the RAM cache for lock free reads
+    if (vol->ram_cache_hot && f.doc_from_ram_cache && frag_type == CACHE_FRAG_TYPE_HTTP && !vol->open_read(&first_key)) {
+      RamCacheHotIndex::Entry hot;
+      hot.key   = first_key;
+      hot.dir   = first_dir;
+      hot.cycle = vol->header->cycle;
+      hot.data  = buf;
+      vol->ram_cache_hot->put(hot);
+    }
     vol->begin_read(this);
 
     goto Lsuccess;
@@ -1248,13 +1399,29 @@ Lookup:
   CACHE_INCREMENT_DYN_STAT(cache_lookup_success_stat);
   _action.continuation->handleEvent(CACHE_EVENT_LOOKUP, nullptr);
   return free_CacheVC(this);
+Lsparse:
+  // nothing to read from the head, the next read is of fragment 0
+  first_buf    = buf;
+  earliest_key = key;
+  fragment     = -1;
+  doc_pos      = reinterpret_cast<Doc *>(buf->data())->len;
+  goto Lsuccess;
 Learliest:
-  first_buf      = buf;
-  buf            = nullptr;
-  earliest_key   = key;
-  last_collision = nullptr;
+  first_buf       = buf;
+  buf             = nullptr;
+  earliest_key    = key;
+  last_collision  = nullptr;
+  f.ram_lock_free = false;
   SET_HANDLER(&CacheVC::openReadStartEarliest);
   return openReadStartEarliest(event, e);
+Llocked:
+  // the lock free entry can't be used as is, go through the directory instead
+  f.ram_lock_free = false;
+  buf             = nullptr;
+  key             = first_key;
+  last_collision  = nullptr;
+  vector.clear();
+  return openReadStartHead(event, e);
 }
 
 /*
@@ -0,0 +1,450 @@
+/** @file
+
+  Replicate hot HTTP documents into additional stripes and spread the reads across the copies.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+// Every HTTP lookup is counted in a count-min sketch which is cleared each second.  A key
+// looked up proxy.config.cache.hot_replica.threshold times within a second is entered in the
+// replica table, and the document is copied under proxy.config.cache.hot_replica.copies
+// derived keys which map to other stripes.  Once the copies are written the lookups of the key
+// go round robin to the original and the copies.  A document which drops below half the
+// threshold for CACHE_REPLICA_COOL_TICKS seconds, or is written or removed, loses its copies.
+//
+// Only documents with a single alternate are replicated, a copy has to be able to serve every
+// request the original can.
+
+#include "P_Cache.h"
+
+#include <shared_mutex>
+#include <unordered_map>
+
+#define CACHE_REPLICA_SHARDS 16
+#define CACHE_REPLICA_SKETCH_ROWS 4
+#define CACHE_REPLICA_SKETCH_WIDTH 8192
+#define CACHE_REPLICA_MAX_COPIES 8 // upper bound of proxy.config.cache.hot_replica.copies
+#define CACHE_REPLICA_COOL_TICKS 10
+#define CACHE_REPLICA_RETRY_DELAY HRTIME_MSECONDS(100)
+
+namespace
+{
+struct CacheReplicaEntry {
+  uint64_t id = 0;
+  std::string hostname;
+  std::vector<CacheKey> replicas;
+  std::atomic<uint32_t> ready{0}; // bit i set once replicas[i] is written
+  std::atomic<uint32_t> hits{0};  // this second
+  std::atomic<uint32_t> next{0};
+  std::atomic<bool> copied{false};
+  int cold_ticks = 0; // the cooler's
+};
+
+struct CacheKeyHasher {
+  size_t
+  operator()(const CacheKey &key) const
+  {
+    return key.fold();
+  }
+};
+
+struct CacheReplicaShard {
+  std::shared_mutex mutex;
+  std::unordered_map<CacheKey, std::unique_ptr<CacheReplicaEntry>, CacheKeyHasher> entries;
+};
+
+CacheReplicaShard replica_shards[CACHE_REPLICA_SHARDS];
+std::atomic<uint32_t> replica_sketch[CACHE_REPLICA_SKETCH_ROWS][CACHE_REPLICA_SKETCH_WIDTH];
+std::atomic<uint64_t> replica_next_id{1};
+
+CacheReplicaShard &
+replica_shard(const CacheKey *key)
+{
+  return replica_shards[key->slice32(3) % CACHE_REPLICA_SHARDS];
+}
+
+// Lookups of the key so far this second.
+uint32_t
+replica_sketch_increment(const CacheKey *key)
+{
+  uint32_t count = UINT32_MAX;
+  for (int row = 0; row < CACHE_REPLICA_SKETCH_ROWS; ++row) {
+    count = std::min(count, ++replica_sketch[row][key->slice32(row) % CACHE_REPLICA_SKETCH_WIDTH]);
+  }
+  return count;
+}
+
+void
+replica_key(CacheKey *replica, const CacheKey *key, int i)
+{
+  *replica = *key;
+  replica->u64[0] ^= 0x9E3779B97F4A7C15ULL * i;
+  replica->u64[1] ^= 0xC2B2AE3D27D4EB4FULL * i;
+}
+
+void
+replica_remove(const std::vector<CacheKey> &keys, const std::string &hostname)
+{
+  for (auto &key : keys) {
+    caches[CACHE_FRAG_TYPE_HTTP]->remove(nullptr, &key, CACHE_FRAG_TYPE_HTTP, hostname.data(), hostname.size());
+  }
+}
+
+// Drops the entry for key if it is still the one with the given id, and removes its copies.
+void
+replica_retire(const CacheKey *key, uint64_t id = 0)
+{
+  CacheReplicaShard &shard = replica_shard(key);
+  std::unique_ptr<CacheReplicaEntry> e;
+  {
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    auto spot = shard.entries.find(*key);
+    if (spot == shard.entries.end() || (id && spot->second->id != id)) {
+      return;
+    }
+    e = std::move(spot->second);
+    shard.entries.erase(spot);
+  }
+  // a copy still being written is removed by its copier
+  std::vector<CacheKey> ready;
+  for (size_t i = 0; i < e->replicas.size(); ++i) {
+    if (e->ready & (1 << i)) {
+      ready.push_back(e->replicas[i]);
+    }
+  }
+  replica_remove(ready, e->hostname);
+  GLOBAL_CACHE_SUM_GLOBAL_DYN_STAT(cache_hot_replica_objects_stat, -1);
+  GLOBAL_CACHE_SUM_GLOBAL_DYN_STAT(cache_hot_replica_retired_stat, 1);
+  char tmpstr[CRYPTO_HEX_SIZE];
+  Debug("cache_replica", "retired %s, %zu copies", key->toHexStr(tmpstr), ready.size());
+}
+
+/* Copies the document to each replica key in turn, reading the original once per copy. The
+   original is only opened while it has no writer, so the read is never a read while writer.
+*/
+struct CacheReplicaCopier : public Continuation {
+  CacheKey key;
+  uint64_t id;
+  std::vector<CacheKey> replicas;
+  std::string hostname;
+  HTTPHdr request;
+  OverridableHttpConfigParams params;
+  size_t next = 0;
+  CacheHTTPInfo info;
+  int64_t size       = 0;
+  CacheVC *read_vc   = nullptr;
+  CacheVC *write_vc  = nullptr;
+  VIO *read_vio      = nullptr;
+  VIO *write_vio     = nullptr;
+  MIOBuffer *buffer  = nullptr;
+  uint32_t written   = 0;
+
+  int startEvent(int event, Event *e);
+  int openReadEvent(int event, void *data);
+  int openWriteEvent(int event, void *data);
+  int copyEvent(int event, void *data);
+  int next_copy();
+  int finish();
+
+  CacheReplicaCopier(const CacheKey *akey, CacheReplicaEntry *e, CacheHTTPHdr *arequest, const OverridableHttpConfigParams *aparams)
+    : Continuation(new_ProxyMutex()), key(*akey), id(e->id), replicas(e->replicas), hostname(e->hostname)
+  {
+    request.create(HTTP_TYPE_REQUEST);
+    request.copy(arequest);
+    if (aparams) {
+      params = *aparams;
+    }
+    SET_HANDLER(&CacheReplicaCopier::startEvent);
+    // Background work, any idle thread may pick it up.
+    thread_stealable = true;
+  }
+
+  ~CacheReplicaCopier() override
+  {
+    request.destroy();
+    info.destroy();
+  }
+};
+
+int
+CacheReplicaCopier::startEvent(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+{
+  if (next == replicas.size()) {
+    return finish();
+  }
+  Vol *vol = caches[CACHE_FRAG_TYPE_HTTP]->key_to_vol(&key, hostname.data(), hostname.size());
+  MUTEX_TRY_LOCK(lock, vol->mutex, this_ethread());
+  if (!lock.is_locked() || vol->open_read(&key)) {
+    eventProcessor.schedule_in(this, lock.is_locked() ? CACHE_REPLICA_RETRY_DELAY : HRTIME_MSECONDS(cache_config_mutex_retry_delay),
+                               ET_CALL);
+    return EVENT_CONT;
+  }
+  SET_HANDLER(&CacheReplicaCopier::openReadEvent);
+  caches[CACHE_FRAG_TYPE_HTTP]->open_read(this, &key, &request, &params, CACHE_FRAG_TYPE_HTTP, hostname.data(), hostname.size());
+  return EVENT_CONT;
+}
+
+int
+CacheReplicaCopier::openReadEvent(int event, void *data)
+{
+  if (event != CACHE_EVENT_OPEN_READ) {
+    return finish();
+  }
+  read_vc = static_cast<CacheVC *>(data);
+  CacheHTTPInfo *alternate;
+  read_vc->get_http_info(&alternate);
+  size = read_vc->get_object_size();
+  if (read_vc->vector.count() != 1 || size <= 0) {
+    char tmpstr[CRYPTO_HEX_SIZE];
+    Debug("cache_replica", "not replicating %s, %d alternates", key.toHexStr(tmpstr), read_vc->vector.count());
+    read_vc->do_io_close();
+    read_vc = nullptr;
+    return finish();
+  }
+  info.destroy();
+  info.copy(alternate);
+  SET_HANDLER(&CacheReplicaCopier::openWriteEvent);
+  caches[CACHE_FRAG_TYPE_HTTP]->open_write(this, &replicas[next], nullptr, 0, nullptr, CACHE_FRAG_TYPE_HTTP, hostname.data(),
+                                           hostname.size());
+  return EVENT_CONT;
+}
+
+int
+CacheReplicaCopier::openWriteEvent(int event, void *data)
+{
+  if (event != CACHE_EVENT_OPEN_WRITE) {
+    // someone else is writing this key, skip it
+    read_vc->do_io_close();
+    read_vc = nullptr;
+    ++next;
+    return next_copy();
+  }
+  write_vc = static_cast<CacheVC *>(data);
+  CacheHTTPInfo copy;
+  copy.copy(&info);
+  write_vc->set_http_info(&copy);
+  buffer                 = new_MIOBuffer(BUFFER_SIZE_INDEX_32K);
+  IOBufferReader *reader = buffer->alloc_reader();
+  SET_HANDLER(&CacheReplicaCopier::copyEvent);
+  write_vio = write_vc->do_io_write(this, size, reader);
+  read_vio  = read_vc->do_io_read(this, size, buffer);
+  return EVENT_CONT;
+}
+
+int
+CacheReplicaCopier::copyEvent(int event, void * /* data ATS_UNUSED */)
+{
+  switch (event) {
+  case VC_EVENT_READ_READY:
+  case VC_EVENT_READ_COMPLETE:
+    write_vio->reenable();
+    return EVENT_CONT;
+  case VC_EVENT_WRITE_READY:
+    read_vio->reenable();
+    return EVENT_CONT;
+  case VC_EVENT_WRITE_COMPLETE:
+    read_vc->do_io_close();
+    write_vc->do_io_close();
+    written |= 1 << next;
+    GLOBAL_CACHE_SUM_GLOBAL_DYN_STAT(cache_hot_replica_writes_stat, 1);
+    break;
+  default:
+    read_vc->do_io_close(1);
+    write_vc->do_io_close(1);
+    break;
+  }
+  read_vc  = nullptr;
+  write_vc = nullptr;
+  free_MIOBuffer(buffer);
+  buffer = nullptr;
+  ++next;
+  return next_copy();
+}
+
+int
+CacheReplicaCopier::next_copy()
+{
+  SET_HANDLER(&CacheReplicaCopier::startEvent);
+  eventProcessor.schedule_imm(this, ET_CALL);
+  return EVENT_CONT;
+}
+
+// The copies are served once they are all written, until then every lookup reads the original.
+int
+CacheReplicaCopier::finish()
+{
+  bool live = false;
+  {
+    CacheReplicaShard &shard = replica_shard(&key);
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    auto spot = shard.entries.find(key);
+    if (spot != shard.entries.end() && spot->second->id == id) {
+      spot->second->ready  = written;
+      spot->second->copied = true;
+      live                 = true;
+    }
+  }
+  if (!live) {
+    // retired while copying
+    std::vector<CacheKey> stale;
+    for (size_t i = 0; i < replicas.size(); ++i) {
+      if (written & (1 << i)) {
+        stale.push_back(replicas[i]);
+      }
+    }
+    replica_remove(stale, hostname);
+  }
+  char tmpstr[CRYPTO_HEX_SIZE];
+  Debug("cache_replica", "copied %s, written 0x%x%s", key.toHexStr(tmpstr), written, live ? "" : ", retired");
+  delete this;
+  return EVENT_DONE;
+}
+
+struct CacheReplicaCooler : public Continuation {
+  int mainEvent(int event, Event *e);
+
+  CacheReplicaCooler() : Continuation(new_ProxyMutex()) { SET_HANDLER(&CacheReplicaCooler::mainEvent); }
+};
+
+int
+CacheReplicaCooler::mainEvent(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+{
+  for (auto &row : replica_sketch) {
+    for (auto &count : row) {
+      count.store(0, std::memory_order_relaxed);
+    }
+  }
+  for (auto &shard : replica_shards) {
+    std::vector<std::pair<CacheKey, uint64_t>> cold;
+    {
+      std::shared_lock<std::shared_mutex> lock(shard.mutex);
+      for (auto &[key, e] : shard.entries) {
+        if (e->hits.exchange(0) < static_cast<uint32_t>(cache_config_hot_replica_threshold) / 2) {
+          if (++e->cold_ticks >= CACHE_REPLICA_COOL_TICKS) {
+            cold.emplace_back(key, e->id);
+          }
+        } else {
+          e->cold_ticks = 0;
+        }
+      }
+    }
+    for (auto &[key, id] : cold) {
+      replica_retire(&key, id);
+    }
+  }
+  return EVENT_CONT;
+}
+
+} // namespace
+
+const CacheKey *
+cache_replica_select(const CacheKey *key, CacheKey *replica, CacheHTTPHdr *request, const OverridableHttpConfigParams *params,
+                     const char *hostname, int host_len)
+{
+  CacheReplicaShard &shard = replica_shard(key);
+  {
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    auto spot = shard.entries.find(*key);
+    if (spot != shard.entries.end()) {
+      CacheReplicaEntry *e = spot->second.get();
+      ++e->hits;
+      uint32_t ready = e->copied ? e->ready.load() : 0;
+      if (!ready) {
+        return key;
+      }
+      // the original is slot 0, the ready copies follow
+      uint32_t n = e->next++ % (__builtin_popcount(ready) + 1);
+      for (size_t i = 0; n && i < e->replicas.size(); ++i) {
+        if ((ready & (1 << i)) && !--n) {
+          *replica = e->replicas[i];
+          return replica;
+        }
+      }
+      return key;
+    }
+  }
+  if (replica_sketch_increment(key) < static_cast<uint32_t>(cache_config_hot_replica_threshold) || !request) {
+    return key;
+  }
+
+  auto e      = std::make_unique<CacheReplicaEntry>();
+  e->id       = replica_next_id++;
+  e->hostname = std::string(hostname ? hostname : "", hostname ? host_len : 0);
+  // derived keys which land in stripes not yet used by the document
+  Cache *cache = caches[CACHE_FRAG_TYPE_HTTP];
+  std::vector<Vol *> vols{cache->key_to_vol(key, hostname, host_len)};
+  int copies = std::min(cache_config_hot_replica_copies, CACHE_REPLICA_MAX_COPIES);
+  for (int i = 1; i <= 4 * copies && static_cast<int>(e->replicas.size()) < copies; ++i) {
+    CacheKey k;
+    replica_key(&k, key, i);
+    Vol *vol = cache->key_to_vol(&k, hostname, host_len);
+    if (std::find(vols.begin(), vols.end(), vol) == vols.end()) {
+      vols.push_back(vol);
+      e->replicas.push_back(k);
+    }
+  }
+  e->copied = e->replicas.empty();
+
+  CacheReplicaCopier *copier = nullptr;
+  {
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    if (shard.entries.count(*key)) {
+      return key;
+    }
+    if (!e->replicas.empty()) {
+      copier = new CacheReplicaCopier(key, e.get(), request, params);
+    }
+    char tmpstr[CRYPTO_HEX_SIZE];
+    Debug("cache_replica", "%s is hot, %zu copies", key->toHexStr(tmpstr), e->replicas.size());
+    shard.entries.emplace(*key, std::move(e));
+  }
+  GLOBAL_CACHE_SUM_GLOBAL_DYN_STAT(cache_hot_replica_objects_stat, 1);
+  if (copier) {
+    eventProcessor.schedule_imm(copier, ET_CALL);
+  }
+  return key;
+}
+
+void
+cache_replica_miss(const CacheKey *key, const CacheKey *replica)
+{
+  CacheReplicaShard &shard = replica_shard(key);
+  std::shared_lock<std::shared_mutex> lock(shard.mutex);
+  auto spot = shard.entries.find(*key);
+  if (spot != shard.entries.end()) {
+    CacheReplicaEntry *e = spot->second.get();
+    for (size_t i = 0; i < e->replicas.size(); ++i) {
+      if (e->replicas[i] == *replica) {
+        e->ready &= ~(1 << i);
+      }
+    }
+  }
+}
+
+void
+cache_replica_retire(const CacheKey *key)
+{
+  replica_retire(key);
+}
+
+void
+cache_replica_init()
+{
+  eventProcessor.schedule_every(new CacheReplicaCooler, HRTIME_SECOND, ET_CALL);
+}
@@ -0,0 +1,410 @@
+/** @file
+
+  Surrogate key index for bulk invalidation of tagged documents.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+// The response header named by proxy.config.cache.surrogate_key.header carries space separated
+// tags.  When an alternate is written its tags are entered in an index from tag to the first
+// keys of the documents which carry it, so all the documents for a tag are removed with one
+// lookup instead of a scan of the cache.  Entries are not dropped when a document is
+// overwritten or evicted, once per proxy.config.cache.dir.sync_frequency the index is pruned of
+// documents no longer in the directory and written to SURROGATE_KEY_FILE in the runtime
+// directory, which is read back at startup.
+
+#include "P_Cache.h"
+#include "tscore/ink_file.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+
+#define SURROGATE_KEY_FILE "surrogate_key.index"
+#define SURROGATE_KEY_MAGIC 0x534B4958 // "SKIX"
+#define SURROGATE_KEY_VERSION 1
+#define SURROGATE_KEY_SHARDS 16
+#define SURROGATE_KEY_MAX_TAG_LEN 1024
+#define SURROGATE_KEY_PRUNE_BUCKETS 64
+
+namespace
+{
+struct SurrogateKeyDoc {
+  CacheKey key;
+  Vol *vol;
+
+  bool
+  operator==(const SurrogateKeyDoc &that) const
+  {
+    return key == that.key && vol == that.vol;
+  }
+};
+
+struct SurrogateKeyDocHasher {
+  size_t
+  operator()(const SurrogateKeyDoc &doc) const
+  {
+    return doc.key.fold();
+  }
+};
+
+using SurrogateKeyDocs = std::unordered_set<SurrogateKeyDoc, SurrogateKeyDocHasher>;
+
+struct SurrogateKeyShard {
+  std::mutex mutex;
+  std::unordered_map<std::string, SurrogateKeyDocs> tags;
+};
+
+SurrogateKeyShard shards[SURROGATE_KEY_SHARDS];
+std::atomic<bool> dirty{false};
+
+// File layout: the header, then for each tag a SurrogateKeyFileTag, the tag and its documents.
+struct SurrogateKeyFileHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint64_t ntags;
+};
+
+struct SurrogateKeyFileTag {
+  uint32_t len;
+  uint32_t unused;
+  uint64_t ndocs;
+};
+
+struct SurrogateKeyFileDoc {
+  CacheKey key;
+  CryptoHash hash_id; // Vol::hash_id
+};
+} // namespace
+
+static SurrogateKeyShard &
+shard_for(std::string_view tag)
+{
+  return shards[std::hash<std::string_view>()(tag) % SURROGATE_KEY_SHARDS];
+}
+
+static std::string
+surrogate_key_path()
+{
+  ats_scoped_str rundir(RecConfigReadRuntimeDir());
+  char path[PATH_NAME_MAX];
+  ink_filepath_make(path, sizeof(path), rundir, SURROGATE_KEY_FILE);
+  return path;
+}
+
+static void
+surrogate_key_add(std::string_view tag, const SurrogateKeyDoc &doc)
+{
+  SurrogateKeyShard &shard = shard_for(tag);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  auto spot = shard.tags.find(std::string(tag));
+  if (spot == shard.tags.end()) {
+    spot = shard.tags.emplace(tag, SurrogateKeyDocs()).first;
+    GLOBAL_CACHE_SUM_GLOBAL_DYN_STAT(cache_surrogate_key_tags_stat, 1);
+  }
+  if (spot->second.insert(doc).second) {
+    GLOBAL_CACHE_SUM_GLOBAL_DYN_STAT(cache_surrogate_key_documents_stat, 1);
+    dirty = true;
+  }
+}
+
+void
+cache_surrogate_key_insert(Vol *vol, const CacheKey *first_key, CacheHTTPInfo *info)
+{
+  HTTPHdr *response = info->response_get();
+  if (!response || !response->valid()) {
+    return;
+  }
+  const MIMEField *field = response->field_find(cache_config_surrogate_key_header, strlen(cache_config_surrogate_key_header));
+  for (; field; field = field->m_next_dup) {
+    int len;
+    const char *value = field->value_get(&len);
+    ts::TextView text(value, len);
+    while (text) {
+      ts::TextView tag = text.take_prefix_if(&ParseRules::is_ws);
+      if (tag && tag.size() <= SURROGATE_KEY_MAX_TAG_LEN) {
+        surrogate_key_add(tag, {*first_key, vol});
+      }
+    }
+  }
+}
+
+namespace
+{
+// Removes the documents on an event thread, the caller might not be one.
+struct SurrogateKeyInvalidator : public Continuation {
+  std::vector<SurrogateKeyDoc> docs;
+
+  int
+  mainEvent(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+  {
+    if (!CacheProcessor::IsCacheReady(CACHE_FRAG_TYPE_HTTP)) {
+      delete this;
+      return EVENT_DONE;
+    }
+    Cache *cache = caches[CACHE_FRAG_TYPE_HTTP];
+    for (auto &doc : docs) {
+      cache->remove_in_vol(nullptr, &doc.key, CACHE_FRAG_TYPE_HTTP, doc.vol);
+    }
+    delete this;
+    return EVENT_DONE;
+  }
+
+  SurrogateKeyInvalidator() : Continuation(new_ProxyMutex())
+  {
+    SET_HANDLER(&SurrogateKeyInvalidator::mainEvent);
+    thread_stealable = true;
+  }
+};
+} // namespace
+
+int64_t
+cache_surrogate_key_invalidate(std::string_view tag)
+{
+  SurrogateKeyDocs docs;
+  {
+    SurrogateKeyShard &shard = shard_for(tag);
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    auto spot = shard.tags.find(std::string(tag));
+    if (spot == shard.tags.end()) {
+      return 0;
+    }
+    docs = std::move(spot->second);
+    shard.tags.erase(spot);
+    GLOBAL_CACHE_SUM_GLOBAL_DYN_STAT(cache_surrogate_key_tags_stat, -1);
+    GLOBAL_CACHE_SUM_GLOBAL_DYN_STAT(cache_surrogate_key_documents_stat, -static_cast<int64_t>(docs.size()));
+    dirty = true;
+  }
+  Debug("cache_surrogate_key", "invalidating %zu documents for tag '%.*s'", docs.size(), static_cast<int>(tag.size()), tag.data());
+  GLOBAL_CACHE_SUM_GLOBAL_DYN_STAT(cache_surrogate_key_invalidated_stat, docs.size());
+  SurrogateKeyInvalidator *invalidator = new SurrogateKeyInvalidator;
+  invalidator->docs.assign(docs.begin(), docs.end());
+  eventProcessor.schedule_imm(invalidator, ET_CALL);
+  return docs.size();
+}
+
+namespace
+{
+struct SurrogateKeySnapshot : public Continuation {
+  int shard_idx = 0;
+  size_t bucket = 0;
+
+  int mainEvent(int event, Event *e);
+  size_t prune(SurrogateKeyShard &shard, size_t from);
+  void write();
+
+  SurrogateKeySnapshot() : Continuation(new_ProxyMutex()) { SET_HANDLER(&SurrogateKeySnapshot::mainEvent); }
+};
+} // namespace
+
+// Prune the tags in SURROGATE_KEY_PRUNE_BUCKETS buckets of the shard from bucket @a from, and
+// return the bucket to continue from, 0 when the shard is done.  The shard is held only for the
+// slice and each stripe only for the probe of one document, a document whose stripe is busy is
+// kept until the next pass.  A rehash between slices can move a tag past the cursor, it is then
+// pruned on the next pass.
+size_t
+SurrogateKeySnapshot::prune(SurrogateKeyShard &shard, size_t from)
+{
+  std::unordered_set<Vol *> vols(gvol, gvol + gnvol);
+  EThread *thread = this_ethread();
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  size_t nbuckets = shard.tags.bucket_count();
+  size_t to       = std::min(from + SURROGATE_KEY_PRUNE_BUCKETS, nbuckets);
+  int64_t pruned  = 0;
+  std::vector<std::string> empty;
+  for (size_t b = from; b < to; ++b) {
+    for (auto spot = shard.tags.begin(b); spot != shard.tags.end(b); ++spot) {
+      SurrogateKeyDocs &docs = spot->second;
+      for (auto doc = docs.begin(); doc != docs.end();) {
+        Dir dir, *last_collision = nullptr;
+        bool stale               = false;
+        if (vols.count(doc->vol)) {
+          MUTEX_TRY_LOCK(vol_lock, doc->vol->mutex, thread);
+          stale = vol_lock.is_locked() && !dir_probe(&doc->key, doc->vol, &dir, &last_collision);
+        }
+        if (stale) {
+          doc = docs.erase(doc);
+          ++pruned;
+        } else {
+          ++doc;
+        }
+      }
+      if (docs.empty()) {
+        empty.push_back(spot->first);
+      }
+    }
+  }
+  for (auto &tag : empty) {
+    shard.tags.erase(tag);
+  }
+  if (!empty.empty()) {
+    GLOBAL_CACHE_SUM_GLOBAL_DYN_STAT(cache_surrogate_key_tags_stat, -static_cast<int64_t>(empty.size()));
+  }
+  if (pruned) {
+    GLOBAL_CACHE_SUM_GLOBAL_DYN_STAT(cache_surrogate_key_documents_stat, -pruned);
+    dirty = true;
+  }
+  return to < nbuckets ? to : 0;
+}
+
+// Blocking file I/O, this runs on ET_TASK.
+void
+SurrogateKeySnapshot::write()
+{
+  std::unordered_map<Vol *, CryptoHash> vols;
+  for (int i = 0; i < gnvol; ++i) {
+    vols[gvol[i]] = gvol[i]->hash_id;
+  }
+
+  std::vector<char> image(sizeof(SurrogateKeyFileHeader));
+  uint64_t ntags = 0;
+  for (auto &shard : shards) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    for (auto &[tag, docs] : shard.tags) {
+      SurrogateKeyFileTag file_tag = {static_cast<uint32_t>(tag.size()), 0, 0};
+      size_t tag_pos               = image.size();
+      image.insert(image.end(), reinterpret_cast<char *>(&file_tag), reinterpret_cast<char *>(&file_tag + 1));
+      image.insert(image.end(), tag.begin(), tag.end());
+      for (auto &doc : docs) {
+        auto vol = vols.find(doc.vol);
+        // the stripe went offline
+        if (vol == vols.end()) {
+          continue;
+        }
+        SurrogateKeyFileDoc file_doc = {doc.key, vol->second};
+        image.insert(image.end(), reinterpret_cast<char *>(&file_doc), reinterpret_cast<char *>(&file_doc + 1));
+        ++file_tag.ndocs;
+      }
+      memcpy(image.data() + tag_pos, &file_tag, sizeof(file_tag));
+      ++ntags;
+    }
+  }
+  SurrogateKeyFileHeader header = {SURROGATE_KEY_MAGIC, SURROGATE_KEY_VERSION, ntags};
+  memcpy(image.data(), &header, sizeof(header));
+
+  std::string path = surrogate_key_path();
+  std::string tmp  = path + ".tmp";
+  int fd           = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    Warning("unable to create surrogate key index '%s': %s", tmp.c_str(), strerror(errno));
+    return;
+  }
+  bool ok = ::write(fd, image.data(), image.size()) == static_cast<ssize_t>(image.size());
+  if (::close(fd) != 0 || !ok) {
+    Warning("unable to write surrogate key index '%s': %s", tmp.c_str(), strerror(errno));
+    return;
+  }
+  if (::rename(tmp.c_str(), path.c_str()) != 0) {
+    Warning("unable to rename surrogate key index '%s': %s", tmp.c_str(), strerror(errno));
+    return;
+  }
+  Debug("cache_surrogate_key", "wrote %" PRIu64 " tags to %s", ntags, path.c_str());
+}
+
+// One slice of a shard per event, so neither inserts nor the stripes wait on a pass over the index.
+int
+SurrogateKeySnapshot::mainEvent(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+{
+  if (shard_idx < SURROGATE_KEY_SHARDS) {
+    bucket = prune(shards[shard_idx], bucket);
+    if (bucket == 0) {
+      ++shard_idx;
+    }
+    eventProcessor.schedule_imm(this, ET_TASK);
+    return EVENT_CONT;
+  }
+  if (dirty.exchange(false)) {
+    write();
+  }
+  shard_idx = 0;
+  eventProcessor.schedule_in(this, HRTIME_SECONDS(cache_config_dir_sync_frequency), ET_TASK);
+  return EVENT_CONT;
+}
+
+namespace
+{
+struct SurrogateKeyLoader : public Continuation {
+  int mainEvent(int event, Event *e);
+  void load();
+
+  SurrogateKeyLoader() : Continuation(new_ProxyMutex()) { SET_HANDLER(&SurrogateKeyLoader::mainEvent); }
+};
+} // namespace
+
+// Blocking file I/O, this runs on ET_TASK.
+void
+SurrogateKeyLoader::load()
+{
+  std::string path = surrogate_key_path();
+  ats_scoped_fd fd(::open(path.c_str(), O_RDONLY));
+  if (fd < 0) {
+    Debug("cache_surrogate_key", "no surrogate key index at %s", path.c_str());
+    return;
+  }
+
+  SurrogateKeyFileHeader header;
+  if (::read(fd, &header, sizeof(header)) != sizeof(header) || header.magic != SURROGATE_KEY_MAGIC ||
+      header.version != SURROGATE_KEY_VERSION) {
+    Warning("ignoring invalid surrogate key index '%s'", path.c_str());
+    return;
+  }
+  uint64_t ndocs = 0;
+  for (uint64_t i = 0; i < header.ntags; ++i) {
+    SurrogateKeyFileTag file_tag;
+    if (::read(fd, &file_tag, sizeof(file_tag)) != sizeof(file_tag) || file_tag.len > SURROGATE_KEY_MAX_TAG_LEN) {
+      Warning("invalid surrogate key index '%s'", path.c_str());
+      break;
+    }
+    std::string tag(file_tag.len, '\0');
+    std::vector<SurrogateKeyFileDoc> file_docs(file_tag.ndocs);
+    ssize_t len = file_tag.ndocs * sizeof(SurrogateKeyFileDoc);
+    if (::read(fd, tag.data(), tag.size()) != static_cast<ssize_t>(tag.size()) || ::read(fd, file_docs.data(), len) != len) {
+      Warning("truncated surrogate key index '%s'", path.c_str());
+      break;
+    }
+    // stripes which are no longer configured are skipped
+    for (auto &file_doc : file_docs) {
+      for (int j = 0; j < gnvol; ++j) {
+        if (gvol[j]->hash_id == file_doc.hash_id) {
+          surrogate_key_add(tag, {file_doc.key, gvol[j]});
+          ++ndocs;
+          break;
+        }
+      }
+    }
+  }
+  Note("loaded %" PRIu64 " surrogate key documents from '%s'", ndocs, path.c_str());
+}
+
+int
+SurrogateKeyLoader::mainEvent(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+{
+  load();
+  eventProcessor.schedule_in(new SurrogateKeySnapshot, HRTIME_SECONDS(cache_config_dir_sync_frequency), ET_TASK);
+  delete this;
+  return EVENT_DONE;
+}
+
+void
+cache_surrogate_key_init()
+{
+  eventProcessor.schedule_imm(new SurrogateKeyLoader, ET_TASK);
+}
@@ -161,6 +161,9 @@ int
 CacheVC::scanObject(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
 {
   Debug("cache_scan_truss", "inside %p:scanObject", this);
+  if (vol) {
+    vol->disk->io_read_done(&io);
+  }
 
   Doc *doc     = nullptr;
   void *result = nullptr;
@@ -374,7 +377,7 @@ Lread:
     io.aiocb.aio_nbytes = vol->skip + vol->len - io.aiocb.aio_offset;
   }
   offset = 0;
-  ink_assert(ink_aio_read(&io) >= 0);
+  vol->disk->io_read(&io);
   Debug("cache_scan_truss", "read %p:scanObject %" PRId64 " %zu", this, (int64_t)io.aiocb.aio_offset, (size_t)io.aiocb.aio_nbytes);
   return EVENT_CONT;
 
@@ -111,6 +111,9 @@ CacheVC::updateVector(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
         alternate.copy_frag_offsets_from(write_vector->get(alternate_index));
       }
       alternate_index = write_vector->insert(&alternate, alternate_index);
+      if (cache_config_surrogate_key_header) {
+        cache_surrogate_key_insert(vol, &first_key, &alternate);
+      }
     }
 
     if (od->move_resident_alt && first_buf.get() && !od->has_multiple_writers()) {
@@ -217,7 +220,7 @@ CacheVC::handleWrite(int event, Event * /* e ATS_UNUSED */)
   } else {
     vol->agg.enqueue(this);
   }
-  if (!vol->is_io_in_progress()) {
+  if (vol->agg_write_ready()) {
     return vol->aggWrite(event, this);
   }
   return EVENT_CONT;
@@ -275,6 +278,97 @@ Vol::force_evacuate_head(Dir *evac_dir, int pinned)
   return b;
 }
 
+// Whether a read of the document at dir should evacuate it when it is closed. With the scrubber
+// the read only adds to the heat of the document and the scrubber decides.
+bool
+Vol::hit_evacuate(Dir *xdir, uint64_t doc_len)
+{
+  if (cache_config_hit_evacuate_size_limit && doc_len > static_cast<uint64_t>(cache_config_hit_evacuate_size_limit)) {
+    return false;
+  }
+  if (!heat.empty()) {
+    uint8_t &h = heat[heat_slot(dir_offset(xdir))];
+    if (h < UINT8_MAX) {
+      ++h;
+    }
+    return false;
+  }
+  return within_hit_evacuate_window(xdir);
+}
+
+// Examine the next n directory entries, evacuating heads which are hot enough and about to be
+// overwritten. The heat is halved after each pass over the directory so it follows recent reads.
+void
+Vol::scrub(int n)
+{
+  // whatever was hot in the data written since the last scrub is gone
+  off_t pos = header->write_pos;
+  if (scrub_write_pos < start) {
+    scrub_write_pos = pos;
+  }
+  if (pos != scrub_write_pos) {
+    size_t from = heat_slot(offset_to_vol_offset(scrub_write_pos));
+    size_t to   = heat_slot(offset_to_vol_offset(pos));
+    if (pos < scrub_write_pos) {
+      std::fill(heat.begin() + from, heat.end(), 0);
+      from = 0;
+    }
+    std::fill(heat.begin() + from, heat.begin() + to, 0);
+    scrub_write_pos = pos;
+  }
+
+  int entries   = direntries();
+  int threshold = cache_config_scrub_heat_threshold;
+  for (int i = 0; i < n; ++i) {
+    Dir *e = &dir[scrub_pos];
+    if (!dir_is_empty(e) && dir_head(e) && heat[heat_slot(dir_offset(e))] >= threshold && dir_valid(this, e) &&
+        within_scrub_window(e) && !evacuation_block_exists(e, this)) {
+      DDebug("cache_evac", "scrub: %d, heat %d", (int)dir_offset(e), heat[heat_slot(dir_offset(e))]);
+      force_evacuate_head(e, dir_pinned(e));
+      Vol *vol = this;
+      CACHE_INCREMENT_DYN_STAT(cache_scrub_evacuate_stat);
+    }
+    if (++scrub_pos >= entries) {
+      scrub_pos = 0;
+      for (auto &h : heat) {
+        h >>= 1;
+      }
+    }
+  }
+}
+
+// Runs Vol::scrub() on every stripe with a heat map, proxy.config.cache.scrub.rate directory
+// entries per second each.
+struct CacheScrubber : public Continuation {
+  int mainEvent(int event, Event *e);
+
+  CacheScrubber() : Continuation(new_ProxyMutex()) { SET_HANDLER(&CacheScrubber::mainEvent); }
+};
+
+int
+CacheScrubber::mainEvent(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+{
+  int n = std::max(cache_config_scrub_rate / CACHE_SCRUB_TICKS_PER_SECOND, 1);
+  for (int i = 0; i < gnvol; ++i) {
+    Vol *vol = gvol[i];
+    if (vol->heat.empty()) {
+      continue;
+    }
+    // a busy stripe is scrubbed on the next tick
+    MUTEX_TRY_LOCK(lock, vol->mutex, this_ethread());
+    if (lock.is_locked()) {
+      vol->scrub(n);
+    }
+  }
+  return EVENT_CONT;
+}
+
+void
+cache_scrub_init()
+{
+  eventProcessor.schedule_every(new CacheScrubber, HRTIME_SECOND / CACHE_SCRUB_TICKS_PER_SECOND, ET_CALL);
+}
+
 void
 Vol::scan_for_pinned_documents()
 {
@@ -308,54 +402,69 @@ Vol::scan_for_pinned_documents()
   }
 }
 
+int
+AggWriteIO::handle_write_done(int event, void * /* data ATS_UNUSED */)
+{
+  return vol->aggWriteDone(event, this);
+}
+
 /* NOTE:: This state can be called by an AIO thread, so DON'T DON'T
    DON'T schedule any events on this thread using VC_SCHED_XXX or
    mutex->thread_holding->schedule_xxx_local(). ALWAYS use
    eventProcessor.schedule_xxx().
    */
 int
-Vol::aggWriteDone(int event, Event *e)
+Vol::aggWriteDone(int event, AggWriteIO *w)
 {
   cancel_trigger();
+  disk->io_write_done(&w->io);
 
   // ensure we have the cacheDirSync lock if we intend to call it later
   // retaking the current mutex recursively is a NOOP
   CACHE_TRY_LOCK(lock, dir_sync_waiting ? cacheDirSync->mutex : mutex, mutex->thread_holding);
   if (!lock.is_locked()) {
-    eventProcessor.schedule_in(this, HRTIME_MSECONDS(cache_config_mutex_retry_delay));
+    eventProcessor.schedule_in(w, HRTIME_MSECONDS(cache_config_mutex_retry_delay));
     return EVENT_CONT;
   }
-  if (io.ok()) {
-    header->last_write_pos = header->write_pos;
-    header->write_pos += io.aiocb.aio_nbytes;
-    ink_assert(header->write_pos >= start);
-    DDebug("cache_agg", "Dir %s, Write: %" PRIu64 ", last Write: %" PRIu64 "", hash_text.get(), header->write_pos,
-           header->last_write_pos);
-    ink_assert(header->write_pos == header->agg_pos);
-    if (header->write_pos + EVACUATION_SIZE > scan_pos) {
-      periodic_scan();
-    }
-    agg_buf_pos = 0;
-    header->write_serial++;
-  } else {
-    // delete all the directory entries that we inserted
-    // for fragments is this aggregation buffer
-    Debug("cache_disk_error", "Write error on disk %s\n \
+  if (!w->done) {
+    w->done = true;
+    --disk->agg_writes_in_flight;
+    AIOCallback *io = &w->io;
+    if (!io->ok()) {
+      // delete all the directory entries that we inserted
+      // for fragments in this write
+      Debug("cache_disk_error", "Write error on disk %s\n \
               write range : [%" PRIu64 " - %" PRIu64 " bytes]  [%" PRIu64 " - %" PRIu64 " blocks] \n",
-          hash_text.get(), (uint64_t)io.aiocb.aio_offset, (uint64_t)io.aiocb.aio_offset + io.aiocb.aio_nbytes,
-          (uint64_t)io.aiocb.aio_offset / CACHE_BLOCK_SIZE,
-          (uint64_t)(io.aiocb.aio_offset + io.aiocb.aio_nbytes) / CACHE_BLOCK_SIZE);
-    Dir del_dir;
-    dir_clear(&del_dir);
-    for (int done = 0; done < agg_buf_pos;) {
-      Doc *doc = reinterpret_cast<Doc *>(agg_buffer + done);
-      dir_set_offset(&del_dir, header->write_pos + done);
-      dir_delete(&doc->key, this, &del_dir);
-      done += round_to_approx_size(doc->len);
-    }
-    agg_buf_pos = 0;
+            hash_text.get(), (uint64_t)io->aiocb.aio_offset, (uint64_t)io->aiocb.aio_offset + io->aiocb.aio_nbytes,
+            (uint64_t)io->aiocb.aio_offset / CACHE_BLOCK_SIZE,
+            (uint64_t)(io->aiocb.aio_offset + io->aiocb.aio_nbytes) / CACHE_BLOCK_SIZE);
+      Dir del_dir;
+      dir_clear(&del_dir);
+      for (size_t done = 0; done < io->aiocb.aio_nbytes;) {
+        Doc *doc = reinterpret_cast<Doc *>(static_cast<char *>(io->aiocb.aio_buf) + done);
+        dir_set_offset(&del_dir, offset_to_vol_offset(io->aiocb.aio_offset + done));
+        dir_delete(&doc->key, this, &del_dir);
+        done += round_to_approx_size(doc->len);
+      }
+      // recovery must not look at the range, it starts after it
+      agg_write_failed_pos = io->aiocb.aio_offset + io->aiocb.aio_nbytes;
+    }
+  }
+
+  // Writes are retired in the order they were issued, so the write serial only counts writes
+  // which are on disk along with everything before them. A failed write moves it on as well,
+  // the documents after it already carry the following serials.
+  bool retired = false;
+  while ((w = agg_write_oldest()) && w->done) {
+    w->done                = false;
+    w->io.aiocb.aio_fildes = AIO_NOT_IN_PROGRESS;
+    --agg_writes_in_flight;
+    header->write_serial++;
+    retired = true;
+  }
+  if (!retired) {
+    return EVENT_CONT;
   }
-  set_io_not_in_progress();
   // callback ready sync CacheVCs
   CacheVC *c = nullptr;
   while ((c = sync.dequeue())) {
@@ -366,12 +475,39 @@ Vol::aggWriteDone(int event, Event *e)
       break;
     }
   }
+  if (agg_writes_in_flight) {
+    // the buffer moves on once everything handed to the disk is written, meanwhile use the free slot
+    if ((agg.head || sync.head || agg_buf_pos > agg_buf_written) && agg_write_ready()) {
+      return aggWrite(event, nullptr);
+    }
+    return EVENT_CONT;
+  }
+
+  header->last_write_pos = header->write_pos;
+  header->write_pos += agg_buf_written;
+  if (agg_write_failed_pos > header->last_write_pos) {
+    header->last_write_pos = agg_write_failed_pos;
+  }
+  agg_write_failed_pos = 0;
+  ink_assert(header->write_pos >= start);
+  DDebug("cache_agg", "Dir %s, Write: %" PRIu64 ", last Write: %" PRIu64 "", hash_text.get(), header->write_pos,
+         header->last_write_pos);
+  ink_assert(header->write_pos == header->agg_pos);
+  if (header->write_pos + EVACUATION_SIZE > scan_pos) {
+    periodic_scan();
+  }
+  // documents copied in while the writes were in flight move to the front of the buffer
+  if (agg_buf_pos > agg_buf_written) {
+    memmove(agg_buffer, agg_buffer + agg_buf_written, agg_buf_pos - agg_buf_written);
+  }
+  agg_buf_pos -= agg_buf_written;
+  agg_buf_written = 0;
   if (dir_sync_waiting) {
     dir_sync_waiting = false;
     cacheDirSync->handleEvent(EVENT_IMMEDIATE, nullptr);
   }
-  if (agg.head || sync.head) {
-    return aggWrite(event, e);
+  if ((agg.head || sync.head || agg_buf_pos) && agg_write_ready()) {
+    return aggWrite(event, nullptr);
   }
   return EVENT_CONT;
 }
@@ -383,7 +519,7 @@ new_DocEvacuator(int nbytes, Vol *vol)
   ProxyMutex *mutex = vol->mutex.get();
   c->base_stat      = cache_evacuate_active_stat;
   CACHE_INCREMENT_DYN_STAT(c->base_stat + CACHE_STAT_ACTIVE);
-  c->buf          = new_IOBufferData(iobuffer_size_to_index(nbytes, MAX_BUFFER_SIZE_INDEX), MEMALIGNED);
+  c->buf          = new_IOBufferData(iobuffer_size_to_index(nbytes, MAX_BUFFER_SIZE_INDEX), POOL_ALIGNED);
   c->vol          = vol;
   c->f.evacuator  = 1;
   c->earliest_key = zero_key;
@@ -610,6 +746,7 @@ Vol::evacuateDocReadDone(int event, Event *e)
   if (event != AIO_EVENT_DONE) {
     return EVENT_DONE;
   }
+  disk->io_read_done(&io);
   ink_assert(is_io_in_progress());
   set_io_not_in_progress();
   ink_assert(mutex->thread_holding == this_ethread());
@@ -731,7 +868,7 @@ Vol::evac_range(off_t low, off_t high, int evac_phase)
       io.thread        = AIO_CALLBACK_THREAD_ANY;
       DDebug("cache_evac", "evac_range evacuating %X %d", (int)dir_tag(&first->dir), (int)dir_offset(&first->dir));
       SET_HANDLER(&Vol::evacuateDocReadDone);
-      ink_assert(ink_aio_read(&io) >= 0);
+      disk->io_read(&io);
       return -1;
     }
   }
@@ -768,7 +905,7 @@ agg_copy(char *p, CacheVC *vc)
     doc->total_len   = vc->total_len;
     doc->first_key   = vc->first_key;
     doc->sync_serial = vol->header->sync_serial;
-    vc->write_serial = doc->write_serial = vol->header->write_serial;
+    vc->write_serial = doc->write_serial = vol->agg_write_serial();
     doc->checksum                        = DOC_NO_CHECKSUM;
     if (vc->pin_in_cache) {
       dir_set_pinned(&vc->dir, 1);
@@ -808,14 +945,15 @@ agg_copy(char *p, CacheVC *vc)
       ink_assert(vc->f.use_first_key);
       if (vc->frag_type == CACHE_FRAG_TYPE_HTTP) {
         ink_assert(vc->write_vector->count() > 0);
-        if (!vc->f.update && !vc->f.evac_vector) {
+        // the length of a sparse object is known up front
+        if (!vc->f.update && !vc->f.evac_vector && !vc->f.sparse) {
           ink_assert(!(vc->first_key == zero_key));
           CacheHTTPInfo *http_info = vc->write_vector->get(vc->alternate_index);
           http_info->object_size_set(vc->total_len);
         }
         // update + data_written =>  Update case (b)
         // need to change the old alternate's object length
-        if (vc->f.update && vc->total_len) {
+        if (vc->f.update && vc->total_len && !vc->f.sparse) {
           CacheHTTPInfo *http_info = vc->write_vector->get(vc->alternate_index);
           http_info->object_size_set(vc->total_len);
         }
@@ -861,6 +999,10 @@ agg_copy(char *p, CacheVC *vc)
     if (vc->frag_type == CACHE_FRAG_TYPE_HTTP && vc->f.single_fragment) {
       ink_assert(doc->hlen);
     }
+    // readers of an object being written read the body fragments just behind the writer
+    if (vc->od && vc->f.readers && !doc->hlen && doc->data_len()) {
+      vc->od->frag_ring_put(doc);
+    }
 
     if (res_alt_blk) {
       res_alt_blk->free();
@@ -879,7 +1021,7 @@ agg_copy(char *p, CacheVC *vc)
     }
 
     doc->sync_serial  = vc->vol->header->sync_serial;
-    doc->write_serial = vc->vol->header->write_serial;
+    doc->write_serial = vc->vol->agg_write_serial();
 
     memcpy(p, doc, doc->len);
 
@@ -968,6 +1110,53 @@ Vol::agg_wrap()
   periodic_scan();
 }
 
+/* The oldest aggregation write which has not been retired, or nullptr. Its write serial is the
+   stripe's.
+*/
+AggWriteIO *
+Vol::agg_write_oldest()
+{
+  for (auto &w : agg_io) {
+    if (w.io.aiocb.aio_fildes != AIO_NOT_IN_PROGRESS && w.serial == header->write_serial) {
+      return &w;
+    }
+  }
+  return nullptr;
+}
+
+/* A free slot for another aggregation write, or nullptr. A stripe can always have one write in
+   flight, more only while the disk has fewer than proxy.config.cache.agg_write_in_flight.
+*/
+AggWriteIO *
+Vol::agg_write_slot()
+{
+  if (agg_writes_in_flight && (agg_writes_in_flight >= AGG_WRITES_MAX ||
+                               disk->agg_writes_in_flight.load(std::memory_order_relaxed) >= cache_config_agg_write_in_flight)) {
+    return nullptr;
+  }
+  for (auto &w : agg_io) {
+    if (w.io.aiocb.aio_fildes == AIO_NOT_IN_PROGRESS) {
+      return &w;
+    }
+  }
+  return nullptr;
+}
+
+/* How much to aggregate before writing. A busy disk gets fewer, larger writes. An idle one
+   gets a write as soon as a share of the high water mark is ready, so that it is not left
+   idle while writers wait for the buffer.
+*/
+int
+Vol::agg_write_size()
+{
+  int limit = cache_config_agg_write_in_flight;
+  int depth = disk->agg_writes_in_flight.load(std::memory_order_relaxed);
+  if (limit <= 1 || depth >= limit) {
+    return AGG_HIGH_WATER;
+  }
+  return AGG_HIGH_WATER / limit * (depth + 1);
+}
+
 /* NOTE: This state can be called by an AIO thread, so DON'T DON'T
    DON'T schedule any events on this thread using VC_SCHED_XXX or
    mutex->thread_holding->schedule_xxx_local(). ALWAYS use
@@ -978,10 +1167,13 @@ Vol::agg_wrap()
 int
 Vol::aggWrite(int event, void * /* e ATS_UNUSED */)
 {
-  ink_assert(!is_io_in_progress());
+  // aggregation writes may be in flight, but not the stripe's own I/O
+  ink_assert(io.aiocb.aio_fildes == AIO_NOT_IN_PROGRESS);
 
   Que(CacheVC, link) tocall;
   CacheVC *c;
+  AggWriteIO *w = nullptr;
+  int nbytes;
 
   cancel_trigger();
 
@@ -994,6 +1186,10 @@ Lagain:
     if (agg_buf_pos + writelen > AGG_SIZE || header->write_pos + agg_buf_pos + writelen > (skip + len)) {
       break;
     }
+    // let a waiting directory sync catch up with the buffer
+    if (dir_sync_waiting && agg_writes_in_flight) {
+      break;
+    }
     DDebug("agg_read", "copying: %d, %" PRIu64 ", key: %d", agg_buf_pos, header->write_pos + agg_buf_pos, c->first_key.slice32(0));
     int wrotelen = agg_copy(agg_buffer + agg_buf_pos, c);
     ink_assert(writelen == wrotelen);
@@ -1049,9 +1245,16 @@ Lagain:
     }
   }
 
-  // if agg.head, then we are near the end of the disk, so
+  // if agg.head, then we are near the end of the disk or the buffer is full, so
   // write down the aggregation in whatever size it is.
-  if (agg_buf_pos < AGG_HIGH_WATER && !agg.head && !sync.head && !dir_sync_waiting) {
+  nbytes = agg_buf_pos - agg_buf_written;
+  if (nbytes < agg_write_size() && !agg.head && !sync.head && !dir_sync_waiting) {
+    goto Lwait;
+  }
+  if (agg_buf_pos && !nbytes) {
+    goto Lwait; // all of it is already on the way
+  }
+  if (!(w = agg_write_slot())) {
     goto Lwait;
   }
 
@@ -1065,25 +1268,41 @@ Lagain:
     d->magic        = DOC_MAGIC;
     d->len          = l;
     d->sync_serial  = header->sync_serial;
-    d->write_serial = header->write_serial;
+    d->write_serial = agg_write_serial();
   }
 
   // set write limit
   header->agg_pos = header->write_pos + agg_buf_pos;
 
-  io.aiocb.aio_fildes = fd;
-  io.aiocb.aio_offset = header->write_pos;
-  io.aiocb.aio_buf    = agg_buffer;
-  io.aiocb.aio_nbytes = agg_buf_pos;
-  io.action           = this;
+  nbytes                 = agg_buf_pos - agg_buf_written;
+  w->io.aiocb.aio_fildes = fd;
+  w->io.aiocb.aio_offset = header->write_pos + agg_buf_written;
+  w->io.aiocb.aio_buf    = agg_buffer + agg_buf_written;
+  w->io.aiocb.aio_nbytes = nbytes;
+  w->io.action           = w;
   /*
     Callback on AIO thread so that we can issue a new write ASAP
     as all writes are serialized in the volume.  This is not necessary
     for reads proceed independently.
    */
-  io.thread = AIO_CALLBACK_THREAD_AIO;
-  SET_HANDLER(&Vol::aggWriteDone);
-  ink_aio_write(&io);
+  w->io.thread    = AIO_CALLBACK_THREAD_AIO;
+  w->serial       = agg_write_serial();
+  agg_buf_written = agg_buf_pos;
+  ++agg_writes_in_flight;
+  ++disk->agg_writes_in_flight;
+  {
+    Vol *vol = this; // must be named "vol" to make STAT macros work.
+    if (nbytes <= 64 * 1024) {
+      CACHE_INCREMENT_DYN_STAT(cache_agg_write_size_64k_stat);
+    } else if (nbytes <= 256 * 1024) {
+      CACHE_INCREMENT_DYN_STAT(cache_agg_write_size_256k_stat);
+    } else if (nbytes <= 1024 * 1024) {
+      CACHE_INCREMENT_DYN_STAT(cache_agg_write_size_1m_stat);
+    } else {
+      CACHE_INCREMENT_DYN_STAT(cache_agg_write_size_4m_stat);
+    }
+  }
+  disk->io_write(&w->io);
 
 Lwait:
   int ret = EVENT_CONT;
@@ -1254,7 +1473,8 @@ CacheVC::openWriteCloseDataDone(int event, Event *e)
     } else {
       // Store the offset only if there is a table.
       // Currently there is no alt (and thence no table) for non-HTTP.
-      if (alternate.valid()) {
+      // A sparse alternate has the whole table already.
+      if (alternate.valid() && !f.sparse) {
         alternate.push_frag_offset(write_pos);
       }
     }
@@ -1268,6 +1488,9 @@ CacheVC::openWriteCloseDataDone(int event, Event *e)
       if (write_len > MAX_FRAG_SIZE) {
         write_len = MAX_FRAG_SIZE;
       }
+      if (f.sparse && write_len > static_cast<uint32_t>(alternate.sparse_frag_size_get())) {
+        write_len = alternate.sparse_frag_size_get();
+      }
       if ((ret = do_write_call()) == EVENT_RETURN) {
         goto Lcallreturn;
       }
@@ -1304,12 +1527,16 @@ CacheVC::openWriteClose(int event, Event *e)
         return openWriteCloseDir(event, e);
       }
     }
-    if (length && (fragment || length > static_cast<int>(MAX_FRAG_SIZE))) {
+    // the data of a sparse object is never written with the vector
+    if (length && (fragment || f.sparse || length > static_cast<int>(MAX_FRAG_SIZE))) {
       SET_HANDLER(&CacheVC::openWriteCloseDataDone);
       write_len = length;
       if (write_len > MAX_FRAG_SIZE) {
         write_len = MAX_FRAG_SIZE;
       }
+      if (f.sparse && write_len > static_cast<uint32_t>(alternate.sparse_frag_size_get())) {
+        write_len = alternate.sparse_frag_size_get();
+      }
       return do_write_lock_call();
     } else {
       return openWriteCloseHead(event, e);
@@ -1350,7 +1577,8 @@ CacheVC::openWriteWriteDone(int event, Event *e)
     } else {
       // Store the offset only if there is a table.
       // Currently there is no alt (and thence no table) for non-HTTP.
-      if (alternate.valid()) {
+      // A sparse alternate has the whole table already.
+      if (alternate.valid() && !f.sparse) {
         alternate.push_frag_offset(write_pos);
       }
     }
@@ -1368,14 +1596,6 @@ CacheVC::openWriteWriteDone(int event, Event *e)
   return openWriteMain(event, e);
 }
 
-static inline int
-target_fragment_size()
-{
-  uint64_t value = cache_config_target_fragment_size - sizeof(Doc);
-  ink_release_assert(value <= MAX_FRAG_SIZE);
-  return value;
-}
-
 int
 CacheVC::openWriteMain(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
 {
@@ -1423,12 +1643,14 @@ Lagain:
     total_len += avail;
   }
   length = static_cast<uint64_t>(towrite);
-  if (length > target_fragment_size() && (length < target_fragment_size() + target_fragment_size() / 4)) {
-    write_len = target_fragment_size();
+  // fragments of a sparse object are all the same size so they can be found by offset
+  int frag_size = f.sparse ? alternate.sparse_frag_size_get() : vol->target_fragment_size();
+  if (length > frag_size && (f.sparse || length < frag_size + frag_size / 4)) {
+    write_len = frag_size;
   } else {
     write_len = length;
   }
-  bool not_writing = towrite != ntodo && towrite < target_fragment_size();
+  bool not_writing = towrite != ntodo && towrite < frag_size;
   if (!called_user) {
     if (not_writing) {
       called_user = 1;
@@ -1714,6 +1936,10 @@ Cache::open_write(Continuation *cont, const CacheKey *key, CacheHTTPInfo *info,
   }
 
   ink_assert(caches[type] == this);
+  if (cache_config_hot_replica_copies > 0) {
+    // the copies would go stale
+    cache_replica_retire(key);
+  }
   intptr_t err      = 0;
   int if_writers    = (uintptr_t)info == CACHE_ALLOW_MULTIPLE_WRITES;
   CacheVC *c        = new_CacheVC(cont);
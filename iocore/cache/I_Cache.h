@@ -40,6 +40,7 @@ static constexpr ts::ModuleVersion CACHE_MODULE_VERSION(1, 0);
 
 #define RAM_CACHE_ALGORITHM_CLFUS 0
 #define RAM_CACHE_ALGORITHM_LRU 1
+#define RAM_CACHE_ALGORITHM_TINYLFU 2
 
 #define CACHE_COMPRESSION_NONE 0
 #define CACHE_COMPRESSION_FASTLZ 1
@@ -97,6 +98,13 @@ struct CacheProcessor : public Processor {
   Action *deref(Continuation *cont, CacheKey *key, CacheFragType frag_type = CACHE_FRAG_TYPE_HTTP, char *hostname = nullptr,
                 int host_len = 0);
 
+  /** Remove every document tagged with @a tag in the proxy.config.cache.surrogate_key.header response header.
+      The removals are scheduled, they are not done when this returns.
+
+      @return The number of documents removed.
+  */
+  int64_t invalidate_tag(const char *tag, int tag_len);
+
   /** Mark physical disk/device/file as offline.
       All stripes for this device are disabled.
 
@@ -172,6 +180,7 @@ struct CacheVConnection : public VConnection {
   VIO *do_io_read(Continuation *c, int64_t nbytes, MIOBuffer *buf) override                           = 0;
   virtual VIO *do_io_pread(Continuation *c, int64_t nbytes, MIOBuffer *buf, int64_t offset)           = 0;
   VIO *do_io_write(Continuation *c, int64_t nbytes, IOBufferReader *buf, bool owner = false) override = 0;
+  virtual VIO *do_io_pwrite(Continuation *c, int64_t nbytes, IOBufferReader *buf, int64_t offset)     = 0;
   void do_io_close(int lerrno = -1) override                                                          = 0;
   void reenable(VIO *avio) override                                                                   = 0;
   void reenable_re(VIO *avio) override                                                                = 0;
@@ -210,6 +219,16 @@ struct CacheVConnection : public VConnection {
   */
   virtual bool is_pread_capable() = 0;
 
+  /** Get the number of bytes of the object in the cache starting at @a offset.
+      For a sparse object this is the contiguous run of fragments which were present when the
+      object was opened, otherwise it is the rest of the object.
+  */
+  virtual int64_t
+  get_cached_length(int64_t offset)
+  {
+    return offset < get_object_size() ? get_object_size() - offset : 0;
+  }
+
   CacheVConnection();
 };
 
@@ -25,9 +25,14 @@
 
 #include "P_CacheHttp.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 struct Vol;
 struct InterimCacheVol;
 struct CacheVC;
+struct Doc;
 
 /*
   Directory layout
@@ -217,6 +222,8 @@ struct FreeDir {
 // is deleted/inserted into the vector just before writing the vector disk
 // (CacheVC::updateVector).
 LINK_FORWARD_DECLARATION(CacheVC, opendir_link) // forward declaration
+#define OPEN_DIR_FRAG_RING_SIZE 8 // upper bound of proxy.config.cache.read_while_writer.fragment_ring
+
 struct OpenDirEntry {
   DLL<CacheVC, Link_CacheVC_opendir_link> writers; // list of all the current writers
   DLL<CacheVC, Link_CacheVC_opendir_link> readers; // list of all the current readers - not used
@@ -234,9 +241,18 @@ struct OpenDirEntry {
   bool reading_vec;                                // somebody is currently reading the vector
   bool writing_vec;                                // somebody is currently writing the vector
 
+  // Copies of the last fragments written, shared by the readers of the object being
+  // written instead of each reading them back from disk. Protected by the stripe mutex.
+  CacheKey frag_ring_key[OPEN_DIR_FRAG_RING_SIZE];
+  Ptr<IOBufferData> frag_ring_data[OPEN_DIR_FRAG_RING_SIZE];
+  int frag_ring_next;
+
   LINK(OpenDirEntry, link);
 
   int wait(CacheVC *c, int msec);
+  void frag_ring_put(const Doc *doc);
+  bool frag_ring_get(const CacheKey *key, Ptr<IOBufferData> *data) const;
+  void frag_ring_clear();
 
   bool
   has_multiple_writers()
@@ -258,16 +274,22 @@ struct OpenDir : public Continuation {
 };
 
 struct CacheSync : public Continuation {
-  int vol_idx    = 0;
-  char *buf      = nullptr;
-  size_t buflen  = 0;
-  bool buf_huge  = false;
-  off_t writepos = 0;
+  int vol_idx        = 0;
+  char *buf          = nullptr;
+  size_t buflen      = 0;
+  bool buf_huge      = false;
+  off_t writepos     = 0;
+  bool write_failed  = false;
+  int64_t sync_bytes = 0;        // bytes written for the current stripe
+  std::vector<bool> sync_blocks; // directory blocks of the current stripe copied into buf
   AIOCallbackInternal io;
   Event *trigger        = nullptr;
   ink_hrtime start_time = 0;
   int mainEvent(int event, Event *e);
   void aio_write(int fd, char *b, int n, off_t o);
+  off_t next_sync_block(off_t pos, off_t headerlen);
+  void alloc_buf(size_t len);
+  void free_buf();
 
   CacheSync() : Continuation(new_ProxyMutex()) { SET_HANDLER(&CacheSync::mainEvent); }
 };
@@ -309,6 +331,49 @@ dir_compare_tag(const Dir *e, const CacheKey *key)
   return (dir_tag(e) == DIR_MASK_TAG(key->slice32(2)));
 }
 
+// Bit i of the result is set if entry i of bucket @a b has the tag of @a key.
+TS_INLINE uint32_t
+dir_bucket_match_scalar(const Dir *b, const CacheKey *key)
+{
+  uint32_t t     = DIR_MASK_TAG(key->slice32(2));
+  uint32_t match = 0;
+  for (int i = 0; i < DIR_DEPTH; i++) {
+    match |= static_cast<uint32_t>(dir_tag(dir_in_seg(b, i)) == t) << i;
+  }
+  return match;
+}
+
+// The entries of a bucket are contiguous, so compare all of their tags at once.
+TS_INLINE uint32_t
+dir_bucket_match(const Dir *b, const CacheKey *key)
+{
+#if defined(__SSE2__) && DIR_DEPTH == 4 && SIZEOF_DIR == 10
+  // The tag is the third uint16_t of an entry, so the four tags are lanes 2 and 7 of bytes
+  // [0, 16) and lanes 0 and 5 of bytes [24, 40). movemask yields two bits per lane.
+  const __m128i tag_mask = _mm_set1_epi16((1 << DIR_TAG_WIDTH) - 1);
+  const __m128i t        = _mm_set1_epi16(static_cast<short>(DIR_MASK_TAG(key->slice32(2))));
+  const char *p          = reinterpret_cast<const char *>(b);
+  __m128i lo             = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p)), tag_mask);
+  __m128i hi             = _mm_and_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(p + 24)), tag_mask);
+  uint32_t l             = _mm_movemask_epi8(_mm_cmpeq_epi16(lo, t));
+  uint32_t h             = _mm_movemask_epi8(_mm_cmpeq_epi16(hi, t));
+  return ((l >> 4) & 1) | ((l >> 13) & 2) | ((h << 2) & 4) | ((h >> 7) & 8);
+#else
+  return dir_bucket_match_scalar(b, key);
+#endif
+}
+
+// Tag comparison for an entry in the chain of @a bucket, @a match is from dir_bucket_match.
+TS_INLINE bool
+dir_compare_tag(const Dir *e, const CacheKey *key, const Dir *bucket, uint32_t match)
+{
+  uintptr_t i = static_cast<uintptr_t>(reinterpret_cast<const char *>(e) - reinterpret_cast<const char *>(bucket)) / SIZEOF_DIR;
+  if (i < DIR_DEPTH) {
+    return (match >> i) & 1;
+  }
+  return dir_compare_tag(e, key);
+}
+
 TS_INLINE Dir *
 dir_from_offset(int64_t i, Dir *seg)
 {
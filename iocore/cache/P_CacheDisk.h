@@ -23,6 +23,9 @@
 
 #pragma once
 
+#include <atomic>
+#include <mutex>
+
 #include "I_Cache.h"
 
 extern int cache_config_max_disk_errors;
@@ -41,6 +44,19 @@ extern int cache_config_max_disk_errors;
 #define STORE_BLOCKS_PER_VOL (VOL_BLOCK_SIZE / STORE_BLOCK_SIZE)
 #define DISK_HEADER_MAGIC 0xABCD1237
 
+// I/O latency histogram buckets, the upper bounds are 1, 4, 16, 64 and 256ms, the last has no bound.
+#define CACHE_DISK_IO_LATENCY_BUCKETS 6
+
+// per disk I/O stats, see CacheDisk::io_read()
+enum {
+  cache_disk_io_reads_in_flight_stat,
+  cache_disk_io_writes_in_flight_stat,
+  cache_disk_io_writes_queued_stat,
+  cache_disk_io_read_latency_stat,
+  cache_disk_io_write_latency_stat = cache_disk_io_read_latency_stat + CACHE_DISK_IO_LATENCY_BUCKETS,
+  cache_disk_io_stat_count         = cache_disk_io_write_latency_stat + CACHE_DISK_IO_LATENCY_BUCKETS
+};
+
 /* each disk vol block has a corresponding Vol object */
 struct CacheDisk;
 
@@ -98,6 +114,19 @@ struct CacheDisk : public Continuation {
   bool read_only_p        = false;
   bool online             = true; /* flag marking cache disk online or offline (because of too many failures or by the operator). */
 
+  // Stripes on this disk being brought online, and those waiting for a slot (see proxy.config.cache.init.stripes_per_disk).
+  int vol_init_active = 0;
+  Queue<Continuation, Continuation::Link_link> vol_init_wait;
+
+  // Aggregation writes in flight from all the stripes on this disk.
+  std::atomic<int> agg_writes_in_flight{0};
+
+  // Stripe I/O scheduling, writes waiting for proxy.config.cache.io.max_writes_in_flight.
+  std::mutex io_mutex;
+  Que(AIOCallback, link) io_write_wait;
+  int io_writes_in_flight  = 0; // protected by io_mutex
+  RecRawStatBlock *io_rsb = nullptr;
+
   // Extra configuration values
   int forced_volume_num = -1;      ///< Volume number for this disk.
   ats_scoped_str hash_base_string; ///< Base string for hash seed.
@@ -120,4 +149,8 @@ struct CacheDisk : public Continuation {
   void update_header();
   DiskVol *get_diskvol(int vol_number);
   void incrErrors(const AIOCallback *io);
+  void io_read(AIOCallback *op);
+  void io_write(AIOCallback *op);
+  void io_read_done(AIOCallback *op);
+  void io_write_done(AIOCallback *op);
 };
@@ -178,6 +178,9 @@ struct ConfigVol {
   bool in_percent;
   bool ramcache_enabled;
   int percent;
+  int avg_obj_size;       // 0 for proxy.config.cache.min_average_object_size
+  int fragment_size;      // 0 for proxy.config.cache.target_fragment_size
+  int64_t ram_cache_size; // 0 for a share of proxy.config.cache.ram_cache.size
   CacheVol *cachep;
   LINK(ConfigVol, link);
 };
@@ -105,6 +105,8 @@ enum {
   cache_direntries_used_stat,
   cache_ram_cache_hits_stat,
   cache_ram_cache_misses_stat,
+  cache_ram_cache_admission_rejects_stat,
+  cache_ram_cache_lock_free_hits_stat,
   cache_pread_count_stat,
   cache_percent_full_stat,
   cache_lookup_active_stat,
@@ -145,6 +147,29 @@ enum {
   cache_directory_sync_count_stat,
   cache_directory_sync_time_stat,
   cache_directory_sync_bytes_stat,
+  cache_directory_sync_skipped_bytes_stat,
+  cache_directory_sync_last_bytes_stat,
+  cache_init_stripes_pending_stat,
+  cache_init_recovery_bytes_stat,
+  cache_read_lock_contention_stat,
+  cache_read_writer_fragment_hits_stat,
+  cache_scrub_evacuate_stat,
+  cache_hot_replica_objects_stat,
+  cache_hot_replica_reads_stat,
+  cache_hot_replica_retired_stat,
+  cache_hot_replica_writes_stat,
+  cache_surrogate_key_documents_stat,
+  cache_surrogate_key_invalidated_stat,
+  cache_surrogate_key_tags_stat,
+  cache_buffer_pool_reserved_bytes_stat,
+  cache_buffer_pool_hugepage_bytes_stat,
+  cache_buffer_pool_in_use_bytes_stat,
+  cache_buffer_pool_allocs_stat,
+  cache_buffer_pool_thread_cache_hits_stat,
+  cache_agg_write_size_64k_stat,
+  cache_agg_write_size_256k_stat,
+  cache_agg_write_size_1m_stat,
+  cache_agg_write_size_4m_stat,
   /* AIO read/write error counters */
   cache_span_errors_read_stat,
   cache_span_errors_write_stat,
@@ -162,8 +187,11 @@ extern RecRawStatBlock *cache_rsb;
 
 #define GLOBAL_CACHE_SET_DYN_STAT(x, y) RecSetGlobalRawStatSum(cache_rsb, (x), (y))
 
-#define CACHE_SET_DYN_STAT(x, y) \
-  RecSetGlobalRawStatSum(cache_rsb, (x), (y)) RecSetGlobalRawStatSum(vol->cache_vol->vol_rsb, (x), (y))
+#define CACHE_SET_DYN_STAT(x, y)                               \
+  do {                                                         \
+    RecSetGlobalRawStatSum(cache_rsb, (x), (y));               \
+    RecSetGlobalRawStatSum(vol->cache_vol->vol_rsb, (x), (y)); \
+  } while (0);
 
 #define CACHE_INCREMENT_DYN_STAT(x)                                              \
   do {                                                                           \
@@ -193,8 +221,11 @@ extern RecRawStatBlock *cache_rsb;
 
 #define GLOBAL_CACHE_SUM_GLOBAL_DYN_STAT(x, y) RecIncrGlobalRawStatSum(cache_rsb, (x), (y))
 
-#define CACHE_SUM_GLOBAL_DYN_STAT(x, y) \
-  RecIncrGlobalRawStatSum(cache_rsb, (x), (y)) RecIncrGlobalRawStatSum(vol->cache_vol->vol_rsb, (x), (y))
+#define CACHE_SUM_GLOBAL_DYN_STAT(x, y)                         \
+  do {                                                          \
+    RecIncrGlobalRawStatSum(cache_rsb, (x), (y));               \
+    RecIncrGlobalRawStatSum(vol->cache_vol->vol_rsb, (x), (y)); \
+  } while (0);
 
 #define CACHE_CLEAR_DYN_STAT(x)                          \
   do {                                                   \
@@ -209,9 +240,12 @@ extern int cache_config_dir_sync_frequency;
 extern int cache_config_http_max_alts;
 extern int cache_config_permit_pinning;
 extern int cache_config_select_alternate;
+extern int cache_config_key_hash;
 extern int cache_config_max_doc_size;
 extern int cache_config_min_average_object_size;
 extern int cache_config_agg_write_backlog;
+extern int cache_config_agg_write_in_flight;
+extern int cache_config_io_max_writes_in_flight;
 extern int cache_config_enable_checksum;
 extern int cache_config_alt_rewrite_max_size;
 extern int cache_config_read_while_writer;
@@ -219,13 +253,26 @@ extern int cache_config_agg_write_backlog;
 extern int cache_config_ram_cache_compress;
 extern int cache_config_ram_cache_compress_percent;
 extern int cache_config_ram_cache_use_seen_filter;
+extern int cache_config_ram_cache_lock_free_entries;
+extern int cache_config_ram_cache_persist_entries;
+extern int cache_config_ram_cache_persist_frequency;
+extern int cache_config_ram_cache_preload_rate;
 extern int cache_config_hit_evacuate_percent;
 extern int cache_config_hit_evacuate_size_limit;
+extern int cache_config_scrub_rate;
+extern int cache_config_scrub_heat_threshold;
+extern int cache_config_hot_replica_copies;
+extern int cache_config_hot_replica_threshold;
+extern char *cache_config_surrogate_key_header;
+extern int cache_config_buffer_pool_hugepages;
+extern int64_t cache_config_buffer_pool_thread_cache;
 extern int cache_config_force_sector_size;
 extern int cache_config_target_fragment_size;
 extern int cache_config_mutex_retry_delay;
+extern int cache_config_init_stripes_per_disk;
 extern int cache_read_while_writer_retry_delay;
 extern int cache_config_read_while_writer_max_retries;
+extern int cache_config_read_while_writer_fragment_ring;
 
 // CacheVC
 struct CacheVC : public CacheVConnection {
@@ -234,6 +281,7 @@ struct CacheVC : public CacheVConnection {
   VIO *do_io_read(Continuation *c, int64_t nbytes, MIOBuffer *buf) override;
   VIO *do_io_pread(Continuation *c, int64_t nbytes, MIOBuffer *buf, int64_t offset) override;
   VIO *do_io_write(Continuation *c, int64_t nbytes, IOBufferReader *buf, bool owner = false) override;
+  VIO *do_io_pwrite(Continuation *c, int64_t nbytes, IOBufferReader *buf, int64_t offset) override;
   void do_io_close(int lerrno = -1) override;
   void reenable(VIO *avio) override;
   void reenable_re(VIO *avio) override;
@@ -328,6 +376,9 @@ struct CacheVC : public CacheVConnection {
   int openReadChooseWriter(int event, Event *e);
   int openReadDirDelete(int event, Event *e);
 
+  int ramCachePreload(int event, Event *e);
+  int ramCachePreloadDone(int event, Event *e);
+
   int openWriteCloseDir(int event, Event *e);
   int openWriteCloseHeadDone(int event, Event *e);
   int openWriteCloseHead(int event, Event *e);
@@ -387,6 +438,9 @@ struct CacheVC : public CacheVConnection {
    */
   virtual uint32_t load_http_info(CacheHTTPInfoVector *info, struct Doc *doc, RefCountObj *block_ptr = nullptr);
   bool is_pread_capable() override;
+  int64_t get_cached_length(int64_t offset) override;
+  /// Record which fragments of a sparse alternate are in the directory, needs the stripe lock.
+  void load_sparse_map();
   bool set_pin_in_cache(time_t time_pin) override;
   time_t get_pin_in_cache() override;
 
@@ -499,6 +553,9 @@ struct CacheVC : public CacheVConnection {
       unsigned int hit_evacuate : 1;
       unsigned int compressed_in_ram : 1; // compressed state in ram cache
       unsigned int allow_empty_doc : 1;   // used for cache empty http document
+      unsigned int ram_lock_free : 1;     // head served from Vol::ram_cache_hot without the stripe mutex
+      unsigned int sparse : 1;            // alternate is a sparse object, fragments are read and written independently
+      unsigned int ram_cache_preload : 1; // reading a persisted hot document back into the RAM cache
     } f;
   };
   // BTF optimization used to skip reading stuff in cache partition that doesn't contain any
@@ -507,6 +564,8 @@ struct CacheVC : public CacheVConnection {
   // BTF fix to handle objects that overlapped over two different reads,
   // this is how much we need to back up the buffer to get the start of the overlapping object.
   off_t scan_fix_buffer_offset;
+  // Fragments of a sparse alternate present in the directory, one bit per fragment.
+  uint8_t *sparse_map;
   // end region C
 };
 
@@ -537,6 +596,16 @@ extern CacheSync *cacheDirSync;
 int cache_write(CacheVC *, CacheHTTPInfoVector *);
 int get_alternate_index(CacheHTTPInfoVector *cache_vector, CacheKey key);
 CacheVC *new_DocEvacuator(int nbytes, Vol *d);
+// hot document replication, see CacheReplica.cc
+void cache_replica_init();
+const CacheKey *cache_replica_select(const CacheKey *key, CacheKey *replica, CacheHTTPHdr *request,
+                                     const OverridableHttpConfigParams *params, const char *hostname, int host_len);
+void cache_replica_miss(const CacheKey *key, const CacheKey *replica);
+void cache_replica_retire(const CacheKey *key);
+// surrogate key index, see CacheSurrogateKey.cc
+void cache_surrogate_key_init();
+void cache_surrogate_key_insert(Vol *vol, const CacheKey *first_key, CacheHTTPInfo *info);
+int64_t cache_surrogate_key_invalidate(std::string_view tag);
 
 // inline Functions
 
@@ -586,6 +655,7 @@ free_CacheVC(CacheVC *cont)
   cont->io.mutex.clear();
   cont->io.aio_result       = 0;
   cont->io.aiocb.aio_nbytes = 0;
+  cont->io.submit_time      = 0;
   cont->request.reset();
   cont->vector.clear();
   cont->vio.buffer.clear();
@@ -606,6 +676,9 @@ free_CacheVC(CacheVC *cont)
   if (cont->scan_vol_map) {
     ats_free(cont->scan_vol_map);
   }
+  if (cont->sparse_map) {
+    ats_free(cont->sparse_map);
+  }
   memset((char *)&cont->vio, 0, cont->size_to_init);
 #ifdef CACHE_STAT_PAGES
   ink_assert(!cont->stat_link.next && !cont->stat_link.prev);
@@ -754,6 +827,20 @@ CacheVC::writer_done()
   return false;
 }
 
+TS_INLINE int
+Vol::average_object_size()
+{
+  return (cache_vol && cache_vol->avg_obj_size) ? cache_vol->avg_obj_size : cache_config_min_average_object_size;
+}
+
+TS_INLINE int
+Vol::target_fragment_size()
+{
+  int size = (cache_vol && cache_vol->fragment_size) ? cache_vol->fragment_size : cache_config_target_fragment_size;
+  ink_release_assert(size - sizeof(Doc) <= MAX_FRAG_SIZE);
+  return size - sizeof(Doc);
+}
+
 TS_INLINE int
 Vol::close_write(CacheVC *cont)
 {
@@ -987,6 +1074,7 @@ struct Cache {
                                 time_t pin_in_cache = (time_t)0, const char *hostname = nullptr, int host_len = 0);
   inkcoreapi Action *remove(Continuation *cont, const CacheKey *key, CacheFragType type = CACHE_FRAG_TYPE_HTTP,
                             const char *hostname = nullptr, int host_len = 0);
+  Action *remove_in_vol(Continuation *cont, const CacheKey *key, CacheFragType type, Vol *vol);
   Action *scan(Continuation *cont, const char *hostname = nullptr, int host_len = 0, int KB_per_second = 2500);
 
   Action *open_read(Continuation *cont, const CacheKey *key, CacheHTTPHdr *request, const OverridableHttpConfigParams *params,
@@ -23,7 +23,9 @@
 
 #pragma once
 
+#include <algorithm>
 #include <atomic>
+#include <vector>
 
 #define CACHE_BLOCK_SHIFT 9
 #define CACHE_BLOCK_SIZE (1 << CACHE_BLOCK_SHIFT) // 512, smallest sector size
@@ -34,10 +36,13 @@
 
 // Vol (volumes)
 #define VOL_MAGIC 0xF1D0F00D
+#define CACHE_KEY_HASH_DEFAULT 0 // MD5, or SHA256 with FIPS
+#define CACHE_KEY_HASH_SIPHASH 1
 #define START_BLOCKS 16 // 8k, STORE_BLOCK_SIZE
 #define START_POS ((off_t)START_BLOCKS * CACHE_BLOCK_SIZE)
 #define AGG_SIZE (4 * 1024 * 1024)     // 4MB
 #define AGG_HIGH_WATER (AGG_SIZE / 2)  // 2MB
+#define AGG_WRITES_MAX 8               // aggregation writes in flight per stripe
 #define EVACUATION_SIZE (2 * AGG_SIZE) // 8MB
 #define MAX_VOL_SIZE ((off_t)512 * 1024 * 1024 * 1024 * 1024)
 #define STORE_BLOCKS_PER_CACHE_BLOCK (STORE_BLOCK_SIZE / CACHE_BLOCK_SIZE)
@@ -45,6 +50,7 @@
 #define MAX_FRAG_SIZE (AGG_SIZE - sizeof(Doc)) // true max
 #define LEAVE_FREE DEFAULT_MAX_BUFFER_SIZE
 #define PIN_SCAN_EVERY 16 // scan every 1/16 of disk
+#define CACHE_SCRUB_TICKS_PER_SECOND 10
 #define VOL_HASH_TABLE_SIZE 32707
 #define VOL_HASH_EMPTY 0xFFFF
 #define VOL_HASH_ALLOC_SIZE (8 * 1024 * 1024) // one chance per this unit
@@ -88,7 +94,7 @@ struct VolHeaderFooter {
   uint32_t write_serial;
   uint32_t dirty;
   uint32_t sector_size;
-  uint32_t unused; // pad out to 8 byte boundary
+  uint32_t key_hash; // CACHE_KEY_HASH_* the keys were made with, 0 before 24.3
   uint16_t freelist[1];
 };
 
@@ -119,6 +125,19 @@ struct EvacuationBlock {
   LINK(EvacuationBlock, link);
 };
 
+// A write of part of the aggregation buffer. A stripe may have several of these in flight,
+// see proxy.config.cache.agg_write_in_flight.
+struct AggWriteIO : public Continuation {
+  Vol *vol        = nullptr;
+  uint32_t serial = 0;     // write serial of the documents in this write
+  bool done       = false; // on disk, but a write issued before it is not
+  AIOCallbackInternal io;
+
+  int handle_write_done(int event, void *data);
+
+  AggWriteIO() : Continuation(nullptr) { SET_HANDLER(&AggWriteIO::handle_write_done); }
+};
+
 struct Vol : public Continuation {
   char *path = nullptr;
   ats_scoped_str hash_text;
@@ -141,17 +160,32 @@ struct Vol : public Continuation {
   int hit_evacuate_window = 0;
   AIOCallbackInternal io;
 
+  // One entry per STORE_BLOCK_SIZE block of directory entries, bit N set if the block has changed
+  // since it was last written to directory copy N (A or B). Used by CacheSync to skip clean blocks.
+  std::vector<uint8_t> dir_dirty_blocks;
+
+  // Read heat of the stored documents when the scrubber is enabled, one saturating counter for each
+  // heat.size()th of the data. The scrubber decays it and evacuates hot documents ahead of the write.
+  std::vector<uint8_t> heat;
+  int scrub_pos         = 0; // next directory entry for the scrubber
+  off_t scrub_write_pos = 0; // header->write_pos at the last scrub
+
   Queue<CacheVC, Continuation::Link_link> agg;
   Queue<CacheVC, Continuation::Link_link> stat_cache_vcs;
   Queue<CacheVC, Continuation::Link_link> sync;
-  char *agg_buffer  = nullptr;
-  int agg_todo_size = 0;
-  int agg_buf_pos   = 0;
+  char *agg_buffer           = nullptr;
+  int agg_todo_size          = 0;
+  int agg_buf_pos            = 0;
+  int agg_buf_written        = 0; // bytes at the front of agg_buffer handed to the disk
+  int agg_writes_in_flight   = 0; // issued and not yet retired, see aggWriteDone
+  off_t agg_write_failed_pos = 0; // end of the last failed write while writes were in flight
+  AggWriteIO agg_io[AGG_WRITES_MAX];
 
   Event *trigger = nullptr;
 
   OpenDir open_dir;
   RamCache *ram_cache            = nullptr;
+  RamCacheHotIndex *ram_cache_hot = nullptr; // lock free lookups of hot documents, if enabled
   int evacuate_size              = 0;
   DLL<EvacuationBlock> *evacuate = nullptr;
   DLL<EvacuationBlock> lookaside[LOOKASIDE_SIZE];
@@ -169,6 +203,7 @@ struct Vol : public Continuation {
   bool dir_sync_waiting      = false;
   bool dir_sync_in_progress  = false;
   bool writing_end_marker    = false;
+  ink_hrtime init_start      = 0;
 
   CacheKey first_fragment_key;
   int64_t first_fragment_offset = 0;
@@ -206,10 +241,11 @@ struct Vol : public Continuation {
   int dir_check(bool fix);
   int db_check(bool fix);
 
+  // the stripe's own I/O or any aggregation write
   int
   is_io_in_progress()
   {
-    return io.aiocb.aio_fildes != AIO_NOT_IN_PROGRESS;
+    return io.aiocb.aio_fildes != AIO_NOT_IN_PROGRESS || agg_writes_in_flight;
   }
   int
   increment_generation()
@@ -227,8 +263,27 @@ struct Vol : public Continuation {
     io.aiocb.aio_fildes = AIO_NOT_IN_PROGRESS;
   }
 
-  int aggWriteDone(int event, Event *e);
+  int aggWriteDone(int event, AggWriteIO *w);
   int aggWrite(int event, void *e);
+  AggWriteIO *agg_write_slot();
+  AggWriteIO *agg_write_oldest();
+  int agg_write_size();
+
+  // write serial of the next aggregation write, and so of documents copied into the buffer now
+  uint32_t
+  agg_write_serial()
+  {
+    return header->write_serial + agg_writes_in_flight;
+  }
+
+  /* Whether aggWrite can run. Besides an idle stripe, this allows copying into the rest of the
+     buffer while earlier parts are written, as long as another write could be started.
+  */
+  bool
+  agg_write_ready()
+  {
+    return io.aiocb.aio_fildes == AIO_NOT_IN_PROGRESS && (!agg_writes_in_flight || agg_write_slot());
+  }
   void agg_wrap();
 
   int evacuateWrite(CacheVC *evacuator, int event, Event *e);
@@ -242,13 +297,21 @@ struct Vol : public Continuation {
   void evacuate_cleanup();
   EvacuationBlock *force_evacuate_head(Dir *dir, int pinned);
   int within_hit_evacuate_window(Dir *dir);
+  bool hit_evacuate(Dir *dir, uint64_t doc_len);
+  size_t heat_slot(off_t offset);
+  bool within_scrub_window(Dir *dir);
+  void scrub(int n);
   uint32_t round_to_approx_size(uint32_t l);
+  int average_object_size();  // directory sizing, per volume or proxy.config.cache.min_average_object_size
+  int target_fragment_size(); // write fragment payload, per volume or proxy.config.cache.target_fragment_size
 
   // inline functions
   int headerlen();         // calculates the total length of the vol header and the freelist
   int direntries();        // total number of dir entries
   Dir *dir_segment(int s); // returns the first dir in the segment s
   size_t dirlen();         // calculates the total length of header, directories and footer
+  void dir_mark_dirty(const Dir *e, size_t n = 1); // mark the blocks holding n dir entries from e as dirty
+  void dir_mark_all_dirty();                       // mark every directory block dirty in both copies
   int vol_out_of_phase_valid(Dir *e);
 
   int vol_out_of_phase_agg_valid(Dir *e);
@@ -266,10 +329,19 @@ struct Vol : public Continuation {
     open_dir.mutex = mutex;
     agg_buffer     = (char *)ats_memalign(ats_pagesize(), AGG_SIZE);
     memset(agg_buffer, 0, AGG_SIZE);
+    ink_aio_register_fixed_buffer(agg_buffer, AGG_SIZE);
+    for (auto &w : agg_io) {
+      w.vol   = this;
+      w.mutex = mutex;
+    }
     SET_HANDLER(&Vol::aggWrite);
   }
 
-  ~Vol() override { ats_memalign_free(agg_buffer); }
+  ~Vol() override
+  {
+    ink_aio_unregister_fixed_buffer(agg_buffer);
+    ats_memalign_free(agg_buffer);
+  }
 };
 
 struct AIO_Callback_handler : public Continuation {
@@ -289,6 +361,10 @@ struct CacheVol {
   LINK(CacheVol, link);
   // per volume stats
   RecRawStatBlock *vol_rsb = nullptr;
+  // size class tuning from volume.config, 0 uses the global setting
+  int avg_obj_size       = 0;
+  int fragment_size      = 0;
+  int64_t ram_cache_size = 0;
 
   CacheVol() {}
 };
@@ -328,6 +404,10 @@ struct Doc {
   char *data();
 };
 
+// Global Functions
+
+void cache_scrub_init();
+
 // Global Data
 
 extern Vol **gvol;
@@ -358,6 +438,24 @@ Vol::dirlen()
          ROUND_TO_STORE_BLOCK(sizeof(VolHeaderFooter));
 }
 
+TS_INLINE void
+Vol::dir_mark_dirty(const Dir *e, size_t n)
+{
+  size_t first = (reinterpret_cast<const char *>(e) - reinterpret_cast<const char *>(this->dir)) / STORE_BLOCK_SIZE;
+  size_t last  = (reinterpret_cast<const char *>(e) + n * SIZEOF_DIR - 1 - reinterpret_cast<const char *>(this->dir)) /
+                STORE_BLOCK_SIZE;
+  ink_assert(last < this->dir_dirty_blocks.size());
+  for (size_t i = first; i <= last; ++i) {
+    this->dir_dirty_blocks[i] = 0x3;
+  }
+}
+
+TS_INLINE void
+Vol::dir_mark_all_dirty()
+{
+  std::fill(this->dir_dirty_blocks.begin(), this->dir_dirty_blocks.end(), 0x3);
+}
+
 TS_INLINE int
 Vol::direntries()
 {
@@ -513,6 +611,29 @@ Vol::within_hit_evacuate_window(Dir *xdir)
     return -delta > (data_blocks - hit_evacuate_window) && -delta < data_blocks;
 }
 
+// Whether the document at dir will be overwritten within the next PIN_SCAN_EVERY-th of the stripe,
+// the same distance ahead of the write as scan_for_pinned_documents().
+TS_INLINE bool
+Vol::within_scrub_window(Dir *xdir)
+{
+  off_t blocks    = (skip + len - start) / CACHE_BLOCK_SIZE;
+  off_t write_off = (header->write_pos + AGG_SIZE - start) / CACHE_BLOCK_SIZE;
+  off_t delta     = dir_offset(xdir) - 1 - write_off;
+  if (delta < 0) {
+    delta += blocks;
+  }
+  return delta < (2 * EVACUATION_SIZE + len / PIN_SCAN_EVERY) / CACHE_BLOCK_SIZE;
+}
+
+// Slot in heat of the document at the directory offset.
+TS_INLINE size_t
+Vol::heat_slot(off_t offset)
+{
+  off_t blocks = (skip + len - start) / CACHE_BLOCK_SIZE;
+  size_t slot  = blocks > 0 ? (offset - 1) * static_cast<off_t>(heat.size()) / blocks : 0;
+  return slot < heat.size() ? slot : heat.size() - 1;
+}
+
 TS_INLINE uint32_t
 Vol::round_to_approx_size(uint32_t l)
 {
@@ -25,6 +25,15 @@
 
 #include "I_Cache.h"
 
+#include <atomic>
+#include <vector>
+
+// Identifies a RAM cache document, auxkey is the directory offset it was read from.
+struct RamCacheKey {
+  CryptoHash key;
+  uint64_t auxkey;
+};
+
 // Generic Ram Cache interface
 
 class RamCache
@@ -35,10 +44,59 @@ public:
   virtual int put(CryptoHash *key, IOBufferData *data, uint32_t len, bool copy = false, uint64_t auxkey = 0) = 0;
   virtual int fixup(const CryptoHash *key, uint64_t old_auxkey, uint64_t new_auxkey)                         = 0;
   virtual int64_t size() const                                                                               = 0;
+  // appends the keys of up to @a max documents, most valuable first
+  virtual void hot_keys(std::vector<RamCacheKey> &keys, int max) const = 0;
+
+  // put() for a document known to be hot, e.g. preloaded after a restart, bypassing any admission filter
+  virtual int
+  warm(CryptoHash *key, IOBufferData *data, uint32_t len, bool copy = false, uint64_t auxkey = 0)
+  {
+    return put(key, data, len, copy, auxkey);
+  }
 
   virtual void init(int64_t max_bytes, Vol *vol) = 0;
   virtual ~RamCache(){};
 };
 
+// Lock free index of hot documents, consulted before taking the stripe mutex.
+// Lookups may run on any thread; put() and remove() require the stripe mutex. Replaced entries
+// are freed after CACHE_MEM_FREE_TIMEOUT so a concurrent reader can still take a reference.
+class RamCacheHotIndex
+{
+public:
+  struct Entry {
+    CryptoHash key; // first key
+    Dir dir;
+    uint32_t cycle; // Vol header cycle when published
+    Ptr<IOBufferData> data;
+    // the whole alternate, if it is not in the first fragment
+    CryptoHash earliest_key;
+    Dir earliest_dir;
+    Ptr<IOBufferData> earliest_data;
+  };
+
+  explicit RamCacheHotIndex(int entries);
+  ~RamCacheHotIndex();
+
+  // returns true and a copy of the entry if @a key is present
+  bool get(const CryptoHash *key, Entry *ret) const;
+  void put(const Entry &entry);
+  void remove(const CryptoHash *key);
+
+private:
+  std::atomic<Entry *> *slots = nullptr;
+  uint32_t mask               = 0;
+
+  std::atomic<Entry *> &
+  slot(const CryptoHash *key) const
+  {
+    return slots[key->slice32(2) & mask];
+  }
+  void retire(Entry *e);
+};
+
 RamCache *new_RamCacheLRU();
 RamCache *new_RamCacheCLFUS();
+RamCache *new_RamCacheTinyLFU();
+
+void ram_cache_persist_init();
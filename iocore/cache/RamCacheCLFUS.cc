@@ -27,6 +27,8 @@
 #include "P_Cache.h"
 #include "I_Tasks.h"
 #include "tscore/fastlz.h"
+
+#include <algorithm>
 #ifdef HAVE_ZLIB_H
 #include <zlib.h>
 #endif
@@ -79,6 +81,8 @@ public:
   int put(CryptoHash *key, IOBufferData *data, uint32_t len, bool copy = false, uint64_t auxkey = 0) override;
   int fixup(const CryptoHash *key, uint64_t old_auxkey, uint64_t new_auxkey) override;
   int64_t size() const override;
+  void hot_keys(std::vector<RamCacheKey> &keys, int max) const override;
+  int warm(CryptoHash *key, IOBufferData *data, uint32_t len, bool copy = false, uint64_t auxkey = 0) override;
 
   void init(int64_t max_bytes, Vol *vol) override;
 
@@ -126,6 +130,23 @@ RamCacheCLFUS::size() const
   return s;
 }
 
+// resident entries by cache value, the history (lru[1]) holds no data
+void
+RamCacheCLFUS::hot_keys(std::vector<RamCacheKey> &keys, int max) const
+{
+  std::vector<RamCacheCLFUSEntry *> entries;
+  forl_LL(RamCacheCLFUSEntry, e, this->_lru[0])
+  {
+    entries.push_back(e);
+  }
+  auto n = std::min(entries.size(), static_cast<size_t>(std::max(max, 0)));
+  std::partial_sort(entries.begin(), entries.begin() + n, entries.end(),
+                    [](RamCacheCLFUSEntry *a, RamCacheCLFUSEntry *b) { return CACHE_VALUE(a) > CACHE_VALUE(b); });
+  for (size_t i = 0; i < n; ++i) {
+    keys.push_back({entries[i]->key, entries[i]->auxkey});
+  }
+}
+
 class RamCacheCLFUSCompressor : public Continuation
 {
 public:
@@ -240,9 +261,10 @@ RamCacheCLFUS::get(CryptoHash *key, Ptr<IOBufferData> *ret_data, uint64_t auxkey
   if (!this->_max_bytes) {
     return 0;
   }
-  int64_t i             = key->slice32(3) % this->_nbuckets;
-  RamCacheCLFUSEntry *e = this->_bucket[i].head;
-  char *b               = nullptr;
+  int64_t i              = key->slice32(3) % this->_nbuckets;
+  RamCacheCLFUSEntry *e  = this->_bucket[i].head;
+  IOBufferData *unzipped = nullptr;
+  char *b                = nullptr;
   while (e) {
     if (e->key == *key && e->auxkey == auxkey) {
       this->_move_compressed(e);
@@ -254,7 +276,9 @@ RamCacheCLFUS::get(CryptoHash *key, Ptr<IOBufferData> *ret_data, uint64_t auxkey
         e->hits++;
         uint32_t ram_hit_state = RAM_HIT_COMPRESS_NONE;
         if (e->flag_bits.compressed) {
-          b = static_cast<char *>(ats_malloc(e->len));
+          // Decompress straight into a disk buffer, the same as an uncompressed hit.
+          unzipped = new_IOBufferData(iobuffer_size_to_index(e->len, MAX_BUFFER_SIZE_INDEX), POOL_ALIGNED);
+          b        = unzipped->data();
           switch (e->flag_bits.compressed) {
           default:
             goto Lfailed;
@@ -290,8 +314,7 @@ RamCacheCLFUS::get(CryptoHash *key, Ptr<IOBufferData> *ret_data, uint64_t auxkey
           }
 #endif
           }
-          IOBufferData *data = new_xmalloc_IOBufferData(b, e->len);
-          data->_mem_type    = DEFAULT_ALLOC;
+          IOBufferData *data = unzipped;
           if (!e->flag_bits.copy) { // don't bother if we have to copy anyway
             int64_t delta = (static_cast<int64_t>(e->compressed_len)) - static_cast<int64_t>(e->size);
             this->_bytes += delta;
@@ -305,7 +328,7 @@ RamCacheCLFUS::get(CryptoHash *key, Ptr<IOBufferData> *ret_data, uint64_t auxkey
         } else {
           IOBufferData *data = e->data.get();
           if (e->flag_bits.copy) {
-            data = new_IOBufferData(iobuffer_size_to_index(e->len, MAX_BUFFER_SIZE_INDEX), MEMALIGNED);
+            data = new_IOBufferData(iobuffer_size_to_index(e->len, MAX_BUFFER_SIZE_INDEX), POOL_ALIGNED);
             ::memcpy(data->data(), e->data->data(), e->len);
           }
           (*ret_data) = data;
@@ -327,7 +350,7 @@ Lerror:
   CACHE_SUM_DYN_STAT_THREAD(cache_ram_cache_misses_stat, 1);
   return 0;
 Lfailed:
-  ats_free(b);
+  unzipped->free();
   this->_destroy(e);
   DDebug("ram_cache", "get %X %" PRId64 " Z_ERR", key->slice32(3), auxkey);
   goto Lerror;
@@ -748,6 +771,15 @@ Lhistory:
   return 0;
 }
 
+int
+RamCacheCLFUS::warm(CryptoHash *key, IOBufferData *data, uint32_t len, bool copy, uint64_t auxkey)
+{
+  if (this->_max_bytes && cache_config_ram_cache_use_seen_filter) {
+    this->_seen[key->slice32(3) % bucket_sizes[this->_ibuckets]] = key->slice32(3) >> 16;
+  }
+  return this->put(key, data, len, copy, auxkey);
+}
+
 int
 RamCacheCLFUS::fixup(const CryptoHash *key, uint64_t old_auxkey, uint64_t new_auxkey)
 {
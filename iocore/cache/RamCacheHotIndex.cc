@@ -0,0 +1,90 @@
+/** @file
+
+  Lock free index of hot RAM cache documents.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+// The index is a direct mapped table of atomic pointers to immutable entries.  Writers are
+// serialized by the stripe mutex, readers only load a slot and take a reference to the data.
+// An entry which is replaced or removed stays allocated for CACHE_MEM_FREE_TIMEOUT, which
+// is far longer than any reader holds the raw pointer, the same way the volume hash table
+// is reclaimed.
+
+#include "P_Cache.h"
+
+RamCacheHotIndex::RamCacheHotIndex(int entries)
+{
+  uint32_t n = 1;
+  while (n < static_cast<uint32_t>(entries)) {
+    n <<= 1;
+  }
+  mask  = n - 1;
+  slots = new std::atomic<Entry *>[n];
+  for (uint32_t i = 0; i < n; ++i) {
+    slots[i].store(nullptr, std::memory_order_relaxed);
+  }
+  Debug("ram_cache", "lock free index with %u entries", n);
+}
+
+RamCacheHotIndex::~RamCacheHotIndex()
+{
+  for (uint32_t i = 0; i <= mask; ++i) {
+    delete slots[i].load(std::memory_order_relaxed);
+  }
+  delete[] slots;
+}
+
+bool
+RamCacheHotIndex::get(const CryptoHash *key, Entry *ret) const
+{
+  Entry *e = slot(key).load(std::memory_order_acquire);
+  if (e && e->key == *key) {
+    *ret = *e;
+    return true;
+  }
+  return false;
+}
+
+void
+RamCacheHotIndex::put(const Entry &entry)
+{
+  retire(slot(&entry.key).exchange(new Entry(entry), std::memory_order_acq_rel));
+  DDebug("ram_cache", "lock free put %X", entry.key.slice32(3));
+}
+
+void
+RamCacheHotIndex::remove(const CryptoHash *key)
+{
+  std::atomic<Entry *> &s = slot(key);
+  Entry *e                = s.load(std::memory_order_relaxed);
+  if (e && e->key == *key) {
+    s.store(nullptr, std::memory_order_release);
+    retire(e);
+    DDebug("ram_cache", "lock free remove %X", key->slice32(3));
+  }
+}
+
+void
+RamCacheHotIndex::retire(Entry *e)
+{
+  if (e) {
+    new_Deleter(e, CACHE_MEM_FREE_TIMEOUT);
+  }
+}
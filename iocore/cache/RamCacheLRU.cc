@@ -43,6 +43,8 @@ struct RamCacheLRU : public RamCache {
   int put(CryptoHash *key, IOBufferData *data, uint32_t len, bool copy = false, uint64_t auxkey = 0) override;
   int fixup(const CryptoHash *key, uint64_t old_auxkey, uint64_t new_auxkey) override;
   int64_t size() const override;
+  void hot_keys(std::vector<RamCacheKey> &keys, int max) const override;
+  int warm(CryptoHash *key, IOBufferData *data, uint32_t len, bool copy = false, uint64_t auxkey = 0) override;
 
   void init(int64_t max_bytes, Vol *vol) override;
 
@@ -71,6 +73,14 @@ RamCacheLRU::size() const
   return s;
 }
 
+void
+RamCacheLRU::hot_keys(std::vector<RamCacheKey> &keys, int max) const
+{
+  for (RamCacheLRUEntry *e = lru.tail; e && max > 0; e = e->lru_link.prev, --max) {
+    keys.push_back({e->key, e->auxkey});
+  }
+}
+
 ClassAllocator<RamCacheLRUEntry> ramCacheLRUEntryAllocator("RamCacheLRUEntry");
 
 static const int bucket_sizes[] = {127,     251,      509,      1021,     2039,      4093,      8191,     16381,
@@ -212,6 +222,15 @@ RamCacheLRU::put(CryptoHash *key, IOBufferData *data, uint32_t len, bool, uint64
   return 1;
 }
 
+int
+RamCacheLRU::warm(CryptoHash *key, IOBufferData *data, uint32_t len, bool copy, uint64_t auxkey)
+{
+  if (max_bytes && cache_config_ram_cache_use_seen_filter) {
+    seen[key->slice32(3) % nbuckets] = key->slice32(3) >> 16;
+  }
+  return put(key, data, len, copy, auxkey);
+}
+
 int
 RamCacheLRU::fixup(const CryptoHash *key, uint64_t old_auxkey, uint64_t new_auxkey)
 {
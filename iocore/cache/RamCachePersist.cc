@@ -0,0 +1,321 @@
+/** @file
+
+  Persist the keys of the hottest RAM cache documents and preload them after a restart.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+// Every proxy.config.cache.ram_cache.persist_frequency seconds the keys of up to
+// proxy.config.cache.ram_cache.persist_entries documents per stripe are written to
+// RAM_CACHE_PERSIST_FILE in the runtime directory.  At startup the file is read and the
+// documents which are still in the directory are read back into the RAM cache, at most
+// proxy.config.cache.ram_cache.preload_rate per second.  Snapshots start once the preload
+// is finished so a restart during the preload does not lose the saved set.
+
+#include "P_Cache.h"
+#include "tscore/ink_file.h"
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#define RAM_CACHE_PERSIST_FILE "ram_cache.hot"
+#define RAM_CACHE_PERSIST_MAGIC 0x52414D48 // "RAMH"
+#define RAM_CACHE_PERSIST_VERSION 1
+#define RAM_CACHE_PERSIST_MAX_KEYS 1048576 // upper bound of proxy.config.cache.ram_cache.persist_entries
+#define RAM_CACHE_PRELOAD_TICK HRTIME_MSECONDS(100)
+#define RAM_CACHE_PRELOAD_TICKS_PER_SECOND 10
+
+// File layout: the header, then for each stripe a RamCachePersistStripe followed by its keys.
+struct RamCachePersistHeader {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t nstripes;
+  uint32_t unused;
+};
+
+struct RamCachePersistStripe {
+  CryptoHash hash_id; // Vol::hash_id
+  uint64_t nkeys;
+};
+
+static std::string
+ram_cache_persist_path()
+{
+  ats_scoped_str rundir(RecConfigReadRuntimeDir());
+  char path[PATH_NAME_MAX];
+  ink_filepath_make(path, sizeof(path), rundir, RAM_CACHE_PERSIST_FILE);
+  return path;
+}
+
+struct RamCacheSnapshot : public Continuation {
+  int vol_idx = 0;
+  std::vector<char> image;
+  uint32_t nstripes = 0;
+
+  int mainEvent(int event, Event *e);
+  void add_stripe(Vol *vol);
+  void write();
+
+  RamCacheSnapshot() : Continuation(new_ProxyMutex()) { SET_HANDLER(&RamCacheSnapshot::mainEvent); }
+};
+
+void
+RamCacheSnapshot::add_stripe(Vol *vol)
+{
+  std::vector<RamCacheKey> keys;
+  vol->ram_cache->hot_keys(keys, cache_config_ram_cache_persist_entries);
+
+  RamCachePersistStripe stripe = {vol->hash_id, keys.size()};
+  image.insert(image.end(), reinterpret_cast<char *>(&stripe), reinterpret_cast<char *>(&stripe + 1));
+  image.insert(image.end(), reinterpret_cast<char *>(keys.data()), reinterpret_cast<char *>(keys.data() + keys.size()));
+  ++nstripes;
+  Debug("ram_cache", "stripe %s: %zu keys", vol->hash_text.get(), keys.size());
+}
+
+// Blocking file I/O, this runs on ET_TASK.
+void
+RamCacheSnapshot::write()
+{
+  std::string path = ram_cache_persist_path();
+  std::string tmp  = path + ".tmp";
+
+  RamCachePersistHeader *header = reinterpret_cast<RamCachePersistHeader *>(image.data());
+  header->nstripes              = nstripes;
+
+  int fd = ::open(tmp.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  if (fd < 0) {
+    Warning("unable to create RAM cache snapshot '%s': %s", tmp.c_str(), strerror(errno));
+    return;
+  }
+  bool ok = ::write(fd, image.data(), image.size()) == static_cast<ssize_t>(image.size());
+  if (::close(fd) != 0 || !ok) {
+    Warning("unable to write RAM cache snapshot '%s': %s", tmp.c_str(), strerror(errno));
+    return;
+  }
+  if (::rename(tmp.c_str(), path.c_str()) != 0) {
+    Warning("unable to rename RAM cache snapshot '%s': %s", tmp.c_str(), strerror(errno));
+    return;
+  }
+  Debug("ram_cache", "wrote %zu bytes to %s", image.size(), path.c_str());
+}
+
+int
+RamCacheSnapshot::mainEvent(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+{
+  if (vol_idx == 0) {
+    RamCachePersistHeader header = {RAM_CACHE_PERSIST_MAGIC, RAM_CACHE_PERSIST_VERSION, 0, 0};
+    image.assign(reinterpret_cast<char *>(&header), reinterpret_cast<char *>(&header + 1));
+    nstripes = 0;
+  }
+  for (; vol_idx < gnvol; ++vol_idx) {
+    Vol *vol = gvol[vol_idx];
+    if (!vol->ram_cache) {
+      continue;
+    }
+    MUTEX_TRY_LOCK(lock, vol->mutex, this_ethread());
+    if (!lock.is_locked()) {
+      eventProcessor.schedule_in(this, HRTIME_MSECONDS(cache_config_mutex_retry_delay), ET_TASK);
+      return EVENT_CONT;
+    }
+    add_stripe(vol);
+  }
+  write();
+  vol_idx = 0;
+  image.clear();
+  image.shrink_to_fit();
+  eventProcessor.schedule_in(this, HRTIME_SECONDS(cache_config_ram_cache_persist_frequency), ET_TASK);
+  return EVENT_CONT;
+}
+
+struct RamCachePreloader : public Continuation {
+  struct Item {
+    Vol *vol;
+    RamCacheKey key;
+  };
+  std::vector<Item> items;
+  size_t next     = 0;
+  int in_flight   = 0;
+  int64_t loaded  = 0;
+  int64_t skipped = 0;
+  Event *trigger  = nullptr;
+
+  int startEvent(int event, Event *e);
+  int mainEvent(int event, void *data);
+  bool load();
+  void finish();
+
+  RamCachePreloader() : Continuation(new_ProxyMutex()) { SET_HANDLER(&RamCachePreloader::startEvent); }
+};
+
+// Blocking file I/O, this runs on ET_TASK.
+bool
+RamCachePreloader::load()
+{
+  std::string path = ram_cache_persist_path();
+  ats_scoped_fd fd(::open(path.c_str(), O_RDONLY));
+  if (fd < 0) {
+    Debug("ram_cache", "no RAM cache snapshot at %s", path.c_str());
+    return false;
+  }
+
+  RamCachePersistHeader header;
+  if (::read(fd, &header, sizeof(header)) != sizeof(header) || header.magic != RAM_CACHE_PERSIST_MAGIC ||
+      header.version != RAM_CACHE_PERSIST_VERSION) {
+    Warning("ignoring invalid RAM cache snapshot '%s'", path.c_str());
+    return false;
+  }
+  for (uint32_t i = 0; i < header.nstripes; ++i) {
+    RamCachePersistStripe stripe;
+    if (::read(fd, &stripe, sizeof(stripe)) != sizeof(stripe) || stripe.nkeys > RAM_CACHE_PERSIST_MAX_KEYS) {
+      Warning("invalid RAM cache snapshot '%s'", path.c_str());
+      break;
+    }
+    std::vector<RamCacheKey> keys(stripe.nkeys);
+    ssize_t len = stripe.nkeys * sizeof(RamCacheKey);
+    if (::read(fd, keys.data(), len) != len) {
+      Warning("truncated RAM cache snapshot '%s'", path.c_str());
+      break;
+    }
+    // stripes which are no longer configured are skipped
+    Vol *vol = nullptr;
+    for (int j = 0; j < gnvol; ++j) {
+      if (gvol[j]->hash_id == stripe.hash_id) {
+        vol = gvol[j];
+        break;
+      }
+    }
+    if (!vol || !vol->ram_cache) {
+      continue;
+    }
+    for (auto &key : keys) {
+      items.push_back({vol, key});
+    }
+  }
+  Note("preloading %zu documents into the RAM cache from '%s'", items.size(), path.c_str());
+  return !items.empty();
+}
+
+void
+RamCachePreloader::finish()
+{
+  if (!items.empty()) {
+    Note("RAM cache preload done, %" PRId64 " documents loaded, %" PRId64 " no longer in the cache", loaded, skipped);
+  }
+  eventProcessor.schedule_in(new RamCacheSnapshot, HRTIME_SECONDS(cache_config_ram_cache_persist_frequency), ET_TASK);
+  delete this;
+}
+
+int
+RamCachePreloader::startEvent(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+{
+  if (!load()) {
+    finish();
+    return EVENT_DONE;
+  }
+  SET_HANDLER(&RamCachePreloader::mainEvent);
+  trigger = eventProcessor.schedule_every(this, RAM_CACHE_PRELOAD_TICK, ET_CALL);
+  return EVENT_CONT;
+}
+
+int
+RamCachePreloader::mainEvent(int event, void * /* data ATS_UNUSED */)
+{
+  switch (event) {
+  case CACHE_EVENT_LOOKUP:
+    ++loaded;
+    --in_flight;
+    break;
+  case CACHE_EVENT_LOOKUP_FAILED:
+    ++skipped;
+    --in_flight;
+    break;
+  default: {
+    // a read may complete synchronously, so this is only checked on the timer
+    if (next == items.size() && !in_flight) {
+      trigger->cancel();
+      finish();
+      return EVENT_DONE;
+    }
+    // at most one tick's worth of reads outstanding
+    int batch = std::max(cache_config_ram_cache_preload_rate / RAM_CACHE_PRELOAD_TICKS_PER_SECOND, 1);
+    while (next < items.size() && in_flight < batch) {
+      Item &item = items[next++];
+      CacheVC *c = new_CacheVC(this);
+      SET_CONTINUATION_HANDLER(c, &CacheVC::ramCachePreload);
+      c->vio.op              = VIO::READ;
+      c->vol                 = item.vol;
+      c->key                 = item.key.key;
+      c->f.ram_cache_preload = 1;
+      dir_set_offset(&c->dir, item.key.auxkey);
+      ++in_flight;
+      c->handleEvent(EVENT_IMMEDIATE, nullptr);
+    }
+    break;
+  }
+  }
+  return EVENT_CONT;
+}
+
+void
+ram_cache_persist_init()
+{
+  eventProcessor.schedule_imm(new RamCachePreloader, ET_TASK);
+}
+
+// The directory offset the document had when the snapshot was taken is in dir.  A document
+// which was rewritten or evacuated since is skipped, traffic will bring the new copy in if
+// it is still hot.
+int
+CacheVC::ramCachePreload(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+{
+  cancel_trigger();
+  int64_t offset = dir_offset(&dir);
+  {
+    CACHE_TRY_LOCK(lock, vol->mutex, mutex->thread_holding);
+    if (!lock.is_locked()) {
+      VC_SCHED_LOCK_RETRY();
+    }
+    last_collision = nullptr;
+    while (dir_probe(&key, vol, &dir, &last_collision)) {
+      if (dir_offset(&dir) == offset) {
+        SET_HANDLER(&CacheVC::ramCachePreloadDone);
+        if (do_read_call(&key) == EVENT_RETURN) {
+          goto Lcallreturn;
+        }
+        return EVENT_CONT;
+      }
+    }
+  }
+  _action.continuation->handleEvent(CACHE_EVENT_LOOKUP_FAILED, nullptr);
+  vol = nullptr; // not counted as a lookup
+  return free_CacheVC(this);
+Lcallreturn:
+  return handleEvent(AIO_EVENT_DONE, nullptr);
+}
+
+int
+CacheVC::ramCachePreloadDone(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+{
+  cancel_trigger();
+  // handleReadDone() put the document into the RAM cache if it was intact
+  _action.continuation->handleEvent(f.not_from_ram_cache || f.doc_from_ram_cache ? CACHE_EVENT_LOOKUP : CACHE_EVENT_LOOKUP_FAILED,
+                                    nullptr);
+  vol = nullptr; // not counted as a lookup
+  return free_CacheVC(this);
+}
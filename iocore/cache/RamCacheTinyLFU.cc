@@ -0,0 +1,450 @@
+/** @file
+
+  W-TinyLFU RAM cache.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+// New objects enter a small LRU window.  Objects pushed out of the window are only
+// admitted to the main segmented LRU (probation + protected) if their estimated access
+// frequency is higher than that of the object they would displace.  Frequencies are
+// estimated with a count-min sketch of 4 bit counters which is periodically halved so
+// that old popularity decays.  See Einziger, Friedman, Manes: "TinyLFU: A Highly
+// Efficient Cache Admission Policy".
+
+#include "P_Cache.h"
+
+#define ENTRY_OVERHEAD 128       // per-entry overhead to consider when computing sizes
+#define WINDOW_PERCENT 1         // percent of bytes used for the admission window
+#define PROTECTED_PERCENT 80     // percent of the main segment reserved for the protected LRU
+#define SKETCH_DEPTH 4           // number of count-min sketch rows
+#define SKETCH_MIN_WIDTH 1024    // minimum counters per sketch row
+#define SKETCH_SAMPLE_FACTOR 10  // halve the sketch after (width * factor) increments
+#define SKETCH_RESET_MASK 0x7777777777777777ULL
+
+enum RamCacheTinyLFUSegment : uint8_t {
+  TINYLFU_WINDOW,
+  TINYLFU_PROBATION,
+  TINYLFU_PROTECTED,
+};
+
+struct RamCacheTinyLFUEntry {
+  CryptoHash key;
+  uint64_t auxkey;
+  uint32_t size; // bytes charged against the cache, including ENTRY_OVERHEAD
+  RamCacheTinyLFUSegment segment;
+  LINK(RamCacheTinyLFUEntry, lru_link);
+  LINK(RamCacheTinyLFUEntry, hash_link);
+  Ptr<IOBufferData> data;
+};
+
+struct RamCacheTinyLFU : public RamCache {
+  int64_t max_bytes = 0;
+  int64_t bytes     = 0;
+  int64_t objects   = 0;
+
+  // returns 1 on found/stored, 0 on not found/stored, if provided auxkey must match
+  int get(CryptoHash *key, Ptr<IOBufferData> *ret_data, uint64_t auxkey = 0) override;
+  int put(CryptoHash *key, IOBufferData *data, uint32_t len, bool copy = false, uint64_t auxkey = 0) override;
+  int warm(CryptoHash *key, IOBufferData *data, uint32_t len, bool copy = false, uint64_t auxkey = 0) override;
+  int fixup(const CryptoHash *key, uint64_t old_auxkey, uint64_t new_auxkey) override;
+  int64_t size() const override;
+  void hot_keys(std::vector<RamCacheKey> &keys, int max) const override;
+
+  void init(int64_t max_bytes, Vol *vol) override;
+
+  ~RamCacheTinyLFU() override;
+
+  // private
+  Que(RamCacheTinyLFUEntry, lru_link) lru[3]; // indexed by RamCacheTinyLFUSegment
+  int64_t segment_bytes[3] = {0, 0, 0};
+  int64_t window_max       = 0;
+  int64_t protected_max    = 0;
+  DList(RamCacheTinyLFUEntry, hash_link) *bucket = nullptr;
+  int nbuckets                                   = 0;
+  int ibuckets                                   = 0;
+  Vol *vol                                       = nullptr;
+
+  // count-min sketch, SKETCH_DEPTH rows of sketch_width 4 bit counters packed 16 per word
+  uint64_t *sketch      = nullptr;
+  uint32_t sketch_width = 0; // power of 2
+  int64_t sketch_adds   = 0;
+
+  void resize_hashtable();
+  void touch(RamCacheTinyLFUEntry *e);
+  void admit(RamCacheTinyLFUEntry *candidate);
+  void move(RamCacheTinyLFUEntry *e, RamCacheTinyLFUSegment segment);
+  RamCacheTinyLFUEntry *victim();
+  RamCacheTinyLFUEntry *remove(RamCacheTinyLFUEntry *e);
+  RamCacheTinyLFUEntry *find(CryptoHash *key, uint64_t auxkey);
+  RamCacheTinyLFUEntry *insert(CryptoHash *key, IOBufferData *data, uint64_t auxkey, RamCacheTinyLFUSegment segment);
+
+  uint32_t sketch_index(const CryptoHash *key, int row) const;
+  void sketch_increment(const CryptoHash *key);
+  int sketch_frequency(const CryptoHash *key) const;
+};
+
+int64_t
+RamCacheTinyLFU::size() const
+{
+  int64_t s = 0;
+  for (const auto &q : lru) {
+    forl_LL(RamCacheTinyLFUEntry, e, q)
+    {
+      s += sizeof(*e);
+      s += sizeof(*e->data);
+      s += e->data->block_size();
+    }
+  }
+  return s;
+}
+
+// protected, then probation, then the window, most recently used first
+void
+RamCacheTinyLFU::hot_keys(std::vector<RamCacheKey> &keys, int max) const
+{
+  for (auto segment : {TINYLFU_PROTECTED, TINYLFU_PROBATION, TINYLFU_WINDOW}) {
+    for (RamCacheTinyLFUEntry *e = lru[segment].tail; e && max > 0; e = e->lru_link.prev, --max) {
+      keys.push_back({e->key, e->auxkey});
+    }
+  }
+}
+
+ClassAllocator<RamCacheTinyLFUEntry> ramCacheTinyLFUEntryAllocator("RamCacheTinyLFUEntry");
+
+static const int bucket_sizes[] = {127,     251,      509,      1021,     2039,      4093,      8191,     16381,
+                                   32749,   65521,    131071,   262139,   524287,    1048573,   2097143,  4194301,
+                                   8388593, 16777213, 33554393, 67108859, 134217689, 268435399, 536870909};
+
+void
+RamCacheTinyLFU::resize_hashtable()
+{
+  int anbuckets = bucket_sizes[ibuckets];
+  DDebug("ram_cache", "resize hashtable %d", anbuckets);
+  int64_t s                                          = anbuckets * sizeof(DList(RamCacheTinyLFUEntry, hash_link));
+  DList(RamCacheTinyLFUEntry, hash_link) *new_bucket = static_cast<DList(RamCacheTinyLFUEntry, hash_link) *>(ats_malloc(s));
+  memset(static_cast<void *>(new_bucket), 0, s);
+  if (bucket) {
+    for (int64_t i = 0; i < nbuckets; i++) {
+      RamCacheTinyLFUEntry *e = nullptr;
+      while ((e = bucket[i].pop())) {
+        new_bucket[e->key.slice32(3) % anbuckets].push(e);
+      }
+    }
+    ats_free(bucket);
+  }
+  bucket   = new_bucket;
+  nbuckets = anbuckets;
+}
+
+void
+RamCacheTinyLFU::init(int64_t abytes, Vol *avol)
+{
+  vol       = avol;
+  max_bytes = abytes;
+  DDebug("ram_cache", "initializing ram_cache %" PRId64 " bytes", abytes);
+  if (!max_bytes) {
+    return;
+  }
+  window_max    = max_bytes * WINDOW_PERCENT / 100;
+  protected_max = (max_bytes - window_max) * PROTECTED_PERCENT / 100;
+
+  // One counter per expected object, assuming objects of the configured average size.
+  int64_t expected = max_bytes / std::max(vol->average_object_size(), 1);
+  sketch_width     = SKETCH_MIN_WIDTH;
+  while (sketch_width < expected && sketch_width < (1U << 30)) {
+    sketch_width <<= 1;
+  }
+  size_t s = SKETCH_DEPTH * (sketch_width / 16) * sizeof(uint64_t);
+  sketch   = static_cast<uint64_t *>(ats_malloc(s));
+  memset(sketch, 0, s);
+  DDebug("ram_cache", "sketch width %u window %" PRId64 " protected %" PRId64, sketch_width, window_max, protected_max);
+
+  resize_hashtable();
+}
+
+RamCacheTinyLFU::~RamCacheTinyLFU()
+{
+  ats_free(sketch);
+  ats_free(bucket);
+}
+
+// The key is already a cryptographic hash so its halves can be combined directly.
+uint32_t
+RamCacheTinyLFU::sketch_index(const CryptoHash *key, int row) const
+{
+  uint64_t h = key->u64[0] + static_cast<uint64_t>(row) * (key->u64[1] | 1);
+  return row * sketch_width + static_cast<uint32_t>((h ^ (h >> 32)) & (sketch_width - 1));
+}
+
+int
+RamCacheTinyLFU::sketch_frequency(const CryptoHash *key) const
+{
+  int freq = 15;
+  for (int row = 0; row < SKETCH_DEPTH; ++row) {
+    uint32_t i = sketch_index(key, row);
+    freq       = std::min(freq, static_cast<int>((sketch[i >> 4] >> ((i & 15) << 2)) & 0xF));
+  }
+  return freq;
+}
+
+// Conservative update: only the counters holding the current minimum are bumped.
+void
+RamCacheTinyLFU::sketch_increment(const CryptoHash *key)
+{
+  int freq = sketch_frequency(key);
+  if (freq >= 15) {
+    return;
+  }
+  for (int row = 0; row < SKETCH_DEPTH; ++row) {
+    uint32_t i = sketch_index(key, row);
+    int shift  = (i & 15) << 2;
+    if (static_cast<int>((sketch[i >> 4] >> shift) & 0xF) == freq) {
+      sketch[i >> 4] += 1ULL << shift;
+    }
+  }
+  if (++sketch_adds >= static_cast<int64_t>(sketch_width) * SKETCH_SAMPLE_FACTOR) {
+    // age: halve every counter
+    for (size_t w = 0, n = SKETCH_DEPTH * (sketch_width / 16); w < n; ++w) {
+      sketch[w] = (sketch[w] >> 1) & SKETCH_RESET_MASK;
+    }
+    sketch_adds /= 2;
+    DDebug("ram_cache", "sketch reset");
+  }
+}
+
+void
+RamCacheTinyLFU::move(RamCacheTinyLFUEntry *e, RamCacheTinyLFUSegment segment)
+{
+  lru[e->segment].remove(e);
+  segment_bytes[e->segment] -= e->size;
+  e->segment = segment;
+  lru[segment].enqueue(e);
+  segment_bytes[segment] += e->size;
+}
+
+void
+RamCacheTinyLFU::touch(RamCacheTinyLFUEntry *e)
+{
+  if (e->segment == TINYLFU_PROBATION) {
+    move(e, TINYLFU_PROTECTED);
+    // demote the least recently used protected entries back to probation
+    while (segment_bytes[TINYLFU_PROTECTED] > protected_max) {
+      move(lru[TINYLFU_PROTECTED].head, TINYLFU_PROBATION);
+    }
+  } else {
+    move(e, e->segment);
+  }
+}
+
+RamCacheTinyLFUEntry *
+RamCacheTinyLFU::victim()
+{
+  if (lru[TINYLFU_PROBATION].head) {
+    return lru[TINYLFU_PROBATION].head;
+  }
+  return lru[TINYLFU_PROTECTED].head;
+}
+
+// Move an entry out of the window, into probation if it is more popular than the entries it displaces.
+void
+RamCacheTinyLFU::admit(RamCacheTinyLFUEntry *candidate)
+{
+  int freq = sketch_frequency(&candidate->key);
+  while (bytes > max_bytes) {
+    RamCacheTinyLFUEntry *v = victim();
+    if (!v) {
+      break;
+    }
+    if (freq <= sketch_frequency(&v->key)) {
+      DDebug("ram_cache", "put %X %" PRIu64 " REJECTED", candidate->key.slice32(3), candidate->auxkey);
+      CACHE_SUM_DYN_STAT_THREAD(cache_ram_cache_admission_rejects_stat, 1);
+      remove(candidate);
+      return;
+    }
+    remove(v);
+  }
+  move(candidate, TINYLFU_PROBATION);
+}
+
+int
+RamCacheTinyLFU::get(CryptoHash *key, Ptr<IOBufferData> *ret_data, uint64_t auxkey)
+{
+  if (!max_bytes) {
+    return 0;
+  }
+  sketch_increment(key);
+  uint32_t i              = key->slice32(3) % nbuckets;
+  RamCacheTinyLFUEntry *e = bucket[i].head;
+  while (e) {
+    if (e->key == *key && e->auxkey == auxkey) {
+      touch(e);
+      (*ret_data) = e->data;
+      DDebug("ram_cache", "get %X %" PRIu64 " HIT", key->slice32(3), auxkey);
+      CACHE_SUM_DYN_STAT_THREAD(cache_ram_cache_hits_stat, 1);
+      return 1;
+    }
+    e = e->hash_link.next;
+  }
+  DDebug("ram_cache", "get %X %" PRIu64 " MISS", key->slice32(3), auxkey);
+  CACHE_SUM_DYN_STAT_THREAD(cache_ram_cache_misses_stat, 1);
+  return 0;
+}
+
+RamCacheTinyLFUEntry *
+RamCacheTinyLFU::remove(RamCacheTinyLFUEntry *e)
+{
+  RamCacheTinyLFUEntry *ret = e->hash_link.next;
+  uint32_t b                = e->key.slice32(3) % nbuckets;
+  bucket[b].remove(e);
+  lru[e->segment].remove(e);
+  segment_bytes[e->segment] -= e->size;
+  bytes -= e->size;
+  CACHE_SUM_DYN_STAT_THREAD(cache_ram_cache_bytes_stat, -static_cast<int64_t>(e->size));
+  DDebug("ram_cache", "put %X %" PRIu64 " FREED", e->key.slice32(3), e->auxkey);
+  e->data = nullptr;
+  THREAD_FREE(e, ramCacheTinyLFUEntryAllocator, this_thread());
+  objects--;
+  return ret;
+}
+
+// returns the entry for @a key, discarding any with a conflicting auxkey
+RamCacheTinyLFUEntry *
+RamCacheTinyLFU::find(CryptoHash *key, uint64_t auxkey)
+{
+  RamCacheTinyLFUEntry *e = bucket[key->slice32(3) % nbuckets].head;
+  while (e) {
+    if (e->key == *key) {
+      if (e->auxkey == auxkey) {
+        return e;
+      } else { // discard when aux keys conflict
+        e = remove(e);
+        continue;
+      }
+    }
+    e = e->hash_link.next;
+  }
+  return nullptr;
+}
+
+RamCacheTinyLFUEntry *
+RamCacheTinyLFU::insert(CryptoHash *key, IOBufferData *data, uint64_t auxkey, RamCacheTinyLFUSegment segment)
+{
+  RamCacheTinyLFUEntry *e = THREAD_ALLOC(ramCacheTinyLFUEntryAllocator, this_ethread());
+  e->key                  = *key;
+  e->auxkey               = auxkey;
+  e->data                 = data;
+  e->size                 = ENTRY_OVERHEAD + data->block_size();
+  e->segment              = segment;
+  bucket[key->slice32(3) % nbuckets].push(e);
+  segment_bytes[segment] += e->size;
+  bytes += e->size;
+  objects++;
+  CACHE_SUM_DYN_STAT_THREAD(cache_ram_cache_bytes_stat, e->size);
+  DDebug("ram_cache", "put %X %" PRIu64 " INSERTED", key->slice32(3), auxkey);
+  return e;
+}
+
+// ignore 'copy' since we don't touch the data
+int
+RamCacheTinyLFU::put(CryptoHash *key, IOBufferData *data, uint32_t len, bool, uint64_t auxkey)
+{
+  if (!max_bytes) {
+    return 0;
+  }
+  RamCacheTinyLFUEntry *e = find(key, auxkey);
+  if (e) {
+    touch(e);
+    return 1;
+  }
+  e = insert(key, data, auxkey, TINYLFU_WINDOW);
+  lru[TINYLFU_WINDOW].enqueue(e);
+  while (segment_bytes[TINYLFU_WINDOW] > window_max) {
+    admit(lru[TINYLFU_WINDOW].head);
+  }
+  // the main segment may be empty if the window holds everything
+  while (bytes > max_bytes) {
+    RamCacheTinyLFUEntry *ee = victim();
+    if (!ee) {
+      ee = lru[TINYLFU_WINDOW].head;
+    }
+    if (ee) {
+      remove(ee);
+    } else {
+      break;
+    }
+  }
+  if (objects > nbuckets) {
+    ++ibuckets;
+    resize_hashtable();
+  }
+  return 1;
+}
+
+// A preloaded document has already proven to be hot, so it skips the window and the admission test
+// and goes straight to probation, counted once in the sketch.  Documents are preloaded most valuable
+// first, so each is queued behind the ones before it and none is evicted to make room.
+int
+RamCacheTinyLFU::warm(CryptoHash *key, IOBufferData *data, uint32_t len, bool, uint64_t auxkey)
+{
+  if (!max_bytes) {
+    return 0;
+  }
+  RamCacheTinyLFUEntry *e = find(key, auxkey);
+  if (e) {
+    touch(e);
+    return 1;
+  }
+  if (bytes + ENTRY_OVERHEAD + static_cast<int64_t>(data->block_size()) > max_bytes) {
+    DDebug("ram_cache", "warm %X %" PRIu64 " FULL", key->slice32(3), auxkey);
+    return 0;
+  }
+  sketch_increment(key);
+  e = insert(key, data, auxkey, TINYLFU_PROBATION);
+  lru[TINYLFU_PROBATION].push(e);
+  if (objects > nbuckets) {
+    ++ibuckets;
+    resize_hashtable();
+  }
+  return 1;
+}
+
+int
+RamCacheTinyLFU::fixup(const CryptoHash *key, uint64_t old_auxkey, uint64_t new_auxkey)
+{
+  if (!max_bytes) {
+    return 0;
+  }
+  uint32_t i              = key->slice32(3) % nbuckets;
+  RamCacheTinyLFUEntry *e = bucket[i].head;
+  while (e) {
+    if (e->key == *key && e->auxkey == old_auxkey) {
+      e->auxkey = new_auxkey;
+      return 1;
+    }
+    e = e->hash_link.next;
+  }
+  return 0;
+}
+
+RamCache *
+new_RamCacheTinyLFU()
+{
+  return new RamCacheTinyLFU;
+}
@@ -0,0 +1,628 @@
+/** @file
+
+  Cache throughput benchmark.
+
+  Drives a mix of cache operations from many virtual clients against file backed spans and reports
+  the rate and latency of each operation. It runs the cache core without a proxy or an origin, so
+  changes to the cache can be measured on their own. For example
+
+    cache_bench --spans 2 --span_size 1024 --clients 256 --seconds 30 --mix lookup=20,read=60,write=20
+
+  Records can be set from the environment as usual, e.g. PROXY_CONFIG_CACHE_RAM_CACHE_SIZE=0.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cinttypes>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "tscore/ink_args.h"
+#include "tscore/I_Layout.h"
+#include "tscore/I_Version.h"
+#include "tscore/Diags.h"
+#include "tscore/CryptoHash.h"
+
+#include "RecordsConfig.h"
+#include "records/I_RecProcess.h"
+#include "P_AIO.h"
+#include "P_Net.h"
+#include "P_Cache.h"
+#include "StatPages.h"
+
+namespace
+{
+enum BenchOp { OP_LOOKUP, OP_READ, OP_WRITE, OP_UPDATE, OP_ALTERNATE, OP_RWW, N_OPS };
+
+const char *const OP_NAMES[N_OPS] = {"lookup", "read", "write", "update", "alternate", "rww"};
+
+// Command line.
+int n_spans          = 1;
+int span_size        = 256; // MB
+int n_clients        = 64;
+int n_threads        = 4;
+int n_seconds        = 10;
+int n_objects        = 10000;
+int object_size      = 16 * 1024;
+int rww_size         = 2 * 1024 * 1024;
+int n_alternates     = 3;
+int no_preload       = 0;
+int seed             = 1;
+char bench_dir[1024] = "./cache_bench";
+char mix_spec[1024]  = "lookup=20,read=50,write=10,update=10,alternate=5,rww=5";
+char debug_tags[1024];
+
+const ArgumentDescription argument_descriptions[] = {
+  {"dir", 'd', "Directory for the span files", "S1023", bench_dir, nullptr, nullptr},
+  {"spans", 's', "Number of spans", "I", &n_spans, nullptr, nullptr},
+  {"span_size", 'z', "Size of each span in MB", "I", &span_size, nullptr, nullptr},
+  {"clients", 'c', "Number of concurrent virtual clients", "I", &n_clients, nullptr, nullptr},
+  {"threads", 't', "Number of event threads", "I", &n_threads, nullptr, nullptr},
+  {"seconds", 'n', "Length of the measured run", "I", &n_seconds, nullptr, nullptr},
+  {"objects", 'o', "Number of distinct objects", "I", &n_objects, nullptr, nullptr},
+  {"object_size", 'b', "Size of the objects in bytes", "I", &object_size, nullptr, nullptr},
+  {"rww_size", 'r', "Size of the objects read while written in bytes", "I", &rww_size, nullptr, nullptr},
+  {"alternates", 'a', "Number of alternates of each object", "I", &n_alternates, nullptr, nullptr},
+  {"mix", 'm', "Weight of each operation, e.g. lookup=20,read=50", "S1023", mix_spec, nullptr, nullptr},
+  {"no_preload", 'N', "Do not write the objects before the run", "F", &no_preload, nullptr, nullptr},
+  {"seed", 'S', "Random seed", "I", &seed, nullptr, nullptr},
+  {"debug_tags", 'T', "Colon separated debug tags", "S1023", debug_tags, nullptr, nullptr},
+  HELP_ARGUMENT_DESCRIPTION(),
+  VERSION_ARGUMENT_DESCRIPTION(),
+};
+
+AppVersionInfo appVersionInfo;
+std::array<int, N_OPS> mix;
+std::vector<HttpCacheKey> object_keys;
+char *object_data;
+
+// Run control, set by the main thread.
+std::atomic<int> clients_done{0};
+ink_hrtime deadline = 0;
+
+const char BENCH_HOST[] = "bench.example.com";
+
+void
+make_key(HttpCacheKey &key, std::string const &url)
+{
+  CryptoContext().hash_immediate(key.hash, url.data(), url.size());
+  key.hostname = BENCH_HOST;
+  key.hostlen  = sizeof(BENCH_HOST) - 1;
+}
+
+void
+parse_hdr(HTTPHdr &hdr, HTTPType type, std::string const &text)
+{
+  HTTPParser parser;
+  const char *start = text.data();
+
+  http_parser_init(&parser);
+  hdr.create(type);
+  if (type == HTTP_TYPE_REQUEST) {
+    ink_release_assert(hdr.parse_req(&parser, &start, text.data() + text.size(), true) == PARSE_RESULT_DONE);
+  } else {
+    ink_release_assert(hdr.parse_resp(&parser, &start, text.data() + text.size(), true) == PARSE_RESULT_DONE);
+  }
+  http_parser_clear(&parser);
+}
+
+/// Alternate @a variant of the objects, which differ by media type.
+void
+build_info(HTTPInfo &info, int variant)
+{
+  std::string type = "application/x-bench-" + std::to_string(variant);
+  HTTPHdr req, resp;
+
+  parse_hdr(req, HTTP_TYPE_REQUEST,
+            "GET http://" + std::string(BENCH_HOST) + "/object HTTP/1.1\r\nAccept: " + type + "\r\nAccept-Encoding: gzip\r\n\r\n");
+  parse_hdr(resp, HTTP_TYPE_RESPONSE,
+            "HTTP/1.1 200 OK\r\nContent-Type: " + type +
+              "\r\nCache-Control: max-age=86400\r\nLast-Modified: Thu, 14 Mar 2019 08:47:40 GMT\r\nVary: Accept\r\n\r\n");
+  info.create();
+  info.request_set(&req);
+  info.response_set(&resp);
+  req.destroy();
+  resp.destroy();
+}
+
+/// Latency samples and outcomes of one operation.
+struct OpStats {
+  std::vector<uint32_t> usecs;
+  uint64_t misses   = 0;
+  uint64_t failures = 0;
+
+  void
+  merge(OpStats const &that)
+  {
+    usecs.insert(usecs.end(), that.usecs.begin(), that.usecs.end());
+    misses += that.misses;
+    failures += that.failures;
+  }
+};
+
+/** A virtual client, which runs one operation at a time until the end of the run.
+
+    Lookups and reads pick an object and an alternate at random. Writes store the first alternate
+    of an object and alternates one of the others, both as a new alternate. Updates read the object
+    and replace its header, as after a revalidation. RWW writes a new object and reads it while the
+    write is in progress.
+ */
+class BenchClient : public Continuation
+{
+public:
+  BenchClient(int id) : Continuation(new_ProxyMutex()), _id(id), _rng(seed * 7919 + id)
+  {
+    _infos.reset(new HTTPInfo[n_alternates]);
+    for (int i = 0; i < n_alternates; ++i) {
+      build_info(_infos[i], i);
+    }
+    SET_HANDLER(&BenchClient::event_handler);
+  }
+
+  /// Write the share of objects of this client.
+  void
+  preload()
+  {
+    _preload_next = _id;
+    eventProcessor.schedule_imm(this, ET_CALL);
+  }
+
+  void
+  run()
+  {
+    _preload_next = -1;
+    for (auto &s : stats) {
+      s = OpStats();
+    }
+    eventProcessor.schedule_imm(this, ET_CALL);
+  }
+
+  std::array<OpStats, N_OPS> stats;
+
+private:
+  int event_handler(int event, void *data);
+  void start_op();
+  void finish_op(bool hit = true, bool failed = false);
+  void start_read(CacheVC *vc);
+  void close_read(int error = -1);
+  void start_write(CacheVC *vc);
+  void close_write(int error = -1);
+  void fill();
+
+  int _id;
+  std::minstd_rand _rng;
+  std::unique_ptr<HTTPInfo[]> _infos;
+
+  int _preload_next = -1;
+  int _rww_serial   = 0;
+
+  BenchOp _op       = OP_LOOKUP;
+  ink_hrtime _start = 0;
+  HttpCacheKey _key;
+  int _variant = 0;
+  OverridableHttpConfigParams _params;
+  HTTPInfo _update_info;
+
+  CacheVC *_read_vc        = nullptr;
+  CacheVC *_write_vc       = nullptr;
+  MIOBuffer *_read_buffer  = nullptr;
+  MIOBuffer *_write_buffer = nullptr;
+  IOBufferReader *_reader  = nullptr;
+  int64_t _to_write        = 0;
+  Action *_read_action     = nullptr; ///< Pending open of the RWW read.
+  bool _reading            = false;   ///< A read is open or being opened.
+  bool _writing            = false;   ///< A write is open.
+  bool _failed             = false;
+};
+
+void
+BenchClient::start_op()
+{
+  _start   = Thread::get_hrtime_updated();
+  _failed  = false;
+  _variant = 0;
+
+  if (_preload_next >= 0) {
+    _op  = OP_WRITE;
+    _key = object_keys[_preload_next];
+    _preload_next += n_clients;
+  } else {
+    int pick = std::uniform_int_distribution<int>(0, mix.back() - 1)(_rng);
+    _op      = static_cast<BenchOp>(std::upper_bound(mix.begin(), mix.end(), pick) - mix.begin());
+    if (_op == OP_RWW) {
+      make_key(_key, "http://" + std::string(BENCH_HOST) + "/rww/" + std::to_string(_id) + "/" + std::to_string(_rww_serial++));
+    } else {
+      _key = object_keys[std::uniform_int_distribution<int>(0, n_objects - 1)(_rng)];
+    }
+    if (_op == OP_LOOKUP || _op == OP_READ || _op == OP_UPDATE) {
+      _variant = std::uniform_int_distribution<int>(0, n_alternates - 1)(_rng);
+    } else if (_op == OP_ALTERNATE && n_alternates > 1) {
+      _variant = std::uniform_int_distribution<int>(1, n_alternates - 1)(_rng);
+    }
+  }
+
+  switch (_op) {
+  case OP_LOOKUP:
+    cacheProcessor.lookup(this, &_key);
+    break;
+  case OP_READ:
+  case OP_UPDATE:
+    _reading = true;
+    cacheProcessor.open_read(this, &_key, _infos[_variant].request_get(), &_params);
+    break;
+  default:
+    cacheProcessor.open_write(this, 0, &_key, _infos[_variant].request_get(), nullptr);
+    break;
+  }
+}
+
+void
+BenchClient::finish_op(bool hit, bool failed)
+{
+  if (_preload_next < 0) {
+    OpStats &s = stats[_op];
+    s.usecs.push_back(ink_hrtime_to_usec(Thread::get_hrtime_updated() - _start));
+    s.misses += !hit;
+    s.failures += failed;
+  }
+  this_ethread()->schedule_imm(this);
+}
+
+void
+BenchClient::start_read(CacheVC *vc)
+{
+  _read_vc     = vc;
+  _read_buffer = new_MIOBuffer(BUFFER_SIZE_INDEX_32K);
+  _reader      = _read_buffer->alloc_reader();
+  _read_vc->do_io_read(this, _read_vc->get_object_size(), _read_buffer);
+}
+
+void
+BenchClient::close_read(int error)
+{
+  if (_read_vc) {
+    _read_vc->do_io_close(error);
+    _read_vc = nullptr;
+    free_MIOBuffer(_read_buffer);
+    _read_buffer = nullptr;
+  }
+  _reading = false;
+}
+
+void
+BenchClient::start_write(CacheVC *vc)
+{
+  HTTPInfo info;
+
+  _writing  = true;
+  _write_vc = vc;
+  info.copy(&_infos[_variant]);
+  _write_vc->set_http_info(&info);
+  _to_write     = _op == OP_RWW ? rww_size : object_size;
+  _write_buffer = new_MIOBuffer(BUFFER_SIZE_INDEX_32K);
+  _write_vc->do_io_write(this, _to_write, _write_buffer->alloc_reader());
+  this->fill();
+}
+
+void
+BenchClient::close_write(int error)
+{
+  if (_write_vc) {
+    _write_vc->do_io_close(error);
+    _write_vc = nullptr;
+    free_MIOBuffer(_write_buffer);
+    _write_buffer = nullptr;
+  }
+  _writing = false;
+}
+
+/// Keep at most one block of the object in the write buffer.
+void
+BenchClient::fill()
+{
+  int64_t block = BUFFER_SIZE_FOR_INDEX(BUFFER_SIZE_INDEX_32K);
+  if (_to_write > 0 && _write_buffer->max_read_avail() < block) {
+    int64_t n = std::min(_to_write, block);
+    _write_buffer->write(object_data, n);
+    _to_write -= n;
+  }
+}
+
+int
+BenchClient::event_handler(int event, void *data)
+{
+  switch (event) {
+  case EVENT_IMMEDIATE:
+  case EVENT_INTERVAL:
+    if (_preload_next >= n_objects || (_preload_next < 0 && Thread::get_hrtime_updated() >= deadline)) {
+      ++clients_done;
+    } else {
+      this->start_op();
+    }
+    return EVENT_DONE;
+
+  case CACHE_EVENT_LOOKUP:
+  case CACHE_EVENT_LOOKUP_FAILED:
+    this->finish_op(event == CACHE_EVENT_LOOKUP);
+    return EVENT_DONE;
+
+  case CACHE_EVENT_OPEN_READ:
+    _read_action = nullptr;
+    if (_op == OP_UPDATE) {
+      CacheVC *vc = static_cast<CacheVC *>(data);
+      _update_info.copy(static_cast<HTTPInfo *>(&vc->alternate));
+      vc->do_io_close();
+      _reading = false;
+      cacheProcessor.open_write(this, 0, &_key, _infos[_variant].request_get(), &_update_info);
+    } else {
+      this->start_read(static_cast<CacheVC *>(data));
+    }
+    return EVENT_DONE;
+
+  case CACHE_EVENT_OPEN_READ_FAILED:
+    _read_action = nullptr;
+    _reading     = false;
+    if (_op == OP_RWW) {
+      // The read gave up waiting for the writer.
+      _failed = true;
+      if (!_writing) {
+        this->finish_op(true, true);
+      }
+    } else {
+      this->finish_op(false);
+    }
+    return EVENT_DONE;
+
+  case VC_EVENT_READ_READY:
+    _reader->consume(_reader->read_avail());
+    static_cast<VIO *>(data)->reenable();
+    return EVENT_CONT;
+
+  case VC_EVENT_READ_COMPLETE:
+  case VC_EVENT_EOS:
+    this->close_read();
+    if (!_writing) {
+      this->finish_op(true, _failed);
+    }
+    return EVENT_DONE;
+
+  case CACHE_EVENT_OPEN_WRITE:
+    if (_op == OP_UPDATE) {
+      HTTPInfo info;
+      CacheVC *vc = static_cast<CacheVC *>(data);
+      info.copy(&_update_info);
+      vc->set_http_info(&info);
+      vc->do_io_close();
+      _update_info.destroy();
+      this->finish_op();
+    } else {
+      this->start_write(static_cast<CacheVC *>(data));
+    }
+    return EVENT_DONE;
+
+  case CACHE_EVENT_OPEN_WRITE_FAILED:
+    _update_info.destroy();
+    this->finish_op(true, true);
+    return EVENT_DONE;
+
+  case VC_EVENT_WRITE_READY:
+    this->fill();
+    static_cast<VIO *>(data)->reenable();
+    // The reader starts once the writer is under way.
+    if (_op == OP_RWW && !_reading && !_failed) {
+      _reading     = true;
+      Action *a    = cacheProcessor.open_read(this, &_key, _infos[_variant].request_get(), &_params);
+      _read_action = _reading && !_read_vc && a != ACTION_RESULT_DONE ? a : nullptr;
+    }
+    return EVENT_CONT;
+
+  case VC_EVENT_WRITE_COMPLETE:
+    this->close_write();
+    if (!_reading) {
+      this->finish_op(true, _failed);
+    }
+    return EVENT_DONE;
+
+  default: // VC_EVENT_ERROR and the like, a reader of the failed write goes with it.
+    if (_read_action) {
+      _read_action->cancel();
+      _read_action = nullptr;
+    }
+    this->close_read(EHTTP_ERROR);
+    this->close_write(EHTTP_ERROR);
+    this->finish_op(true, true);
+    return EVENT_DONE;
+  }
+}
+
+/// Turn the weights in @a spec into cumulative weights in @c mix.
+bool
+parse_mix(char *spec)
+{
+  std::array<int, N_OPS> weight{};
+  char *last = nullptr;
+
+  for (char *item = strtok_r(spec, ",", &last); item; item = strtok_r(nullptr, ",", &last)) {
+    char *value = strchr(item, '=');
+    if (!value) {
+      return false;
+    }
+    *value++ = '\0';
+    auto op  = std::find_if(std::begin(OP_NAMES), std::end(OP_NAMES), [=](const char *name) { return strcmp(name, item) == 0; });
+    if (op == std::end(OP_NAMES)) {
+      return false;
+    }
+    weight[op - std::begin(OP_NAMES)] = std::max(0, atoi(value));
+  }
+  for (int i = 0, sum = 0; i < N_OPS; ++i) {
+    mix[i] = sum += weight[i];
+  }
+  return mix.back() > 0;
+}
+
+/// Make a directory for each span and the storage.config for them in @a dir.
+bool
+make_spans(std::string const &dir)
+{
+  std::string storage = dir + "/storage.config";
+  FILE *fp;
+
+  mkdir(dir.c_str(), 0755);
+  if ((fp = fopen(storage.c_str(), "w")) == nullptr) {
+    return false;
+  }
+  for (int i = 0; i < n_spans; ++i) {
+    std::string span = dir + "/span" + std::to_string(i);
+    mkdir(span.c_str(), 0755);
+    // Start from an empty cache every run.
+    unlink((span + "/cache.db").c_str());
+    fprintf(fp, "%s %dM\n", span.c_str(), span_size);
+  }
+  fclose(fp);
+  return true;
+}
+
+/// Start the clients and wait for all of them to stop.
+void
+run_clients(std::vector<BenchClient *> &clients, bool preload)
+{
+  clients_done = 0;
+  for (auto client : clients) {
+    preload ? client->preload() : client->run();
+  }
+  while (clients_done < n_clients) {
+    usleep(10000);
+  }
+}
+
+void
+report(std::vector<BenchClient *> &clients, double seconds)
+{
+  uint64_t total = 0;
+
+  printf("%-10s %10s %10s %7s %7s %9s %9s %9s %9s %9s\n", "operation", "count", "ops/sec", "miss%", "fail%", "p50(us)", "p90(us)",
+         "p99(us)", "p99.9(us)", "max(us)");
+  for (int op = 0; op < N_OPS; ++op) {
+    OpStats s;
+    for (auto client : clients) {
+      s.merge(client->stats[op]);
+    }
+    if (s.usecs.empty()) {
+      continue;
+    }
+    std::sort(s.usecs.begin(), s.usecs.end());
+    auto pct = [&](double p) { return s.usecs[std::min<size_t>(s.usecs.size() - 1, s.usecs.size() * p)]; };
+    double n = s.usecs.size();
+    total += s.usecs.size();
+    printf("%-10s %10zu %10.0f %7.2f %7.2f %9u %9u %9u %9u %9u\n", OP_NAMES[op], s.usecs.size(), n / seconds, 100.0 * s.misses / n,
+           100.0 * s.failures / n, pct(0.5), pct(0.9), pct(0.99), pct(0.999), s.usecs.back());
+  }
+  printf("%-10s %10" PRIu64 " %10.0f\n", "total", total, total / seconds);
+}
+} // namespace
+
+int
+main(int /* argc ATS_UNUSED */, const char **argv)
+{
+  appVersionInfo.setup(PACKAGE_NAME, "cache_bench", PACKAGE_VERSION, __DATE__, __TIME__, BUILD_MACHINE, BUILD_PERSON, "");
+  process_args(&appVersionInfo, argument_descriptions, countof(argument_descriptions), argv);
+
+  if (!parse_mix(mix_spec)) {
+    fprintf(stderr, "Invalid operation mix, expected a list of <operation>=<weight>\n");
+    ::exit(EX_USAGE);
+  }
+  n_clients    = std::max(n_clients, 1);
+  n_objects    = std::max(n_objects, 1);
+  n_alternates = std::max(n_alternates, 1);
+
+  BaseLogFile *base_log_file = new BaseLogFile("stderr");
+  diags                      = new Diags("cache_bench", debug_tags, "", base_log_file);
+  if (*debug_tags) {
+    diags->activate_taglist(debug_tags, DiagsTagType_Debug);
+    diags->config.enabled[DiagsTagType_Debug] = true;
+  }
+
+  mime_init();
+  http_init();
+  Layout::create();
+  RecProcessInit(RECM_STAND_ALONE);
+  LibRecordsConfigInit();
+  ink_net_init(ts::ModuleVersion(1, 0, ts::ModuleVersion::PRIVATE));
+  statPagesManager.init();
+  netProcessor.init();
+  eventProcessor.start(n_threads);
+  ink_aio_init(AIO_MODULE_PUBLIC_VERSION);
+
+  EThread *thread = new EThread();
+  thread->set_specific();
+  init_buffer_allocators(0);
+
+  std::string dir = bench_dir;
+  if (!make_spans(dir)) {
+    fprintf(stderr, "Failed to write the spans in %s: %s\n", dir.c_str(), strerror(errno));
+    ::exit(1);
+  }
+  char path[PATH_MAX];
+  Layout::get()->sysconfdir = Layout::get()->prefix = realpath(dir.c_str(), path);
+
+  ink_cache_init(ts::ModuleVersion(1, 0, ts::ModuleVersion::PRIVATE));
+  cacheProcessor.start();
+  while (!CacheProcessor::IsCacheReady(CACHE_FRAG_TYPE_HTTP)) {
+    if (CacheProcessor::initialized == CACHE_INIT_FAILED) {
+      fprintf(stderr, "Cache initialization failed\n");
+      ::exit(1);
+    }
+    usleep(10000);
+  }
+
+  object_data = static_cast<char *>(ats_malloc(BUFFER_SIZE_FOR_INDEX(BUFFER_SIZE_INDEX_32K)));
+  for (int i = 0; i < BUFFER_SIZE_FOR_INDEX(BUFFER_SIZE_INDEX_32K); ++i) {
+    object_data[i] = 'a' + i % 26;
+  }
+  object_keys.resize(n_objects);
+  for (int i = 0; i < n_objects; ++i) {
+    make_key(object_keys[i], "http://" + std::string(BENCH_HOST) + "/object/" + std::to_string(i));
+  }
+  std::vector<BenchClient *> clients;
+  for (int i = 0; i < n_clients; ++i) {
+    clients.push_back(new BenchClient(i));
+  }
+
+  if (!no_preload) {
+    ink_hrtime start = Thread::get_hrtime_updated();
+    run_clients(clients, true);
+    printf("Preloaded %d objects in %.2f sec\n", n_objects, ink_hrtime_to_msec(Thread::get_hrtime_updated() - start) / 1000.0);
+  }
+
+  ink_hrtime start = Thread::get_hrtime_updated();
+  deadline         = start + HRTIME_SECONDS(n_seconds);
+  run_clients(clients, false);
+  report(clients, ink_hrtime_to_msec(Thread::get_hrtime_updated() - start) / 1000.0);
+
+  fflush(stdout);
+  ::_exit(0);
+}
@@ -0,0 +1,185 @@
+/** @file
+
+  A brief file description
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "main.h"
+
+#define LARGE_FILE 10 * 1024 * 1024
+#define SMALL_FILE 10 * 1024
+
+// Writes to the stripe are held back by occupying the disk's only write slot (see
+// proxy.config.cache.io.max_writes_in_flight), so the aggregation writes pile up in flight.
+static AIOCallbackInternal disk_plug;
+// sync serial of the directory sync started while the writes are held back
+static uint32_t agg_sync_serial = 0;
+
+static void
+plug_disk(CacheDisk *d)
+{
+  std::lock_guard<std::mutex> lock(d->io_mutex);
+  ++d->io_writes_in_flight;
+  disk_plug.submit_time = 1;
+}
+
+static void
+unplug_disk(CacheDisk *d)
+{
+  // starts the first queued write in the plug's place
+  d->io_write_done(&disk_plug);
+}
+
+// Waits for overlapping aggregation writes, checks their serials and that a directory sync
+// waits for them, then lets them go.
+class AggWriteOverlapCheck : public Continuation
+{
+public:
+  AggWriteOverlapCheck() : Continuation(new_ProxyMutex()) { SET_HANDLER(&AggWriteOverlapCheck::check_event); }
+
+  int
+  check_event(int event, void *e)
+  {
+    Vol *vol = gvol[0];
+    MUTEX_TRY_LOCK(lock, vol->mutex, this_ethread());
+    if (!lock.is_locked() || vol->agg_writes_in_flight < 2) {
+      REQUIRE(++_tries < 1000);
+      this_ethread()->schedule_in(this, HRTIME_MSECONDS(5));
+      return 0;
+    }
+    if (!agg_sync_serial) {
+      // every write in flight has its own serial, the oldest one is the stripe's
+      uint32_t serials = 0;
+      for (auto &w : vol->agg_io) {
+        if (w.io.aiocb.aio_fildes != AIO_NOT_IN_PROGRESS) {
+          REQUIRE(w.serial - vol->header->write_serial < static_cast<uint32_t>(vol->agg_writes_in_flight));
+          serials |= 1 << (w.serial - vol->header->write_serial);
+        }
+      }
+      CHECK(serials == (1u << vol->agg_writes_in_flight) - 1);
+      CHECK(vol->agg_write_serial() == vol->header->write_serial + vol->agg_writes_in_flight);
+      CHECK(vol->is_io_in_progress());
+      agg_sync_serial = vol->header->sync_serial + 1;
+      eventProcessor.schedule_imm(cacheDirSync, ET_CALL);
+      this_ethread()->schedule_in(this, HRTIME_MSECONDS(100));
+      return 0;
+    }
+    // the directory sync must not run before the writes are on disk
+    CHECK(vol->dir_sync_waiting);
+    CHECK(vol->header->sync_serial + 1 == agg_sync_serial);
+    unplug_disk(vol->disk);
+    delete this;
+    return 0;
+  }
+
+private:
+  int _tries = 0;
+};
+
+// Once the directory is synced, checks the stripe as recovery would find it: the documents
+// between the synced last and current write positions, and all documents written before them,
+// are valid and their write serials never go down or past the synced header's.
+class AggWriteRecoveryCheck : public TerminalTest
+{
+public:
+  AggWriteRecoveryCheck() { SET_HANDLER(&AggWriteRecoveryCheck::check_event); }
+
+  int
+  check_event(int event, void *e)
+  {
+    Vol *vol = gvol[0];
+    MUTEX_TRY_LOCK(lock, vol->mutex, this_ethread());
+    if (!lock.is_locked() || !agg_sync_serial || static_cast<int32_t>(vol->header->sync_serial - agg_sync_serial) < 0 ||
+        vol->dir_sync_in_progress) {
+      REQUIRE(++_tries < 1000);
+      this_ethread()->schedule_in(this, HRTIME_MSECONDS(5));
+      return 0;
+    }
+
+    size_t dirlen    = vol->dirlen();
+    size_t footerlen = ROUND_TO_STORE_BLOCK(sizeof(VolHeaderFooter));
+    off_t dir_start  = vol->skip + ((vol->header->sync_serial & 1) ? dirlen : 0);
+    char *buf        = static_cast<char *>(ats_memalign(ats_pagesize(), dirlen));
+    REQUIRE(pread(vol->fd, buf, dirlen, dir_start) == static_cast<ssize_t>(dirlen));
+    VolHeaderFooter *header = reinterpret_cast<VolHeaderFooter *>(buf);
+    VolHeaderFooter *footer = reinterpret_cast<VolHeaderFooter *>(buf + dirlen - footerlen);
+    CHECK(header->magic == VOL_MAGIC);
+    CHECK(header->sync_serial == vol->header->sync_serial);
+    CHECK(footer->sync_serial == header->sync_serial);
+    CHECK(header->last_write_pos < header->write_pos);
+
+    size_t len = header->write_pos - vol->start;
+    char *data = static_cast<char *>(ats_memalign(ats_pagesize(), len));
+    REQUIRE(pread(vol->fd, data, len, vol->start) == static_cast<ssize_t>(len));
+    uint32_t last_serial = 0;
+    bool recover_from    = false;
+    for (size_t done = 0; done < len;) {
+      Doc *doc = reinterpret_cast<Doc *>(data + done);
+      REQUIRE(doc->magic == DOC_MAGIC);
+      CHECK(doc->write_serial >= last_serial);
+      CHECK(doc->write_serial <= header->write_serial);
+      last_serial = doc->write_serial;
+      recover_from |= vol->start + static_cast<off_t>(done) == header->last_write_pos;
+      done += vol->round_to_approx_size(doc->len);
+    }
+    // recovery starts on a document boundary
+    CHECK(recover_from);
+    ats_memalign_free(data);
+    ats_memalign_free(buf);
+
+    delete this;
+    return 0;
+  }
+
+private:
+  int _tries = 0;
+};
+
+class CacheAggWriteInit : public CacheInit
+{
+public:
+  CacheAggWriteInit() {}
+  int
+  cache_init_success_callback(int event, void *e) override
+  {
+    REQUIRE(gnvol == 1);
+    plug_disk(gvol[0]->disk);
+    CacheTestHandler *h  = new CacheTestHandler(LARGE_FILE);
+    CacheTestHandler *h2 = new CacheTestHandler(SMALL_FILE, "http://www.scw11.com");
+    h->add(h2);
+    h->add(new AggWriteRecoveryCheck);
+    this_ethread()->schedule_imm(h);
+    this_ethread()->schedule_imm(new AggWriteOverlapCheck);
+    delete this;
+    return 0;
+  }
+};
+
+TEST_CASE("cache write -> read with several aggregation writes in flight", "cache")
+{
+  // the large document spans several aggregation buffers, each written in parts
+  RecSetRecordInt("proxy.config.cache.agg_write_in_flight", 4, REC_SOURCE_EXPLICIT);
+  RecSetRecordInt("proxy.config.cache.io.max_writes_in_flight", 1, REC_SOURCE_EXPLICIT);
+  init_cache(256 * 1024 * 1024);
+  CacheAggWriteInit *init = new CacheAggWriteInit;
+
+  this_ethread()->schedule_imm(init);
+  this_thread()->execute();
+}
@@ -0,0 +1,70 @@
+/** @file
+
+  Directory bucket probe tests.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#define SMALL_FILE 10 * 1024
+#include "main.h"
+
+#include <random>
+
+namespace
+{
+constexpr int N_BUCKETS = 4096;
+
+// Fill the buckets with random entries, with a share of the tags matching one of the keys.
+void
+fill_buckets(Dir *dir, CacheKey *keys, std::mt19937 &rng)
+{
+  for (int i = 0; i < N_BUCKETS; ++i) {
+    keys[i].b[0] = (static_cast<uint64_t>(rng()) << 32) | rng();
+    keys[i].b[1] = (static_cast<uint64_t>(rng()) << 32) | rng();
+  }
+  for (int i = 0; i < N_BUCKETS * DIR_DEPTH; ++i) {
+    Dir *e = dir_in_seg(dir, i);
+    for (auto &w : e->w) {
+      w = rng();
+    }
+    if (rng() % 3 == 0) {
+      dir_set_tag(e, keys[rng() % N_BUCKETS].slice32(2));
+    }
+  }
+}
+} // namespace
+
+TEST_CASE("dir bucket match", "cache")
+{
+  std::mt19937 rng(13);
+  std::vector<Dir> dir(N_BUCKETS * DIR_DEPTH);
+  std::vector<CacheKey> keys(N_BUCKETS);
+  fill_buckets(dir.data(), keys.data(), rng);
+
+  for (int i = 0; i < N_BUCKETS; ++i) {
+    for (int k = 0; k < N_BUCKETS; k += 61) {
+      Dir *b = dir_bucket(i, dir.data());
+      REQUIRE(dir_bucket_match(b, &keys[k]) == dir_bucket_match_scalar(b, &keys[k]));
+      for (int j = 0; j < DIR_DEPTH; ++j) {
+        Dir *e = dir_bucket_row(b, j);
+        CHECK(dir_compare_tag(e, &keys[k], b, dir_bucket_match(b, &keys[k])) == static_cast<bool>(dir_compare_tag(e, &keys[k])));
+      }
+    }
+  }
+}
@@ -0,0 +1,160 @@
+/** @file
+
+  Hot document replication tests.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#define SMALL_FILE 10 * 1024
+#define HOT_URL "http://www.scw88.com/"
+
+#include "main.h"
+
+static int64_t
+global_stat(int stat)
+{
+  int64_t v = 0;
+  RecGetGlobalRawStatSum(cache_rsb, stat, &v);
+  return v;
+}
+
+// CACHE_INCREMENT_DYN_STAT on this thread
+static int64_t
+local_stat(int stat)
+{
+  return raw_stat_get_tlp(cache_rsb, stat, this_ethread())->sum;
+}
+
+class HotReplicaRead : public CacheTestHandler
+{
+public:
+  HotReplicaRead(size_t size, const char *url) : CacheTestHandler()
+  {
+    this->_rt        = new CacheReadTest(size, this, url);
+    this->_rt->mutex = this->mutex;
+
+    SET_HANDLER(&HotReplicaRead::start_test);
+  }
+
+  int
+  start_test(int event, void *e)
+  {
+    this_ethread()->schedule_imm(this->_rt);
+    return 0;
+  }
+
+  void
+  handle_cache_event(int event, CacheTestBase *base) override
+  {
+    switch (event) {
+    case CACHE_EVENT_OPEN_READ:
+      base->do_io_read();
+      break;
+    case VC_EVENT_READ_READY:
+      base->reenable();
+      break;
+    case VC_EVENT_READ_COMPLETE:
+      base->close();
+      delete this;
+      break;
+    default:
+      REQUIRE(false);
+      break;
+    }
+  }
+};
+
+// Waits for the copier, then checks the counters.
+class HotReplicaCheck : public CacheTestHandler
+{
+public:
+  using Check = std::function<bool()>;
+
+  HotReplicaCheck(Check wait, Check check) : _wait(std::move(wait)), _check(std::move(check))
+  {
+    SET_HANDLER(&HotReplicaCheck::check_event);
+  }
+
+  int
+  check_event(int event, void *e)
+  {
+    if (!_wait()) {
+      REQUIRE(++_tries < 500);
+      this_ethread()->schedule_in(this, HRTIME_MSECONDS(10));
+      return 0;
+    }
+    CHECK(_check());
+    delete this;
+    return 0;
+  }
+
+private:
+  Check _wait;
+  Check _check;
+  int _tries = 0;
+};
+
+class HotReplicaInit : public CacheInit
+{
+public:
+  HotReplicaInit() {}
+  int
+  cache_init_success_callback(int event, void *e) override
+  {
+    REQUIRE(gnvol > 1);
+    // the write and its read, then enough reads to cross the threshold
+    CacheTestHandler *h = new CacheTestHandler(SMALL_FILE, HOT_URL);
+    h->add(new HotReplicaRead(SMALL_FILE, HOT_URL));
+    h->add(new HotReplicaRead(SMALL_FILE, HOT_URL));
+    h->add(new HotReplicaCheck([] { return global_stat(cache_hot_replica_writes_stat) > 0; },
+                               [] { return global_stat(cache_hot_replica_objects_stat) == 1; }));
+    // the original and the copy take turns
+    for (int i = 0; i < 4; ++i) {
+      h->add(new HotReplicaRead(SMALL_FILE, HOT_URL));
+    }
+    h->add(new HotReplicaCheck([] { return true; }, [] { return local_stat(cache_hot_replica_reads_stat) == 2; }));
+    // a new alternate drops the copy, and the document is no longer copied as it has two
+    h->add(new CacheTestHandler(SMALL_FILE, HOT_URL));
+    h->add(new HotReplicaRead(SMALL_FILE, HOT_URL));
+    h->add(new HotReplicaRead(SMALL_FILE, HOT_URL));
+    h->add(new HotReplicaCheck([] { return true; },
+                               [] {
+                                 return global_stat(cache_hot_replica_retired_stat) == 1 &&
+                                        global_stat(cache_hot_replica_writes_stat) == 1 &&
+                                        local_stat(cache_hot_replica_reads_stat) == 2;
+                               }));
+    h->add(new TerminalTest);
+    this_ethread()->schedule_imm(h);
+    delete this;
+    return 0;
+  }
+};
+
+TEST_CASE("cache hot replica", "cache")
+{
+  RecSetRecordInt("proxy.config.cache.hot_replica.copies", 1, REC_SOURCE_EXPLICIT);
+  RecSetRecordInt("proxy.config.cache.hot_replica.threshold", 3, REC_SOURCE_EXPLICIT);
+  // a larger span so there is more than one stripe
+  Layout::get()->sysconfdir = std::string(TS_ABS_TOP_SRCDIR) + "/iocore/cache/test/hot_replica";
+  init_cache(512 * 1024 * 1024);
+  HotReplicaInit *init = new HotReplicaInit;
+
+  this_ethread()->schedule_imm(init);
+  this_thread()->execute();
+}
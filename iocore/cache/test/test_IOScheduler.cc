@@ -0,0 +1,94 @@
+/** @file
+
+  Per disk I/O scheduler tests.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "main.h"
+
+#define LARGE_FILE 10 * 1024 * 1024
+
+static int64_t
+io_stat(CacheDisk *d, int stat, int n = 1)
+{
+  int64_t sum = 0;
+  for (int i = 0; i < n; ++i) {
+    int64_t v = 0;
+    RecGetGlobalRawStatSum(d->io_rsb, stat + i, &v);
+    sum += v;
+  }
+  return sum;
+}
+
+// Waits for the writes still queued behind the read to drain, then checks the books balance.
+class IOSchedulerCheck : public TerminalTest
+{
+public:
+  IOSchedulerCheck() { SET_HANDLER(&IOSchedulerCheck::check_event); }
+
+  int
+  check_event(int event, void *e)
+  {
+    CacheDisk *d = gvol[0]->disk;
+    if (io_stat(d, cache_disk_io_writes_in_flight_stat) || io_stat(d, cache_disk_io_reads_in_flight_stat)) {
+      REQUIRE(++_tries < 500);
+      this_ethread()->schedule_in(this, HRTIME_MSECONDS(10));
+      return 0;
+    }
+    CHECK(d->io_writes_in_flight == 0);
+    CHECK(d->io_write_wait.empty());
+    CHECK(io_stat(d, cache_disk_io_writes_queued_stat) == 0);
+    CHECK(io_stat(d, cache_disk_io_read_latency_stat, CACHE_DISK_IO_LATENCY_BUCKETS) > 0);
+    CHECK(io_stat(d, cache_disk_io_write_latency_stat, CACHE_DISK_IO_LATENCY_BUCKETS) > 0);
+    delete this;
+    return 0;
+  }
+
+private:
+  int _tries = 0;
+};
+
+class IOSchedulerInit : public CacheInit
+{
+public:
+  IOSchedulerInit() {}
+  int
+  cache_init_success_callback(int event, void *e) override
+  {
+    REQUIRE(gnvol == 1);
+    REQUIRE(gvol[0]->disk->io_rsb != nullptr);
+    CacheTestHandler *h = new CacheTestHandler(LARGE_FILE, "http://www.scw77.com/");
+    h->add(new IOSchedulerCheck);
+    this_ethread()->schedule_imm(h);
+    delete this;
+    return 0;
+  }
+};
+
+TEST_CASE("cache I/O scheduler", "cache")
+{
+  // every write waits for the one before it
+  RecSetRecordInt("proxy.config.cache.io.max_writes_in_flight", 1, REC_SOURCE_EXPLICIT);
+  init_cache(256 * 1024 * 1024);
+  IOSchedulerInit *init = new IOSchedulerInit;
+
+  this_ethread()->schedule_imm(init);
+  this_thread()->execute();
+}
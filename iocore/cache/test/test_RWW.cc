@@ -391,6 +391,138 @@ private:
   bool _is_read_start = false;
 };
 
+// One writer and many readers of the same object.  The writer pauses after each fragment so
+// the readers, polling for the next fragment, stay within the writer's fragment ring.
+class CacheRWWFanOutTest : public CacheTestHandler
+{
+public:
+  CacheRWWFanOutTest(int nreaders, int ring, const char *url) : CacheTestHandler(), _nreaders(nreaders), _ring(ring)
+  {
+    this->_wt        = new CacheWriteTest(LARGE_FILE, this, url);
+    this->_wt->mutex = this->mutex;
+    for (int i = 0; i < nreaders; ++i) {
+      CacheTestBase *rt = new CacheReadTest(LARGE_FILE, this, url);
+      rt->mutex         = this->mutex;
+      this->_readers.push_back(rt);
+    }
+
+    SET_HANDLER(&CacheRWWFanOutTest::start_test);
+  }
+
+  int
+  start_test(int event, void *e)
+  {
+    REQUIRE(event == EVENT_IMMEDIATE);
+    cache_config_read_while_writer_fragment_ring = this->_ring;
+    this->_hits = fragment_hits();
+    SET_HANDLER(&CacheRWWFanOutTest::pace_event);
+    this_ethread()->schedule_imm(this->_wt);
+    return 0;
+  }
+
+  int
+  pace_event(int event, void *e)
+  {
+    if (this->_wt) {
+      this->_wt->reenable();
+    }
+    return 0;
+  }
+
+  void
+  handle_cache_event(int event, CacheTestBase *base) override
+  {
+    REQUIRE(base != nullptr);
+
+    if (base == this->_wt) {
+      process_write_event(event, base);
+    } else {
+      process_read_event(event, base);
+    }
+
+    if (this->_wt == nullptr && this->_nreaders == 0) {
+      int64_t hits = fragment_hits();
+      if (this->_ring) {
+        CHECK(hits > this->_hits);
+      } else {
+        CHECK(hits == this->_hits);
+      }
+      cache_config_read_while_writer_fragment_ring = 4;
+      delete this;
+    }
+  }
+
+  // the readers all run on this thread, which is not one of the event processor threads
+  // summed by RecGetRawStatSum()
+  int64_t
+  fragment_hits()
+  {
+    return raw_stat_get_tlp(cache_rsb, cache_read_writer_fragment_hits_stat, this_ethread())->sum;
+  }
+
+  void
+  process_write_event(int event, CacheTestBase *base)
+  {
+    switch (event) {
+    case CACHE_EVENT_OPEN_WRITE:
+      base->do_io_write();
+      break;
+    case VC_EVENT_WRITE_READY:
+      if (this->_latest_fragments == base->vc->fragment) {
+        base->reenable();
+        break;
+      }
+      if (!this->_is_read_start) {
+        this->_is_read_start = true;
+        for (auto rt : this->_readers) {
+          this_ethread()->schedule_imm(rt);
+        }
+      }
+      this->_latest_fragments = base->vc->fragment;
+      this_ethread()->schedule_in(this, HRTIME_MSECONDS(100));
+      break;
+    case VC_EVENT_WRITE_COMPLETE:
+      base->close();
+      this->_wt = nullptr;
+      break;
+    default:
+      REQUIRE(false);
+      break;
+    }
+  }
+
+  void
+  process_read_event(int event, CacheTestBase *base)
+  {
+    switch (event) {
+    case CACHE_EVENT_OPEN_READ:
+      base->do_io_read();
+      break;
+    case VC_EVENT_READ_READY:
+      base->reenable();
+      break;
+    case VC_EVENT_READ_COMPLETE:
+      CHECK(base->vio->ndone == LARGE_FILE);
+      base->close();
+      --this->_nreaders;
+      break;
+    default:
+      CHECK(event == 0);
+      base->close();
+      --this->_nreaders;
+      break;
+    }
+  }
+
+private:
+  int64_t _latest_fragments = 0;
+  bool _is_read_start       = false;
+  int _nreaders             = 0;
+  int _ring                 = 0;
+  int64_t _hits             = 0;
+  std::vector<CacheTestBase *> _readers;
+};
+
 class CacheRWWCacheInit : public CacheInit
 {
 public:
@@ -405,6 +537,8 @@ public:
 
     crww->add(crww_l);
     crww->add(crww_eos);
+    crww->add(new CacheRWWFanOutTest(200, 0, "http://www.scw55.com/"));
+    crww->add(new CacheRWWFanOutTest(400, 4, "http://www.scw66.com/"));
     crww->add(tt);
     this_ethread()->schedule_imm(crww);
     delete this;
@@ -0,0 +1,128 @@
+/** @file
+
+  A brief file description
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#define SMALL_FILE 10 * 1024
+
+#include "main.h"
+
+// Read a document and check whether the stripe mutex was bypassed.
+class CacheLockFreeRead : public CacheTestHandler
+{
+public:
+  CacheLockFreeRead(size_t size, const char *url, bool lock_free) : CacheTestHandler(), _lock_free(lock_free)
+  {
+    this->_rt        = new CacheReadTest(size, this, url);
+    this->_rt->mutex = this->mutex;
+
+    SET_HANDLER(&CacheLockFreeRead::start_test);
+  }
+
+  int
+  start_test(int event, void *e)
+  {
+    REQUIRE(event == EVENT_IMMEDIATE);
+    this_ethread()->schedule_imm(this->_rt);
+    return 0;
+  }
+
+  void
+  handle_cache_event(int event, CacheTestBase *base) override
+  {
+    switch (event) {
+    case CACHE_EVENT_OPEN_READ:
+      CHECK(static_cast<bool>(base->vc->f.ram_lock_free) == this->_lock_free);
+      base->do_io_read();
+      break;
+    case VC_EVENT_READ_READY:
+      base->reenable();
+      break;
+    case VC_EVENT_READ_COMPLETE:
+      base->close();
+      delete this;
+      break;
+    default:
+      REQUIRE(false);
+      break;
+    }
+  }
+
+private:
+  bool _lock_free;
+};
+
+// Rewrite a document and check that it left the lock free index as soon as the writer opened.
+class CacheLockFreeRewrite : public CacheTestHandler
+{
+public:
+  CacheLockFreeRewrite(size_t size, const char *url) : CacheTestHandler(size, url) {}
+
+  void
+  handle_cache_event(int event, CacheTestBase *base) override
+  {
+    if (event == CACHE_EVENT_OPEN_WRITE) {
+      RamCacheHotIndex::Entry hot;
+      CHECK(base->vc->vol->ram_cache_hot->get(&base->vc->first_key, &hot) == false);
+    }
+    CacheTestHandler::handle_cache_event(event, base);
+  }
+};
+
+class CacheLockFreeInit : public CacheInit
+{
+public:
+  CacheLockFreeInit() {}
+  int
+  cache_init_success_callback(int event, void *e) override
+  {
+    const char *url = "http://www.scw11.com";
+    // write and read from disk, hit in the RAM cache, then read without the stripe mutex
+    CacheTestHandler *h       = new CacheTestHandler(SMALL_FILE, url);
+    CacheLockFreeRead *hit    = new CacheLockFreeRead(SMALL_FILE, url, false);
+    CacheLockFreeRead *hot    = new CacheLockFreeRead(SMALL_FILE, url, true);
+    // opening a writer for the document must take it out of the lock free index
+    CacheTestHandler *rewrite = new CacheLockFreeRewrite(SMALL_FILE, url);
+    CacheLockFreeRead *again  = new CacheLockFreeRead(SMALL_FILE, url, false);
+    TerminalTest *tt          = new TerminalTest;
+
+    h->add(hit);
+    h->add(hot);
+    h->add(rewrite);
+    h->add(again);
+    h->add(tt);
+    this_ethread()->schedule_imm(h);
+    delete this;
+    return 0;
+  }
+};
+
+TEST_CASE("cache lock free ram cache read", "cache")
+{
+  RecSetRecordInt("proxy.config.cache.ram_cache.lock_free_entries", 64, REC_SOURCE_EXPLICIT);
+  // admit documents to the RAM cache on the first read
+  RecSetRecordInt("proxy.config.cache.ram_cache.use_seen_filter", 0, REC_SOURCE_EXPLICIT);
+  init_cache(256 * 1024 * 1024);
+  CacheLockFreeInit *init = new CacheLockFreeInit;
+
+  this_ethread()->schedule_imm(init);
+  this_thread()->execute();
+}
@@ -0,0 +1,113 @@
+/** @file
+
+  RAM cache preload tests.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "main.h"
+
+#include <random>
+
+namespace
+{
+constexpr int N_SLOTS  = 64; // documents the RAM cache holds
+constexpr int N_WARM   = 48; // documents preloaded
+constexpr int N_SCAN   = 256;
+constexpr int DOC_SIZE = 8192;
+
+std::vector<CryptoHash>
+make_keys(std::mt19937 &rng, int n)
+{
+  std::vector<CryptoHash> keys(n);
+  for (auto &key : keys) {
+    key.u64[0] = (static_cast<uint64_t>(rng()) << 32) | rng();
+    key.u64[1] = (static_cast<uint64_t>(rng()) << 32) | rng();
+  }
+  return keys;
+}
+} // namespace
+
+TEST_CASE("TinyLFU warm", "[cache][ram_cache]")
+{
+  // The test case runs once per section, the stats are registered once.
+  static RecRawStatBlock *vol_rsb = [] {
+    ink_cache_init(ts::ModuleVersion(1, 0, ts::ModuleVersion::PRIVATE));
+    return RecAllocateRawStatBlock(static_cast<int>(cache_stat_count));
+  }();
+
+  std::mt19937 rng(17);
+  CacheVol cache_vol;
+  cache_vol.vol_rsb = vol_rsb;
+  Vol vol;
+  vol.cache_vol = &cache_vol;
+  RamCache *ram_cache = new_RamCacheTinyLFU();
+  // 128 is the per entry overhead charged by the TinyLFU cache.
+  ram_cache->init(N_SLOTS * (DOC_SIZE + 128), &vol);
+
+  Ptr<IOBufferData> data = make_ptr(new_IOBufferData(iobuffer_size_to_index(DOC_SIZE, MAX_BUFFER_SIZE_INDEX), MEMALIGNED));
+  REQUIRE(data->block_size() == DOC_SIZE);
+
+  auto warmed = make_keys(rng, N_WARM);
+  for (int i = 0; i < N_WARM; ++i) {
+    REQUIRE(ram_cache->warm(&warmed[i], data.get(), DOC_SIZE, false, i) == 1);
+  }
+
+  SECTION("preloaded documents keep their order")
+  {
+    std::vector<RamCacheKey> hot;
+    ram_cache->hot_keys(hot, N_WARM);
+    REQUIRE(hot.size() == N_WARM);
+    for (int i = 0; i < N_WARM; ++i) {
+      CHECK(hot[i].key == warmed[i]);
+      CHECK(hot[i].auxkey == static_cast<uint64_t>(i));
+    }
+  }
+
+  SECTION("a full cache takes no more preloaded documents")
+  {
+    auto extra = make_keys(rng, N_SLOTS);
+    int stored = 0;
+    for (int i = 0; i < N_SLOTS; ++i) {
+      stored += ram_cache->warm(&extra[i], data.get(), DOC_SIZE, false, 0);
+    }
+    CHECK(stored == N_SLOTS - N_WARM);
+    Ptr<IOBufferData> hit;
+    for (int i = 0; i < N_WARM; ++i) {
+      CHECK(ram_cache->get(&warmed[i], &hit, i) == 1);
+    }
+  }
+
+  SECTION("preloaded documents survive a scan")
+  {
+    // Each scanned document misses once and is then stored, as a read from disk would.
+    auto scan = make_keys(rng, N_SCAN);
+    Ptr<IOBufferData> hit;
+    for (auto &key : scan) {
+      CHECK(ram_cache->get(&key, &hit, 0) == 0);
+      ram_cache->put(&key, data.get(), DOC_SIZE, false, 0);
+    }
+    for (int i = 0; i < N_WARM; ++i) {
+      CHECK(ram_cache->get(&warmed[i], &hit, i) == 1);
+      CHECK(hit.get() == data.get());
+    }
+  }
+
+  delete ram_cache;
+}
@@ -0,0 +1,96 @@
+/** @file
+
+  Background stripe scrubber tests.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "main.h"
+
+// A head entry for a document from the previous pass over the stripe, offset blocks ahead of the write.
+static Dir
+insert_head(Vol *vol, CacheKey *key, off_t offset)
+{
+  Dir dir;
+  dir_clear(&dir);
+  dir_set_offset(&dir, vol->offset_to_vol_offset(vol->header->write_pos + AGG_SIZE) + offset);
+  dir_set_phase(&dir, !vol->header->phase);
+  dir_set_head(&dir, 1);
+  dir_set_approx_size(&dir, 4096);
+  REQUIRE(dir_insert(key, vol, &dir));
+  REQUIRE(dir_valid(vol, &dir));
+  return dir;
+}
+
+class CacheScrubInit : public CacheInit
+{
+public:
+  CacheScrubInit() {}
+  int
+  cache_init_success_callback(int event, void *e) override
+  {
+    Vol *vol = gvol[0];
+    REQUIRE(!vol->heat.empty());
+    SCOPED_MUTEX_LOCK(lock, vol->mutex, this_ethread());
+
+    CacheKey hot_key, cold_key, far_key;
+    rand_CacheKey(&hot_key, vol->mutex);
+    rand_CacheKey(&cold_key, vol->mutex);
+    rand_CacheKey(&far_key, vol->mutex);
+    Dir hot  = insert_head(vol, &hot_key, 100);
+    Dir cold = insert_head(vol, &cold_key, 2000);
+    // hot, but not about to be overwritten
+    Dir far = insert_head(vol, &far_key, (vol->len / 2) / CACHE_BLOCK_SIZE);
+    REQUIRE(vol->within_scrub_window(&hot));
+    REQUIRE(vol->within_scrub_window(&cold));
+    REQUIRE(!vol->within_scrub_window(&far));
+
+    for (int i = 0; i < cache_config_scrub_heat_threshold; ++i) {
+      // reads only count with the scrubber
+      CHECK(!vol->hit_evacuate(&hot, 1000));
+      CHECK(!vol->hit_evacuate(&far, 1000));
+    }
+    CHECK(!vol->hit_evacuate(&cold, 1000));
+    CHECK(vol->heat[vol->heat_slot(dir_offset(&hot))] == cache_config_scrub_heat_threshold);
+
+    // one pass from the start of the directory, the scrubber may have been running already
+    vol->scrub_pos = 0;
+    vol->scrub(vol->direntries());
+    CHECK(evacuation_block_exists(&hot, vol) != nullptr);
+    CHECK(evacuation_block_exists(&cold, vol) == nullptr);
+    CHECK(evacuation_block_exists(&far, vol) == nullptr);
+    // a pass over the directory halves the heat
+    CHECK(vol->heat[vol->heat_slot(dir_offset(&hot))] == cache_config_scrub_heat_threshold / 2);
+    CHECK(vol->heat[vol->heat_slot(dir_offset(&cold))] == 0);
+
+    this_ethread()->schedule_imm(new TerminalTest);
+    delete this;
+    return 0;
+  }
+};
+
+TEST_CASE("cache scrub", "cache")
+{
+  RecSetRecordInt("proxy.config.cache.scrub.rate", 1000, REC_SOURCE_EXPLICIT);
+  init_cache(256 * 1024 * 1024);
+  CacheScrubInit *init = new CacheScrubInit;
+
+  this_ethread()->schedule_imm(init);
+  this_thread()->execute();
+}
@@ -0,0 +1,116 @@
+/** @file
+
+  Alternate selection tests.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "main.h"
+
+#include "HttpTransact.h"
+#include "HttpTransactCache.h"
+#include "InkAPIInternal.h"
+
+namespace
+{
+void
+parse(HTTPHdr &hdr, HTTPType type, ts::TextView text)
+{
+  HTTPParser parser;
+  http_parser_init(&parser);
+  hdr.create(type);
+  const char *start = text.data();
+  if (type == HTTP_TYPE_REQUEST) {
+    REQUIRE(hdr.parse_req(&parser, &start, text.data_end(), true) == PARSE_RESULT_DONE);
+  } else {
+    REQUIRE(hdr.parse_resp(&parser, &start, text.data_end(), true) == PARSE_RESULT_DONE);
+  }
+  http_parser_clear(&parser);
+}
+
+/// Add an alternate for @a request, received @a age seconds ago.
+void
+add_alternate(CacheHTTPInfoVector &vector, ts::TextView request, ts::TextView response, time_t age)
+{
+  HTTPHdr req, resp;
+  parse(req, HTTP_TYPE_REQUEST, request);
+  parse(resp, HTTP_TYPE_RESPONSE, response);
+
+  CacheHTTPInfo info;
+  CryptoHash key;
+  info.create();
+  info.request_set(&req);
+  info.response_set(&resp);
+  info.request_sent_time_set(ink_local_time() - age);
+  info.response_received_time_set(ink_local_time() - age);
+  key.u64[0] = vector.count() + 1;
+  key.u64[1] = 0;
+  info.object_key_set(key);
+  // As when the alternate is marshaled.
+  info.m_alt->m_vary_key = HTTPInfo::vary_key(&resp, &req);
+  vector.insert(&info);
+
+  req.destroy();
+  resp.destroy();
+}
+} // namespace
+
+// The newer alternate differs from the client request only in a header that Vary matching ignores,
+// so it is preferred for being fresher.
+TEST_CASE("SelectFromAlternates ignored Vary headers", "[cache][alternate]")
+{
+  static bool initialized = [] {
+    http_init();
+    http_global_hooks = new HttpAPIHooks;
+    return true;
+  }();
+  REQUIRE(initialized);
+
+  OverridableHttpConfigParams params;
+  CacheHTTPInfoVector vector;
+  HTTPHdr client;
+
+  SECTION("global User-Agent")
+  {
+    static char UA[] = "ATS";
+
+    add_alternate(vector, "GET / HTTP/1.1\r\nUser-Agent: a\r\n\r\n", "HTTP/1.1 200 OK\r\nVary: User-Agent\r\n\r\n", 1000);
+    add_alternate(vector, "GET / HTTP/1.1\r\nUser-Agent: b\r\n\r\n", "HTTP/1.1 200 OK\r\nVary: User-Agent\r\n\r\n", 10);
+    parse(client, HTTP_TYPE_REQUEST, "GET / HTTP/1.1\r\nUser-Agent: a\r\n\r\n");
+
+    CHECK(HttpTransactCache::SelectFromAlternates(&vector, &client, &params) == 0);
+    params.global_user_agent_header = UA;
+    CHECK(HttpTransactCache::SelectFromAlternates(&vector, &client, &params) == 1);
+    params.global_user_agent_header = nullptr;
+  }
+
+  SECTION("ignore Accept-Encoding mismatch")
+  {
+    add_alternate(vector, "GET / HTTP/1.1\r\nAccept-Encoding: gzip\r\n\r\n", "HTTP/1.1 200 OK\r\nVary: Accept-Encoding\r\n\r\n",
+                  1000);
+    add_alternate(vector, "GET / HTTP/1.1\r\nAccept-Encoding: br\r\n\r\n", "HTTP/1.1 200 OK\r\nVary: Accept-Encoding\r\n\r\n", 10);
+    parse(client, HTTP_TYPE_REQUEST, "GET / HTTP/1.1\r\nAccept-Encoding: gzip\r\n\r\n");
+
+    CHECK(HttpTransactCache::SelectFromAlternates(&vector, &client, &params) == 0);
+    params.ignore_accept_encoding_mismatch = 1;
+    CHECK(HttpTransactCache::SelectFromAlternates(&vector, &client, &params) == 1);
+  }
+
+  client.destroy();
+}
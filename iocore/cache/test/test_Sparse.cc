@@ -0,0 +1,307 @@
+/** @file
+
+  Sparse (partial) object tests.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "main.h"
+
+#define SPARSE_URL "http://www.scw22.com/"
+
+constexpr int64_t FRAG_SIZE   = 64 * 1024;
+constexpr int64_t OBJECT_SIZE = 3 * FRAG_SIZE + 1000;
+
+// GLOBAL_DATA is uniform, a pattern is needed to catch data served from the wrong offset.
+static char *SPARSE_DATA = nullptr;
+
+class CacheSparseWriteTest : public CacheTestBase
+{
+public:
+  CacheSparseWriteTest(int64_t offset, int64_t len, CacheTestHandler *cont) : CacheTestBase(cont), _offset(offset), _len(len)
+  {
+    this->_write_buffer = new_MIOBuffer(BUFFER_SIZE_INDEX_4K);
+
+    this->info.create();
+    build_hdrs(this->info, SPARSE_URL);
+  }
+
+  int
+  start_test(int event, void *e) override
+  {
+    HttpCacheKey key = generate_key(this->info);
+
+    HTTPInfo *old_info = &this->old_info;
+    if (!old_info->valid()) {
+      old_info = nullptr;
+    }
+
+    SET_HANDLER(&CacheSparseWriteTest::write_event);
+    cacheProcessor.open_write(this, 0, &key, (CacheHTTPHdr *)this->info.request_get(), old_info);
+    return 0;
+  }
+
+  int
+  write_event(int event, void *e)
+  {
+    switch (event) {
+    case CACHE_EVENT_OPEN_WRITE:
+      this->vc = static_cast<CacheVC *>(e);
+      /* fall through */
+    case VC_EVENT_WRITE_READY:
+    case VC_EVENT_WRITE_COMPLETE:
+      this->process_event(event);
+      break;
+    default:
+      this->close();
+      CHECK(false);
+      break;
+    }
+    return 0;
+  }
+
+  void
+  do_io_write(size_t size = 0) override
+  {
+    if (this->old_info.valid()) {
+      this->info.copy(&this->old_info);
+    } else {
+      REQUIRE(this->info.mark_sparse(OBJECT_SIZE, FRAG_SIZE));
+    }
+    this->vc->set_http_info(&this->info);
+    this->vio = this->vc->do_io_pwrite(this, this->_len, this->_write_buffer->alloc_reader(), this->_offset);
+    this->_write_buffer->write(SPARSE_DATA + this->_offset, this->_len);
+  }
+
+  HTTPInfo info;
+  HTTPInfo old_info;
+
+private:
+  int64_t _offset          = 0;
+  int64_t _len             = 0;
+  MIOBuffer *_write_buffer = nullptr;
+};
+
+class CacheSparseReadTest : public CacheTestBase
+{
+public:
+  CacheSparseReadTest(int64_t offset, int64_t len, int64_t cached, CacheTestHandler *cont)
+    : CacheTestBase(cont), _offset(offset), _len(len), _cached(cached), _pos(offset)
+  {
+    this->_read_buffer = new_MIOBuffer(BUFFER_SIZE_INDEX_4K);
+    this->_reader      = this->_read_buffer->alloc_reader();
+
+    this->info.create();
+    build_hdrs(this->info, SPARSE_URL);
+  }
+
+  int
+  start_test(int event, void *e) override
+  {
+    HttpCacheKey key = generate_key(this->info);
+
+    SET_HANDLER(&CacheSparseReadTest::read_event);
+    cacheProcessor.open_read(this, &key, (CacheHTTPHdr *)this->info.request_get(), &this->params);
+    return 0;
+  }
+
+  int
+  read_event(int event, void *e)
+  {
+    switch (event) {
+    case CACHE_EVENT_OPEN_READ:
+      this->vc = static_cast<CacheVC *>(e);
+      this->process_event(event);
+      break;
+    case VC_EVENT_READ_READY:
+      this->check_data();
+      this->process_event(event);
+      break;
+    case VC_EVENT_READ_COMPLETE:
+    case VC_EVENT_EOS:
+      // a read stops at the first fragment which is not cached
+      this->check_data();
+      CHECK(this->_pos == this->_offset + std::min(this->_len, this->_cached));
+      this->process_event(event);
+      break;
+    default:
+      CHECK(false);
+      this->close();
+      TEST_DONE();
+      break;
+    }
+    return 0;
+  }
+
+  void
+  check_data()
+  {
+    while (this->_reader->block_read_avail()) {
+      auto str = this->_reader->block_read_view();
+      REQUIRE(this->_pos + static_cast<int64_t>(str.size()) <= OBJECT_SIZE);
+      CHECK(memcmp(str.data(), SPARSE_DATA + this->_pos, str.size()) == 0);
+      this->_reader->consume(str.size());
+      this->_pos += str.size();
+    }
+  }
+
+  void
+  do_io_read(size_t size = 0) override
+  {
+    REQUIRE(this->vc->alternate.is_sparse());
+    CHECK(this->vc->alternate.object_size_get() == OBJECT_SIZE);
+    CHECK(this->vc->get_cached_length(this->_offset) == this->_cached);
+    this->vio = this->vc->do_io_pread(this, this->_len, this->_read_buffer, this->_offset);
+  }
+
+  HTTPInfo info;
+
+private:
+  int64_t _offset         = 0;
+  int64_t _len            = 0;
+  int64_t _cached         = 0;
+  int64_t _pos            = 0;
+  MIOBuffer *_read_buffer = nullptr;
+  IOBufferReader *_reader = nullptr;
+  OverridableHttpConfigParams params;
+};
+
+// One step of the test: write a new sparse object, read a range of it, or read the
+// current alternate and write a range which fills in more of it.
+class CacheSparseTest : public CacheTestHandler
+{
+public:
+  enum Step { WRITE, READ, FILL };
+
+  CacheSparseTest(Step step, int64_t offset, int64_t len, int64_t cached = 0)
+  {
+    if (step != WRITE) {
+      this->_rt        = new CacheSparseReadTest(offset, len, cached, this);
+      this->_rt->mutex = this->mutex;
+    }
+    if (step != READ) {
+      this->_wt        = new CacheSparseWriteTest(offset, len, this);
+      this->_wt->mutex = this->mutex;
+    }
+
+    SET_HANDLER(&CacheSparseTest::start_test);
+  }
+
+  int
+  start_test(int event, void *e)
+  {
+    REQUIRE(event == EVENT_IMMEDIATE);
+    this_ethread()->schedule_imm(this->_rt ? this->_rt : this->_wt);
+    return 0;
+  }
+
+  void
+  handle_cache_event(int event, CacheTestBase *base) override
+  {
+    switch (event) {
+    case CACHE_EVENT_OPEN_READ:
+      if (this->_wt) {
+        // fill: update the alternate just read
+        static_cast<CacheSparseWriteTest *>(this->_wt)->old_info.copy(static_cast<HTTPInfo *>(&base->vc->alternate));
+        base->close();
+        this->_rt = nullptr;
+        this_ethread()->schedule_imm(this->_wt);
+      } else {
+        base->do_io_read();
+      }
+      break;
+    case CACHE_EVENT_OPEN_WRITE:
+      base->do_io_write();
+      break;
+    case VC_EVENT_READ_READY:
+    case VC_EVENT_WRITE_READY:
+      base->reenable();
+      break;
+    case VC_EVENT_READ_COMPLETE:
+    case VC_EVENT_WRITE_COMPLETE:
+    case VC_EVENT_EOS:
+      base->close();
+      delete this;
+      break;
+    default:
+      REQUIRE(false);
+      break;
+    }
+  }
+};
+
+class CacheSparseInit : public CacheInit
+{
+public:
+  CacheSparseInit() {}
+  int
+  cache_init_success_callback(int event, void *e) override
+  {
+    SPARSE_DATA = static_cast<char *>(ats_malloc(OBJECT_SIZE));
+    for (int64_t i = 0; i < OBJECT_SIZE; ++i) {
+      SPARSE_DATA[i] = static_cast<char>(i * 7 + i / 4093);
+    }
+
+    // only the third fragment
+    CacheSparseTest *h = new CacheSparseTest(CacheSparseTest::WRITE, 2 * FRAG_SIZE, FRAG_SIZE);
+    h->add(new CacheSparseTest(CacheSparseTest::READ, 2 * FRAG_SIZE, FRAG_SIZE, FRAG_SIZE));
+    // a hole reads as end of stream
+    h->add(new CacheSparseTest(CacheSparseTest::READ, 0, FRAG_SIZE, 0));
+    // fill in the first two fragments, then read across the fragments from inside the first
+    h->add(new CacheSparseTest(CacheSparseTest::FILL, 0, 2 * FRAG_SIZE));
+    h->add(new CacheSparseTest(CacheSparseTest::READ, FRAG_SIZE / 2, 2 * FRAG_SIZE, 3 * FRAG_SIZE - FRAG_SIZE / 2));
+    // a read past the cached range stops at the missing short last fragment
+    h->add(new CacheSparseTest(CacheSparseTest::READ, 0, OBJECT_SIZE, 3 * FRAG_SIZE));
+    h->add(new CacheSparseTest(CacheSparseTest::FILL, 3 * FRAG_SIZE, OBJECT_SIZE - 3 * FRAG_SIZE));
+    h->add(new CacheSparseTest(CacheSparseTest::READ, 0, OBJECT_SIZE, OBJECT_SIZE));
+    h->add(new TerminalTest);
+
+    this_ethread()->schedule_imm(h);
+    delete this;
+    return 0;
+  }
+};
+
+TEST_CASE("sparse fragment table bound", "cache")
+{
+  HTTPInfo info;
+  info.create();
+
+  // 64GB in 64KB fragments would be 1M fragments.
+  constexpr int64_t SIZE = int64_t(1) << 36;
+  REQUIRE(info.mark_sparse(SIZE, FRAG_SIZE));
+  CHECK(info.sparse_frag_size_get() == SIZE / HTTPInfo::SPARSE_MAX_FRAGS);
+  CHECK(info.get_frag_offset_count() == HTTPInfo::SPARSE_MAX_FRAGS - 1);
+  info.destroy();
+
+  info.create();
+  REQUIRE_FALSE(info.mark_sparse(SIZE * 8, FRAG_SIZE));
+  CHECK_FALSE(info.is_sparse());
+  CHECK(info.get_frag_offset_count() == 0);
+  info.destroy();
+}
+
+TEST_CASE("sparse cache write -> read", "cache")
+{
+  init_cache(256 * 1024 * 1024);
+  CacheSparseInit *init = new CacheSparseInit;
+
+  this_ethread()->schedule_imm(init);
+  this_thread()->execute();
+}
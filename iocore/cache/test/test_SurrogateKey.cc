@@ -0,0 +1,139 @@
+/** @file
+
+  Surrogate key invalidation tests.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#define SMALL_FILE 10 * 1024
+#define URL_A "http://www.scw91.com/"
+#define URL_B "http://www.scw92.com/"
+#define URL_C "http://www.scw93.com/"
+
+#include "main.h"
+
+static int64_t
+global_stat(int stat)
+{
+  int64_t v = 0;
+  RecGetGlobalRawStatSum(cache_rsb, stat, &v);
+  return v;
+}
+
+static bool
+cached(const char *url)
+{
+  HTTPInfo info;
+  info.create();
+  build_hdrs(info, url);
+  HttpCacheKey key = generate_key(info);
+  Vol *vol         = caches[CACHE_FRAG_TYPE_HTTP]->key_to_vol(&key.hash, key.hostname, key.hostlen);
+  Dir dir, *last_collision = nullptr;
+  bool found;
+  {
+    SCOPED_MUTEX_LOCK(lock, vol->mutex, this_ethread());
+    found = dir_probe(&key.hash, vol, &dir, &last_collision);
+  }
+  info.destroy();
+  return found;
+}
+
+// Writes the document with its surrogate keys, then reads it back.
+class SurrogateKeyWrite : public CacheTestHandler
+{
+public:
+  SurrogateKeyWrite(const char *url, const char *tags) : CacheTestHandler(SMALL_FILE, url)
+  {
+    HTTPHdr *response = static_cast<CacheWriteTest *>(this->_wt)->info.response_get();
+    response->value_set("Surrogate-Key", 13, tags, strlen(tags));
+  }
+};
+
+class SurrogateKeyInvalidate : public CacheTestHandler
+{
+public:
+  SurrogateKeyInvalidate() { SET_HANDLER(&SurrogateKeyInvalidate::invalidate_event); }
+
+  int
+  invalidate_event(int event, void *e)
+  {
+    CHECK(global_stat(cache_surrogate_key_tags_stat) == 3);
+    CHECK(global_stat(cache_surrogate_key_documents_stat) == 4);
+    CHECK(cacheProcessor.invalidate_tag("b", 1) == 2);
+    CHECK(cacheProcessor.invalidate_tag("b", 1) == 0);
+    CHECK(cacheProcessor.invalidate_tag("d", 1) == 0);
+    CHECK(global_stat(cache_surrogate_key_tags_stat) == 2);
+    CHECK(global_stat(cache_surrogate_key_documents_stat) == 2);
+    CHECK(global_stat(cache_surrogate_key_invalidated_stat) == 2);
+    delete this;
+    return 0;
+  }
+};
+
+// Waits for the removals.
+class SurrogateKeyCheck : public CacheTestHandler
+{
+public:
+  SurrogateKeyCheck() { SET_HANDLER(&SurrogateKeyCheck::check_event); }
+
+  int
+  check_event(int event, void *e)
+  {
+    if (cached(URL_A) || cached(URL_B)) {
+      REQUIRE(++_tries < 500);
+      this_ethread()->schedule_in(this, HRTIME_MSECONDS(10));
+      return 0;
+    }
+    CHECK(cached(URL_C));
+    delete this;
+    return 0;
+  }
+
+private:
+  int _tries = 0;
+};
+
+class SurrogateKeyInit : public CacheInit
+{
+public:
+  SurrogateKeyInit() {}
+  int
+  cache_init_success_callback(int event, void *e) override
+  {
+    CacheTestHandler *h = new SurrogateKeyWrite(URL_A, "a b");
+    h->add(new SurrogateKeyWrite(URL_B, " b  "));
+    h->add(new SurrogateKeyWrite(URL_C, "c"));
+    h->add(new SurrogateKeyInvalidate);
+    h->add(new SurrogateKeyCheck);
+    h->add(new TerminalTest);
+    this_ethread()->schedule_imm(h);
+    delete this;
+    return 0;
+  }
+};
+
+TEST_CASE("cache surrogate key", "cache")
+{
+  RecSetRecordString("proxy.config.cache.surrogate_key.header", const_cast<char *>("Surrogate-Key"), REC_SOURCE_EXPLICIT);
+  init_cache(256 * 1024 * 1024);
+  SurrogateKeyInit *init = new SurrogateKeyInit;
+
+  this_ethread()->schedule_imm(init);
+  this_thread()->execute();
+}
@@ -25,7 +25,12 @@
   UIOBuffer.cc
 
 **************************************************************************/
+#include <atomic>
+#include <mutex>
+#include <vector>
+
 #include "tscore/ink_defs.h"
+#include "tscore/hugepages.h"
 #include "P_EventSystem.h"
 
 //
@@ -59,6 +64,201 @@ init_buffer_allocators(int iobuffer_advice)
   }
 }
 
+//
+// Aligned Buffer Pool
+//
+namespace
+{
+// Slabs are at least this large, or a huge page if that is larger.
+constexpr int64_t ALIGNED_POOL_SLAB_SIZE = 2 * 1024 * 1024;
+
+// Counts kept by one thread, read by others for the stats.
+struct AlignedThreadCounts {
+  std::atomic<int64_t> in_use{0};
+  std::atomic<int64_t> allocs{0};
+  std::atomic<int64_t> cache_hits{0};
+};
+
+inline void
+bump(std::atomic<int64_t> &count, int64_t n)
+{
+  count.store(count.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+struct AlignedThreadCache;
+
+struct AlignedPool {
+  struct SizeClass {
+    std::mutex mutex;
+    std::vector<void *> free;
+  };
+
+  bool hugepages       = false;
+  int64_t thread_cache = 0;
+  SizeClass sizes[DEFAULT_BUFFER_SIZES];
+  std::atomic<int64_t> reserved{0};
+  std::atomic<int64_t> hugepage{0};
+
+  std::mutex threads_mutex;
+  std::vector<AlignedThreadCache *> threads;
+  AlignedBufferPoolStats retired; ///< Counts from threads that have exited.
+
+  /// Most buffers of size @a size_index a thread keeps.
+  size_t
+  limit(int64_t size_index) const
+  {
+    if (cmd_disable_pfreelist) {
+      return 0;
+    }
+    return std::min<int64_t>(thread_freelist_high_watermark, thread_cache / BUFFER_SIZE_FOR_INDEX(size_index));
+  }
+
+  /// Add a slab of buffers of size @a size_index, the size class lock must be held.
+  void
+  grow(int64_t size_index)
+  {
+    int64_t size     = BUFFER_SIZE_FOR_INDEX(size_index);
+    int64_t slab     = std::max(size, ALIGNED_POOL_SLAB_SIZE);
+    char *base       = nullptr;
+    size_t page_size = ats_hugepage_size();
+
+    if (hugepages && page_size > 0) {
+      slab = INK_ALIGN(slab, page_size);
+      if ((base = static_cast<char *>(ats_alloc_hugepage(slab))) != nullptr) {
+        hugepage += slab;
+      }
+    }
+    if (base == nullptr) {
+      slab = INK_ALIGN(slab, ats_pagesize());
+      base = static_cast<char *>(ats_memalign(ats_pagesize(), slab));
+    }
+    reserved += slab;
+
+    std::vector<void *> &list = sizes[size_index].free;
+    for (int64_t offset = slab - size; offset >= 0; offset -= size) {
+      list.push_back(base + offset);
+    }
+  }
+};
+
+AlignedPool &
+aligned_pool()
+{
+  // Never destroyed, the thread caches return their buffers to it as threads exit.
+  static AlignedPool *pool = new AlignedPool;
+  return *pool;
+}
+
+struct AlignedThreadCache {
+  std::vector<void *> free[DEFAULT_BUFFER_SIZES];
+  AlignedThreadCounts counts;
+
+  AlignedThreadCache()
+  {
+    AlignedPool &pool = aligned_pool();
+    std::lock_guard<std::mutex> lock(pool.threads_mutex);
+    pool.threads.push_back(this);
+  }
+
+  ~AlignedThreadCache()
+  {
+    AlignedPool &pool = aligned_pool();
+    for (int i = 0; i < DEFAULT_BUFFER_SIZES; ++i) {
+      this->flush(i, free[i].size());
+    }
+    std::lock_guard<std::mutex> lock(pool.threads_mutex);
+    pool.threads.erase(std::find(pool.threads.begin(), pool.threads.end(), this));
+    pool.retired.in_use += counts.in_use;
+    pool.retired.allocs += counts.allocs;
+    pool.retired.cache_hits += counts.cache_hits;
+  }
+
+  /// Move @a n buffers of size @a size_index from the shared free list.
+  void
+  fill(int64_t size_index, size_t n)
+  {
+    AlignedPool::SizeClass &sc = aligned_pool().sizes[size_index];
+    std::lock_guard<std::mutex> lock(sc.mutex);
+    if (sc.free.empty()) {
+      aligned_pool().grow(size_index);
+    }
+    n = std::min(std::max<size_t>(n, 1), sc.free.size());
+    free[size_index].insert(free[size_index].end(), sc.free.end() - n, sc.free.end());
+    sc.free.resize(sc.free.size() - n);
+  }
+
+  /// Move @a n buffers of size @a size_index to the shared free list.
+  void
+  flush(int64_t size_index, size_t n)
+  {
+    AlignedPool::SizeClass &sc = aligned_pool().sizes[size_index];
+    std::vector<void *> &local = free[size_index];
+    std::lock_guard<std::mutex> lock(sc.mutex);
+    sc.free.insert(sc.free.end(), local.end() - n, local.end());
+    local.resize(local.size() - n);
+  }
+};
+
+thread_local AlignedThreadCache aligned_thread_cache;
+} // namespace
+
+void
+init_aligned_buffer_pool(bool hugepages, int64_t thread_cache)
+{
+  AlignedPool &pool = aligned_pool();
+  pool.hugepages    = hugepages;
+  pool.thread_cache = std::max<int64_t>(thread_cache, 0);
+}
+
+void *
+aligned_buffer_alloc(int64_t size_index)
+{
+  AlignedThreadCache &tc     = aligned_thread_cache;
+  std::vector<void *> &local = tc.free[size_index];
+
+  bump(tc.counts.allocs, 1);
+  bump(tc.counts.in_use, BUFFER_SIZE_FOR_INDEX(size_index));
+  if (local.empty()) {
+    tc.fill(size_index, aligned_pool().limit(size_index) / 2);
+  } else {
+    bump(tc.counts.cache_hits, 1);
+  }
+  void *ptr = local.back();
+  local.pop_back();
+  return ptr;
+}
+
+void
+aligned_buffer_free(void *ptr, int64_t size_index)
+{
+  AlignedThreadCache &tc     = aligned_thread_cache;
+  std::vector<void *> &local = tc.free[size_index];
+  size_t limit               = aligned_pool().limit(size_index);
+
+  bump(tc.counts.in_use, -BUFFER_SIZE_FOR_INDEX(size_index));
+  local.push_back(ptr);
+  if (local.size() > limit) {
+    tc.flush(size_index, local.size() - limit / 2);
+  }
+}
+
+AlignedBufferPoolStats
+aligned_buffer_pool_stats()
+{
+  AlignedPool &pool = aligned_pool();
+  std::lock_guard<std::mutex> lock(pool.threads_mutex);
+  AlignedBufferPoolStats stats = pool.retired;
+
+  stats.reserved = pool.reserved;
+  stats.hugepage = pool.hugepage;
+  for (auto tc : pool.threads) {
+    stats.in_use += tc->counts.in_use.load(std::memory_order_relaxed);
+    stats.allocs += tc->counts.allocs.load(std::memory_order_relaxed);
+    stats.cache_hits += tc->counts.cache_hits.load(std::memory_order_relaxed);
+  }
+  return stats;
+}
+
 //
 // MIOBuffer
 //
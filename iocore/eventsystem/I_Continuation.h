@@ -198,6 +198,16 @@ public:
     thread_affinity = nullptr;
   }
 
+  /**
+    Immediate events of this continuation on the ET_CALL threads may be run by any of them.
+
+    With proxy.config.exec_thread.work_stealing enabled such an event can be taken by an idle
+    thread, and scheduling does not set a thread affinity. Set this only for a continuation with
+    its own lock that depends neither on the thread it runs on nor on running in order with the
+    events of other continuations.
+  */
+  bool thread_stealable = false;
+
   /**
     Receives the event code and data for an Event.
 
@@ -326,6 +326,7 @@ public:
   void execute() override;
   void execute_regular();
   void process_queue(Que(Event, link) * NegativeQueue, int *ev_count, int *nq_count);
+  bool steal_events();
   void process_event(Event *e, int calling_code);
   void free_event(Event *e);
   LoopTailHandler *tail_cb = &DEFAULT_TAIL_HANDLER;
@@ -352,34 +353,21 @@ public:
 
   /** Default handler used until it is overridden.
 
-      This uses the cond var wait in @a ExternalQueue.
+      This waits on the thread's event descriptor if it has one, otherwise on the cond var in @a
+      EventQueueExternal.
   */
   class DefaultTailHandler : public LoopTailHandler
   {
     // cppcheck-suppress noExplicitConstructor; allow implicit conversion
-    DefaultTailHandler(ProtectedQueue &q) : _q(q) {}
-
-    int
-    waitForActivity(ink_hrtime timeout) override
-    {
-      _q.wait(Thread::get_hrtime() + timeout);
-      return 0;
-    }
-    void
-    signalActivity() override
-    {
-      /* Try to acquire the `EThread::lock` of the Event Thread:
-       *   - Acquired, indicating that the Event Thread is sleep,
-       *               must send a wakeup signal to the Event Thread.
-       *   - Failed, indicating that the Event Thread is busy, do nothing.
-       */
-      (void)_q.try_signal();
-    }
-
-    ProtectedQueue &_q;
+    DefaultTailHandler(EThread &t) : _t(t) {}
+
+    int waitForActivity(ink_hrtime timeout) override;
+    void signalActivity() override;
+
+    EThread &_t;
 
     friend class EThread;
-  } DEFAULT_TAIL_HANDLER = EventQueueExternal;
+  } DEFAULT_TAIL_HANDLER = *this;
 
   /// Statistics data for event dispatching.
   struct EventMetrics {
@@ -398,8 +386,10 @@ public:
       Events() {}
     } _events;
 
-    int _count = 0; ///< # of times the loop executed.
-    int _wait  = 0; ///< # of timed wait for events
+    int _count  = 0; ///< # of times the loop executed.
+    int _wait   = 0; ///< # of timed wait for events
+    int _steals = 0; ///< # of events taken from other threads.
+    int _queue  = 0; ///< max # of external events waiting at the start of a loop.
 
     /// Add @a that to @a this data.
     /// This embodies the custom logic per member concerning whether each is a sum, min, or max.
@@ -430,6 +420,8 @@ public:
     STAT_LOOP_WAIT,       ///< # of loops that did a conditional wait.
     STAT_LOOP_TIME_MIN,   ///< Shortest time spent in loop.
     STAT_LOOP_TIME_MAX,   ///< Longest time spent in loop.
+    STAT_LOOP_STEALS,     ///< # of events taken from other threads.
+    STAT_LOOP_QUEUE_MAX,  ///< max # of external events waiting for a thread.
     N_EVENT_STATS         ///< NOT A VALID STAT INDEX - # of different stat types.
   };
 
@@ -477,3 +469,4 @@ operator new(size_t, ink_dummy_for_new *p)
 extern EThread *this_ethread();
 
 extern int thread_max_heartbeat_mseconds;
+extern int thread_work_stealing;
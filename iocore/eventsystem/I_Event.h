@@ -209,7 +209,8 @@ public:
   unsigned int immediate : 1;
   unsigned int globally_allocated : 1;
   unsigned int in_heap : 4;
-  int callback_event = 0;
+  int callback_event    = 0;
+  uint32_t external_seq = 0; ///< Order in which the event was pushed to the external queue of @a ethread.
 
   ink_hrtime timeout_at = 0;
   ink_hrtime period     = 0;
@@ -56,6 +56,7 @@ enum AllocType {
   NO_ALLOC,
   MEMALIGNED,
   DEFAULT_ALLOC,
+  POOL_ALIGNED,
 };
 
 #define DEFAULT_BUFFER_NUMBER 128
@@ -113,6 +114,34 @@ inkcoreapi extern Allocator ioBufAllocator[DEFAULT_BUFFER_SIZES];
 
 void init_buffer_allocators(int iobuffer_advice);
 
+/*
+  Aligned buffer pool for disk I/O, kept apart from the network buffers in
+  ioBufAllocator. Buffers of the fast allocated sizes are carved out of large
+  slabs, backed by huge pages if that is enabled for the pool, so a large cache
+  working set needs far fewer TLB entries. Buffers are aligned to their size, up
+  to the page size. Each thread keeps some free buffers of each size so an alloc
+  and free on the same thread do not touch shared state.
+*/
+struct AlignedBufferPoolStats {
+  int64_t reserved   = 0; ///< Bytes in slabs.
+  int64_t hugepage   = 0; ///< Bytes in slabs backed by huge pages.
+  int64_t in_use     = 0; ///< Bytes handed out and not yet freed.
+  int64_t allocs     = 0; ///< Buffers handed out.
+  int64_t cache_hits = 0; ///< Buffers handed out from a thread cache.
+};
+
+/** Set up the aligned buffer pool.
+
+    @a hugepages backs the slabs with huge pages when the system has them. @a thread_cache is the
+    number of bytes of each buffer size a thread may keep, zero to disable the thread caches. This
+    must be called before any buffer is allocated from the pool.
+ */
+void init_aligned_buffer_pool(bool hugepages, int64_t thread_cache);
+void *aligned_buffer_alloc(int64_t size_index);
+void aligned_buffer_free(void *ptr, int64_t size_index);
+/// Counts summed over all threads.
+AlignedBufferPoolStats aligned_buffer_pool_stats();
+
 /**
   A reference counted wrapper around fast allocated or malloced memory.
   The IOBufferData class provides two basic services around a portion
@@ -140,6 +169,10 @@ void init_buffer_allocators(int iobuffer_advice);
       <td>DEFAULT_ALLOC</td>
       <td></td>
     </tr>
+    <tr>
+      <td>POOL_ALIGNED</td>
+      <td>From the aligned buffer pool, for disk I/O.</td>
+    </tr>
   </table>
 
  */
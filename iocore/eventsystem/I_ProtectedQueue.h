@@ -24,29 +24,61 @@
 /****************************************************************************
 
   Protected Queue, a FIFO queue with the following functionality:
-  (1). Multiple threads could be simultaneously trying to enqueue
-       and dequeue. Hence the queue needs to be protected with mutex.
+  (1). Multiple threads could be simultaneously trying to enqueue, only
+       the owning thread dequeues. Enqueue is a lock free push.
   (2). In case the queue is empty, dequeue() sleeps for a specified
        amount of time, or until a new element is inserted, whichever
-       is earlier
+       is earlier. Only the first enqueue after the owning thread has
+       gone to sleep wakes it up.
+  (3). Events that may run on any thread of the group are kept apart,
+       an idle thread can take them while the owning thread is busy.
 
 
  ****************************************************************************/
 #pragma once
 
+#include <atomic>
+
 #include "tscore/ink_platform.h"
 #include "I_Event.h"
 struct ProtectedQueue {
   void enqueue(Event *e);
+  void enqueue_shared(Event *e); // As enqueue, but another thread may take @a e with @c steal.
   void signal();
   int try_signal();             // Use non blocking lock and if acquired, signal
   void enqueue_local(Event *e); // Safe when called from the same thread
-  void remove(Event *e);
   Event *dequeue_local();
-  void dequeue_external();       // Dequeue any external events.
   void wait(ink_hrtime timeout); // Wait for @a timeout nanoseconds on a condition variable if there are no events.
 
-  InkAtomicList al;
+  /** Move the external events to the local queue, in the order each producer pushed them.
+
+      The shared events are interleaved with the others by their number. An event numbered after
+      the dequeue started can follow an event of the same producer that is not pushed yet, if
+      there are shared events such an event is held back until the next dequeue.
+
+      @return The number of events taken.
+   */
+  int dequeue_external();
+
+  /** Take the shared events of this queue, from any thread.
+
+      @return The events, oldest first, linked through @c Event::link.
+   */
+  Event *steal();
+
+  /** Mark the owning thread as about to sleep, so the next @c enqueue wakes it.
+
+      @return @c false if there are external events already, the thread should not sleep.
+   */
+  bool prepare_sleep();
+  /// Mark the owning thread as awake, @c enqueue does not need to wake it.
+  void end_sleep();
+
+  std::atomic<Event *> head{nullptr};   ///< External events, most recent first.
+  std::atomic<Event *> shared{nullptr}; ///< Events any thread of the group may run, most recent first.
+  std::atomic<uint32_t> pushed{0};      ///< Numbers the events pushed to @c head and @c shared.
+  std::atomic<bool> sleeping{false};    ///< The owning thread is, or is about to be, waiting for activity.
+  Event *held = nullptr; ///< Events taken too early to be ordered, see @c dequeue_external. Owning thread only.
   ink_mutex lock;
   ink_cond might_have_data;
   Que(Event, link) localQueue;
@@ -31,6 +31,7 @@
 #pragma once
 
 #include "tscore/ink_platform.h"
+#include "tscore/ink_queue.h"
 
 class EThread;
 
@@ -114,15 +115,16 @@ void thread_freeup(Allocator &a, ProxyAllocator &l);
 
 #define THREAD_ALLOC(_a, _t) thread_alloc(::_a, _t->_a)
 #define THREAD_ALLOC_INIT(_a, _t) thread_alloc_init(::_a, _t->_a)
-#define THREAD_FREE(_p, _a, _t)                              \
-  if (!cmd_disable_pfreelist) {                              \
-    do {                                                     \
-      *(char **)_p    = (char *)_t->_a.freelist;             \
-      _t->_a.freelist = _p;                                  \
-      _t->_a.allocated++;                                    \
-      if (_t->_a.allocated > thread_freelist_high_watermark) \
-        thread_freeup(::_a, _t->_a);                         \
-    } while (0);                                             \
-  } else {                                                   \
-    thread_free(::_a, _p);                                   \
+// Memory of another NUMA node goes back to the global freelist rather than being reused on this one.
+#define THREAD_FREE(_p, _a, _t)                                  \
+  if (!cmd_disable_pfreelist && !ink_freelist_numa_remote(_p)) { \
+    do {                                                         \
+      *(char **)_p    = (char *)_t->_a.freelist;                 \
+      _t->_a.freelist = _p;                                      \
+      _t->_a.allocated++;                                        \
+      if (_t->_a.allocated > thread_freelist_high_watermark)     \
+        thread_freeup(::_a, _t->_a);                             \
+    } while (0);                                                 \
+  } else {                                                       \
+    thread_free(::_a, _p);                                       \
   }
@@ -245,6 +245,13 @@ IOBufferData::alloc(int64_t size_index, AllocType type)
       _data = (char *)ats_memalign(ats_pagesize(), index_to_buffer_size(size_index));
     }
     break;
+  case POOL_ALIGNED:
+    if (BUFFER_SIZE_INDEX_IS_FAST_ALLOCATED(size_index)) {
+      _data = (char *)aligned_buffer_alloc(size_index);
+    } else if (BUFFER_SIZE_INDEX_IS_XMALLOCED(size_index)) {
+      _data = (char *)ats_memalign(ats_pagesize(), index_to_buffer_size(size_index));
+    }
+    break;
   default:
   case DEFAULT_ALLOC:
     if (BUFFER_SIZE_INDEX_IS_FAST_ALLOCATED(size_index)) {
@@ -270,6 +277,13 @@ IOBufferData::dealloc()
       ::free((void *)_data);
     }
     break;
+  case POOL_ALIGNED:
+    if (BUFFER_SIZE_INDEX_IS_FAST_ALLOCATED(_size_index)) {
+      aligned_buffer_free(_data, _size_index);
+    } else if (BUFFER_SIZE_INDEX_IS_XMALLOCED(_size_index)) {
+      ::free((void *)_data);
+    }
+    break;
   default:
   case DEFAULT_ALLOC:
     if (BUFFER_SIZE_INDEX_IS_FAST_ALLOCATED(_size_index)) {
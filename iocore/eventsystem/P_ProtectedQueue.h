@@ -34,9 +34,7 @@
 TS_INLINE
 ProtectedQueue::ProtectedQueue()
 {
-  Event e;
   ink_mutex_init(&lock);
-  ink_atomiclist_init(&al, "ProtectedQueue", (char *)&e.link.next - (char *)&e);
   ink_cond_init(&might_have_data);
 }
 
@@ -71,16 +69,6 @@ ProtectedQueue::enqueue_local(Event *e)
   localQueue.enqueue(e);
 }
 
-TS_INLINE void
-ProtectedQueue::remove(Event *e)
-{
-  ink_assert(e->in_the_prot_queue);
-  if (!ink_atomiclist_remove(&al, e)) {
-    localQueue.remove(e);
-  }
-  e->in_the_prot_queue = 0;
-}
-
 TS_INLINE Event *
 ProtectedQueue::dequeue_local()
 {
@@ -91,3 +79,21 @@ ProtectedQueue::dequeue_local()
   }
   return e;
 }
+
+TS_INLINE bool
+ProtectedQueue::prepare_sleep()
+{
+  // Paired with the push in enqueue, either this sees the event or the producer sees the flag.
+  sleeping.store(true);
+  if (head.load() != nullptr || shared.load() != nullptr || held != nullptr) {
+    sleeping.store(false);
+    return false;
+  }
+  return true;
+}
+
+TS_INLINE void
+ProtectedQueue::end_sleep()
+{
+  sleeping.store(false, std::memory_order_relaxed);
+}
@@ -99,6 +99,10 @@ EventProcessor::schedule(Event *e, EventType etype)
 
   EThread *affinity_thread = e->continuation->getThreadAffinity();
   EThread *curr_thread     = this_ethread();
+  // An immediate event for a continuation that asked for it, is not tied to a thread and has a lock to keep its events
+  // apart, may be run by any thread of the group.
+  bool shared = thread_work_stealing && etype == ET_CALL && e->continuation->thread_stealable && affinity_thread == nullptr &&
+                e->timeout_at == 0 && e->continuation->mutex;
   if (affinity_thread != nullptr && affinity_thread->is_event_type(etype)) {
     e->ethread = affinity_thread;
   } else {
@@ -108,7 +112,7 @@ EventProcessor::schedule(Event *e, EventType etype)
     } else {
       e->ethread = assign_thread(etype);
     }
-    if (affinity_thread == nullptr) {
+    if (affinity_thread == nullptr && !shared) {
       e->continuation->setThreadAffinity(e->ethread);
     }
   }
@@ -117,7 +121,9 @@ EventProcessor::schedule(Event *e, EventType etype)
     e->mutex = e->continuation->mutex;
   }
 
-  if (curr_thread != nullptr && e->ethread == curr_thread) {
+  if (shared) {
+    e->ethread->EventQueueExternal.enqueue_shared(e);
+  } else if (curr_thread != nullptr && e->ethread == curr_thread) {
     e->ethread->EventQueueExternal.enqueue_local(e);
   } else {
     e->ethread->EventQueueExternal.enqueue(e);
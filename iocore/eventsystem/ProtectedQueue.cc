@@ -23,8 +23,9 @@
   @section details Details
 
   ProtectedQueue implements a FIFO queue with the following functionality:
-    -# Multiple threads could be simultaneously trying to enqueue and
-      dequeue. Hence the queue needs to be protected with mutex.
+    -# Multiple threads could be simultaneously trying to enqueue, only the
+      owning thread dequeues. Enqueue pushes on to a lock free stack which
+      the owning thread takes all at once.
     -# In case the queue is empty, dequeue() sleeps for a specified amount
       of time, or until a new element is inserted, whichever is earlier.
 
@@ -43,43 +44,118 @@
 
 extern ClassAllocator<Event> eventAllocator;
 
+namespace
+{
+void
+push(std::atomic<Event *> &stack, std::atomic<uint32_t> &pushed, Event *e)
+{
+  // Numbered before the push, so an event of the same producer pushed after @a e has a larger number.
+  e->external_seq = pushed.fetch_add(1);
+  Event *top      = stack.load(std::memory_order_relaxed);
+  do {
+    e->link.next = top;
+  } while (!stack.compare_exchange_weak(top, e));
+}
+
+/// Take all of @a stack, oldest first.
+Event *
+pop_all(std::atomic<Event *> &stack)
+{
+  Event *e = stack.exchange(nullptr, std::memory_order_acquire);
+  // invert the list, to preserve order
+  SLL<Event, Event::Link_link> l, t;
+  t.head = e;
+  while ((e = t.pop())) {
+    l.push(e);
+  }
+  return l.head;
+}
+
+/// Merge @a a and @a b, lower numbers first.
+Event *
+merge(Event *a, Event *b)
+{
+  Event *head  = nullptr;
+  Event **tail = &head;
+  while (a && b) {
+    Event *&first = static_cast<int32_t>(a->external_seq - b->external_seq) <= 0 ? a : b;
+    *tail         = first;
+    tail          = &first->link.next;
+    first         = first->link.next;
+  }
+  *tail = a ? a : b;
+  return head;
+}
+} // namespace
+
 void
 ProtectedQueue::enqueue(Event *e)
 {
   ink_assert(!e->in_the_prot_queue && !e->in_the_priority_queue);
   EThread *e_ethread   = e->ethread;
   e->in_the_prot_queue = 1;
-  bool was_empty       = (ink_atomiclist_push(&al, e) == nullptr);
-
-  if (was_empty) {
-    EThread *inserting_thread = this_ethread();
-    // queue e->ethread in the list of threads to be signalled
-    // inserting_thread == 0 means it is not a regular EThread
-    if (inserting_thread != e_ethread) {
-      e_ethread->tail_cb->signalActivity();
-    }
+  push(head, pushed, e);
+
+  // Only wake the thread if it is going to sleep, and only once for all the events pushed meanwhile. A
+  // thread that is awake takes the events before it sleeps again.
+  // this_ethread() == nullptr means it is not a regular EThread
+  if (this_ethread() != e_ethread && sleeping.load() && sleeping.exchange(false)) {
+    e_ethread->tail_cb->signalActivity();
   }
 }
 
 void
+ProtectedQueue::enqueue_shared(Event *e)
+{
+  ink_assert(!e->in_the_prot_queue && !e->in_the_priority_queue);
+  EThread *e_ethread   = e->ethread;
+  e->in_the_prot_queue = 1;
+  push(shared, pushed, e);
+
+  if (this_ethread() != e_ethread && sleeping.load() && sleeping.exchange(false)) {
+    e_ethread->tail_cb->signalActivity();
+  }
+}
+
+Event *
+ProtectedQueue::steal()
+{
+  return shared.load(std::memory_order_relaxed) ? pop_all(shared) : nullptr;
+}
+
+int
 ProtectedQueue::dequeue_external()
 {
-  Event *e = static_cast<Event *>(ink_atomiclist_popall(&al));
-  // invert the list, to preserve order
-  SLL<Event, Event::Link_link> l, t;
-  t.head = e;
-  while ((e = t.pop())) {
-    l.push(e);
+  // An event numbered from here on can follow an event of the same producer that is not pushed yet.
+  uint32_t limit = pushed.load();
+  Event *e       = pop_all(head);
+  bool merged    = held != nullptr || shared.load() != nullptr;
+  if (merged) {
+    e    = merge(merge(held, pop_all(shared)), e);
+    held = nullptr;
   }
+
   // insert into localQueue
-  while ((e = l.pop())) {
-    if (!e->cancelled) {
-      localQueue.enqueue(e);
+  Event **held_tail = &held;
+  int count         = 0;
+  while (e) {
+    Event *next  = e->link.next;
+    e->link.next = nullptr;
+    if (merged && static_cast<int32_t>(e->external_seq - limit) >= 0) {
+      *held_tail = e;
+      held_tail  = &e->link.next;
     } else {
-      e->mutex = nullptr;
-      eventAllocator.free(e);
+      ++count;
+      if (!e->cancelled) {
+        localQueue.enqueue(e);
+      } else {
+        e->mutex = nullptr;
+        eventAllocator.free(e);
+      }
     }
+    e = next;
   }
+  return count;
 }
 
 void
@@ -91,7 +167,7 @@ ProtectedQueue::wait(ink_hrtime timeout)
    *   - And then the Event Thread goes to sleep and waits for the wakeup signal of `EThread::might_have_data`,
    *   - The `EThread::lock` will be locked again when the Event Thread wakes up.
    */
-  if (INK_ATOMICLIST_EMPTY(al) && localQueue.empty()) {
+  if (head.load() == nullptr && shared.load() == nullptr && held == nullptr && localQueue.empty()) {
     timespec ts = ink_hrtime_to_timespec(timeout);
     ink_cond_timedwait(&might_have_data, &lock, &ts);
   }
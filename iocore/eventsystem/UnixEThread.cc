@@ -31,6 +31,7 @@
 #include "P_EventSystem.h"
 
 #if HAVE_EVENTFD
+#include <poll.h>
 #include <sys/eventfd.h>
 #endif
 
@@ -45,11 +46,13 @@ struct AIOCallback;
 char const *const EThread::STAT_NAME[] = {"proxy.process.eventloop.count",      "proxy.process.eventloop.events",
                                           "proxy.process.eventloop.events.min", "proxy.process.eventloop.events.max",
                                           "proxy.process.eventloop.wait",       "proxy.process.eventloop.time.min",
-                                          "proxy.process.eventloop.time.max"};
+                                          "proxy.process.eventloop.time.max",   "proxy.process.eventloop.steals",
+                                          "proxy.process.eventloop.queue.max"};
 
 int const EThread::SAMPLE_COUNT[N_EVENT_TIMESCALES] = {10, 100, 1000};
 
 int thread_max_heartbeat_mseconds = THREAD_MAX_HEARTBEAT_MSECONDS;
+int thread_work_stealing          = 0;
 
 // To define a class inherits from Thread:
 //   1) Define an independent ink_thread_key
@@ -186,7 +189,10 @@ EThread::process_queue(Que(Event, link) * NegativeQueue, int *ev_count, int *nq_
   Event *e;
 
   // Move events from the external thread safe queues to the local queue.
-  EventQueueExternal.dequeue_external();
+  int queued = EventQueueExternal.dequeue_external();
+  if (queued > current_metric->_queue) {
+    current_metric->_queue = queued;
+  }
 
   // execute all the available external events that have
   // already been dequeued
@@ -216,6 +222,41 @@ EThread::process_queue(Que(Event, link) * NegativeQueue, int *ev_count, int *nq_
   }
 }
 
+/** Take the shared events of a busy thread in the same group.
+
+    Only immediate events on the ET_CALL threads for continuations marked @c thread_stealable are
+    shared, see @c EventProcessor::schedule. A thread that is waiting for activity runs its own shared
+    events soon enough, so only a thread that is busy is stolen from.
+ */
+bool
+EThread::steal_events()
+{
+  auto threads = eventProcessor.active_group_threads(ET_CALL);
+  size_t n     = threads.end() - threads.begin();
+  if (n < 2 || !this->is_event_type(ET_CALL)) {
+    return false;
+  }
+  // Start after this thread so the thieves do not all go for the same victim.
+  for (size_t i = 1; i < n; ++i) {
+    EThread *victim = threads.begin()[(id + i) % n];
+    if (victim == nullptr || victim == this || victim->EventQueueExternal.sleeping.load(std::memory_order_relaxed)) {
+      continue;
+    }
+    if (Event *e = victim->EventQueueExternal.steal(); e) {
+      while (e) {
+        Event *next  = e->link.next;
+        e->link.next = nullptr;
+        e->ethread   = this;
+        EventQueueExternal.localQueue.enqueue(e);
+        ++(current_metric->_steals);
+        e = next;
+      }
+      return true;
+    }
+  }
+  return false;
+}
+
 void
 EThread::execute_regular()
 {
@@ -300,7 +341,16 @@ EThread::execute_regular()
       sleep_time = 0;
     }
 
+    // Rather than sleep, run the events a busy thread has not got to yet.
+    if (sleep_time > 0 && thread_work_stealing && this->steal_events()) {
+      sleep_time = 0;
+    }
+    // Producers only signal a thread that is about to sleep, so recheck for events that were pushed before that.
+    if (sleep_time > 0 && !EventQueueExternal.prepare_sleep()) {
+      sleep_time = 0;
+    }
     tail_cb->waitForActivity(sleep_time);
+    EventQueueExternal.end_sleep();
 
     // loop cleanup
     loop_finish_time = Thread::get_hrtime_updated();
@@ -375,6 +425,43 @@ EThread::execute()
   // coverity[missing_unlock]
 }
 
+int
+EThread::DefaultTailHandler::waitForActivity(ink_hrtime timeout)
+{
+#if HAVE_EVENTFD
+  if (_t.evfd != ts::NO_FD) {
+    // A signal left over from a pass that did not sleep just makes this return at once.
+    pollfd pfd{_t.evfd, POLLIN, 0};
+    timespec ts = ink_hrtime_to_timespec(timeout);
+    if (timeout > 0 && ppoll(&pfd, 1, &ts, nullptr) > 0 && (pfd.revents & POLLIN)) {
+      uint64_t counter;
+      ATS_UNUSED_RETURN(read(_t.evfd, &counter, sizeof(counter)));
+    }
+    return 0;
+  }
+#endif
+  _t.EventQueueExternal.wait(Thread::get_hrtime() + timeout);
+  return 0;
+}
+
+void
+EThread::DefaultTailHandler::signalActivity()
+{
+#if HAVE_EVENTFD
+  if (_t.evfd != ts::NO_FD) {
+    uint64_t counter = 1;
+    ATS_UNUSED_RETURN(write(_t.evfd, &counter, sizeof(counter)));
+    return;
+  }
+#endif
+  /* Try to acquire the `EThread::lock` of the Event Thread:
+   *   - Acquired, indicating that the Event Thread is sleep,
+   *               must send a wakeup signal to the Event Thread.
+   *   - Failed, indicating that the Event Thread is busy, do nothing.
+   */
+  (void)_t.EventQueueExternal.try_signal();
+}
+
 EThread::EventMetrics &
 EThread::EventMetrics::operator+=(EventMetrics const &that)
 {
@@ -385,6 +472,8 @@ EThread::EventMetrics::operator+=(EventMetrics const &that)
   this->_loop_time._max = std::max(this->_loop_time._max, that._loop_time._max);
   this->_count += that._count;
   this->_wait += that._wait;
+  this->_steals += that._steals;
+  this->_queue = std::max(this->_queue, that._queue);
   return *this;
 }
 
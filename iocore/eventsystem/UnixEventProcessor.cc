@@ -112,12 +112,30 @@ EventMetricStatSync(const char *, RecDataT, RecData *, RecRawStatBlock *rsb, int
     rsb->global[id + EThread::STAT_LOOP_EVENTS_MAX]->sum   = m->_events._max;
     rsb->global[id + EThread::STAT_LOOP_EVENTS_MAX]->count = 1;
     RecRawStatUpdateSum(rsb, id + EThread::STAT_LOOP_EVENTS_MAX);
+
+    rsb->global[id + EThread::STAT_LOOP_STEALS]->sum   = m->_steals;
+    rsb->global[id + EThread::STAT_LOOP_STEALS]->count = 1;
+    RecRawStatUpdateSum(rsb, id + EThread::STAT_LOOP_STEALS);
+    rsb->global[id + EThread::STAT_LOOP_QUEUE_MAX]->sum   = m->_queue;
+    rsb->global[id + EThread::STAT_LOOP_QUEUE_MAX]->count = 1;
+    RecRawStatUpdateSum(rsb, id + EThread::STAT_LOOP_QUEUE_MAX);
   }
 
   ink_mutex_release(&(rsb->mutex));
   return REC_ERR_OKAY;
 }
 
+int
+FreelistStatSync(const char *, RecDataT, RecData *, RecRawStatBlock *rsb, int id)
+{
+  ink_mutex_acquire(&(rsb->mutex));
+  rsb->global[id]->sum   = ink_freelists_numa_remote_frees();
+  rsb->global[id]->count = 1;
+  RecRawStatUpdateSum(rsb, id);
+  ink_mutex_release(&(rsb->mutex));
+  return REC_ERR_OKAY;
+}
+
 /// This is a wrapper used to convert a static function into a continuation. The function pointer is
 /// passed in the cookie. For this reason the class is used as a singleton.
 /// @internal This is the implementation for @c schedule_spawn... overloads.
@@ -200,6 +218,16 @@ ThreadAffinityInitializer::set_affinity(int, Event *)
     Debug("iocore_thread", "EThread: %d %s: %d", _name, obj->logical_index);
 #endif // HWLOC_API_VERSION
     hwloc_set_thread_cpubind(ink_get_topology(), t->tid, obj->cpuset, HWLOC_CPUBIND_STRICT);
+
+    // If the thread is inside one NUMA node, allocate from the freelists of that node.
+    for (int i = 0; ink_freelist_numa_nodes && i < hwloc_get_nbobjs_by_type(ink_get_topology(), HWLOC_OBJ_NODE); ++i) {
+      hwloc_obj_t node = hwloc_get_obj_by_type(ink_get_topology(), HWLOC_OBJ_NODE, i);
+      if (hwloc_bitmap_isincluded(obj->cpuset, node->cpuset)) {
+        ink_freelist_set_thread_node(i);
+        Debug("iocore_thread", "EThread: %p allocates from NUMA node %d", t, ink_freelist_thread_node());
+        break;
+      }
+    }
   } else {
     Warning("hwloc returned an unexpected number of objects -- CPU affinity disabled");
   }
@@ -452,6 +480,11 @@ EventProcessor::start(int n_event_threads, size_t stacksize)
   // Name must be that of a stat, pick one at random since we do all of them in one pass/callback.
   RecRegisterRawStatSyncCb(name, EventMetricStatSync, rsb, 0);
 
+  // Frees of freelist items by a thread of another NUMA node, summed over the freelists.
+  rsb = RecAllocateRawStatBlock(1);
+  RecRegisterRawStat(rsb, RECT_PROCESS, "proxy.process.allocator.numa.remote_frees", RECD_COUNTER, RECP_NON_PERSISTENT, 0, NULL);
+  RecRegisterRawStatSyncCb("proxy.process.allocator.numa.remote_frees", FreelistStatSync, rsb, 0);
+
   this->spawn_event_threads(ET_CALL, n_event_threads, stacksize);
 
   Debug("iocore_thread", "Created event thread group id %d with %d threads", ET_CALL, n_event_threads);
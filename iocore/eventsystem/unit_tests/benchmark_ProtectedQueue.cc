@@ -0,0 +1,179 @@
+/** @file
+
+  Cross thread event benchmark.
+
+  Measures the external event queue of an event thread. Producer threads schedule events on to one
+  event thread as fast as they can, which gives the handoff throughput, then single events are
+  scheduled on to the idle thread, which gives the time to wake it up. For example
+
+    benchmark_ProtectedQueue --producers 8 --events 1000000 --pings 5000
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <cinttypes>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "I_EventSystem.h"
+#include "tscore/ink_args.h"
+#include "tscore/I_Layout.h"
+#include "tscore/I_Version.h"
+
+#include "diags.i"
+
+namespace
+{
+// Command line.
+int n_producers = 4;
+int n_events    = 1000000; // per producer
+int n_pings     = 2000;
+int interval    = 500; // usec
+
+const ArgumentDescription argument_descriptions[] = {
+  {"producers", 'p', "Number of threads scheduling events", "I", &n_producers, nullptr, nullptr},
+  {"events", 'e', "Number of events each producer schedules", "I", &n_events, nullptr, nullptr},
+  {"pings", 'n', "Number of single events to time the wake up of the thread", "I", &n_pings, nullptr, nullptr},
+  {"interval", 'i', "Microseconds between the single events, for the thread to go to sleep", "I", &interval, nullptr, nullptr},
+  HELP_ARGUMENT_DESCRIPTION(),
+  VERSION_ARGUMENT_DESCRIPTION(),
+};
+
+AppVersionInfo appVersionInfo;
+
+/// Counts the events scheduled by one producer, each has its own so they do not share a mutex.
+struct Sink : public Continuation {
+  Sink() : Continuation(new_ProxyMutex()) { SET_HANDLER(&Sink::handle); }
+
+  int
+  handle(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+  {
+    handled.store(handled.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    return EVENT_DONE;
+  }
+
+  std::atomic<uint64_t> handled{0};
+};
+
+/// Records when it is called back.
+struct Ping : public Continuation {
+  Ping() : Continuation(new_ProxyMutex()) { SET_HANDLER(&Ping::handle); }
+
+  int
+  handle(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+  {
+    received.store(Thread::get_hrtime_updated(), std::memory_order_release);
+    return EVENT_DONE;
+  }
+
+  std::atomic<ink_hrtime> received{0};
+};
+
+void
+run_throughput(EThread *target)
+{
+  std::vector<Sink *> sinks;
+  std::vector<std::thread> producers;
+
+  for (int i = 0; i < n_producers; ++i) {
+    sinks.push_back(new Sink);
+  }
+  ink_hrtime start = Thread::get_hrtime_updated();
+  for (int i = 0; i < n_producers; ++i) {
+    producers.emplace_back([target, sink = sinks[i]]() {
+      for (int k = 0; k < n_events; ++k) {
+        target->schedule_imm(sink);
+      }
+    });
+  }
+  for (auto &t : producers) {
+    t.join();
+  }
+  ink_hrtime pushed = Thread::get_hrtime_updated();
+  for (auto sink : sinks) {
+    while (sink->handled.load(std::memory_order_acquire) < static_cast<uint64_t>(n_events)) {
+      std::this_thread::yield();
+    }
+  }
+  ink_hrtime done = Thread::get_hrtime_updated();
+
+  double total = static_cast<double>(n_producers) * n_events;
+  printf("%-12s %10s %12s %12s\n", "producers", "events", "enqueue/sec", "handled/sec");
+  printf("%-12d %10.0f %12.0f %12.0f\n", n_producers, total, total / (ink_hrtime_to_usec(pushed - start) / 1e6),
+         total / (ink_hrtime_to_usec(done - start) / 1e6));
+}
+
+void
+run_wake(EThread *target)
+{
+  Ping *ping = new Ping;
+  std::vector<ink_hrtime> usecs;
+
+  usecs.reserve(n_pings);
+  for (int i = 0; i < n_pings; ++i) {
+    usleep(interval);
+    ping->received.store(0, std::memory_order_relaxed);
+    ink_hrtime sent = Thread::get_hrtime_updated();
+    target->schedule_imm(ping);
+    ink_hrtime received;
+    while ((received = ping->received.load(std::memory_order_acquire)) == 0) {
+      std::this_thread::yield();
+    }
+    usecs.push_back(ink_hrtime_to_usec(received - sent));
+  }
+  if (usecs.empty()) {
+    return;
+  }
+  std::sort(usecs.begin(), usecs.end());
+  auto pct = [&](double p) { return usecs[std::min<size_t>(usecs.size() - 1, usecs.size() * p)]; };
+  printf("%-12s %10s %9s %9s %9s %9s\n", "wake", "count", "p50(us)", "p90(us)", "p99(us)", "max(us)");
+  printf("%-12s %10zu %9" PRId64 " %9" PRId64 " %9" PRId64 " %9" PRId64 "\n", "", usecs.size(), pct(0.5), pct(0.9), pct(0.99),
+         usecs.back());
+}
+} // namespace
+
+int
+main(int /* argc ATS_UNUSED */, const char **argv)
+{
+  appVersionInfo.setup(PACKAGE_NAME, "benchmark_ProtectedQueue", PACKAGE_VERSION, __DATE__, __TIME__, BUILD_MACHINE, BUILD_PERSON,
+                       "");
+  process_args(&appVersionInfo, argument_descriptions, countof(argument_descriptions), argv);
+  n_producers = std::max(n_producers, 1);
+
+  Layout::create();
+  init_diags("", nullptr);
+  RecProcessInit(RECM_STAND_ALONE);
+
+  ink_event_system_init(EVENT_SYSTEM_MODULE_PUBLIC_VERSION);
+  eventProcessor.start(1, 1048576); // Hardcoded stacksize at 1MB
+
+  EThread *main_thread = new EThread;
+  main_thread->set_specific();
+
+  EThread *target = eventProcessor.assign_thread(ET_CALL);
+  run_throughput(target);
+  run_wake(target);
+
+  fflush(stdout);
+  ::_exit(0);
+}
@@ -24,6 +24,10 @@
 #define CATCH_CONFIG_MAIN
 #include "catch.hpp"
 
+#include <condition_variable>
+#include <mutex>
+#include <vector>
+
 #include "I_EventSystem.h"
 #include "tscore/I_Layout.h"
 #include "tscore/TSSystemState.h"
@@ -32,6 +36,135 @@
 
 #define TEST_TIME_SECOND 60
 #define TEST_THREADS 2
+#define TEST_TASKS 16
+
+// Must run before EventSystem, which shuts the event system down.
+TEST_CASE("EventSystemWorkStealing", "[iocore]")
+{
+  static std::mutex m;
+  static std::condition_variable cv;
+  static int done;
+  static int moved;
+  static EThread *busy_thread;
+  static EThread *control_thread;
+
+  struct task : public Continuation {
+    task() : Continuation(new_ProxyMutex())
+    {
+      SET_HANDLER(&task::run);
+      thread_stealable = true;
+    }
+
+    int
+    run(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+    {
+      std::lock_guard<std::mutex> lock(m);
+      if (this_ethread() != busy_thread) {
+        ++moved;
+      }
+      ++done;
+      cv.notify_all();
+      delete this;
+      return 0;
+    }
+  };
+
+  // Not marked, so it waits for the busy thread.
+  struct control : public Continuation {
+    control() : Continuation(new_ProxyMutex()) { SET_HANDLER(&control::run); }
+
+    int
+    run(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+    {
+      std::lock_guard<std::mutex> lock(m);
+      control_thread = this_ethread();
+      cv.notify_all();
+      delete this;
+      return 0;
+    }
+  };
+
+  // Schedules the tasks on its own thread and then blocks it until they are done, only another thread can run them.
+  struct hog : public Continuation {
+    hog() : Continuation(new_ProxyMutex()) { SET_HANDLER(&hog::run); }
+
+    int
+    run(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+    {
+      std::unique_lock<std::mutex> lock(m);
+      busy_thread = this_ethread();
+      eventProcessor.schedule_imm(new control, ET_CALL);
+      for (int i = 0; i < TEST_TASKS; ++i) {
+        eventProcessor.schedule_imm(new task, ET_CALL);
+      }
+      cv.wait_for(lock, std::chrono::seconds(30), [] { return done == TEST_TASKS; });
+      return 0;
+    }
+  };
+
+  thread_work_stealing = 1;
+  eventProcessor.schedule_imm(new hog, ET_CALL);
+  {
+    std::unique_lock<std::mutex> lock(m);
+    cv.wait_for(lock, std::chrono::seconds(60), [] { return done == TEST_TASKS && control_thread != nullptr; });
+  }
+  thread_work_stealing = 0;
+
+  std::lock_guard<std::mutex> lock(m);
+  REQUIRE(done == TEST_TASKS);
+  CHECK(moved == TEST_TASKS);
+  CHECK(control_thread == busy_thread);
+}
+
+TEST_CASE("ProtectedQueueOrder", "[iocore]")
+{
+  struct noop : public Continuation {
+    noop() : Continuation(new_ProxyMutex()) { SET_HANDLER(&noop::run); }
+
+    int
+    run(int /* event ATS_UNUSED */, Event * /* e ATS_UNUSED */)
+    {
+      return 0;
+    }
+  } cont;
+
+  ProtectedQueue q;
+  std::vector<Event *> events;
+  for (int i = 0; i < 8; ++i) {
+    Event *e   = eventAllocator.alloc();
+    e->ethread = this_ethread();
+    e->init(&cont);
+    if (i % 3 == 0) {
+      q.enqueue_shared(e);
+    } else {
+      q.enqueue(e);
+    }
+    events.push_back(e);
+  }
+
+  SECTION("shared events keep their place")
+  {
+    REQUIRE(q.dequeue_external() == 8);
+  }
+
+  SECTION("events numbered during the dequeue are held back")
+  {
+    // As if the last two were numbered after the dequeue started.
+    q.pushed = 6;
+    REQUIRE(q.dequeue_external() == 6);
+    REQUIRE(q.held != nullptr);
+    q.pushed = 8;
+    REQUIRE(q.dequeue_external() == 2);
+    REQUIRE(q.held == nullptr);
+  }
+
+  for (Event *e : events) {
+    Event *local = q.dequeue_local();
+    CHECK(local == e);
+    local->free();
+  }
+  CHECK(q.dequeue_local() == nullptr);
+}
 
 TEST_CASE("EventSystem", "[iocore]")
 {
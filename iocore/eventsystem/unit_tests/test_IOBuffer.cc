@@ -330,6 +330,49 @@ TEST_CASE("MIOBuffer", "[iocore]")
   }
 }
 
+TEST_CASE("AlignedBufferPool", "[iocore]")
+{
+  init_aligned_buffer_pool(false, 64 * 1024);
+
+  SECTION("aligned to size")
+  {
+    for (int64_t i = BUFFER_SIZE_INDEX_512; i <= BUFFER_SIZE_INDEX_2M; ++i) {
+      IOBufferData *d = new_IOBufferData(i, POOL_ALIGNED);
+      CHECK(reinterpret_cast<uintptr_t>(d->data()) % std::min<int64_t>(BUFFER_SIZE_FOR_INDEX(i), ats_pagesize()) == 0);
+      d->free();
+    }
+  }
+
+  SECTION("thread cache")
+  {
+    AlignedBufferPoolStats before = aligned_buffer_pool_stats();
+    void *a                       = aligned_buffer_alloc(BUFFER_SIZE_INDEX_8K);
+    void *b                       = aligned_buffer_alloc(BUFFER_SIZE_INDEX_8K);
+    CHECK(a != b);
+    CHECK(aligned_buffer_pool_stats().in_use - before.in_use == 2 * 8192);
+    aligned_buffer_free(b, BUFFER_SIZE_INDEX_8K);
+    // The buffer just freed is handed out again from the thread cache.
+    CHECK(aligned_buffer_alloc(BUFFER_SIZE_INDEX_8K) == b);
+    aligned_buffer_free(a, BUFFER_SIZE_INDEX_8K);
+    aligned_buffer_free(b, BUFFER_SIZE_INDEX_8K);
+
+    AlignedBufferPoolStats after = aligned_buffer_pool_stats();
+    CHECK(after.in_use == before.in_use);
+    CHECK(after.allocs - before.allocs == 3);
+    CHECK(after.cache_hits - before.cache_hits >= 2);
+    CHECK(after.reserved >= 2 * 1024 * 1024);
+  }
+
+  SECTION("no thread cache")
+  {
+    init_aligned_buffer_pool(false, 0);
+    AlignedBufferPoolStats before = aligned_buffer_pool_stats();
+    aligned_buffer_free(aligned_buffer_alloc(BUFFER_SIZE_INDEX_128), BUFFER_SIZE_INDEX_128);
+    aligned_buffer_free(aligned_buffer_alloc(BUFFER_SIZE_INDEX_128), BUFFER_SIZE_INDEX_128);
+    CHECK(aligned_buffer_pool_stats().cache_hits == before.cache_hits);
+  }
+}
+
 struct EventProcessorListener : Catch::TestEventListenerBase {
   using TestEventListenerBase::TestEventListenerBase;
 
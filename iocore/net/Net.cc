@@ -95,6 +95,9 @@ register_net_stats()
     {"proxy.process.net.write_bytes", net_write_bytes_stat},
     {"proxy.process.net.fastopen_out.attempts", net_fastopen_attempts_stat},
     {"proxy.process.net.fastopen_out.successes", net_fastopen_successes_stat},
+    {"proxy.process.net.io_uring.submits", net_io_uring_submits_stat},
+    {"proxy.process.net.io_uring.completions", net_io_uring_completions_stat},
+    {"proxy.process.net.io_uring.recv_no_buffers", net_io_uring_recv_no_buffers_stat},
     {"proxy.process.socks.connections_successful", socks_connections_successful_stat},
     {"proxy.process.socks.connections_unsuccessful", socks_connections_unsuccessful_stat},
   };
@@ -106,6 +109,9 @@ register_net_stats()
     {"proxy.process.net.default_inactivity_timeout_count", default_inactivity_timeout_count_stat},
     {"proxy.process.net.dynamic_keep_alive_timeout_in_count", keep_alive_queue_timeout_count_stat},
     {"proxy.process.net.dynamic_keep_alive_timeout_in_total", keep_alive_queue_timeout_total_stat},
+    {"proxy.process.net.timers", net_timers_stat},
+    {"proxy.process.net.timer_expiry_count", net_timer_expiry_count_stat},
+    {"proxy.process.net.timer_expiry_latency_total", net_timer_expiry_latency_total_stat},
     {"proxy.process.socks.connections_currently_open", socks_connections_currently_open_stat},
   };
 
@@ -133,6 +139,9 @@ register_net_stats()
   NET_CLEAR_DYN_STAT(keep_alive_queue_timeout_count_stat);
   NET_CLEAR_DYN_STAT(default_inactivity_timeout_count_stat);
   NET_CLEAR_DYN_STAT(default_inactivity_timeout_applied_stat);
+  NET_CLEAR_DYN_STAT(net_timers_stat);
+  NET_CLEAR_DYN_STAT(net_timer_expiry_count_stat);
+  NET_CLEAR_DYN_STAT(net_timer_expiry_latency_total_stat);
 
   RecRegisterRawStat(net_rsb, RECT_PROCESS, "proxy.process.tcp.total_accepts", RECD_INT, RECP_NON_PERSISTENT,
                      static_cast<int>(net_tcp_accept_stat), RecRawStatSyncSum);
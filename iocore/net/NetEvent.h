@@ -60,6 +60,16 @@ public:
   virtual Ptr<ProxyMutex> &get_mutex()   = 0;
   virtual ContFlags &get_control_flags() = 0;
 
+  /// A timeout now expires at @a at, move the timer up if it is filed for later.
+  void
+  update_timer(ink_hrtime at)
+  {
+    if (at && at < timer_at) {
+      this->move_timer(at);
+    }
+  }
+  void move_timer(ink_hrtime at);
+
   EventIO ep{};
   NetState read{};
   NetState write{};
@@ -75,8 +85,14 @@ public:
 
   bool default_inactivity_timeout = false;
 
+  // The NetHandler timer wheel, see @c TimerWheel.
+  ink_hrtime timer_at      = 0;
+  int timer_slot           = -1;
+  int in_timer_update_list = 0;
+
   LINK(NetEvent, open_link);
-  LINK(NetEvent, cop_link);
+  LINK(NetEvent, timer_link);
+  SLINK(NetEvent, timer_update_link);
   LINKM(NetEvent, read, ready_link)
   SLINKM(NetEvent, read, enable_link)
   LINKM(NetEvent, write, ready_link)
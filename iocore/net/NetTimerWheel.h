@@ -0,0 +1,197 @@
+/** @file
+
+  Hierarchical timing wheel for network timeouts.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+
+#include "tscore/List.h"
+#include "tscore/ink_hrtime.h"
+
+/**
+  TimerWheel - file objects by the time they need to be looked at.
+
+  Time is counted in ticks. The first level has a slot for each of the next 64 ticks, each higher
+  level has slots 64 times as long, which are moved down a level as the lower one wraps. Adding,
+  removing and expiring an object are all constant time, so the cost of a pass is the number of
+  objects that are due rather than the number filed.
+
+  An object is never expired before its time, but may be up to a tick late. Anything beyond the
+  range of the current top level slots is filed at the end of it and comes up early, the caller
+  checks its own deadline and files it again.
+
+  C must have these members.
+  ```
+  LINK(C, timer_link);
+  ink_hrtime timer_at; // Time it is filed for, 0 if it is not filed.
+  int timer_slot;      // Slot it is filed in, -1 if it is not filed.
+  ```
+ */
+template <class C, class L = typename C::Link_timer_link> class TimerWheel
+{
+public:
+  static constexpr int SLOT_BITS = 6;
+  static constexpr int SLOTS     = 1 << SLOT_BITS;
+  static constexpr int LEVELS    = 4;
+
+  /// Start counting ticks of @a tick from @a now.
+  void init(ink_hrtime tick, ink_hrtime now);
+
+  /// File @a c for @a at, replacing the time it was filed for if any.
+  void schedule(C *c, ink_hrtime at);
+  /// Take @a c out, it is fine if it is not filed.
+  void remove(C *c);
+  bool
+  in(C const *c) const
+  {
+    return c->timer_slot >= 0;
+  }
+
+  /** Move time up to @a now and call @a f for each object that is due.
+
+      Each object is taken out before it is passed to @a f, which may file it again or take out
+      others.
+   */
+  template <class F> void advance(ink_hrtime now, F const &f);
+
+  /// Number of objects filed.
+  size_t
+  count() const
+  {
+    return _count;
+  }
+
+  ink_hrtime
+  tick() const
+  {
+    return _tick;
+  }
+
+private:
+  /// Ticks covered by the levels below @a level.
+  static constexpr int64_t
+  span(int level)
+  {
+    return int64_t(1) << (SLOT_BITS * level);
+  }
+
+  void file(C *c, int64_t t);
+  void cascade(int level, int64_t index);
+
+  DLL<C, L> _slots[LEVELS * SLOTS];
+  ink_hrtime _tick = HRTIME_SECOND;
+  int64_t _next    = 0; ///< The next tick to expire.
+  size_t _count    = 0;
+};
+
+////
+// Inline functions
+
+template <class C, class L>
+void
+TimerWheel<C, L>::init(ink_hrtime tick, ink_hrtime now)
+{
+  _tick = tick;
+  _next = now / tick;
+}
+
+template <class C, class L>
+void
+TimerWheel<C, L>::schedule(C *c, ink_hrtime at)
+{
+  this->remove(c);
+  c->timer_at = at;
+  // Round up so it is never early.
+  this->file(c, (at + _tick - 1) / _tick);
+  ++_count;
+}
+
+template <class C, class L>
+void
+TimerWheel<C, L>::remove(C *c)
+{
+  if (c->timer_slot >= 0) {
+    _slots[c->timer_slot].remove(c);
+    c->timer_slot = -1;
+    c->timer_at   = 0;
+    --_count;
+  }
+}
+
+template <class C, class L>
+void
+TimerWheel<C, L>::file(C *c, int64_t t)
+{
+  // The top level covers the ticks that differ from the next one only in its bits.
+  int64_t last = _next | (span(LEVELS) - 1);
+  t            = std::clamp(t, _next, last);
+
+  // File it in the lowest level above which it matches the next tick, so it is moved down before it is due.
+  int level = 0;
+  while ((t >> (SLOT_BITS * (level + 1))) != (_next >> (SLOT_BITS * (level + 1)))) {
+    ++level;
+  }
+  c->timer_slot = level * SLOTS + ((t >> (SLOT_BITS * level)) & (SLOTS - 1));
+  _slots[c->timer_slot].push(c);
+}
+
+template <class C, class L>
+void
+TimerWheel<C, L>::cascade(int level, int64_t index)
+{
+  DLL<C, L> &slot = _slots[level * SLOTS + index];
+  while (C *c = slot.pop()) {
+    this->file(c, (c->timer_at + _tick - 1) / _tick);
+  }
+}
+
+template <class C, class L>
+template <class F>
+void
+TimerWheel<C, L>::advance(ink_hrtime now, F const &f)
+{
+  int64_t end = now / _tick;
+
+  if (_count == 0) {
+    _next = std::max(_next, end + 1);
+    return;
+  }
+  while (_next <= end) {
+    int64_t t = _next;
+    // As each level wraps, the next slot of the level above is spread over the one below.
+    for (int level = 1; level < LEVELS && (t & (span(level) - 1)) == 0; ++level) {
+      this->cascade(level, (t >> (SLOT_BITS * level)) & (SLOTS - 1));
+    }
+    // Move up first so anything filed again goes to a later slot.
+    ++_next;
+    DLL<C, L> &slot = _slots[t & (SLOTS - 1)];
+    while (C *c = slot.pop()) {
+      c->timer_slot = -1;
+      c->timer_at   = 0;
+      --_count;
+      f(c);
+    }
+  }
+}
@@ -59,6 +59,12 @@ enum Net_Stats {
   net_connections_throttled_in_stat,
   net_connections_throttled_out_stat,
   net_requests_max_throttled_in_stat,
+  net_timers_stat,
+  net_timer_expiry_count_stat,
+  net_timer_expiry_latency_total_stat,
+  net_io_uring_submits_stat,
+  net_io_uring_completions_stat,
+  net_io_uring_recv_no_buffers_stat,
   Net_Stat_Count
 };
 
@@ -141,6 +141,7 @@ struct EventIO {
 #include "P_DNSConnection.h"
 #include "P_UnixUDPConnection.h"
 #include "P_UnixPollDescriptor.h"
+#include "NetTimerWheel.h"
 #include <limits>
 
 class NetEvent;
@@ -265,7 +266,8 @@ public:
   QueM(NetEvent, NetState, read, ready_link) read_ready_list;
   QueM(NetEvent, NetState, write, ready_link) write_ready_list;
   Que(NetEvent, open_link) open_list;
-  DList(NetEvent, cop_link) cop_list;
+  TimerWheel<NetEvent> timer_wheel;
+  ASLL(NetEvent, timer_update_link) timer_update_list;
   ASLLM(NetEvent, NetState, read, enable_link) read_enable_list;
   ASLLM(NetEvent, NetState, write, enable_link) write_enable_list;
   Que(NetEvent, keep_alive_queue_link) keep_alive_queue;
@@ -273,6 +275,12 @@ public:
   Que(NetEvent, active_queue_link) active_queue;
   uint32_t active_queue_size = 0;
 
+  uint64_t timers_expired         = 0; ///< Timeouts found by the timer wheel.
+  ink_hrtime timer_expiry_latency = 0; ///< Sum of how late they were found.
+#if TS_USE_LINUX_IO_URING_NET
+  NetIOUring *io_uring = nullptr; ///< Socket reads and writes go through this if it is set.
+#endif
+
   /// configuration settings for managing the active and keep-alive queues
   struct Config {
     uint32_t max_connections_in                 = 0;
@@ -327,6 +335,8 @@ public:
   void remove_from_keep_alive_queue(NetEvent *ne);
   bool add_to_active_queue(NetEvent *ne);
   void remove_from_active_queue(NetEvent *ne);
+  /// File @a ne in the timer wheel for its next timeout, or for the next tick if it has none.
+  void schedule_timer(NetEvent *ne, ink_hrtime now);
 
   /// Per process initialization logic.
   static void init_for_process();
@@ -355,7 +365,7 @@ public:
 
   /**
     Start to handle active timeout and inactivity timeout on a NetEvent.
-    Put the ne into open_list. All NetEvents in the open_list is checked for timeout by InactivityCop.
+    Put the ne into open_list and the timer wheel, InactivityCop checks it when its timer is due.
     Only be called when holding the mutex of this NetHandler and must call startIO(ne) first.
 
     @param ne NetEvent to be managed by InactivityCop
@@ -363,7 +373,7 @@ public:
   void startCop(NetEvent *ne);
   /**
     Stop to handle active timeout and inactivity on a NetEvent.
-    Remove the ne from open_list and cop_list.
+    Remove the ne from open_list and the timer wheel.
     Also remove the ne from keep_alive_queue and active_queue if its context is IN.
     Only be called when holding the mutex of this NetHandler.
 
@@ -887,6 +897,7 @@ NetHandler::startCop(NetEvent *ne)
   ink_assert(!open_list.in(ne));
 
   open_list.enqueue(ne);
+  schedule_timer(ne, Thread::get_hrtime());
 }
 
 TS_INLINE void
@@ -895,7 +906,11 @@ NetHandler::stopCop(NetEvent *ne)
   ink_release_assert(ne->nh == this);
 
   open_list.remove(ne);
-  cop_list.remove(ne);
+  timer_wheel.remove(ne);
+  if (ne->in_timer_update_list) {
+    timer_update_list.remove(ne);
+    ne->in_timer_update_list = 0;
+  }
   remove_from_keep_alive_queue(ne);
   remove_from_active_queue(ne);
 }
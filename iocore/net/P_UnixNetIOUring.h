@@ -0,0 +1,137 @@
+/** @file
+
+  io_uring network I/O for a NetHandler.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include "tscore/ink_config.h"
+
+#if TS_USE_LINUX_IO_URING_NET
+
+#include <liburing.h>
+
+#include "I_IOBuffer.h"
+
+class NetHandler;
+class NetIOUring;
+class UnixNetVConnection;
+struct PollDescriptor;
+struct NetIOUringOp;
+
+/** The state of a connection on a @c NetIOUring.
+
+    This is only changed on the thread of the ring, the completions change it as well as the reads
+    and writes of the connection.
+ */
+struct NetIOUringState {
+  /// Ring the connection has operations or data on, it must be detached from it before it is
+  /// closed. Set and cleared on the thread of the ring, while the connection is not shared.
+  NetIOUring *ring       = nullptr;
+  NetIOUringOp *recv     = nullptr; ///< Multishot receive, until its last completion.
+  NetIOUringOp *send     = nullptr; ///< Send in flight.
+  MIOBuffer *staged      = nullptr; ///< Data received and not yet read.
+  IOBufferReader *reader = nullptr; ///< Reader for @a staged.
+  int recv_result        = 1;       ///< 0 once the peer has closed, -errno if a receive failed.
+  uint32_t writer        = 0;       ///< Count of @c do_io_write calls, which identifies the write buffer.
+  uint32_t send_writer   = 0;       ///< @a writer when the send was made.
+  int64_t sent           = 0;       ///< Result of the finished send, for the next write.
+  bool send_done         = false;   ///< @a sent has not been reported yet.
+  bool quiet             = false;   ///< epoll no longer reports read or write readiness.
+};
+
+/** Socket reads and writes for the connections of a @c NetHandler, batched on an io_uring.
+
+    Each ready connection costs a @c readv or @c writev call with epoll. With a ring the
+    connection has a multishot receive armed, which fills buffers from a provided buffer ring, and
+    sends are queued as they are asked for. The queued operations are submitted by the same call
+    that waits for completions, so a pass of the event loop makes one system call however many
+    connections it serves. The completions put the connections on the ready lists of the
+    @c NetHandler to be processed exactly as the epoll events are.
+
+    epoll is still used for everything else (accepts, DNS, the thread's signal descriptor) and for
+    a connection until its first read. The epoll descriptor is polled on the ring.
+ */
+class NetIOUring
+{
+public:
+  /// Set up a ring for @a nh if it is configured, @c nullptr if not or if the kernel can not do it.
+  static NetIOUring *create(NetHandler *nh);
+
+  ~NetIOUring();
+
+  /** Submit the queued operations and wait for completions or for an event on @a pd.
+
+      @param timeout Milliseconds to wait, 0 to not wait and -1 to wait indefinitely.
+      @return The number of epoll events in @a pd, as @c epoll_wait would.
+   */
+  int wait(PollDescriptor *pd, int timeout);
+
+  /// Copy data received for @a vc into @a iov, with the result of @c readv.
+  int64_t readv(UnixNetVConnection *vc, IOVec *iov, int niov);
+
+  /** Send data from @a buf for @a vc, as @c UnixNetVConnection::load_buffer_and_write.
+
+      This queues a send and returns @c -EAGAIN. The result is returned, and the data consumed from
+      @a buf, by the call after it completes.
+   */
+  int64_t write(UnixNetVConnection *vc, int64_t towrite, MIOBufferAccessor &buf, int64_t &total_written, int &needs);
+
+  /// Drop the operations and data of @a vc, before its socket is closed.
+  void detach(UnixNetVConnection *vc);
+
+  /** Stop receiving for @a vc, so nothing on this thread changes it while another thread has it.
+
+      epoll reports its readiness again, and it is detached unless data or the result of a send are
+      waiting to be read, which can not move to another ring.
+   */
+  void disarm(UnixNetVConnection *vc);
+
+private:
+  NetIOUring(NetHandler *nh) : _nh(nh) {}
+
+  bool init(unsigned entries, unsigned buffers, unsigned buffer_size);
+  io_uring_sqe *get_sqe();
+  void submit();
+  NetIOUringOp *new_op(int type, UnixNetVConnection *vc);
+  bool arm_recv(UnixNetVConnection *vc);
+  void quiet(UnixNetVConnection *vc);
+  void cancel(NetIOUringOp *op);
+  void reap();
+  void complete_recv(NetIOUringOp *op, io_uring_cqe *cqe);
+  void complete_send(NetIOUringOp *op, io_uring_cqe *cqe);
+  void free_op(NetIOUringOp *op);
+
+  NetHandler *_nh;
+  io_uring _ring;
+  io_uring_buf_ring *_buf_ring = nullptr; ///< Buffers the kernel picks from for receives.
+  char *_buffers               = nullptr;
+  unsigned _buffer_count       = 0;
+  unsigned _buffer_size        = 0;
+  int64_t _staged_index        = 0; ///< Buffer size index for the staged data.
+  int64_t _staged_limit        = 0; ///< Receiving stops for a connection with this much data not read.
+  uint64_t _batch              = 1; ///< Number of the batch being queued.
+  bool _ring_ready             = false;
+  bool _poll_armed             = false; ///< The epoll descriptor is polled on the ring.
+  bool _epoll_ready            = false; ///< There are epoll events to collect.
+};
+
+#endif
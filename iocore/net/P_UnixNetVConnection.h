@@ -37,6 +37,7 @@
 #include "P_Connection.h"
 #include "P_NetAccept.h"
 #include "NetEvent.h"
+#include "P_UnixNetIOUring.h"
 
 class UnixNetVConnection;
 class NetHandler;
@@ -258,6 +259,12 @@ public:
    */
   UnixNetVConnection *migrateToCurrentThread(Continuation *c, EThread *t);
 
+  /**
+   * Release the I/O state that ties the NetVC to its thread, so another thread can take it with
+   * migrateToCurrentThread. This must be called on the thread of the NetVC before it is shared.
+   */
+  void prepareForSharing();
+
   Action action_;
 
   unsigned int id = 0;
@@ -267,6 +274,9 @@ public:
   OOB_callback *oob_ptr    = nullptr;
   bool from_accept_thread  = false;
   NetAccept *accept_object = nullptr;
+#if TS_USE_LINUX_IO_URING_NET
+  NetIOUringState uring; ///< Reads and sends on the io_uring of the NetHandler, if it has one.
+#endif
 
   int startEvent(int event, Event *e);
   int acceptEvent(int event, Event *e);
@@ -358,6 +368,7 @@ UnixNetVConnection::set_active_timeout(ink_hrtime timeout_in)
   Debug("socket", "Set active timeout=%" PRId64 ", NetVC=%p", timeout_in, this);
   active_timeout_in        = timeout_in;
   next_activity_timeout_at = (active_timeout_in > 0) ? Thread::get_hrtime() + timeout_in : 0;
+  update_timer(next_activity_timeout_at);
 }
 
 inline void
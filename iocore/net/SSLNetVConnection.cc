@@ -960,6 +960,11 @@ SSLNetVConnection::free(EThread *t)
 
   // cancel OOB
   cancel_OOB();
+#if TS_USE_LINUX_IO_URING_NET
+  if (uring.ring) {
+    uring.ring->detach(this);
+  }
+#endif
   // close socket fd
   if (con.fd != NO_FD) {
     NET_SUM_GLOBAL_DYN_STAT(net_connections_currently_open_stat, -1);
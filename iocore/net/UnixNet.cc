@@ -41,7 +41,7 @@ extern "C" void fd_reify(struct ev_loop *);
 
 // INKqa10496
 // One Inactivity cop runs on each thread once every second and
-// loops through the list of NetEvents and calls the timeouts
+// calls the timeouts of the NetEvents whose timer is due
 class InactivityCop : public Continuation
 {
 public:
@@ -54,64 +54,17 @@ public:
     NetHandler &nh = *get_NetHandler(this_ethread());
 
     Debug("inactivity_cop_check", "Checking inactivity on Thread-ID #%d", this_ethread()->id);
-    // The rest NetEvents in cop_list which are not triggered between InactivityCop runs.
-    // Use pop() to catch any closes caused by callbacks.
-    while (NetEvent *ne = nh.cop_list.pop()) {
-      // If we cannot get the lock don't stop just keep cleaning
-      MUTEX_TRY_LOCK(lock, ne->get_mutex(), this_ethread());
-      if (!lock.is_locked()) {
-        NET_INCREMENT_DYN_STAT(inactivity_cop_lock_acquire_failure_stat);
-        continue;
-      }
-
-      if (ne->closed) {
-        nh.free_netevent(ne);
-        continue;
-      }
-
-      // set a default inactivity timeout if one is not set
-      // The event `EVENT_INACTIVITY_TIMEOUT` only be triggered if a read
-      // or write I/O operation was set by `do_io_read()` or `do_io_write()`.
-      if (ne->next_inactivity_timeout_at == 0 && nh.config.default_inactivity_timeout > 0 &&
-          (ne->read.enabled || ne->write.enabled)) {
-        Debug("inactivity_cop", "vc: %p inactivity timeout not set, setting a default of %d", ne,
-              nh.config.default_inactivity_timeout);
-        ne->set_default_inactivity_timeout(HRTIME_SECONDS(nh.config.default_inactivity_timeout));
-        NET_INCREMENT_DYN_STAT(default_inactivity_timeout_applied_stat);
-      }
-
-      if (ne->next_inactivity_timeout_at && ne->next_inactivity_timeout_at < now) {
-        if (ne->is_default_inactivity_timeout()) {
-          // track the connections that timed out due to default inactivity
-          NET_INCREMENT_DYN_STAT(default_inactivity_timeout_count_stat);
-        }
-        if (nh.keep_alive_queue.in(ne)) {
-          // only stat if the connection is in keep-alive, there can be other inactivity timeouts
-          ink_hrtime diff = (now - (ne->next_inactivity_timeout_at - ne->inactivity_timeout_in)) / HRTIME_SECOND;
-          NET_SUM_DYN_STAT(keep_alive_queue_timeout_total_stat, diff);
-          NET_INCREMENT_DYN_STAT(keep_alive_queue_timeout_count_stat);
-        }
-        Debug("inactivity_cop_verbose", "ne: %p now: %" PRId64 " timeout at: %" PRId64 " timeout in: %" PRId64, ne,
-              ink_hrtime_to_sec(now), ne->next_inactivity_timeout_at, ne->inactivity_timeout_in);
-        ne->callback(VC_EVENT_INACTIVITY_TIMEOUT, e);
-      } else if (ne->next_activity_timeout_at && ne->next_activity_timeout_at < now) {
-        Debug("inactivity_cop_verbose", "active ne: %p now: %" PRId64 " timeout at: %" PRId64 " timeout in: %" PRId64, ne,
-              ink_hrtime_to_sec(now), ne->next_activity_timeout_at, ne->active_timeout_in);
-        ne->callback(VC_EVENT_ACTIVE_TIMEOUT, e);
-      }
+    // Timeouts set from other threads, these may be earlier than the timer.
+    SList(NetEvent, timer_update_link) uq(nh.timer_update_list.popall());
+    while (NetEvent *ne = uq.pop()) {
+      ne->in_timer_update_list = 0;
+      nh.schedule_timer(ne, now);
     }
-    // The cop_list is empty now.
-    // Let's reload the cop_list from open_list again.
-    forl_LL(NetEvent, ne, nh.open_list)
-    {
-      if (ne->get_thread() == this_ethread()) {
-        nh.cop_list.push(ne);
-      }
-    }
-    // NetHandler will remove NetEvent from cop_list if it is triggered.
-    // As the NetHandler runs, the number of NetEvents in the cop_list is decreasing.
-    // NetHandler runs 100 times maximum between InactivityCop runs.
-    // Therefore we don't have to check all the NetEvents as much as open_list.
+
+    // Only the NetEvents whose timer is due are checked, the rest have not reached a timeout.
+    nh.timer_wheel.advance(now, [&](NetEvent *ne) { this->check_timeout(nh, ne, now, e); });
+    NET_SUM_DYN_STAT(net_timers_stat, static_cast<int64_t>(nh.timer_wheel.count()) - _timers);
+    _timers = nh.timer_wheel.count();
 
     // Cleanup the active and keep-alive queues periodically
     nh.manage_active_queue(nullptr, true); // close any connections over the active timeout
@@ -119,6 +72,73 @@ public:
 
     return 0;
   }
+
+private:
+  void
+  check_timeout(NetHandler &nh, NetEvent *ne, ink_hrtime now, Event *e)
+  {
+    // If we cannot get the lock don't stop just keep cleaning
+    MUTEX_TRY_LOCK(lock, ne->get_mutex(), this_ethread());
+    if (!lock.is_locked()) {
+      NET_INCREMENT_DYN_STAT(inactivity_cop_lock_acquire_failure_stat);
+      nh.timer_wheel.schedule(ne, now + nh.timer_wheel.tick());
+      return;
+    }
+
+    if (ne->closed) {
+      nh.free_netevent(ne);
+      return;
+    }
+
+    // set a default inactivity timeout if one is not set
+    // The event `EVENT_INACTIVITY_TIMEOUT` only be triggered if a read
+    // or write I/O operation was set by `do_io_read()` or `do_io_write()`.
+    if (ne->next_inactivity_timeout_at == 0 && nh.config.default_inactivity_timeout > 0 &&
+        (ne->read.enabled || ne->write.enabled)) {
+      Debug("inactivity_cop", "vc: %p inactivity timeout not set, setting a default of %d", ne,
+            nh.config.default_inactivity_timeout);
+      ne->set_default_inactivity_timeout(HRTIME_SECONDS(nh.config.default_inactivity_timeout));
+      NET_INCREMENT_DYN_STAT(default_inactivity_timeout_applied_stat);
+    }
+
+    if (ne->next_inactivity_timeout_at && ne->next_inactivity_timeout_at < now) {
+      if (ne->is_default_inactivity_timeout()) {
+        // track the connections that timed out due to default inactivity
+        NET_INCREMENT_DYN_STAT(default_inactivity_timeout_count_stat);
+      }
+      if (nh.keep_alive_queue.in(ne)) {
+        // only stat if the connection is in keep-alive, there can be other inactivity timeouts
+        ink_hrtime diff = (now - (ne->next_inactivity_timeout_at - ne->inactivity_timeout_in)) / HRTIME_SECOND;
+        NET_SUM_DYN_STAT(keep_alive_queue_timeout_total_stat, diff);
+        NET_INCREMENT_DYN_STAT(keep_alive_queue_timeout_count_stat);
+      }
+      Debug("inactivity_cop_verbose", "ne: %p now: %" PRId64 " timeout at: %" PRId64 " timeout in: %" PRId64, ne,
+            ink_hrtime_to_sec(now), ne->next_inactivity_timeout_at, ne->inactivity_timeout_in);
+      this->expired(nh, ne, now, ne->next_inactivity_timeout_at);
+      ne->callback(VC_EVENT_INACTIVITY_TIMEOUT, e);
+    } else if (ne->next_activity_timeout_at && ne->next_activity_timeout_at < now) {
+      Debug("inactivity_cop_verbose", "active ne: %p now: %" PRId64 " timeout at: %" PRId64 " timeout in: %" PRId64, ne,
+            ink_hrtime_to_sec(now), ne->next_activity_timeout_at, ne->active_timeout_in);
+      this->expired(nh, ne, now, ne->next_activity_timeout_at);
+      ne->callback(VC_EVENT_ACTIVE_TIMEOUT, e);
+    } else {
+      nh.schedule_timer(ne, now);
+    }
+  }
+
+  /// Account for the timeout of @a ne at @a at, before the callback which may free it.
+  void
+  expired(NetHandler &nh, NetEvent *ne, ink_hrtime now, ink_hrtime at)
+  {
+    ++nh.timers_expired;
+    nh.timer_expiry_latency += now - at;
+    NET_INCREMENT_DYN_STAT(net_timer_expiry_count_stat);
+    NET_SUM_DYN_STAT(net_timer_expiry_latency_total_stat, ink_hrtime_to_msec(now - at));
+    // Look at it again on the next tick, the callback clears or resets the timeout.
+    nh.timer_wheel.schedule(ne, now + nh.timer_wheel.tick());
+  }
+
+  int64_t _timers = 0; ///< Timers counted in the stat.
 };
 
 PollCont::PollCont(Ptr<ProxyMutex> &m, int pt)
@@ -173,8 +193,13 @@ PollCont::do_poll(ink_hrtime timeout)
   }
 // wait for fd's to trigger, or don't wait if timeout is 0
 #if TS_USE_EPOLL
-  pollDescriptor->result =
-    epoll_wait(pollDescriptor->epoll_fd, pollDescriptor->ePoll_Triggered_Events, POLL_DESCRIPTOR_SIZE, poll_timeout);
+#if TS_USE_LINUX_IO_URING_NET
+  if (net_handler && net_handler->io_uring) {
+    pollDescriptor->result = net_handler->io_uring->wait(pollDescriptor, poll_timeout);
+  } else
+#endif
+    pollDescriptor->result =
+      epoll_wait(pollDescriptor->epoll_fd, pollDescriptor->ePoll_Triggered_Events, POLL_DESCRIPTOR_SIZE, poll_timeout);
   NetDebug("v_iocore_net_poll", "[PollCont::pollEvent] epoll_fd: %d, timeout: %d, results: %d", pollDescriptor->epoll_fd,
            poll_timeout, pollDescriptor->result);
 #elif TS_USE_KQUEUE
@@ -250,7 +275,12 @@ initialize_thread_for_net(EThread *thread)
   REC_ReadConfigInteger(cop_freq, "proxy.config.net.inactivity_check_frequency");
   memcpy(&nh->config, &NetHandler::global_config, sizeof(NetHandler::global_config));
   nh->configure_per_thread_values();
+  // The wheel moves a tick each time the cop runs.
+  nh->timer_wheel.init(HRTIME_SECONDS(cop_freq), Thread::get_hrtime_updated());
   thread->schedule_every(inactivityCop, HRTIME_SECONDS(cop_freq));
+#if TS_USE_LINUX_IO_URING_NET
+  nh->io_uring = NetIOUring::create(nh);
+#endif
 
   thread->set_tail_handler(nh);
   thread->ep = static_cast<EventIO *>(ats_malloc(sizeof(EventIO)));
@@ -503,10 +533,6 @@ NetHandler::waitForActivity(ink_hrtime timeout)
     epd = static_cast<EventIO *> get_ev_data(pd, x);
     if (epd->type == EVENTIO_READWRITE_VC) {
       ne = epd->data.ne;
-      // Remove triggered NetEvent from cop_list because it won't be timeout before next InactivityCop runs.
-      if (cop_list.in(ne)) {
-        cop_list.remove(ne);
-      }
       if (get_ev_events(pd, x) & (EVENTIO_READ | EVENTIO_ERROR)) {
         ne->read.triggered = 1;
         if (!read_ready_list.in(ne)) {
@@ -703,6 +729,43 @@ NetHandler::_close_ne(NetEvent *ne, ink_hrtime now, int &handle_event, int &clos
   }
 }
 
+void
+NetHandler::schedule_timer(NetEvent *ne, ink_hrtime now)
+{
+  ink_hrtime at = ne->next_inactivity_timeout_at;
+
+  if (ne->closed) {
+    at = now;
+  } else if (ne->next_activity_timeout_at && (at == 0 || ne->next_activity_timeout_at < at)) {
+    at = ne->next_activity_timeout_at;
+  }
+  // With no timeout the cop still looks each tick, to set the default inactivity timeout.
+  timer_wheel.schedule(ne, at ? at : now + timer_wheel.tick());
+}
+
+void
+NetEvent::move_timer(ink_hrtime at)
+{
+  NetHandler *h = nh;
+
+  if (h == nullptr) {
+    return;
+  }
+  if (h->thread == this_ethread()) {
+    MUTEX_TRY_LOCK(lock, h->mutex, h->thread);
+    if (lock.is_locked()) {
+      if (h->timer_wheel.in(this)) {
+        h->timer_wheel.schedule(this, at);
+      }
+      return;
+    }
+  }
+  // The cop files it again on its next run.
+  if (!ink_atomic_swap(&in_timer_update_list, 1)) {
+    h->timer_update_list.push(this);
+  }
+}
+
 void
 NetHandler::add_to_keep_alive_queue(NetEvent *ne)
 {
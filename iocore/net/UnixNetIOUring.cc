@@ -0,0 +1,516 @@
+/** @file
+
+  io_uring network I/O for a NetHandler.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "P_Net.h"
+
+#if TS_USE_LINUX_IO_URING_NET
+
+#include <poll.h>
+#include <sys/epoll.h>
+
+namespace
+{
+/// Buffer group of the provided buffers, there is only the one.
+constexpr int BUFFER_GROUP = 0;
+/// Blocks sent by a single operation.
+constexpr int SEND_IOV = 16;
+/// User data of the poll on the epoll descriptor.
+constexpr uint64_t EPOLL_TAG = 1;
+} // namespace
+
+struct NetIOUringOp {
+  enum Type { RECV, SEND };
+
+  int type;
+  UnixNetVConnection *vc; ///< Connection it is for, @c nullptr once that is closed.
+  uint64_t batch;         ///< Batch it was queued in.
+  bool cancelled;
+  msghdr msg;
+  IOVec iov[SEND_IOV];
+  Ptr<IOBufferBlock> blocks[SEND_IOV]; ///< Keep the data being sent, one for each of @a iov.
+};
+
+ClassAllocator<NetIOUringOp> netIOUringOpAllocator("netIOUringOpAllocator");
+
+NetIOUring *
+NetIOUring::create(NetHandler *nh)
+{
+  RecInt enabled     = 0;
+  RecInt entries     = 4096;
+  RecInt buffers     = 4096;
+  RecInt buffer_size = 16384;
+
+  REC_ReadConfigInteger(enabled, "proxy.config.net.io_uring.enabled");
+  if (!enabled) {
+    return nullptr;
+  }
+  REC_ReadConfigInteger(entries, "proxy.config.net.io_uring.entries");
+  REC_ReadConfigInteger(buffers, "proxy.config.net.io_uring.recv_buffers");
+  REC_ReadConfigInteger(buffer_size, "proxy.config.net.io_uring.recv_buffer_size");
+
+  NetIOUring *ring = new NetIOUring(nh);
+  if (!ring->init(entries, buffers, buffer_size)) {
+    delete ring;
+    return nullptr;
+  }
+  return ring;
+}
+
+bool
+NetIOUring::init(unsigned entries, unsigned buffers, unsigned buffer_size)
+{
+  int ret = io_uring_queue_init(entries, &_ring, 0);
+  if (ret < 0) {
+    Warning("io_uring_queue_init(%u) failed: %s (%d), network I/O uses epoll", entries, strerror(-ret), -ret);
+    return false;
+  }
+  _ring_ready = true;
+
+  // The buffer ring size must be a power of 2.
+  for (_buffer_count = 1; _buffer_count < buffers && _buffer_count < 32768; _buffer_count <<= 1) {
+  }
+  _buffer_size = buffer_size;
+  _buf_ring    = io_uring_setup_buf_ring(&_ring, _buffer_count, BUFFER_GROUP, 0, &ret);
+  if (_buf_ring == nullptr) {
+    Warning("io_uring provided buffers are not available: %s (%d), network I/O uses epoll", strerror(-ret), -ret);
+    return false;
+  }
+  _buffers = static_cast<char *>(ats_memalign(ats_pagesize(), static_cast<size_t>(_buffer_count) * _buffer_size));
+  for (unsigned i = 0; i < _buffer_count; ++i) {
+    io_uring_buf_ring_add(_buf_ring, _buffers + i * _buffer_size, _buffer_size, i, io_uring_buf_ring_mask(_buffer_count), i);
+  }
+  io_uring_buf_ring_advance(_buf_ring, _buffer_count);
+
+  _staged_index = iobuffer_size_to_index(_buffer_size, MAX_BUFFER_SIZE_INDEX);
+  _staged_limit = 4 * static_cast<int64_t>(_buffer_size);
+  Debug("iocore_net", "io_uring with %u entries and %u receive buffers of %u bytes", entries, _buffer_count, _buffer_size);
+  return true;
+}
+
+NetIOUring::~NetIOUring()
+{
+  if (_ring_ready) {
+    if (_buf_ring) {
+      io_uring_free_buf_ring(&_ring, _buf_ring, _buffer_count, BUFFER_GROUP);
+    }
+    io_uring_queue_exit(&_ring);
+  }
+  ats_free(_buffers);
+}
+
+NetIOUringOp *
+NetIOUring::new_op(int type, UnixNetVConnection *vc)
+{
+  NetIOUringOp *op = netIOUringOpAllocator.alloc();
+  op->type         = type;
+  op->vc           = vc;
+  op->batch        = _batch;
+  op->cancelled    = false;
+  return op;
+}
+
+void
+NetIOUring::free_op(NetIOUringOp *op)
+{
+  for (auto &block : op->blocks) {
+    block = nullptr;
+  }
+  netIOUringOpAllocator.free(op);
+}
+
+void
+NetIOUring::submit()
+{
+  ProxyMutex *mutex = _nh->thread->mutex.get();
+  int ret           = io_uring_submit(&_ring);
+
+  ++_batch;
+  NET_INCREMENT_DYN_STAT(net_io_uring_submits_stat);
+  if (ret < 0 && ret != -EAGAIN && ret != -EBUSY && ret != -EINTR) {
+    Warning("io_uring_submit failed: %s (%d)", strerror(-ret), -ret);
+  }
+}
+
+io_uring_sqe *
+NetIOUring::get_sqe()
+{
+  io_uring_sqe *sqe = io_uring_get_sqe(&_ring);
+  if (sqe == nullptr) {
+    // The queue is full, send this batch on ahead.
+    this->submit();
+    sqe = io_uring_get_sqe(&_ring);
+  }
+  return sqe;
+}
+
+void
+NetIOUring::cancel(NetIOUringOp *op)
+{
+  if (io_uring_sqe *sqe = this->get_sqe(); sqe) {
+    io_uring_prep_cancel(sqe, op, 0);
+    io_uring_sqe_set_data(sqe, nullptr);
+  }
+  op->cancelled = true;
+}
+
+/** Take read and write readiness of @a vc off epoll.
+
+    The completions on the ring report both, epoll reporting them as well would wake the loop again
+    for each. It is only left the errors, which it reports regardless. @c EventIO::start_common
+    adds every descriptor with @c EPOLLEXCLUSIVE (P_UnixNet.h), and @c EPOLL_CTL_MOD fails with
+    @c EINVAL on such a descriptor, so it is deleted and added again without it.
+ */
+void
+NetIOUring::quiet(UnixNetVConnection *vc)
+{
+  NetIOUringState &u = vc->uring;
+  EventIO &ep        = vc->ep;
+  epoll_event ev;
+
+  ink_zero(ev);
+  ev.events   = EPOLLET;
+  ev.data.ptr = &ep;
+  if (ep.event_loop == nullptr || epoll_ctl(ep.event_loop->epoll_fd, EPOLL_CTL_DEL, ep.fd, nullptr) < 0 ||
+      epoll_ctl(ep.event_loop->epoll_fd, EPOLL_CTL_ADD, ep.fd, &ev) < 0) {
+    return;
+  }
+  u.quiet = true;
+  // A write waiting on epoll goes through the ring from now on.
+  if (vc->write.enabled && !vc->write.triggered) {
+    vc->write.triggered = 1;
+    _nh->write_ready_list.in_or_enqueue(vc);
+  }
+}
+
+bool
+NetIOUring::arm_recv(UnixNetVConnection *vc)
+{
+  NetIOUringState &u = vc->uring;
+  io_uring_sqe *sqe  = this->get_sqe();
+
+  if (sqe == nullptr) {
+    return false;
+  }
+  u.ring = this;
+  u.recv = this->new_op(NetIOUringOp::RECV, vc);
+  io_uring_prep_recv_multishot(sqe, vc->con.fd, nullptr, 0, 0);
+  sqe->flags |= IOSQE_BUFFER_SELECT;
+  sqe->buf_group = BUFFER_GROUP;
+  io_uring_sqe_set_data(sqe, u.recv);
+
+  if (u.staged == nullptr) {
+    u.staged = new_MIOBuffer(_staged_index);
+    u.reader = u.staged->alloc_reader();
+  }
+  if (!u.quiet) {
+    this->quiet(vc);
+  }
+  return true;
+}
+
+int64_t
+NetIOUring::readv(UnixNetVConnection *vc, IOVec *iov, int niov)
+{
+  NetIOUringState &u = vc->uring;
+  int64_t n          = 0;
+
+  if (u.reader) {
+    for (int i = 0; i < niov; ++i) {
+      int64_t len = u.reader->read(iov[i].iov_base, iov[i].iov_len);
+      n += len;
+      if (len < static_cast<int64_t>(iov[i].iov_len)) {
+        break;
+      }
+    }
+  }
+  // Receive more once there is room.
+  if (u.recv == nullptr && u.recv_result > 0 && (u.reader == nullptr || u.reader->read_avail() < _staged_limit)) {
+    if (!this->arm_recv(vc) && n == 0) {
+      // No room on the ring, read it directly.
+      return socketManager.readv(vc->con.fd, iov, niov);
+    }
+  }
+  if (n > 0) {
+    return n;
+  }
+  return u.recv_result > 0 ? -EAGAIN : u.recv_result;
+}
+
+int64_t
+NetIOUring::write(UnixNetVConnection *vc, int64_t towrite, MIOBufferAccessor &buf, int64_t &total_written, int &needs)
+{
+  NetIOUringState &u = vc->uring;
+  ProxyMutex *mutex  = _nh->thread->mutex.get();
+  int64_t r          = -EAGAIN;
+
+  needs |= EVENTIO_WRITE;
+
+  if (u.send_done) {
+    u.send_done = false;
+    // If the buffer was swapped out since, there is nothing to account the send to.
+    if (u.send_writer == u.writer) {
+      r = u.sent;
+      if (r > 0) {
+        r = std::min(r, buf.reader()->read_avail());
+        buf.reader()->consume(r);
+        total_written += r;
+      }
+      return r;
+    }
+  }
+  if (u.send) {
+    // The completion brings it back here.
+    return r;
+  }
+
+  NetIOUringOp *op           = this->new_op(NetIOUringOp::SEND, vc);
+  IOBufferReader *tmp_reader = buf.reader()->clone();
+  int64_t try_to_write       = 0;
+  int niov                   = 0;
+
+  while (niov < SEND_IOV && try_to_write < towrite) {
+    int64_t len = std::min(tmp_reader->block_read_avail(), towrite - try_to_write);
+    if (len <= 0) {
+      break;
+    }
+    op->iov[niov].iov_len  = len;
+    op->iov[niov].iov_base = tmp_reader->start();
+    op->blocks[niov]       = tmp_reader->get_current_block();
+    niov++;
+    try_to_write += len;
+    tmp_reader->consume(len);
+  }
+  tmp_reader->dealloc();
+  ink_assert(niov > 0);
+
+  ink_zero(op->msg);
+  op->msg.msg_iov    = &op->iov[0];
+  op->msg.msg_iovlen = niov;
+
+  if (io_uring_sqe *sqe = this->get_sqe(); sqe) {
+    io_uring_prep_sendmsg(sqe, vc->con.fd, &op->msg, MSG_NOSIGNAL);
+    io_uring_sqe_set_data(sqe, op);
+    u.ring        = this;
+    u.send        = op;
+    u.send_writer = u.writer;
+    return r;
+  }
+
+  // No room on the ring, send it directly.
+  r = socketManager.writev(vc->con.fd, &op->iov[0], niov);
+  NET_INCREMENT_DYN_STAT(net_calls_to_write_stat);
+  this->free_op(op);
+  if (r > 0) {
+    buf.reader()->consume(r);
+    total_written += r;
+  }
+  return r;
+}
+
+void
+NetIOUring::detach(UnixNetVConnection *vc)
+{
+  NetIOUringState &u = vc->uring;
+  bool flush         = false;
+
+  for (NetIOUringOp *op : {u.recv, u.send}) {
+    if (op) {
+      op->vc = nullptr;
+      // The socket is closed next and its number may be reused before this batch goes out.
+      flush = flush || op->batch == _batch;
+      this->cancel(op);
+    }
+  }
+  if (flush) {
+    this->submit();
+  }
+  if (u.staged) {
+    free_MIOBuffer(u.staged);
+  }
+  u = NetIOUringState();
+}
+
+void
+NetIOUring::disarm(UnixNetVConnection *vc)
+{
+  NetIOUringState &u = vc->uring;
+
+  ink_assert(u.ring == this);
+  if (u.recv) {
+    u.recv->vc = nullptr;
+    this->cancel(u.recv);
+    u.recv = nullptr;
+    // Out now, before another thread can arm a receive on the socket.
+    this->submit();
+  }
+  if (u.quiet && vc->ep.event_loop) {
+    // Back on epoll to see the peer close.
+    EventLoop loop = vc->ep.event_loop;
+    vc->ep.stop();
+    vc->ep.start(loop, vc, EVENTIO_READ | EVENTIO_WRITE);
+    u.quiet = false;
+  }
+  if (u.send == nullptr && !u.send_done && (u.reader == nullptr || u.reader->read_avail() == 0)) {
+    this->detach(vc);
+  }
+}
+
+void
+NetIOUring::complete_recv(NetIOUringOp *op, io_uring_cqe *cqe)
+{
+  UnixNetVConnection *vc = op->vc;
+  bool more              = cqe->flags & IORING_CQE_F_MORE;
+
+  if (cqe->flags & IORING_CQE_F_BUFFER) {
+    unsigned bid = cqe->flags >> IORING_CQE_BUFFER_SHIFT;
+    char *data   = _buffers + bid * _buffer_size;
+    if (vc && cqe->res > 0) {
+      vc->uring.staged->write(data, cqe->res);
+    }
+    io_uring_buf_ring_add(_buf_ring, data, _buffer_size, bid, io_uring_buf_ring_mask(_buffer_count), 0);
+    io_uring_buf_ring_advance(_buf_ring, 1);
+  }
+
+  if (vc == nullptr) {
+    if (!more) {
+      this->free_op(op);
+    }
+    return;
+  }
+
+  NetIOUringState &u = vc->uring;
+  if (cqe->res == -ENOBUFS) {
+    // Out of buffers, the next read arms it again.
+    ProxyMutex *mutex = _nh->thread->mutex.get();
+    NET_INCREMENT_DYN_STAT(net_io_uring_recv_no_buffers_stat);
+  } else if (cqe->res <= 0 && cqe->res != -ECANCELED) {
+    u.recv_result = cqe->res;
+  } else if (more && !op->cancelled && u.reader->read_avail() >= _staged_limit) {
+    // Nobody is reading, stop until they catch up.
+    this->cancel(op);
+  }
+  if (!more) {
+    u.recv = nullptr;
+    this->free_op(op);
+  }
+
+  vc->read.triggered = 1;
+  if (vc->nh) {
+    vc->nh->read_ready_list.in_or_enqueue(vc);
+  }
+}
+
+void
+NetIOUring::complete_send(NetIOUringOp *op, io_uring_cqe *cqe)
+{
+  UnixNetVConnection *vc = op->vc;
+
+  this->free_op(op);
+  if (vc == nullptr) {
+    return;
+  }
+
+  NetIOUringState &u = vc->uring;
+  u.send             = nullptr;
+  // Anything else is the result of the send, -EAGAIN means it has to go again.
+  if (cqe->res != -EAGAIN) {
+    u.sent      = cqe->res;
+    u.send_done = true;
+  }
+  vc->write.triggered = 1;
+  if (vc->nh) {
+    vc->nh->write_ready_list.in_or_enqueue(vc);
+  }
+}
+
+void
+NetIOUring::reap()
+{
+  ProxyMutex *mutex = _nh->thread->mutex.get();
+  io_uring_cqe *cqe;
+  unsigned head;
+  unsigned count = 0;
+
+  io_uring_for_each_cqe(&_ring, head, cqe)
+  {
+    ++count;
+    if (cqe->user_data == EPOLL_TAG) {
+      _poll_armed  = false;
+      _epoll_ready = true;
+      continue;
+    }
+    NetIOUringOp *op = static_cast<NetIOUringOp *>(io_uring_cqe_get_data(cqe));
+    if (op == nullptr) { // cancel
+      continue;
+    }
+    if (op->type == NetIOUringOp::RECV) {
+      this->complete_recv(op, cqe);
+    } else {
+      this->complete_send(op, cqe);
+    }
+  }
+  io_uring_cq_advance(&_ring, count);
+  NET_SUM_DYN_STAT(net_io_uring_completions_stat, count);
+}
+
+int
+NetIOUring::wait(PollDescriptor *pd, int timeout)
+{
+  ProxyMutex *mutex = _nh->thread->mutex.get();
+  int ret           = 0;
+
+  // Anything that is not read or sent on the ring shows up on the epoll descriptor, which is polled
+  // here so the one call both submits and sleeps until there is something to do.
+  if (!_poll_armed) {
+    if (io_uring_sqe *sqe = this->get_sqe(); sqe) {
+      io_uring_prep_poll_add(sqe, pd->epoll_fd, POLLIN);
+      io_uring_sqe_set_data64(sqe, EPOLL_TAG);
+      _poll_armed = true;
+    }
+  }
+
+  if (timeout == 0) {
+    ret = io_uring_submit(&_ring);
+  } else {
+    io_uring_cqe *cqe = nullptr;
+    __kernel_timespec ts;
+    ts.tv_sec  = timeout / 1000;
+    ts.tv_nsec = 1000000 * (timeout % 1000);
+    ret        = io_uring_submit_and_wait_timeout(&_ring, &cqe, 1, timeout > 0 ? &ts : nullptr, nullptr);
+  }
+  ++_batch;
+  NET_INCREMENT_DYN_STAT(net_io_uring_submits_stat);
+  if (ret < 0 && ret != -ETIME && ret != -EAGAIN && ret != -EBUSY && ret != -EINTR) {
+    Warning("io_uring_submit failed: %s (%d)", strerror(-ret), -ret);
+  }
+
+  this->reap();
+
+  if (!_epoll_ready) {
+    return 0;
+  }
+  _epoll_ready = false;
+  return epoll_wait(pd->epoll_fd, pd->ePoll_Triggered_Events, POLL_DESCRIPTOR_SIZE, 0);
+}
+
+#endif
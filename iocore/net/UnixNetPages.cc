@@ -168,6 +168,10 @@ struct ShowNet : public ShowCont {
     CHECK_SHOW(show("<tr><td>%s</td><td>%d</td></tr>\n", "Connections", connections));
     // CHECK_SHOW(show("<tr><td>%s</td><td>%d</td></tr>\n", "Last Poll Size", pollDescriptor->nfds));
     CHECK_SHOW(show("<tr><td>%s</td><td>%d</td></tr>\n", "Last Poll Ready", pollDescriptor->result));
+    CHECK_SHOW(show("<tr><td>%s</td><td>%d</td></tr>\n", "Timers", static_cast<int>(nh->timer_wheel.count())));
+    CHECK_SHOW(show("<tr><td>%s</td><td>%" PRIu64 "</td></tr>\n", "Timers Expired", nh->timers_expired));
+    int64_t latency = nh->timers_expired ? ink_hrtime_to_msec(nh->timer_expiry_latency) / nh->timers_expired : 0;
+    CHECK_SHOW(show("<tr><td>%s</td><td>%" PRId64 "</td></tr>\n", "Mean Timer Expiry Latency (ms)", latency));
     CHECK_SHOW(show("</table>\n"));
     CHECK_SHOW(show("<table border=1>\n"));
     CHECK_SHOW(show("<tr><th>#</th><th>Read Priority</th><th>Read Bucket</th><th>Write Priority</th><th>Write Bucket</th></tr>\n"));
@@ -255,9 +255,15 @@ read_from_net(NetHandler *nh, UnixNetVConnection *vc, EThread *thread)
 
       ink_assert(niov > 0);
       ink_assert(niov <= countof(tiovec));
-      r = socketManager.readv(vc->con.fd, &tiovec[0], niov);
-
-      NET_INCREMENT_DYN_STAT(net_calls_to_read_stat);
+#if TS_USE_LINUX_IO_URING_NET
+      if (nh->io_uring) {
+        r = nh->io_uring->readv(vc, &tiovec[0], niov);
+      } else
+#endif
+      {
+        r = socketManager.readv(vc->con.fd, &tiovec[0], niov);
+        NET_INCREMENT_DYN_STAT(net_calls_to_read_stat);
+      }
 
       total_read += rattempted;
     } while (rattempted && r == rattempted && total_read < toread);
@@ -607,6 +613,9 @@ UnixNetVConnection::do_io_write(Continuation *c, int64_t nbytes, IOBufferReader
   write.vio.nbytes    = nbytes;
   write.vio.ndone     = 0;
   write.vio.vc_server = (VConnection *)this;
+#if TS_USE_LINUX_IO_URING_NET
+  ++uring.writer;
+#endif
   if (reader) {
     ink_assert(!owner);
     write.vio.buffer.reader_for(reader);
@@ -678,6 +687,9 @@ UnixNetVConnection::do_io_close(int alerrno /* = -1 */)
     } else {
       free(t);
     }
+  } else {
+    // Have the inactivity cop reap it on its next run.
+    update_timer(Thread::get_hrtime());
   }
 }
 
@@ -898,6 +910,7 @@ UnixNetVConnection::set_enabled(VIO *vio)
   STATE_FROM_VIO(vio)->enabled = 1;
   if (!next_inactivity_timeout_at && inactivity_timeout_in) {
     next_inactivity_timeout_at = Thread::get_hrtime() + inactivity_timeout_in;
+    update_timer(next_inactivity_timeout_at);
   }
 }
 
@@ -920,6 +933,13 @@ UnixNetVConnection::net_write_io(NetHandler *nh, EThread *lthread)
 int64_t
 UnixNetVConnection::load_buffer_and_write(int64_t towrite, MIOBufferAccessor &buf, int64_t &total_written, int &needs)
 {
+#if TS_USE_LINUX_IO_URING_NET
+  // The first write of a fast open connect carries the connect, that is done here.
+  if (nh && nh->io_uring && (this->con.is_connected || !this->options.f_tcp_fastopen)) {
+    return nh->io_uring->write(this, towrite, buf, total_written, needs);
+  }
+#endif
+
   int64_t r                  = 0;
   int64_t try_to_write       = 0;
   IOBufferReader *tmp_reader = buf.reader()->clone();
@@ -1347,6 +1367,11 @@ UnixNetVConnection::free(EThread *t)
 
   // cancel OOB
   cancel_OOB();
+#if TS_USE_LINUX_IO_URING_NET
+  if (uring.ring) {
+    uring.ring->detach(this);
+  }
+#endif
   // close socket fd
   if (con.fd != NO_FD) {
     NET_SUM_GLOBAL_DYN_STAT(net_connections_currently_open_stat, -1);
@@ -1377,6 +1402,7 @@ UnixNetVConnection::set_inactivity_timeout(ink_hrtime timeout_in)
   Debug("socket", "Set inactive timeout=%" PRId64 ", for NetVC=%p", timeout_in, this);
   inactivity_timeout_in      = timeout_in;
   next_inactivity_timeout_at = (timeout_in > 0) ? Thread::get_hrtime() + inactivity_timeout_in : 0;
+  update_timer(next_inactivity_timeout_at);
 }
 
 TS_INLINE void
@@ -1386,6 +1412,7 @@ UnixNetVConnection::set_default_inactivity_timeout(ink_hrtime timeout_in)
   inactivity_timeout_in      = 0;
   default_inactivity_timeout = true;
   next_inactivity_timeout_at = Thread::get_hrtime() + timeout_in;
+  update_timer(next_inactivity_timeout_at);
 }
 
 TS_INLINE bool
@@ -1394,6 +1421,18 @@ UnixNetVConnection::is_default_inactivity_timeout()
   return (default_inactivity_timeout && inactivity_timeout_in == 0);
 }
 
+void
+UnixNetVConnection::prepareForSharing()
+{
+  ink_assert(this->thread == this_ethread());
+#if TS_USE_LINUX_IO_URING_NET
+  // The completions on the ring would change the NetVC while another thread looks at it.
+  if (uring.ring) {
+    uring.ring->disarm(this);
+  }
+#endif
+}
+
 /*
  * Close down the current netVC.  Save aside the socket and SSL information
  * and create new netVC in the current thread/netVC
@@ -1407,6 +1446,13 @@ UnixNetVConnection::migrateToCurrentThread(Continuation *cont, EThread *t)
     // We're already there!
     return this;
   }
+#if TS_USE_LINUX_IO_URING_NET
+  // Still on the ring of the original thread after prepareForSharing, what is waiting there can not
+  // be moved so the caller opens a new connection instead.
+  if (uring.ring) {
+    return nullptr;
+  }
+#endif
 
   Connection hold_con;
   hold_con.move(this->con);
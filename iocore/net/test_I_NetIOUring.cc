@@ -0,0 +1,327 @@
+/** @file
+
+  Loopback test of connections on the io_uring of the NetHandler.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include <iostream>
+#include <cstdlib>
+#include <cstring>
+
+#include "tscore/ink_config.h"
+
+#if TS_USE_LINUX_IO_URING_NET
+
+#include <sys/wait.h>
+
+#include "tscore/I_Layout.h"
+#include "tscore/TestBox.h"
+
+#include "I_EventSystem.h"
+#include "RecordsConfig.h"
+#include "P_Net.h"
+
+#include "diags.i"
+
+static constexpr int CONNECTIONS = 4;     // In turn, so the descriptors are reused.
+static constexpr int CHUNK       = 65536; // More than a provided receive buffer.
+static constexpr int CHUNKS      = 8;
+
+in_port_t port = 0;
+int pfd[2]; // Pipe used to signal client with the port, 0 if there is no io_uring.
+
+/// Echo what is read back to the client, close at the end of the stream.
+class EchoSession : public Continuation
+{
+public:
+  EchoSession(UnixNetVConnection *vc) : Continuation(new_ProxyMutex()), vc(vc)
+  {
+    SET_HANDLER(&EchoSession::handle_io);
+    buffer = new_MIOBuffer(BUFFER_SIZE_INDEX_32K);
+    reader = buffer->alloc_reader();
+  }
+
+  ~EchoSession() override { free_MIOBuffer(buffer); }
+
+  void
+  start()
+  {
+    read_vio  = vc->do_io_read(this, INT64_MAX, buffer);
+    write_vio = vc->do_io_write(this, INT64_MAX, reader);
+  }
+
+  int handle_io(int event, void *data);
+
+  UnixNetVConnection *vc;
+  MIOBuffer *buffer;
+  IOBufferReader *reader;
+  VIO *read_vio  = nullptr;
+  VIO *write_vio = nullptr;
+};
+
+int
+EchoSession::handle_io(int event, void *)
+{
+  switch (event) {
+  case VC_EVENT_READ_READY:
+    write_vio->reenable();
+    break;
+
+  case VC_EVENT_WRITE_READY:
+    read_vio->reenable();
+    break;
+
+  case VC_EVENT_EOS:
+    if (vc->uring.ring == nullptr) {
+      std::cout << "Connection was not on the io_uring" << std::endl;
+      std::exit(EXIT_FAILURE);
+    }
+    vc->do_io_close();
+    delete this;
+    break;
+
+  default:
+    std::cout << "got unexpected event [" << event << "]" << std::endl;
+    std::exit(EXIT_FAILURE);
+  }
+
+  return EVENT_DONE;
+}
+
+class EchoServer : public Continuation
+{
+public:
+  EchoServer() : Continuation(new_ProxyMutex()) { SET_HANDLER(&EchoServer::start); };
+  int start(int, void *);
+  int accept(int event, void *data);
+};
+
+int
+EchoServer::start(int, void *)
+{
+  SET_HANDLER(&EchoServer::accept);
+
+  if (get_NetHandler(this_ethread())->io_uring == nullptr) {
+    std::cout << "io_uring is not available" << std::endl;
+    ink_release_assert(write(pfd[1], &port, sizeof(port)) == sizeof(port));
+    return EVENT_DONE;
+  }
+
+  sockaddr_in addr;
+  socklen_t addrlen   = sizeof(addr);
+  addr.sin_family      = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port        = 0;
+
+  int fd = socket(AF_INET, SOCK_STREAM, 0);
+  ink_release_assert(fd >= 0);
+  ink_release_assert(bind(fd, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) == 0);
+  ink_release_assert(listen(fd, 16) == 0);
+  ink_release_assert(getsockname(fd, reinterpret_cast<sockaddr *>(&addr), &addrlen) == 0);
+  port = ntohs(addr.sin_port);
+
+  NetProcessor::AcceptOptions opt;
+  opt.local_port     = port;
+  opt.localhost_only = true;
+  opt.accept_threads = 1;
+  netProcessor.main_accept(this, fd, opt);
+
+  std::cout << "Echo Server port: " << port << std::endl;
+  ink_release_assert(write(pfd[1], &port, sizeof(port)) == sizeof(port));
+  return EVENT_DONE;
+}
+
+int
+EchoServer::accept(int event, void *data)
+{
+  if (event != NET_EVENT_ACCEPT) {
+    std::cout << "got accept failure [" << event << "]" << std::endl;
+    std::exit(EXIT_FAILURE);
+  }
+  EchoSession *session = new EchoSession(static_cast<UnixNetVConnection *>(data));
+  SCOPED_MUTEX_LOCK(lock, session->mutex, this_ethread());
+  session->start();
+  return EVENT_DONE;
+}
+
+void
+signal_handler(int signum)
+{
+  std::exit(EXIT_SUCCESS);
+}
+
+void
+echo_server()
+{
+  Layout::create();
+  RecProcessInit(RECM_STAND_ALONE);
+  LibRecordsConfigInit();
+  RecSetRecordInt("proxy.config.net.io_uring.enabled", 1, REC_SOURCE_EXPLICIT);
+
+  Thread *main_thread = new EThread();
+  main_thread->set_specific();
+  net_config_poll_timeout = 10;
+
+  init_diags("net_io_uring", nullptr);
+  ink_event_system_init(EVENT_SYSTEM_MODULE_PUBLIC_VERSION);
+  ink_net_init(NET_SYSTEM_MODULE_PUBLIC_VERSION);
+  naVecMutex = new_ProxyMutex();
+  netProcessor.init();
+  eventProcessor.start(1);
+
+  signal(SIGPIPE, SIG_IGN);
+  signal(SIGTERM, signal_handler);
+
+  EchoServer server;
+  eventProcessor.schedule_imm(&server, ET_NET);
+
+  this_thread()->execute();
+}
+
+/// Send @c CHUNKS chunks over a new connection and check each comes back, then check the server closes.
+bool
+echo_client(int id)
+{
+  int sock = socket(AF_INET, SOCK_STREAM, 0);
+  if (sock < 0) {
+    std::cout << "Couldn't create socket" << std::endl;
+    return false;
+  }
+
+  struct timeval tv;
+  tv.tv_sec  = 20;
+  tv.tv_usec = 0;
+
+  setsockopt(sock, SOL_SOCKET, SO_SNDTIMEO, reinterpret_cast<char *>(&tv), sizeof(tv));
+  setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, reinterpret_cast<char *>(&tv), sizeof(tv));
+
+  sockaddr_in addr;
+  addr.sin_family      = AF_INET;
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  addr.sin_port        = htons(port);
+
+  if (connect(sock, reinterpret_cast<sockaddr *>(&addr), sizeof(addr)) < 0) {
+    std::cout << "Couldn't connect" << std::endl;
+    close(sock);
+    return false;
+  }
+
+  static char out[CHUNK];
+  static char in[CHUNK];
+  bool ok = true;
+
+  for (int i = 0; ok && i < CHUNKS; ++i) {
+    for (int k = 0; k < CHUNK; ++k) {
+      out[k] = static_cast<char>(id * 31 + i * 7 + k);
+    }
+    ok = write(sock, out, CHUNK) == CHUNK;
+    for (int n = 0; ok && n < CHUNK;) {
+      ssize_t r = recv(sock, in + n, CHUNK - n, 0);
+      ok        = r > 0;
+      n += r;
+    }
+    if (ok && memcmp(in, out, CHUNK) != 0) {
+      std::cout << "Echo doesn't match on connection " << id << " chunk " << i << std::endl;
+      ok = false;
+    }
+  }
+
+  // The server closes when it reads the end of the stream.
+  if (ok) {
+    shutdown(sock, SHUT_WR);
+    ok = recv(sock, in, sizeof(in), 0) == 0;
+    if (!ok) {
+      std::cout << "Connection " << id << " was not closed" << std::endl;
+    }
+  }
+
+  close(sock);
+  return ok;
+}
+
+static bool skipped = false;
+
+REGRESSION_TEST(NetIOUring_echo)(RegressionTest *t, int /* atype ATS_UNUSED */, int *pstatus)
+{
+  TestBox box(t, pstatus);
+  box = REGRESSION_TEST_PASSED;
+
+  int z = pipe(pfd);
+  if (z < 0) {
+    std::cout << "Unable to create pipe" << std::endl;
+    std::exit(EXIT_FAILURE);
+  }
+
+  pid_t pid = fork();
+  if (pid < 0) {
+    std::cout << "Couldn't fork" << std::endl;
+    std::exit(EXIT_FAILURE);
+  } else if (pid == 0) {
+    close(pfd[0]);
+    echo_server();
+  } else {
+    close(pfd[1]);
+    if (read(pfd[0], &port, sizeof(port)) <= 0) {
+      std::cout << "Failed to get signal with port data [" << errno << ']' << std::endl;
+      std::exit(EXIT_FAILURE);
+    }
+
+    bool ok = true;
+    if (port == 0) {
+      skipped = true;
+    } else {
+      for (int i = 0; ok && i < CONNECTIONS; ++i) {
+        ok = echo_client(i);
+      }
+    }
+
+    kill(pid, SIGTERM);
+    int status;
+    wait(&status);
+
+    if (WIFEXITED(status) && WEXITSTATUS(status) == 0) {
+      box.check(ok, "echo failed");
+    } else {
+      std::cout << "Echo Server exit failure" << std::endl;
+      std::exit(EXIT_FAILURE);
+    }
+  }
+}
+
+int
+main(int /* argc ATS_UNUSED */, const char ** /* argv ATS_UNUSED */)
+{
+  RegressionTest::run("NetIOUring", REGRESSION_TEST_QUICK);
+  if (skipped) {
+    return 77;
+  }
+  return RegressionTest::final_status == REGRESSION_TEST_PASSED ? 0 : 1;
+}
+
+#else
+
+int
+main(int /* argc ATS_UNUSED */, const char ** /* argv ATS_UNUSED */)
+{
+  std::cout << "io_uring network I/O is not built" << std::endl;
+  return 77;
+}
+
+#endif
@@ -0,0 +1,173 @@
+/** @file
+
+  Catch based unit tests for the network timer wheel.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "catch.hpp"
+
+#include <vector>
+
+#include "NetTimerWheel.h"
+
+namespace
+{
+struct Item {
+  explicit Item(int n) : id(n) {}
+
+  int id;
+  ink_hrtime timer_at = 0;
+  int timer_slot      = -1;
+  LINK(Item, timer_link);
+};
+
+constexpr ink_hrtime TICK  = HRTIME_SECOND;
+constexpr ink_hrtime START = HRTIME_SECONDS(1000);
+
+/// Advance @a wheel a tick at a time to @a to, recording when each item expires.
+std::vector<std::pair<int, ink_hrtime>>
+run(TimerWheel<Item> &wheel, ink_hrtime from, ink_hrtime to)
+{
+  std::vector<std::pair<int, ink_hrtime>> expired;
+  for (ink_hrtime now = from; now <= to; now += TICK) {
+    wheel.advance(now, [&](Item *item) { expired.emplace_back(item->id, now); });
+  }
+  return expired;
+}
+} // namespace
+
+TEST_CASE("TimerWheel expiry", "[net][TimerWheel]")
+{
+  TimerWheel<Item> wheel;
+  wheel.init(TICK, START);
+
+  SECTION("Never early, at most a tick late")
+  {
+    std::vector<Item> items;
+    // Spread over all the levels.
+    ink_hrtime delays[] = {0, TICK / 2, 2 * TICK, 5 * TICK, 63 * TICK, 64 * TICK, 65 * TICK, 1000 * TICK, 4095 * TICK, 4097 * TICK,
+                           300000 * TICK};
+    for (int i = 0; i < static_cast<int>(std::size(delays)); ++i) {
+      items.emplace_back(i);
+    }
+    for (size_t i = 0; i < items.size(); ++i) {
+      wheel.schedule(&items[i], START + delays[i]);
+    }
+    REQUIRE(wheel.count() == items.size());
+
+    auto expired = run(wheel, START, START + 300001 * TICK);
+    REQUIRE(expired.size() == items.size());
+    REQUIRE(wheel.count() == 0);
+    for (auto const &[id, when] : expired) {
+      CHECK(when >= START + delays[id]);
+      CHECK(when < START + delays[id] + TICK + TICK / 2);
+      CHECK(items[id].timer_slot == -1);
+    }
+    // In order of the times.
+    for (size_t i = 0; i < expired.size(); ++i) {
+      CHECK(expired[i].first == static_cast<int>(i));
+    }
+  }
+
+  SECTION("Skipped ticks")
+  {
+    Item a(0), b(1);
+    wheel.schedule(&a, START + 10 * TICK);
+    wheel.schedule(&b, START + 200 * TICK);
+    std::vector<int> expired;
+    wheel.advance(START + 150 * TICK, [&](Item *item) { expired.push_back(item->id); });
+    REQUIRE(expired == std::vector<int>{0});
+    wheel.advance(START + 199 * TICK, [&](Item *item) { expired.push_back(item->id); });
+    REQUIRE(expired.size() == 1);
+    wheel.advance(START + 200 * TICK, [&](Item *item) { expired.push_back(item->id); });
+    REQUIRE(expired == std::vector<int>{0, 1});
+  }
+
+  SECTION("Past the horizon")
+  {
+    Item a(0);
+    ink_hrtime far = START + (TimerWheel<Item>::SLOTS * TimerWheel<Item>::SLOTS * TimerWheel<Item>::SLOTS * 100) * TICK;
+    wheel.schedule(&a, far);
+    auto expired = run(wheel, START, START + (1 << 24) * TICK);
+    // Comes up early, the owner files it again.
+    REQUIRE(expired.size() == 1);
+    CHECK(expired[0].second < far);
+  }
+}
+
+TEST_CASE("TimerWheel changes", "[net][TimerWheel]")
+{
+  TimerWheel<Item> wheel;
+  wheel.init(TICK, START);
+  Item a(0), b(1), c(2);
+
+  SECTION("Remove")
+  {
+    wheel.schedule(&a, START + 3 * TICK);
+    wheel.schedule(&b, START + 100 * TICK);
+    REQUIRE(wheel.in(&a));
+    wheel.remove(&a);
+    wheel.remove(&b);
+    wheel.remove(&b);
+    REQUIRE(!wheel.in(&a));
+    REQUIRE(wheel.count() == 0);
+    REQUIRE(run(wheel, START, START + 200 * TICK).empty());
+  }
+
+  SECTION("Schedule again")
+  {
+    wheel.schedule(&a, START + 100 * TICK);
+    wheel.schedule(&b, START + 10 * TICK);
+    wheel.schedule(&a, START + 5 * TICK);
+    wheel.schedule(&b, START + 5000 * TICK);
+    REQUIRE(wheel.count() == 2);
+    auto expired = run(wheel, START, START + 6000 * TICK);
+    REQUIRE(expired.size() == 2);
+    CHECK(expired[0] == std::make_pair(0, START + 5 * TICK));
+    CHECK(expired[1] == std::make_pair(1, START + 5000 * TICK));
+  }
+
+  SECTION("Changes from the callback")
+  {
+    wheel.schedule(&a, START + 2 * TICK);
+    wheel.schedule(&b, START + 2 * TICK);
+    wheel.schedule(&c, START + 2 * TICK);
+    std::vector<int> expired;
+    int repeats = 0;
+    wheel.advance(START + 2 * TICK, [&](Item *item) {
+      expired.push_back(item->id);
+      // Take out whichever is left of the others and file this one for the same tick, which must wait.
+      for (Item *other : {&a, &b, &c}) {
+        if (other != item) {
+          wheel.remove(other);
+        }
+      }
+      if (repeats++ == 0) {
+        wheel.schedule(item, START + 2 * TICK);
+      }
+    });
+    REQUIRE(expired.size() == 1);
+    REQUIRE(wheel.count() == 1);
+    wheel.advance(START + 3 * TICK, [&](Item *item) { expired.push_back(item->id); });
+    REQUIRE(expired.size() == 2);
+    CHECK(expired[0] == expired[1]);
+    CHECK(wheel.count() == 0);
+  }
+}
@@ -59,6 +59,7 @@
 #define MGMT_EVENT_DRAIN 10013
 #define MGMT_EVENT_HOST_STATUS_UP 10014
 #define MGMT_EVENT_HOST_STATUS_DOWN 10015
+#define MGMT_EVENT_CACHE_INVALIDATE_TAG 10016
 
 /***********************************************************************
  *
@@ -500,6 +500,9 @@ ProcessManager::handleMgmtMsgFromLM(MgmtMessageHdr *mh)
   case MGMT_EVENT_STORAGE_DEVICE_CMD_OFFLINE:
     executeMgmtCallback(MGMT_EVENT_STORAGE_DEVICE_CMD_OFFLINE, payload);
     break;
+  case MGMT_EVENT_CACHE_INVALIDATE_TAG:
+    executeMgmtCallback(MGMT_EVENT_CACHE_INVALIDATE_TAG, payload);
+    break;
   case MGMT_EVENT_LIFECYCLE_MESSAGE:
     executeMgmtCallback(MGMT_EVENT_LIFECYCLE_MESSAGE, payload);
     break;
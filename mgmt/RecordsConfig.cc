@@ -119,6 +119,8 @@ static const RecordElement RecordsConfig[] =
   ,
   {RECT_CONFIG, "proxy.config.exec_thread.listen", RECD_INT, "0", RECU_RESTART_TS, RR_NULL, RECC_INT, "[0-1]", RECA_READ_ONLY}
   ,
+  {RECT_CONFIG, "proxy.config.exec_thread.work_stealing", RECD_INT, "0", RECU_RESTART_TS, RR_NULL, RECC_INT, "[0-1]", RECA_READ_ONLY}
+  ,
   {RECT_CONFIG, "proxy.config.accept_threads", RECD_INT, "1", RECU_RESTART_TS, RR_NULL, RECC_INT, "[0-" TS_STR(TS_MAX_NUMBER_EVENT_THREADS) "]", RECA_READ_ONLY}
   ,
   {RECT_CONFIG, "proxy.config.task_threads", RECD_INT, "2", RECU_RESTART_TS, RR_NULL, RECC_INT, "[1-" TS_STR(TS_MAX_NUMBER_EVENT_THREADS) "]", RECA_READ_ONLY}
@@ -774,6 +776,14 @@ static const RecordElement RecordsConfig[] =
   ,
   {RECT_CONFIG, "proxy.config.net.event_period", RECD_INT, "10", RECU_RESTART_TS, RR_NULL, RECC_NULL, nullptr, RECA_NULL}
   ,
+  {RECT_CONFIG, "proxy.config.net.io_uring.enabled", RECD_INT, "0", RECU_RESTART_TS, RR_NULL, RECC_INT, "[0-1]", RECA_NULL}
+  ,
+  {RECT_CONFIG, "proxy.config.net.io_uring.entries", RECD_INT, "4096", RECU_RESTART_TS, RR_NULL, RECC_INT, "[1-32768]", RECA_NULL}
+  ,
+  {RECT_CONFIG, "proxy.config.net.io_uring.recv_buffers", RECD_INT, "4096", RECU_RESTART_TS, RR_NULL, RECC_INT, "[1-32768]", RECA_NULL}
+  ,
+  {RECT_CONFIG, "proxy.config.net.io_uring.recv_buffer_size", RECD_INT, "16384", RECU_RESTART_TS, RR_NULL, RECC_INT, "[512-1048576]", RECA_NULL}
+  ,
   {RECT_CONFIG, "proxy.config.net.accept_period", RECD_INT, "10", RECU_RESTART_TS, RR_NULL, RECC_NULL, nullptr, RECA_NULL}
   ,
   {RECT_CONFIG, "proxy.config.net.retry_delay", RECD_INT, "10", RECU_DYNAMIC, RR_NULL, RECC_NULL, nullptr, RECA_NULL}
@@ -796,6 +806,41 @@ static const RecordElement RecordsConfig[] =
   ,
   {RECT_CONFIG, "proxy.config.cache.hit_evacuate_size_limit", RECD_INT, "0", RECU_RESTART_TS, RR_NULL, RECC_NULL, nullptr, RECA_NULL}
   ,
+  //  # directory entries the background scrubber examines per second per stripe, 0 to evacuate on read instead
+  {RECT_CONFIG, "proxy.config.cache.scrub.rate", RECD_INT, "0", RECU_RESTART_TS, RR_NULL, RECC_INT, "[0-100000000]", RECA_NULL}
+  ,
+  {RECT_CONFIG, "proxy.config.cache.scrub.heat_threshold", RECD_INT, "4", RECU_DYNAMIC, RR_NULL, RECC_INT, "[1-255]", RECA_NULL}
+  ,
+  //##############################################################################
+  //#
+  //# Hot Object Replication
+  //#
+  //##############################################################################
+  //  # additional copies of a hot document in other stripes, 0 to disable
+  {RECT_CONFIG, "proxy.config.cache.hot_replica.copies", RECD_INT, "0", RECU_RESTART_TS, RR_NULL, RECC_INT, "[0-8]", RECA_NULL}
+  ,
+  //  # lookups per second which make a document hot
+  {RECT_CONFIG, "proxy.config.cache.hot_replica.threshold", RECD_INT, "1000", RECU_DYNAMIC, RR_NULL, RECC_INT, "[1-100000000]", RECA_NULL}
+  ,
+  //##############################################################################
+  //#
+  //# Surrogate Keys
+  //#
+  //##############################################################################
+  //  # response header with the space separated tags of a document, unset to disable
+  {RECT_CONFIG, "proxy.config.cache.surrogate_key.header", RECD_STRING, nullptr, RECU_RESTART_TS, RR_NULL, RECC_NULL, nullptr, RECA_NULL}
+  ,
+  //##############################################################################
+  //#
+  //# Disk Buffer Pool
+  //#
+  //##############################################################################
+  //  # back the cache disk buffers with huge pages
+  {RECT_CONFIG, "proxy.config.cache.buffer_pool.hugepages", RECD_INT, "0", RECU_RESTART_TS, RR_NULL, RECC_INT, "[0-1]", RECA_NULL}
+  ,
+  //  # bytes of each buffer size a thread keeps, 0 to disable
+  {RECT_CONFIG, "proxy.config.cache.buffer_pool.thread_cache_size", RECD_INT, "4194304", RECU_RESTART_TS, RR_NULL, RECC_INT, "[0-1073741824]", RECA_NULL}
+  ,
   //##############################################################################
   //#
   //# Cache
@@ -815,10 +860,18 @@ static const RecordElement RecordsConfig[] =
   //  # alternatively: 20971520 (20MB)
   {RECT_CONFIG, "proxy.config.cache.ram_cache.size", RECD_INT, "-1", RECU_RESTART_TS, RR_NULL, RECC_STR, "^-?[0-9]+$", RECA_NULL}
   ,
-  {RECT_CONFIG, "proxy.config.cache.ram_cache.algorithm", RECD_INT, "1", RECU_RESTART_TS, RR_NULL, RECC_INT, "[0-1]", RECA_NULL}
+  {RECT_CONFIG, "proxy.config.cache.ram_cache.algorithm", RECD_INT, "1", RECU_RESTART_TS, RR_NULL, RECC_INT, "[0-2]", RECA_NULL}
   ,
   {RECT_CONFIG, "proxy.config.cache.ram_cache.use_seen_filter", RECD_INT, "1", RECU_RESTART_TS, RR_NULL, RECC_INT, "[0-1]", RECA_NULL}
   ,
+  {RECT_CONFIG, "proxy.config.cache.ram_cache.lock_free_entries", RECD_INT, "0", RECU_RESTART_TS, RR_NULL, RECC_INT, "[0-1048576]", RECA_NULL}
+  ,
+  {RECT_CONFIG, "proxy.config.cache.ram_cache.persist_entries", RECD_INT, "0", RECU_RESTART_TS, RR_NULL, RECC_INT, "[0-1048576]", RECA_NULL}
+  ,
+  {RECT_CONFIG, "proxy.config.cache.ram_cache.persist_frequency", RECD_INT, "300", RECU_DYNAMIC, RR_NULL, RECC_INT, "[1-86400]", RECA_NULL}
+  ,
+  {RECT_CONFIG, "proxy.config.cache.ram_cache.preload_rate", RECD_INT, "1000", RECU_DYNAMIC, RR_NULL, RECC_INT, "[1-1000000]", RECA_NULL}
+  ,
   {RECT_CONFIG, "proxy.config.cache.ram_cache.compress", RECD_INT, "0", RECU_RESTART_TS, RR_NULL, RECC_INT, "[0-3]", RECA_NULL}
   ,
   {RECT_CONFIG, "proxy.config.cache.ram_cache.compress_percent", RECD_INT, "90", RECU_RESTART_TS, RR_NULL, RECC_NULL, nullptr, RECA_NULL}
@@ -830,6 +883,10 @@ static const RecordElement RecordsConfig[] =
   ,
   {RECT_CONFIG, "proxy.config.cache.select_alternate", RECD_INT, "1", RECU_DYNAMIC, RR_NULL, RECC_NULL, nullptr, RECA_NULL}
   ,
+  //  # The hash for cache keys made from URLs, 0 = MD5 (SHA256 with FIPS), 1 = SipHash-2-4-128.
+  //  # Changing this clears the cache.
+  {RECT_CONFIG, "proxy.config.cache.key_hash", RECD_INT, "0", RECU_RESTART_TS, RR_NULL, RECC_INT, "[0-1]", RECA_NULL}
+  ,
   {RECT_CONFIG, "proxy.config.cache.ram_cache_cutoff", RECD_INT, "4194304", RECU_DYNAMIC, RR_NULL, RECC_NULL, nullptr, RECA_NULL}
   ,
   //  # The maximum number of alternates that are allowed for any given URL.
@@ -848,8 +905,16 @@ static const RecordElement RecordsConfig[] =
   ,
   {RECT_CONFIG, "proxy.config.cache.threads_per_disk", RECD_INT, "8", RECU_DYNAMIC, RR_NULL, RECC_NULL, nullptr, RECA_NULL}
   ,
+  {RECT_CONFIG, "proxy.config.aio.io_uring.entries", RECD_INT, "1024", RECU_RESTART_TS, RR_NULL, RECC_INT, "[1-32768]", RECA_NULL}
+  ,
   {RECT_CONFIG, "proxy.config.cache.agg_write_backlog", RECD_INT, "5242880", RECU_DYNAMIC, RR_NULL, RECC_NULL, nullptr, RECA_NULL}
   ,
+  //  # aggregation buffer writes in flight per disk, each stripe may always have one
+  {RECT_CONFIG, "proxy.config.cache.agg_write_in_flight", RECD_INT, "1", RECU_DYNAMIC, RR_NULL, RECC_INT, "[1-64]", RECA_NULL}
+  ,
+  //  # stripe and directory writes in flight per disk, reads are never held back, 0 for no limit
+  {RECT_CONFIG, "proxy.config.cache.io.max_writes_in_flight", RECD_INT, "4", RECU_DYNAMIC, RR_NULL, RECC_INT, "[0-1024]", RECA_NULL}
+  ,
   {RECT_CONFIG, "proxy.config.cache.enable_checksum", RECD_INT, "0", RECU_DYNAMIC, RR_NULL, RECC_NULL, nullptr, RECA_NULL}
   ,
   {RECT_CONFIG, "proxy.config.cache.alt_rewrite_max_size", RECD_INT, "4096", RECU_DYNAMIC, RR_NULL, RECC_NULL, nullptr, RECA_NULL}
@@ -858,10 +923,16 @@ static const RecordElement RecordsConfig[] =
   ,
   {RECT_CONFIG, "proxy.config.cache.mutex_retry_delay", RECD_INT, "2", RECU_DYNAMIC, RR_NULL, RECC_NULL, nullptr, RECA_NULL}
   ,
+  //  # how many stripes per disk to bring online at once at startup, 0 for all of them
+  {RECT_CONFIG, "proxy.config.cache.init.stripes_per_disk", RECD_INT, "0", RECU_RESTART_TS, RR_NULL, RECC_INT, "[0-1024]", RECA_NULL}
+  ,
   {RECT_CONFIG, "proxy.config.cache.read_while_writer.max_retries", RECD_INT, "10", RECU_DYNAMIC, RR_NULL, RECC_NULL, nullptr, RECA_NULL}
   ,
   {RECT_CONFIG, "proxy.config.cache.read_while_writer_retry.delay", RECD_INT, "50", RECU_DYNAMIC, RR_NULL, RECC_NULL, nullptr, RECA_NULL}
   ,
+  //  # fragments kept in memory for the readers of an object being written, 0 to disable
+  {RECT_CONFIG, "proxy.config.cache.read_while_writer.fragment_ring", RECD_INT, "4", RECU_DYNAMIC, RR_NULL, RECC_INT, "[0-8]", RECA_NULL}
+  ,
 
   //##############################################################################
   //#
@@ -1477,6 +1548,10 @@ static const RecordElement RecordsConfig[] =
   ,
   {RECT_CONFIG, "proxy.config.allocator.dontdump_iobuffers", RECD_INT, "1", RECU_RESTART_TS, RR_NULL, RECC_NULL, "[0-1]", RECA_NULL}
   ,
+  {RECT_CONFIG, "proxy.config.allocator.numa", RECD_INT, "0", RECU_RESTART_TS, RR_NULL, RECC_NULL, "[0-1]", RECA_NULL}
+  ,
+  {RECT_CONFIG, "proxy.config.allocator.numa_arena_size", RECD_INT, "0", RECU_RESTART_TS, RR_NULL, RECC_NULL, nullptr, RECA_NULL}
+  ,
 
   // Controls for TLS ASYN_JOBS and engine loading
   {RECT_CONFIG, "proxy.config.ssl.async.handshake.enabled", RECD_INT, "0", RECU_RESTART_TS, RR_NULL, RECC_NULL, "[0-1]", RECA_NULL},
@@ -479,6 +479,17 @@ StorageDeviceCmdOffline(const char *dev)
   lmgmt->signalEvent(MGMT_EVENT_STORAGE_DEVICE_CMD_OFFLINE, dev);
   return TS_ERR_OKAY;
 }
+/*-------------------------------------------------------------------------
+ * CacheInvalidateTag
+ *-------------------------------------------------------------------------
+ * Remove the cached documents carrying a surrogate key.
+ */
+TSMgmtError
+CacheInvalidateTag(const char *tag)
+{
+  lmgmt->signalEvent(MGMT_EVENT_CACHE_INVALIDATE_TAG, tag);
+  return TS_ERR_OKAY;
+}
 /*-------------------------------------------------------------------------
  * Lifecycle Message
  *-------------------------------------------------------------------------
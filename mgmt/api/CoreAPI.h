@@ -52,6 +52,7 @@ TSMgmtError Bounce(unsigned options);
 TSMgmtError Stop(unsigned options);                                                // stop traffic_server
 TSMgmtError Drain(unsigned options);                                               // drain requests of traffic_server
 TSMgmtError StorageDeviceCmdOffline(const char *dev);                              // Storage device operation.
+TSMgmtError CacheInvalidateTag(const char *tag);                                   // Remove documents by surrogate key.
 TSMgmtError LifecycleMessage(const char *tag, void const *data, size_t data_size); // Lifecycle alert to plugins.
 
 /***************************************************************************
@@ -483,6 +483,22 @@ StorageDeviceCmdOffline(const char *dev)
   return (ret == TS_ERR_OKAY) ? parse_generic_response(OpType::STORAGE_DEVICE_CMD_OFFLINE, main_socket_fd) : ret;
 }
 
+/*-------------------------------------------------------------------------
+ * CacheInvalidateTag
+ *-------------------------------------------------------------------------
+ * Remove the cached documents carrying a surrogate key.
+ */
+TSMgmtError
+CacheInvalidateTag(const char *tag)
+{
+  TSMgmtError ret;
+  OpType optype           = OpType::CACHE_INVALIDATE_TAG;
+  MgmtMarshallString name = const_cast<MgmtMarshallString>(tag);
+
+  ret = MGMTAPI_SEND_MESSAGE(main_socket_fd, OpType::CACHE_INVALIDATE_TAG, &optype, &name);
+  return (ret == TS_ERR_OKAY) ? parse_generic_response(OpType::CACHE_INVALIDATE_TAG, main_socket_fd) : ret;
+}
+
 /*-------------------------------------------------------------------------
  * Lifecycle Alert
  *-------------------------------------------------------------------------
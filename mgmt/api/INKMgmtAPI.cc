@@ -834,6 +834,12 @@ TSStorageDeviceCmdOffline(const char *dev)
   return StorageDeviceCmdOffline(dev);
 }
 
+tsapi TSMgmtError
+TSCacheCmdInvalidateTag(const char *tag)
+{
+  return CacheInvalidateTag(tag);
+}
+
 tsapi TSMgmtError
 TSLifecycleMessage(const char *tag, void const *data, size_t data_size)
 {
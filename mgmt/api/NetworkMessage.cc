@@ -63,6 +63,7 @@ static const struct NetCmdOperation requests[] = {
   /* LIFECYCLE_MESSAGE          */ {3, {MGMT_MARSHALL_INT, MGMT_MARSHALL_STRING, MGMT_MARSHALL_DATA}},
   /* HOST_STATUS_HOST_UP        */ {4, {MGMT_MARSHALL_INT, MGMT_MARSHALL_STRING, MGMT_MARSHALL_STRING, MGMT_MARSHALL_INT}},
   /* HOST_STATUS_HOST_DOWN      */ {4, {MGMT_MARSHALL_INT, MGMT_MARSHALL_STRING, MGMT_MARSHALL_STRING, MGMT_MARSHALL_INT}},
+  /* CACHE_INVALIDATE_TAG       */ {2, {MGMT_MARSHALL_INT, MGMT_MARSHALL_STRING}},
 };
 
 // Responses always begin with a TSMgmtError code, followed by additional fields.
@@ -99,6 +100,7 @@ static const struct NetCmdOperation responses[] = {
   /* LIFECYCLE_MESSAGE          */ {1, {MGMT_MARSHALL_INT}},
   /* HOST_STATUS_UP             */ {1, {MGMT_MARSHALL_INT}},
   /* HOST_STATUS_DOWN           */ {1, {MGMT_MARSHALL_INT}},
+  /* CACHE_INVALIDATE_TAG       */ {1, {MGMT_MARSHALL_INT}},
 };
 
 #define GETCMD(ops, optype, cmd)                           \
@@ -219,6 +221,7 @@ send_mgmt_error(int fd, OpType optype, TSMgmtError error)
   case OpType::HOST_STATUS_UP:
   case OpType::HOST_STATUS_DOWN:
   case OpType::STORAGE_DEVICE_CMD_OFFLINE:
+  case OpType::CACHE_INVALIDATE_TAG:
     ink_release_assert(responses[static_cast<unsigned>(optype)].nfields == 1);
     return send_mgmt_response(fd, optype, &ecode);
 
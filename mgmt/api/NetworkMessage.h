@@ -56,6 +56,7 @@ enum class OpType : MgmtMarshallInt {
   LIFECYCLE_MESSAGE,
   HOST_STATUS_UP,
   HOST_STATUS_DOWN,
+  CACHE_INVALIDATE_TAG,
   UNDEFINED_OP /* This must be last */
 };
 
@@ -642,6 +642,30 @@ handle_storage_device_cmd_offline(int fd, void *req, size_t reqlen)
   return send_mgmt_response(fd, OpType::STORAGE_DEVICE_CMD_OFFLINE, &err);
 }
 
+/**************************************************************************
+ * handle_cache_invalidate_tag
+ *
+ * purpose: handle cache surrogate key invalidation command.
+ * output: TS_ERR_xx
+ * note: None
+ *************************************************************************/
+static TSMgmtError
+handle_cache_invalidate_tag(int fd, void *req, size_t reqlen)
+{
+  MgmtMarshallInt optype;
+  MgmtMarshallString tag = nullptr;
+  MgmtMarshallInt err;
+
+  err = recv_mgmt_request(req, reqlen, OpType::CACHE_INVALIDATE_TAG, &optype, &tag);
+  if (err == TS_ERR_OKAY) {
+    // forward to server
+    lmgmt->signalEvent(MGMT_EVENT_CACHE_INVALIDATE_TAG, tag);
+  }
+
+  ats_free(tag);
+  return send_mgmt_response(fd, OpType::CACHE_INVALIDATE_TAG, &err);
+}
+
 /**************************************************************************
  * handle_event_resolve
  *
@@ -1040,6 +1064,7 @@ static const control_message_handler handlers[] = {
   /* LIFECYCLE_MESSAGE          */ {MGMT_API_PRIVILEGED, handle_lifecycle_message},
   /* HOST_STATUS_UP             */ {MGMT_API_PRIVILEGED, handle_host_status_up},
   /* HOST_STATUS_DOWN           */ {MGMT_API_PRIVILEGED, handle_host_status_down},
+  /* CACHE_INVALIDATE_TAG       */ {MGMT_API_PRIVILEGED, handle_cache_invalidate_tag},
 };
 
 // This should use countof(), but we need a constexpr :-/
@@ -379,6 +379,12 @@ tsapi TSMgmtError TSDrain(unsigned options);
  */
 tsapi TSMgmtError TSStorageDeviceCmdOffline(const char *dev);
 
+/* TSCacheCmdInvalidateTag: Request to remove the cached documents carrying a surrogate key.
+ * @arg tag Surrogate key, as in the proxy.config.cache.surrogate_key.header response header.
+ * @return Success.
+ */
+tsapi TSMgmtError TSCacheCmdInvalidateTag(const char *tag);
+
 /* TSLifecycleMessage: Send a lifecycle message to the plugins.
  * @arg tag Alert tag string (null-terminated)
  * @return Success
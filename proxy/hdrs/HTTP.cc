@@ -29,7 +29,9 @@
 #include <cstring>
 #include "HTTP.h"
 #include "HdrToken.h"
+#include "HdrUtils.h"
 #include "tscore/Diags.h"
+#include "tscore/HashFNV.h"
 
 /***********************************************************************
  *                                                                     *
@@ -1921,12 +1923,13 @@ HTTPCacheAlt::copy(HTTPCacheAlt *to_copy)
 {
   m_magic = to_copy->m_magic;
   // m_writeable =      to_copy->m_writeable;
-  m_unmarshal_len = to_copy->m_unmarshal_len;
-  m_id            = to_copy->m_id;
-  m_rid           = to_copy->m_rid;
+  m_unmarshal_len    = to_copy->m_unmarshal_len;
+  m_id               = to_copy->m_id;
+  m_sparse_frag_size = to_copy->m_sparse_frag_size;
   memcpy(&m_object_key[0], &to_copy->m_object_key[0], CRYPTO_HASH_SIZE);
   m_object_size[0] = to_copy->m_object_size[0];
   m_object_size[1] = to_copy->m_object_size[1];
+  m_vary_key       = to_copy->m_vary_key;
 
   if (to_copy->m_request_hdr.valid()) {
     m_request_hdr.copy(&to_copy->m_request_hdr);
@@ -2011,6 +2014,42 @@ HTTPInfo::marshal_length()
   return len;
 }
 
+uint32_t
+HTTPInfo::vary_key(HTTPHdr *response, HTTPHdr *request)
+{
+  ATSHash32FNV1a hash;
+  MIMEField *vary = response->field_find(MIME_FIELD_VARY, MIME_LEN_VARY);
+
+  if (vary) {
+    HdrCsvIter names;
+    int name_len;
+    for (const char *name = names.get_first(vary, &name_len); name; name = names.get_next(&name_len)) {
+      if (name_len == 0) {
+        continue;
+      }
+      const char *wks  = hdrtoken_string_to_wks(name, name_len);
+      MIMEField *field = request->field_find(wks ? wks : name, name_len);
+
+      hash.update(name, name_len, ATSHash::nocase());
+      if (field == nullptr) {
+        // Absent is different from every value, including an empty one.
+        hash.update("\0\1", 2);
+        continue;
+      }
+      // Values are compared one by one without case, so hash them that way with a separator.
+      HdrCsvIter values;
+      int value_len;
+      hash.update("\0", 1);
+      for (const char *value = values.get_first(field, &value_len); value; value = values.get_next(&value_len)) {
+        hash.update(value, value_len, ATSHash::nocase());
+        hash.update(",", 1);
+      }
+    }
+  }
+  hash.final();
+  return hash.get() ? hash.get() : 1;
+}
+
 int
 HTTPInfo::marshal(char *buf, int len)
 {
@@ -2024,6 +2063,10 @@ HTTPInfo::marshal(char *buf, int len)
   // Make sure the buffer is aligned
   //    ink_assert(((intptr_t)buf) & 0x3 == 0);
 
+  if (m_alt->m_request_hdr.valid() && m_alt->m_response_hdr.valid()) {
+    m_alt->m_vary_key = vary_key(&m_alt->m_response_hdr, &m_alt->m_request_hdr);
+  }
+
   // Memcpy the whole object so that we can use it
   //   live later.  This involves copying a few
   //   extra bytes now but will save copying any
@@ -2345,3 +2388,24 @@ HTTPInfo::push_frag_offset(FragOffset offset)
 
   m_alt->m_frag_offsets[m_alt->m_frag_offset_count++] = offset;
 }
+
+bool
+HTTPInfo::mark_sparse(int64_t size, int32_t frag_size)
+{
+  ink_assert(m_alt && frag_size > 0);
+  ink_assert(m_alt->m_frag_offset_count == 0);
+  int64_t n = frag_size;
+  while ((size + n - 1) / n > SPARSE_MAX_FRAGS) {
+    n *= 2;
+  }
+  if (n > SPARSE_MAX_FRAG_SIZE) {
+    return false;
+  }
+  frag_size                 = n;
+  m_alt->m_sparse_frag_size = frag_size;
+  object_size_set(size);
+  for (int64_t offset = frag_size; offset < size; offset += frag_size) {
+    push_frag_offset(offset);
+  }
+  return true;
+}
@@ -1345,11 +1345,16 @@ struct HTTPCacheAlt {
   int32_t m_writeable     = 1;
   int32_t m_unmarshal_len = -1;
 
-  int32_t m_id  = -1;
-  int32_t m_rid = -1;
+  int32_t m_id = -1;
+  /// Payload length of each fragment of a sparse (partially cached) object, -1 if the object is stored whole.
+  /// @note This takes the slot of the unused request id so the marshaled layout does not change.
+  int32_t m_sparse_frag_size = -1;
 
   int32_t m_object_key[sizeof(CryptoHash) / sizeof(int32_t)];
   int32_t m_object_size[2];
+  /// Hash of the request header values named by the response Vary header, 0 if not known.
+  /// @note This is in what was padding before the headers so the marshaled layout does not change.
+  uint32_t m_vary_key = 0;
 
   HTTPHdr m_request_hdr;
   HTTPHdr m_response_hdr;
@@ -1427,22 +1432,12 @@ public:
   {
     return m_alt->m_id;
   }
-  int32_t
-  rid_get()
-  {
-    return m_alt->m_rid;
-  }
 
   void
   id_set(int32_t id)
   {
     m_alt->m_id = id;
   }
-  void
-  rid_set(int32_t id)
-  {
-    m_alt->m_rid = id;
-  }
 
   CryptoHash object_key_get();
   void object_key_get(CryptoHash *);
@@ -1522,6 +1517,49 @@ public:
   /// Add an @a offset to the end of the fragment offset table.
   void push_frag_offset(FragOffset offset);
 
+  /// Most fragments of a sparse object, so its fragment table fits in the head of the object.
+  static constexpr int64_t SPARSE_MAX_FRAGS = 65536;
+  /// Largest fragment of a sparse object, below the largest cache fragment.
+  static constexpr int32_t SPARSE_MAX_FRAG_SIZE = 2 * 1024 * 1024;
+
+  /** Mark the alternate as a sparse object of @a size bytes.
+      The object is stored in fragments of @a frag_size bytes which are cached independently, so any of
+      them may be missing. The fragment offset table is filled in for the whole object.
+
+      @a frag_size is doubled until the object has at most @c SPARSE_MAX_FRAGS fragments, so callers
+      must use @c sparse_frag_size_get for the fragment boundaries.
+
+      @return @c false if the object needs fragments larger than @c SPARSE_MAX_FRAG_SIZE, the
+      alternate is left as it was.
+  */
+  bool mark_sparse(int64_t size, int32_t frag_size);
+  /// Check if the alternate is a sparse object.
+  bool
+  is_sparse() const
+  {
+    return m_alt->m_sparse_frag_size > 0;
+  }
+  /// Get the fragment payload length of a sparse object.
+  int32_t
+  sparse_frag_size_get() const
+  {
+    return m_alt->m_sparse_frag_size;
+  }
+
+  /// Get the Vary key of the stored request, 0 if not known. This is set when the alternate is marshaled.
+  uint32_t
+  vary_key_get() const
+  {
+    return m_alt->m_vary_key;
+  }
+
+  /** Hash the values in @a request of the headers named by the Vary header of @a response.
+
+      Two requests get the same key if their selecting headers match as for
+      @c HttpCompat::do_vary_header_values_match, barring hash collisions. The result is never 0.
+   */
+  static uint32_t vary_key(HTTPHdr *response, HTTPHdr *request);
+
   // Sanity check functions
   static bool check_marshalled(char *buf, int len);
 
@@ -98,6 +98,12 @@ int URL_LEN_MMST;
 // url_CryptoHash_get_fast() does NOT produce the same result as url_CryptoHash_get_general().
 static int url_hash_method = 0;
 
+#if TS_ENABLE_FIPS == 1
+URLHashContext::HashType URLHashContext::Setting = URLHashContext::SHA256;
+#else
+URLHashContext::HashType URLHashContext::Setting = URLHashContext::MD5;
+#endif
+
 // test to see if a character is a valid character for a host in a URI according to
 // RFC 3986 and RFC 1034
 inline static int
@@ -89,7 +89,15 @@ struct URLImpl : public HdrHeapObjImpl {
   void check_strings(HeapCheck *heaps, int num_heaps);
 };
 
-using URLHashContext = CryptoContext;
+/// The hash for cache keys made from URLs, selected by proxy.config.cache.key_hash.
+/// This is independent of @c CryptoContext::Setting which is used for everything else.
+class URLHashContext : public CryptoContext
+{
+public:
+  URLHashContext() : CryptoContext(Setting) {}
+
+  static HashType Setting;
+};
 
 extern const char *URL_SCHEME_FILE;
 extern const char *URL_SCHEME_FTP;
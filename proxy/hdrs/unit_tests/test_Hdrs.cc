@@ -2033,3 +2033,47 @@ TEST_CASE("HdrTest", "[proxy][hdrtest]")
     }
   }
 }
+
+TEST_CASE("HdrVaryKey", "[proxy][hdrtest]")
+{
+  auto parse = [](HTTPHdr &hdr, HTTPType type, ts::TextView text) {
+    HTTPParser parser;
+    http_parser_init(&parser);
+    hdr.create(type);
+    const char *start = text.data();
+    if (type == HTTP_TYPE_REQUEST) {
+      REQUIRE(hdr.parse_req(&parser, &start, text.data_end(), true) == PARSE_RESULT_DONE);
+    } else {
+      REQUIRE(hdr.parse_resp(&parser, &start, text.data_end(), true) == PARSE_RESULT_DONE);
+    }
+    http_parser_clear(&parser);
+  };
+  HTTPHdr resp, plain, gzip_br, gzip_br_spaced, br_gzip, gzip, absent, empty;
+
+  parse(resp, HTTP_TYPE_RESPONSE, "HTTP/1.1 200 OK\r\nVary: Accept-Encoding, X-Mode\r\n\r\n");
+  parse(plain, HTTP_TYPE_RESPONSE, "HTTP/1.1 200 OK\r\n\r\n");
+  parse(gzip_br, HTTP_TYPE_REQUEST, "GET / HTTP/1.1\r\nAccept-Encoding: gzip,br\r\nX-Mode: a\r\n\r\n");
+  parse(gzip_br_spaced, HTTP_TYPE_REQUEST, "GET / HTTP/1.1\r\naccept-encoding: GZIP , br\r\nX-Mode: a\r\n\r\n");
+  parse(br_gzip, HTTP_TYPE_REQUEST, "GET / HTTP/1.1\r\nAccept-Encoding: br, gzip\r\nX-Mode: a\r\n\r\n");
+  parse(gzip, HTTP_TYPE_REQUEST, "GET / HTTP/1.1\r\nAccept-Encoding: gzip\r\nAccept-Encoding: br\r\nX-Mode: a\r\n\r\n");
+  parse(absent, HTTP_TYPE_REQUEST, "GET / HTTP/1.1\r\nAccept-Encoding: gzip,br\r\n\r\n");
+  parse(empty, HTTP_TYPE_REQUEST, "GET / HTTP/1.1\r\nAccept-Encoding: gzip,br\r\nX-Mode:\r\n\r\n");
+
+  uint32_t key = HTTPInfo::vary_key(&resp, &gzip_br);
+  CHECK(key != 0);
+  // Keys are equal when the values match as for Vary.
+  CHECK(HTTPInfo::vary_key(&resp, &gzip_br_spaced) == key);
+  CHECK(HTTPInfo::vary_key(&resp, &gzip) == key);
+  CHECK(HttpCompat::do_vary_header_values_match(gzip_br.field_find(MIME_FIELD_ACCEPT_ENCODING, MIME_LEN_ACCEPT_ENCODING),
+                                                gzip.field_find(MIME_FIELD_ACCEPT_ENCODING, MIME_LEN_ACCEPT_ENCODING)));
+  CHECK(HTTPInfo::vary_key(&resp, &br_gzip) != key);
+  CHECK(HTTPInfo::vary_key(&resp, &absent) != key);
+  CHECK(HTTPInfo::vary_key(&resp, &empty) != key);
+  CHECK(HTTPInfo::vary_key(&resp, &absent) != HTTPInfo::vary_key(&resp, &empty));
+  // Without Vary every request has the same key.
+  CHECK(HTTPInfo::vary_key(&plain, &gzip_br) == HTTPInfo::vary_key(&plain, &absent));
+
+  for (HTTPHdr *hdr : {&resp, &plain, &gzip_br, &gzip_br_spaced, &br_gzip, &gzip, &absent, &empty}) {
+    hdr->destroy();
+  }
+}
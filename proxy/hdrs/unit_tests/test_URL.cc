@@ -19,6 +19,8 @@
  */
 
 #include <cstdio>
+#include <chrono>
+#include <iostream>
 
 #include "catch.hpp"
 
@@ -483,3 +485,65 @@ TEST_CASE("UrlParse", "[proxy][parseurl]")
     test_parse(test_case, URL_PARSE_REGEX);
   }
 }
+
+TEST_CASE("UrlHash", "[proxy][urlhash]")
+{
+  // the fast path, and the general path for the query string
+  std::string_view urls[] = {"http://www.example.com/images/logo.png", "http://www.example.com/search?q=traffic%20server"};
+  // MD5, or SHA256 with FIPS
+  auto saved = URLHashContext::Setting;
+
+  for (auto text : urls) {
+    URL url;
+    HdrHeap *heap = new_HdrHeap();
+    url.create(heap);
+    REQUIRE(url.parse(text) == PARSE_RESULT_DONE);
+
+    CryptoHash default_hash, sip_hash, hash;
+    URLHashContext::Setting = saved;
+    url.hash_get(&default_hash);
+    URLHashContext::Setting = URLHashContext::SIPHASH;
+    url.hash_get(&sip_hash);
+    url.hash_get(&hash);
+    CHECK(sip_hash == hash);
+    CHECK(sip_hash != default_hash);
+    url.hash_get(&hash, 1);
+    CHECK(sip_hash != hash);
+    heap->destroy();
+  }
+  URLHashContext::Setting = saved;
+}
+
+// Normally there's no point in running the performance tests, but it's worth keeping the code
+// for when additional testing needs to be done.
+#if 0
+TEST_CASE("UrlHash performance", "[proxy][urlhash][performance]")
+{
+  constexpr int N_LOOPS = 1000000;
+  // the fast path, and the general path for the query string
+  std::string_view urls[] = {"http://www.example.com/images/logo.png", "http://www.example.com/search?q=traffic%20server"};
+  // MD5, or SHA256 with FIPS
+  auto saved = URLHashContext::Setting;
+
+  for (auto text : urls) {
+    URL url;
+    HdrHeap *heap = new_HdrHeap();
+    url.create(heap);
+    REQUIRE(url.parse(text) == PARSE_RESULT_DONE);
+
+    CryptoHash hash;
+    for (auto type : {saved, URLHashContext::SIPHASH}) {
+      URLHashContext::Setting = type;
+      auto start              = std::chrono::high_resolution_clock::now();
+      for (int i = 0; i < N_LOOPS; ++i) {
+        url.hash_get(&hash);
+      }
+      auto delta = std::chrono::high_resolution_clock::now() - start;
+      std::cout << (type == saved ? "default " : "SipHash ") << text << " "
+                << std::chrono::duration_cast<std::chrono::nanoseconds>(delta).count() / N_LOOPS << "ns" << std::endl;
+    }
+    heap->destroy();
+  }
+  URLHashContext::Setting = saved;
+}
+#endif
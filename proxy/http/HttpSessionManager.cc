@@ -467,6 +467,12 @@ HttpSessionManager::release_session(PoolableSession *to_release)
   // The per thread lock looks like it should not be needed but if it's not locked the close checking I/O op will crash.
   MUTEX_TRY_LOCK(lock, pool->mutex, ethread);
   if (lock.is_locked()) {
+    // Sessions in the global pool can be taken by other threads, which move the connection there.
+    if (pool == m_g_pool) {
+      if (UnixNetVConnection *vc = dynamic_cast<UnixNetVConnection *>(to_release->get_netvc()); vc) {
+        vc->prepareForSharing();
+      }
+    }
     pool->releaseSession(to_release);
   } else if (this->get_pool_type() == TS_SERVER_SESSION_SHARING_POOL_HYBRID) {
     // Try again with the thread pool
@@ -27,6 +27,7 @@
 #include "HttpTransactHeaders.h"
 #include "HttpTransactCache.h"
 #include <ctime>
+#include <vector>
 #include "HTTP.h"
 #include "HttpCompat.h"
 #include "tscore/InkErrno.h"
@@ -189,7 +190,7 @@ HttpTransactCache::SelectFromAlternates(CacheHTTPInfoVector *cache_vector, HTTPH
     return 0;
   }
 
-  for (int i = 0; i < alt_count; i++) {
+  auto score = [&](int i) {
     float Q;
     CacheHTTPInfo *obj       = cache_vector->get(i);
     HTTPHdr *cached_request  = obj->request_get();
@@ -248,6 +249,48 @@ HttpTransactCache::SelectFromAlternates(CacheHTTPInfoVector *cache_vector, HTTPH
         best_index = i;
       }
     }
+  };
+
+  // Alternates stored for the same values of the request headers named by Vary are the ones the
+  // origin chose for a request like this one. If one of those is acceptable the rest are not
+  // scored, which saves comparing the headers of every alternate of objects with many variants.
+  // Alternates from before the key was kept have no key and are always scored. Plugins on the
+  // select alternate hook may prefer any alternate, so then all of them are scored. The key covers
+  // every header named by Vary, so it is not used when User-Agent or Accept-Encoding is ignored
+  // by CalcVariability.
+  std::vector<bool> scored(alt_count, false);
+  if (alt_count > 1 && http_global_hooks->get(TS_HTTP_SELECT_ALT_HOOK) == nullptr &&
+      http_config_params->global_user_agent_header == nullptr && !http_config_params->ignore_accept_encoding_mismatch) {
+    MIMEField *last_vary = nullptr;
+    uint32_t client_key  = 0;
+    for (int i = 0; i < alt_count; i++) {
+      CacheHTTPInfo *obj = cache_vector->get(i);
+      uint32_t key       = obj->vary_key_get();
+      if (key != 0) {
+        // Alternates of an object nearly always have the same Vary, so the key is made once.
+        MIMEField *vary = obj->response_get()->field_find(MIME_FIELD_VARY, MIME_LEN_VARY);
+        if (client_key == 0 || vary == nullptr || last_vary == nullptr || vary->has_dups() || last_vary->has_dups() ||
+            vary->value_get() != last_vary->value_get()) {
+          client_key = HTTPInfo::vary_key(obj->response_get(), client_request);
+        }
+        last_vary = vary;
+        if (key != client_key) {
+          continue;
+        }
+      }
+      score(i);
+      scored[i] = true;
+    }
+    if (best_index != -1 && best_Q > unacceptable_Q) {
+      Debug("http_match", "[SelectFromAlternates] alternate %d selected by Vary key", best_index);
+    }
+  }
+  if (best_index == -1 || best_Q <= unacceptable_Q) {
+    for (int i = 0; i < alt_count; i++) {
+      if (!scored[i]) {
+        score(i);
+      }
+    }
   }
   Debug("http_seq", "[SelectFromAlternates] Chosen alternate # %d", best_index);
   if (is_debug_tag_set("http_alts")) {
@@ -244,6 +244,7 @@ Stripe::InitializeMeta()
       j.phase = j.cycle = j.sync_serial = j.write_serial = j.dirty = 0;
       j.create_time                                                = time(nullptr);
       j.sector_size                                                = DEFAULT_HW_SECTOR_SIZE;
+      j.key_hash                                                   = 0;
     }
   }
   if (!freelist) // freelist is not allocated yet
@@ -265,7 +266,7 @@ Stripe::validateMeta(StripeMeta const *meta)
 {
   // Need to be bit more robust at some point.
   return StripeMeta::MAGIC == meta->magic && meta->version._major <= ts::CACHE_DB_MAJOR_VERSION &&
-         meta->version._minor <= 2 // This may have always been zero, actually.
+         meta->version._minor <= ts::CACHE_DB_MINOR_VERSION // This may have always been zero, actually.
     ;
 }
 
@@ -364,8 +365,9 @@ Stripe::vol_dirlen()
 void
 Stripe::vol_init_data_internal()
 {
-  this->_buckets =
-    ((this->_len.count() * 8192 - (this->_content - this->_start)) / cache_config_min_average_object_size) / DIR_DEPTH;
+  int avg_obj_size = this->_avg_obj_size ? this->_avg_obj_size : cache_config_min_average_object_size;
+
+  this->_buckets  = ((this->_len.count() * 8192 - (this->_content - this->_start)) / avg_obj_size) / DIR_DEPTH;
   this->_segments = (this->_buckets + (((1 << 16) - 1) / DIR_DEPTH)) / ((1 << 16) / DIR_DEPTH);
   this->_buckets  = (this->_buckets + this->_segments - 1) / this->_segments;
   this->_content  = this->_start + Bytes(2 * vol_dirlen());
@@ -409,6 +411,31 @@ Stripe::updateLiveData(enum Copy c)
   _directory._skip = header_len;
 }
 
+// permutation table, as in iocore/cache/CacheDir.cc
+static const uint8_t CacheKey_next_table[256] = {
+  21,  53,  167, 51,  255, 126, 241, 151, 115, 66,  155, 174, 226, 215, 80,  188, 12,  95,  8,   24,  162, 201, 46,  104, 79,  172,
+  39,  68,  56,  144, 142, 217, 101, 62,  14,  108, 120, 90,  61,  47,  132, 199, 110, 166, 83,  125, 57,  65,  19,  130, 148, 116,
+  228, 189, 170, 1,   71,  0,   252, 184, 168, 177, 88,  229, 242, 237, 183, 55,  13,  212, 240, 81,  211, 74,  195, 205, 147, 93,
+  30,  87,  86,  63,  135, 102, 233, 106, 118, 163, 107, 10,  243, 136, 160, 119, 43,  161, 206, 141, 203, 78,  175, 36,  37,  140,
+  224, 197, 185, 196, 248, 84,  122, 73,  152, 157, 18,  225, 219, 145, 45,  2,   171, 249, 173, 32,  143, 137, 69,  41,  35,  89,
+  33,  98,  179, 214, 114, 231, 251, 123, 180, 194, 29,  3,   178, 31,  192, 164, 15,  234, 26,  230, 91,  156, 5,   16,  23,  244,
+  58,  50,  4,   67,  134, 165, 60,  235, 250, 7,   138, 216, 49,  139, 191, 154, 11,  52,  239, 59,  111, 245, 9,   64,  25,  129,
+  247, 232, 190, 246, 109, 22,  112, 210, 221, 181, 92,  169, 48,  100, 193, 77,  103, 133, 70,  220, 207, 223, 176, 204, 76,  186,
+  200, 208, 158, 182, 227, 222, 131, 38,  187, 238, 6,   34,  253, 128, 146, 44,  94,  127, 105, 153, 113, 20,  27,  124, 159, 17,
+  72,  218, 96,  149, 213, 42,  28,  254, 202, 40,  117, 82,  97,  209, 54,  236, 121, 75,  85,  150, 99,  198,
+};
+
+void
+next_CacheKey(CryptoHash *next_key, const CryptoHash *key)
+{
+  uint8_t *b       = next_key->u8;
+  const uint8_t *k = key->u8;
+  b[0]             = CacheKey_next_table[k[0]];
+  for (int i = 1; i < 16; i++) {
+    b[i] = CacheKey_next_table[(b[i - 1] + k[i]) & 0xFF];
+  }
+}
+
 bool
 dir_compare_tag(const CacheDirEntry *e, const CryptoHash *key)
 {
@@ -418,13 +445,13 @@ dir_compare_tag(const CacheDirEntry *e, const CryptoHash *key)
 int
 vol_in_phase_valid(Stripe *d, CacheDirEntry *e)
 {
-  return (dir_offset(e) - 1 < ((d->_meta[0][0].write_pos + d->agg_buf_pos - d->_start) / CACHE_BLOCK_SIZE));
+  return (dir_offset(e) - 1 < ((d->_meta[0][0].write_pos + d->agg_buf_pos - d->_content) / CACHE_BLOCK_SIZE));
 }
 
 int
 vol_out_of_phase_valid(Stripe *d, CacheDirEntry *e)
 {
-  return (dir_offset(e) - 1 >= ((d->_meta[0][0].agg_pos - d->_start) / CACHE_BLOCK_SIZE));
+  return (dir_offset(e) - 1 >= ((d->_meta[0][0].agg_pos - d->_content) / CACHE_BLOCK_SIZE));
 }
 
 bool
@@ -492,6 +519,34 @@ Stripe::dir_probe(CryptoHash *key, CacheDirEntry *result, CacheDirEntry **last_c
   return 0; // Why does this have a non-void return?
 }
 
+CacheDirEntry *
+Stripe::dir_insert(const CryptoHash *key, const CacheDirEntry *to)
+{
+  int s              = key->slice32(0) % this->_segments;
+  int b              = key->slice32(1) % this->_buckets;
+  CacheDirEntry *seg = this->dir_segment(s);
+  CacheDirEntry *e   = dir_bucket(b, seg);
+
+  if (dir_offset(e)) {
+    // take the head of the segment freelist and link it in after the bucket
+    CacheDirEntry *f = dir_from_offset(this->freelist[s], seg);
+    if (!f) {
+      return nullptr;
+    }
+    this->freelist[s] = dir_next(f);
+    if (CacheDirEntry *h = dir_from_offset(this->freelist[s], seg); h) {
+      dir_set_prev(h, 0);
+    }
+    dir_assign(f, to);
+    dir_set_next(f, dir_next(e));
+    dir_set_next(e, dir_to_offset(f, seg));
+    return f;
+  }
+  dir_assign(e, to);
+  dir_set_next(e, 0);
+  return e;
+}
+
 CacheDirEntry *
 Stripe::dir_delete_entry(CacheDirEntry *e, CacheDirEntry *p, int s)
 {
@@ -632,6 +687,53 @@ Stripe::loadDir()
   }
   return zret;
 }
+
+void
+Stripe::unloadDir()
+{
+  if (dir) {
+    ats_free(reinterpret_cast<char *>(const_cast<CacheDirEntry *>(dir)) - this->vol_headerlen());
+    dir = nullptr;
+  }
+}
+
+Errata
+Stripe::writeDir()
+{
+  Errata zret;
+  if (!OPEN_RW_FLAG) {
+    zret.push(0, 1, "Writing Not Enabled.. Please use --write to enable writing to disk");
+    return zret;
+  }
+
+  int64_t dirlen    = this->vol_dirlen();
+  int64_t hdrlen    = this->vol_headerlen();
+  int64_t footerlen = ROUND_TO_STORE_BLOCK(sizeof(StripeMeta));
+  char *raw_dir     = static_cast<char *>(ats_memalign(ats_pagesize(), dirlen));
+  StripeMeta meta   = _meta[A][HEAD];
+
+  // Header and footer must match for the directory to be accepted, the bumped serial makes this copy the newest.
+  ++meta.sync_serial;
+  meta.dirty = 0;
+  memset(raw_dir, 0, dirlen);
+  memcpy(raw_dir, &meta, sizeof(StripeMeta));
+  memcpy(raw_dir + offsetof(StripeMeta, freelist), this->freelist, this->_segments * sizeof(uint16_t));
+  memcpy(raw_dir + hdrlen, dir, dirlen - hdrlen - footerlen);
+  memcpy(raw_dir + dirlen - footerlen, &meta, sizeof(StripeMeta));
+
+  for (auto i : {A, B}) {
+    ssize_t n = pwrite(_span->_fd, raw_dir, dirlen, this->_start + Bytes(i * dirlen));
+    if (n < dirlen) {
+      zret.push(0, errno, "Failed to write the directory of stripe ", this->hashText, ": ", strerror(errno));
+      break;
+    }
+  }
+  if (zret) {
+    _meta[A][HEAD] = _meta[A][FOOT] = meta;
+  }
+  ats_free(raw_dir);
+  return zret;
+}
 //
 // Cache Directory
 //
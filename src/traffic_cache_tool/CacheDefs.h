@@ -70,7 +70,7 @@ namespace ts
   } while (0)
 
 constexpr static uint8_t CACHE_DB_MAJOR_VERSION = 24;
-constexpr static uint8_t CACHE_DB_MINOR_VERSION = 1;
+constexpr static uint8_t CACHE_DB_MINOR_VERSION = 3;
 /// Maximum allowed volume index.
 constexpr static int MAX_VOLUME_IDX          = 255;
 constexpr static int ENTRIES_PER_BUCKET      = 4;
@@ -158,11 +158,13 @@ public:
   uint32_t write_serial;
   uint32_t dirty;
   uint32_t sector_size;
-  uint32_t unused; // pad out to 8 byte boundary
+  uint32_t key_hash; // proxy.config.cache.key_hash the keys were made with, 0 before 24.3
   uint16_t freelist[1];
 };
 
 struct Doc {
+  static constexpr uint32_t MAGIC = 0x5F129B13;
+
   uint32_t magic;     // DOC_MAGIC
   uint32_t len;       // length of this fragment (including hlen & sizeof(Doc), unrounded)
   uint64_t total_len; // total length of document
@@ -390,11 +392,42 @@ namespace ct
 #define dir_phase(_e) dir_bit(_e, 2, 12)
 #define DIR_BLOCK_SHIFT(_i) (3 * (_i))
 #define DIR_BLOCK_SIZE(_i) (CACHE_BLOCK_SIZE << DIR_BLOCK_SHIFT(_i))
+#define DIR_SIZE_WITH_BLOCK(_i) ((1 << DIR_SIZE_WIDTH) * DIR_BLOCK_SIZE(_i))
+#define dir_set_bit(_e, _w, _b, _v) (_e)->w[_w] = (uint16_t)(((_e)->w[_w] & ~(1 << (_b))) | (((_v) ? 1 : 0) << (_b)))
+#define dir_set_big(_e, _v) (_e)->w[1] = (uint16_t)(((_e)->w[1] & 0xFCFF) | (((uint16_t)(_v)) & 0x3) << 8)
+#define dir_set_size(_e, _v) (_e)->w[1] = (uint16_t)(((_e)->w[1] & ((1 << 10) - 1)) | ((_v) << 10))
+#define dir_set_tag(_e, _t) \
+  (_e)->w[2] = (uint16_t)(((_e)->w[2] & ~((1 << DIR_TAG_WIDTH) - 1)) | ((_t) & ((1 << DIR_TAG_WIDTH) - 1)))
+#define dir_set_phase(_e, _v) dir_set_bit(_e, 2, 12, _v)
+#define dir_set_head(_e, _v) dir_set_bit(_e, 2, 13, _v)
+#define dir_set_pinned(_e, _v) dir_set_bit(_e, 2, 14, _v)
 #define dir_set_prev(_e, _o) (_e)->w[2] = (uint16_t)(_o)
 #define dir_set_next(_e, _o) (_e)->w[3] = (uint16_t)(_o)
 
 #define dir_in_seg(_s, _i) ((CacheDirEntry *)(((char *)(_s)) + (SIZEOF_DIR * (_i))))
 
+inline void
+dir_set_approx_size(CacheDirEntry *e, int64_t s)
+{
+  int big = 0;
+  while (big < DIR_BLOCK_SIZES - 1 && s > DIR_SIZE_WITH_BLOCK(big)) {
+    ++big;
+  }
+  dir_set_big(e, big);
+  dir_set_size(e, (s - 1) / DIR_BLOCK_SIZE(big));
+}
+
+/// Round a fragment length @a s up to what its directory entry can describe.
+inline int64_t
+round_to_approx_dir_size(int64_t s)
+{
+  int big = 0;
+  while (big < DIR_BLOCK_SIZES - 1 && s > DIR_SIZE_WITH_BLOCK(big)) {
+    ++big;
+  }
+  return INK_ALIGN(s, DIR_BLOCK_SIZE(big));
+}
+
 inline CacheDirEntry *
 dir_from_offset(int64_t i, CacheDirEntry *seg)
 {
@@ -439,6 +472,10 @@ dir_to_offset(const CacheDirEntry *d, const CacheDirEntry *seg)
 #endif
 }
 
+bool dir_compare_tag(const CacheDirEntry *e, const CryptoHash *key);
+/// The key of the fragment after the one with @a key.
+void next_CacheKey(CryptoHash *next_key, const CryptoHash *key);
+
 struct Stripe;
 struct Span {
   Span(ts::file::path const &path) : _path(path) {}
@@ -516,6 +553,10 @@ struct Stripe {
   /// Load metadata for this stripe.
   Errata loadMeta();
   Errata loadDir();
+  /// Release the directory from @c loadDir.
+  void unloadDir();
+  /// Write the directory and the current metadata to both copies on disk.
+  Errata writeDir();
   int check_loop(int s);
   void dir_check();
   bool walk_bucket_chain(int s); // returns true if there is a loop
@@ -536,6 +577,7 @@ struct Stripe {
 
   int64_t _buckets  = 0; ///< Number of buckets per segment.
   int64_t _segments = 0; ///< Number of segments.
+  int _avg_obj_size = 0; ///< Average object size for directory sizing, 0 for the global value.
 
   std::string hashText;
 
@@ -575,6 +617,8 @@ struct Stripe {
   CacheDirEntry *dir_delete_entry(CacheDirEntry *e, CacheDirEntry *p, int s);
   //  int dir_bucket_length(CacheDirEntry *b, int s);
   int dir_probe(CryptoHash *key, CacheDirEntry *result, CacheDirEntry **last_collision);
+  /// Add an entry for @a key with the data of @a to, @c nullptr if the segment is full.
+  CacheDirEntry *dir_insert(const CryptoHash *key, const CacheDirEntry *to);
   bool dir_valid(CacheDirEntry *e);
   bool validate_sync_serial();
   Errata updateHeaderFooter();
@@ -0,0 +1,342 @@
+/** @file
+
+  Sequential sweep of stripe content to verify or rebuild the stripe directory.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include <algorithm>
+#include <bitset>
+#include <cinttypes>
+#include <unordered_set>
+#include <vector>
+
+#include "CacheSweep.h"
+#include "../../proxy/hdrs/HTTP.h"
+
+namespace ct
+{
+void
+SweepHistogram::add(uint64_t value)
+{
+  int i = 0;
+  while (value > 1 && i < N - 1) {
+    value >>= 1;
+    ++i;
+  }
+  ++_count[i];
+}
+
+void
+SweepHistogram::merge(SweepHistogram const &that)
+{
+  for (int i = 0; i < N; ++i) {
+    _count[i] += that._count[i];
+  }
+}
+
+void
+SweepHistogram::print(std::ostream &s, const char *title, const char *unit) const
+{
+  uint64_t total = 0;
+  for (auto n : _count) {
+    total += n;
+  }
+  s << "  " << title << std::endl;
+  if (total == 0) {
+    return;
+  }
+  for (int i = 0; i < N; ++i) {
+    if (_count[i]) {
+      char line[128];
+      snprintf(line, sizeof(line), "    < %14" PRIu64 " %s: %12" PRIu64 " [%5.2f%%]\n", uint64_t(2) << i, unit, _count[i],
+               100.0 * _count[i] / total);
+      s << line;
+    }
+  }
+}
+
+void
+SweepStats::merge(SweepStats const &that)
+{
+  docs += that.docs;
+  objects += that.objects;
+  bytes += that.bytes;
+  entries += that.entries;
+  missing += that.missing;
+  mismatched += that.mismatched;
+  short_size += that.short_size;
+  unreferenced += that.unreferenced;
+  inserted += that.inserted;
+  dropped += that.dropped;
+  sizes.merge(that.sizes);
+  ages.merge(that.ages);
+}
+
+void
+SweepStats::print(std::ostream &s, bool verify, bool rebuild) const
+{
+  s << "  Fragments:         " << docs << std::endl;
+  s << "  Objects:           " << objects << std::endl;
+  s << "  Fragment Bytes:    " << bytes << std::endl;
+  if (verify) {
+    s << "  Directory Entries: " << entries << std::endl;
+    s << "    Missing:         " << missing << std::endl;
+    s << "    Tag Mismatch:    " << mismatched << std::endl;
+    s << "    Too Small:       " << short_size << std::endl;
+    s << "  Unreferenced:      " << unreferenced << std::endl;
+  }
+  if (rebuild) {
+    s << "  Entries Inserted:  " << inserted << std::endl;
+    s << "  Fragments Dropped: " << dropped << std::endl;
+  }
+  sizes.print(s, "Object Sizes", "bytes");
+  ages.print(s, "Object Ages", "sec");
+}
+
+bool
+CacheSweep::in_phase(int64_t offset) const
+{
+  return offset - 1 < (_recent_end - _stripe->_content.count()) / CACHE_BLOCK_SIZE;
+}
+
+void
+CacheSweep::account(Doc *doc)
+{
+  ++stats.docs;
+  stats.bytes += doc->len;
+  if (doc->hlen) {
+    ++stats.objects;
+    stats.sizes.add(doc->total_len);
+    // The alternates are still marshaled, but the fixed part of the first one is readable as is.
+    HTTPCacheAlt const *alt = reinterpret_cast<HTTPCacheAlt const *>(doc->hdr());
+    if (doc->hlen >= sizeof(HTTPCacheAlt) && alt->m_magic == CACHE_ALT_MAGIC_MARSHALED && alt->m_response_received_time > 0) {
+      stats.ages.add(std::max<time_t>(0, _now - alt->m_response_received_time));
+    }
+  }
+}
+
+Errata
+CacheSweep::sweep(off_t from, off_t to, PosFunc const &f)
+{
+  Errata zret;
+  int fd          = _stripe->_span->_fd;
+  int sector_size = std::max<int>(_stripe->_meta[0][0].sector_size, CACHE_BLOCK_SIZE);
+  char *buff      = static_cast<char *>(ats_memalign(ats_pagesize(), READ_SIZE));
+
+  bool done = false;
+
+  for (off_t pos = from; pos < to && !done;) {
+    off_t want = std::min<off_t>(READ_SIZE, to - pos);
+    ssize_t n  = pread(fd, buff, want, pos);
+    if (n < 0) {
+      zret.push(0, errno, "Failed to read stripe ", _stripe->hashText, " at ", pos, ": ", strerror(errno));
+      break;
+    } else if (n < CACHE_BLOCK_SIZE) {
+      zret.push(0, EIO, "Short read of stripe ", _stripe->hashText, " at ", pos, ": ", n, " of ", want, " bytes");
+      break;
+    }
+    // Fragments start on a block boundary, anything that does not look like one is skipped a block at a time.
+    int64_t i = 0;
+    while (i + static_cast<int64_t>(sizeof(Doc)) <= n) {
+      Doc *doc = reinterpret_cast<Doc *>(buff + i);
+      if (doc->magic != Doc::MAGIC || doc->len < sizeof(Doc) || doc->hlen > doc->len - sizeof(Doc) ||
+          static_cast<off_t>(doc->len) > to - (pos + i)) {
+        i += CACHE_BLOCK_SIZE;
+        continue;
+      }
+      // Read again from here if the start of the alternates is not in the buffer.
+      if (i + static_cast<int64_t>(sizeof(Doc) + std::min<size_t>(doc->hlen, sizeof(HTTPCacheAlt))) > n) {
+        break;
+      }
+      if (!f(doc, pos + i)) {
+        done = true;
+        break;
+      }
+      i += INK_ALIGN(round_to_approx_dir_size(doc->len), sector_size);
+    }
+    if (i == 0) { // short read
+      i = CACHE_BLOCK_SIZE;
+    }
+    pos += i;
+  }
+  ats_free(buff);
+  return zret;
+}
+
+Errata
+CacheSweep::sweep(DocFunc const &f)
+{
+  Errata zret;
+  StripeMeta const &meta = _stripe->_meta[0][0];
+  off_t content          = _stripe->_content.count();
+  off_t end              = (_stripe->_start + Bytes(_stripe->_len)).count();
+  int sector_size        = std::max<int>(meta.sector_size, CACHE_BLOCK_SIZE);
+  auto visit             = [&](Doc *doc, off_t pos) -> bool {
+    this->account(doc);
+    f(doc, (pos - content) / CACHE_BLOCK_SIZE + 1);
+    return true;
+  };
+
+  // Fragments written since the directory was last synced follow the write position back to back,
+  // like the recovery on startup, the run of them is part of this pass.
+  _recent_end = meta.write_pos;
+  zret        = this->sweep(meta.write_pos, end, [&](Doc *doc, off_t pos) -> bool {
+    if (pos != _recent_end || doc->sync_serial < meta.sync_serial) {
+      return false;
+    }
+    _recent_end = pos + INK_ALIGN(round_to_approx_dir_size(doc->len), sector_size);
+    return true;
+  });
+
+  // Ahead of that is the previous pass over the stripe, behind the write position is this one.
+  if (zret && meta.cycle > 0) {
+    zret = this->sweep(_recent_end, end, visit);
+  }
+  if (zret) {
+    zret = this->sweep(content, _recent_end, visit);
+  }
+  return zret;
+}
+
+Errata
+CacheSweep::verify()
+{
+  std::vector<std::pair<int64_t, CacheDirEntry *>> live;
+  std::bitset<MAX_ENTRIES_PER_SEGMENT> seen;
+
+  for (int s = 0; s < _stripe->_segments; s++) {
+    CacheDirEntry *seg = _stripe->dir_segment(s);
+    seen.reset();
+    for (int b = 0; b < _stripe->_buckets; b++) {
+      for (CacheDirEntry *e = dir_bucket(b, seg); e && dir_offset(e); e = next_dir(e, seg)) {
+        // loop detected
+        if (seen[dir_to_offset(e, seg)]) {
+          break;
+        }
+        seen[dir_to_offset(e, seg)] = true;
+        if (_stripe->dir_valid(e)) {
+          live.emplace_back(dir_offset(e), e);
+        }
+      }
+    }
+  }
+  std::sort(live.begin(), live.end(), [](auto const &lhs, auto const &rhs) { return lhs.first < rhs.first; });
+  stats.entries = live.size();
+
+  std::vector<bool> found(live.size());
+  Errata zret = this->sweep([&](Doc *doc, int64_t offset) {
+    auto spot = std::lower_bound(live.begin(), live.end(), offset, [](auto const &item, int64_t o) { return item.first < o; });
+    if (spot == live.end() || spot->first != offset) {
+      ++stats.unreferenced;
+    }
+    for (; spot != live.end() && spot->first == offset; ++spot) {
+      CacheDirEntry *e           = spot->second;
+      found[spot - live.begin()] = true;
+      if (!dir_compare_tag(e, &doc->key) && !dir_compare_tag(e, &doc->first_key)) {
+        ++stats.mismatched;
+      }
+      if (static_cast<uint64_t>(dir_approx_size(e)) < doc->len) {
+        ++stats.short_size;
+      }
+    }
+  });
+  if (zret) {
+    stats.missing = std::count(found.begin(), found.end(), false);
+  }
+  return zret;
+}
+
+Errata
+CacheSweep::rebuild()
+{
+  Errata zret;
+  StripeMeta const &meta = _stripe->_meta[0][0];
+  CacheDirEntry *dir     = const_cast<CacheDirEntry *>(_stripe->dir);
+  int64_t seg_entries    = _stripe->_buckets * DIR_DEPTH;
+  // The folded key for each entry, to find an older copy of the same fragment.
+  std::vector<uint64_t> entry_key(_stripe->_segments * seg_entries);
+  // Earliest keys of objects whose alternates were written without data.
+  std::unordered_set<uint64_t> earliest;
+  struct Fragment {
+    CryptoHash key;
+    CacheDirEntry dir;
+  };
+  std::vector<Fragment> fragments;
+
+  memset(dir, 0, _stripe->_segments * seg_entries * SIZEOF_DIR);
+  _stripe->init_dir();
+
+  auto insert = [&](CryptoHash const &key, CacheDirEntry *to) {
+    int s              = key.slice32(0) % _stripe->_segments;
+    CacheDirEntry *seg = _stripe->dir_segment(s);
+    dir_set_tag(to, key.slice32(2));
+    // Fragments are seen oldest first, so a later copy replaces the entry.
+    for (CacheDirEntry *e = dir_bucket(key.slice32(1) % _stripe->_buckets, seg); e && dir_offset(e); e = next_dir(e, seg)) {
+      if (entry_key[s * seg_entries + dir_to_offset(e, seg)] == key.fold() && dir_head(e) == dir_head(to) &&
+          dir_compare_tag(e, &key)) {
+        uint16_t next = dir_next(e);
+        dir_assign(e, to);
+        dir_set_next(e, next);
+        return;
+      }
+    }
+    if (CacheDirEntry *e = _stripe->dir_insert(&key, to); e) {
+      entry_key[s * seg_entries + dir_to_offset(e, seg)] = key.fold();
+      ++stats.inserted;
+    } else {
+      ++stats.dropped;
+    }
+  };
+
+  zret = this->sweep([&](Doc *doc, int64_t offset) {
+    CacheDirEntry to;
+    dir_clear(&to);
+    dir_set_offset(&to, offset);
+    dir_set_approx_size(&to, doc->len);
+    dir_set_phase(&to, in_phase(offset) ? meta.phase : !meta.phase);
+    dir_set_pinned(&to, doc->pinned != 0);
+    if (doc->hlen) {
+      dir_set_head(&to, true);
+      insert(doc->first_key, &to);
+      // A vector written by itself carries the key before the earliest fragment of its alternate, see agg_copy.
+      if (doc->data_len() == 0) {
+        CryptoHash earliest_key;
+        next_CacheKey(&earliest_key, &doc->key);
+        earliest.insert(earliest_key.fold());
+      }
+    } else {
+      // The first data fragment is a head as well, which is only known once the alternates are seen.
+      fragments.push_back({doc->key, to});
+    }
+  });
+  if (!zret) {
+    return zret;
+  }
+  for (auto &frag : fragments) {
+    dir_set_head(&frag.dir, earliest.count(frag.key.fold()) > 0);
+    insert(frag.key, &frag.dir);
+  }
+  // The recovered fragments are behind the write position of the new directory.
+  if (_recent_end > meta.write_pos) {
+    _stripe->_meta[0][0].write_pos = _stripe->_meta[0][0].last_write_pos = _stripe->_meta[0][0].agg_pos = _recent_end;
+  }
+  return _stripe->writeDir();
+}
+} // namespace ct
@@ -0,0 +1,105 @@
+/** @file
+
+  Sequential sweep of stripe content to verify or rebuild the stripe directory.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#pragma once
+
+#include <array>
+#include <functional>
+#include <string>
+
+#include "CacheDefs.h"
+
+namespace ct
+{
+/// Counts in power of two buckets.
+struct SweepHistogram {
+  static constexpr int N = 40;
+  std::array<uint64_t, N> _count{};
+
+  void add(uint64_t value);
+  void merge(SweepHistogram const &that);
+  void print(std::ostream &s, const char *title, const char *unit) const;
+};
+
+struct SweepStats {
+  uint64_t docs    = 0; ///< Fragments found in the content.
+  uint64_t objects = 0; ///< Fragments with the alternates of an object.
+  uint64_t bytes   = 0; ///< Sum of the fragment lengths.
+  // verify
+  uint64_t entries      = 0; ///< Live directory entries checked.
+  uint64_t missing      = 0; ///< Entries with no fragment at their offset.
+  uint64_t mismatched   = 0; ///< Entries whose tag does not match the fragment key.
+  uint64_t short_size   = 0; ///< Entries too small for the fragment.
+  uint64_t unreferenced = 0; ///< Fragments with no entry, these are stale or were removed.
+  // rebuild
+  uint64_t inserted = 0; ///< Entries added to the new directory.
+  uint64_t dropped  = 0; ///< Fragments left out because their segment was full.
+
+  SweepHistogram sizes; ///< Object sizes in bytes.
+  SweepHistogram ages;  ///< Object ages in seconds, from the first alternate.
+
+  void merge(SweepStats const &that);
+  void print(std::ostream &s, bool verify, bool rebuild) const;
+};
+
+/** Read the content of a stripe front to back in large blocks and find every fragment.
+
+    This is what @c CacheScan does one directory entry at a time, but with large sequential reads,
+    so it is practical for full size disks. Each instance works on a single stripe so stripes can
+    be swept on separate threads.
+ */
+class CacheSweep
+{
+public:
+  /// Size of each read.
+  static constexpr int64_t READ_SIZE = 8 * 1024 * 1024;
+
+  explicit CacheSweep(Stripe *stripe) : _stripe(stripe) {}
+
+  /// Check the live directory entries against the fragments.
+  Errata verify();
+  /// Replace the directory with one made from the fragments.
+  Errata rebuild();
+
+  SweepStats stats;
+
+private:
+  /// Fragment callback, with the dir offset of the fragment.
+  using DocFunc = std::function<void(Doc *doc, int64_t offset)>;
+  /// Fragment callback, with the disk position of the fragment. Return @c false to stop.
+  using PosFunc = std::function<bool(Doc *doc, off_t pos)>;
+
+  /// Visit the fragments in the content from @a from to @a to, in order.
+  Errata sweep(off_t from, off_t to, PosFunc const &f);
+  /// Visit every fragment, oldest first.
+  Errata sweep(DocFunc const &f);
+  /// Fragment size and age accounting.
+  void account(Doc *doc);
+  /// A fragment written in the current pass over the stripe.
+  bool in_phase(int64_t offset) const;
+
+  Stripe *_stripe;
+  off_t _recent_end = 0; ///< End of the fragments written since the last directory sync.
+  time_t _now = time(nullptr);
+};
+} // namespace ct
@@ -29,12 +29,16 @@
 #include <system_error>
 #include <fcntl.h>
 #include <cctype>
+#include <climits>
 #include <cstring>
 #include <vector>
 #include <unordered_set>
 #include <ctime>
 #include <bitset>
 #include <cinttypes>
+#include <atomic>
+#include <mutex>
+#include <sstream>
 
 #include "tscore/ink_memory.h"
 #include "tscore/ink_file.h"
@@ -45,6 +49,7 @@
 
 #include "CacheDefs.h"
 #include "CacheScan.h"
+#include "CacheSweep.h"
 
 using ts::Bytes;
 using ts::Megabytes;
@@ -65,6 +70,7 @@ const Bytes ts::CacheSpan::OFFSET{CacheStoreBlocks{1}};
 ts::file::path SpanFile;
 ts::file::path VolumeFile;
 ts::ArgParser parser;
+int Threads = std::thread::hardware_concurrency();
 
 Errata err;
 
@@ -106,8 +112,9 @@ struct VolumeConfig {
 
   /// Data direct from the config file.
   struct Data {
-    int _idx     = 0;         ///< Volume index.
-    int _percent = 0;         ///< Size if specified as a percent.
+    int _idx          = 0;    ///< Volume index.
+    int _percent      = 0;    ///< Size if specified as a percent.
+    int _avg_obj_size = 0;    ///< Average object size, 0 for the global value.
     Megabytes _size{0};       ///< Size if specified as an absolute.
     CacheStripeBlocks _alloc; ///< Allocation size.
 
@@ -184,6 +191,7 @@ struct Cache {
   ~Cache();
 
   Errata loadSpan(ts::file::path const &path);
+  Errata loadVolumeConfig(ts::file::path const &path);
   Errata loadSpanConfig(ts::file::path const &path);
   Errata loadSpanDirect(ts::file::path const &path, int vol_idx = -1, const Bytes &size = Bytes(-1));
   Errata loadURLs(ts::file::path const &path);
@@ -205,6 +213,7 @@ struct Cache {
 
   std::list<Span *> _spans;
   std::map<int, Volume> _volumes;
+  std::map<int, int> _avg_obj_size; ///< Average object size by volume index, from the volume config.
   std::vector<Stripe *> globalVec_stripe;
   std::unordered_set<ts::CacheURL *> URLset;
   unsigned short *stripes_hash_table;
@@ -463,10 +472,29 @@ Cache::loadSpan(ts::file::path const &path)
     zret = Errata::Message(0, EINVAL, "A span file specified by --spans is required");
   } else if (!ts::file::is_readable(path)) {
     zret = Errata::Message(0, EPERM, '\'', path.string(), "' is not readable.");
-  } else if (ts::file::is_regular_file(fs)) {
-    zret = this->loadSpanConfig(path);
   } else {
-    zret = this->loadSpanDirect(path);
+    // Stripe directories are sized by the volume's average object size, which must be known first.
+    if (!VolumeFile.empty()) {
+      zret = this->loadVolumeConfig(VolumeFile);
+    }
+    if (zret) {
+      zret = ts::file::is_regular_file(fs) ? this->loadSpanConfig(path) : this->loadSpanDirect(path);
+    }
+  }
+  return zret;
+}
+
+Errata
+Cache::loadVolumeConfig(ts::file::path const &path)
+{
+  VolumeConfig vols;
+  Errata zret = vols.load(path);
+  if (zret) {
+    for (auto &vol : vols) {
+      if (vol._avg_obj_size) {
+        _avg_obj_size[vol._idx] = vol._avg_obj_size;
+      }
+    }
   }
   return zret;
 }
@@ -487,6 +515,9 @@ Cache::loadSpanDirect(ts::file::path const &path, int vol_idx, const Bytes &size
         if (raw.free == 0) {
           stripe->_vol_idx = raw.vol_idx;
           stripe->_type    = raw.type;
+          if (auto spot = _avg_obj_size.find(stripe->_vol_idx); spot != _avg_obj_size.end()) {
+            stripe->_avg_obj_size = spot->second;
+          }
           _volumes[stripe->_vol_idx]._stripes.push_back(stripe);
           _volumes[stripe->_vol_idx]._size += stripe->_len;
           stripe->vol_init_data();
@@ -1032,6 +1063,7 @@ VolumeConfig::load(ts::file::path const &path)
 {
   static const ts::TextView TAG_SIZE("size");
   static const ts::TextView TAG_VOL("volume");
+  static const ts::TextView TAG_AOS("avg_obj_size");
 
   Errata zret;
 
@@ -1090,6 +1122,22 @@ VolumeConfig::load(ts::file::path const &path)
               zret.push(0, 4, "Line ", ln, " has invalid value '", value, "' for ", TAG_VOL, " field");
             }
           }
+        } else if (0 == strcasecmp(tag, TAG_AOS)) {
+          ts::TextView text;
+          auto n = ts::svtoi(value, &text);
+          if (text) {
+            ts::TextView suffix(text.data_end(), value.data_end()); // clip parsed number.
+            if (suffix.size() == 1 && ('K' == toupper(*suffix) || 'M' == toupper(*suffix))) {
+              n *= 'K' == toupper(*suffix) ? 1024 : 1024 * 1024;
+            } else if (!suffix.empty()) {
+              n = 0;
+            }
+          }
+          if (n > 0 && n <= INT_MAX) {
+            v._avg_obj_size = n;
+          } else {
+            zret.push(0, 11, "Line ", ln, " has invalid value '", value, "' for ", TAG_AOS, " field");
+          }
         }
       }
       if (v.hasSize() && v.hasIndex()) {
@@ -1362,6 +1410,66 @@ Scan_Cache(ts::file::path const &regex_path)
   }
 }
 
+/// Sweep the content of every stripe, @a Threads stripes at a time, and check or replace the directories.
+void
+Sweep_Stripes(bool rebuild)
+{
+  Cache cache;
+
+  if (rebuild && !OPEN_RW_FLAG) {
+    err.push(0, 1, "Writing Not Enabled.. Please use --write to enable writing to disk");
+    return;
+  }
+
+  if ((err = cache.loadSpan(SpanFile))) {
+    std::vector<Stripe *> stripes;
+    std::atomic<size_t> next{0};
+    std::mutex lock;
+    SweepStats total;
+    std::vector<std::thread> threadPool;
+
+    // allocated stripes, the default volume has index 0 as well as free space.
+    for (auto &item : cache._volumes) {
+      stripes.insert(stripes.end(), item.second._stripes.begin(), item.second._stripes.end());
+    }
+    auto worker = [&]() {
+      for (size_t i = next++; i < stripes.size(); i = next++) {
+        Stripe *stripe = stripes[i];
+        CacheSweep sweep(stripe);
+        Errata zret = stripe->loadMeta();
+        if (zret) {
+          stripe->loadDir();
+          zret = rebuild ? sweep.rebuild() : sweep.verify();
+          stripe->unloadDir();
+        }
+
+        std::ostringstream out;
+        out << "Stripe '[" << stripe->hashText << "]'" << std::endl;
+        if (zret) {
+          sweep.stats.print(out, !rebuild, rebuild);
+        } else {
+          out << zret;
+        }
+        std::lock_guard<std::mutex> guard(lock);
+        std::cout << out.str();
+        if (zret) {
+          total.merge(sweep.stats);
+        } else {
+          err.push(0, 1, "Failed to sweep stripe ", stripe->hashText);
+        }
+      }
+    };
+    for (int i = 0, n = std::min<int>(std::max(Threads, 1), stripes.size()); i < n; ++i) {
+      threadPool.emplace_back(worker);
+    }
+    for (auto &th : threadPool) {
+      th.join();
+    }
+    std::cout << "Total" << std::endl;
+    total.print(std::cout, !rebuild, rebuild);
+  }
+}
+
 int
 main(int argc, const char *argv[])
 {
@@ -1376,7 +1484,8 @@ main(int argc, const char *argv[])
     .add_option("--write", "-w", "")
     .add_option("--input", "-i", "", "", 1)
     .add_option("--device", "-d", "", "", 1)
-    .add_option("--aos", "-o", "", "", 1);
+    .add_option("--aos", "-o", "", "", 1)
+    .add_option("--threads", "-t", "", "", 1);
 
   parser.add_command("list", "List elements of the cache", []() { List_Stripes(Cache::SpanDumpDepth::SPAN); })
     .add_command("stripes", "List the stripes", []() { List_Stripes(Cache::SpanDumpDepth::STRIPE); });
@@ -1387,6 +1496,8 @@ main(int argc, const char *argv[])
   c.add_command("full", "Full report of the cache storage", &dir_check);
   c.add_command("freelist", "check the freelist for loop", [&]() { Check_Freelist(inputFile); });
   c.add_command("bucket_chain", "walk bucket chains for loops", [&]() { walk_bucket_chain(inputFile); });
+  c.add_command("verify", "check the directories against the stripe content", []() { Sweep_Stripes(false); });
+  c.add_command("rebuild", "rebuild the directories from the stripe content", []() { Sweep_Stripes(true); });
   parser.add_command("volumes", "Volumes", &Simulate_Span_Allocation);
   parser.add_command("alloc", "Storage allocation")
     .require_commands()
@@ -1412,6 +1523,9 @@ main(int argc, const char *argv[])
   if (auto data = arguments.get("aos")) {
     cache_config_min_average_object_size = std::stoi(data.value());
   }
+  if (auto data = arguments.get("threads")) {
+    Threads = std::stoi(data.value());
+  }
   if (auto data = arguments.get("device")) {
     inputFile = data.value();
   }
@@ -0,0 +1,156 @@
+/** @file
+
+  Tests for the stripe content sweep.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "catch.hpp"
+
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "../CacheSweep.h"
+
+extern int OPEN_RW_FLAG;
+
+using namespace ct;
+
+namespace
+{
+constexpr int STRIPE_BLOCKS = 2048; // store blocks, 16MB
+
+CryptoHash
+make_key(uint64_t a, uint64_t b)
+{
+  CryptoHash key;
+  key.u64[0] = a;
+  key.u64[1] = b;
+  return key;
+}
+
+/// Write a fragment at @a pos and return the position of the next one.
+off_t
+write_doc(int fd, off_t pos, CryptoHash const &first_key, CryptoHash const &key, uint32_t hlen, uint32_t data_len)
+{
+  std::vector<char> buff(sizeof(Doc) + hlen + data_len);
+  Doc *doc       = reinterpret_cast<Doc *>(buff.data());
+  doc->magic     = Doc::MAGIC;
+  doc->len       = buff.size();
+  doc->total_len = data_len;
+  doc->first_key = first_key;
+  doc->key       = key;
+  doc->hlen      = hlen;
+  REQUIRE(pwrite(fd, buff.data(), buff.size(), pos) == static_cast<ssize_t>(buff.size()));
+  return pos + round_to_approx_dir_size(doc->len);
+}
+
+/// The entry for @a key, @c nullptr if there is none.
+CacheDirEntry *
+find(Stripe &stripe, CryptoHash const &key)
+{
+  CacheDirEntry *seg = stripe.dir_segment(key.slice32(0) % stripe._segments);
+  for (CacheDirEntry *e = dir_bucket(key.slice32(1) % stripe._buckets, seg); e && dir_offset(e); e = next_dir(e, seg)) {
+    if (dir_compare_tag(e, &key)) {
+      return e;
+    }
+  }
+  return nullptr;
+}
+} // namespace
+
+TEST_CASE("CacheSweep rebuild", "[cache_tool][sweep]")
+{
+  char path[] = "/tmp/test_CacheSweep.XXXXXX";
+  int fd      = mkstemp(path);
+  REQUIRE(fd >= 0);
+  unlink(path);
+
+  Span span(ts::file::path{path});
+  span._fd = fd;
+  REQUIRE(ftruncate(fd, STRIPE_BLOCKS * CacheStoreBlocks::SCALE) == 0);
+
+  Stripe stripe(&span, Bytes(0), CacheStoreBlocks(STRIPE_BLOCKS));
+  stripe.vol_init_data();
+  REQUIRE(stripe.InitializeMeta());
+
+  SECTION("vector written by itself")
+  {
+    // The alternates of an update are written without data under the key before the earliest
+    // fragment of the new alternate, the data fragments follow.
+    CryptoHash first_key  = make_key(0x1111, 0x2222);
+    CryptoHash vector_key = make_key(0x3333, 0x4444);
+    CryptoHash earliest_key, second_key;
+    next_CacheKey(&earliest_key, &vector_key);
+    next_CacheKey(&second_key, &earliest_key);
+
+    off_t pos = stripe._content.count();
+    pos       = write_doc(fd, pos, first_key, vector_key, 1024, 0);
+    pos       = write_doc(fd, pos, first_key, earliest_key, 0, 8192);
+    pos       = write_doc(fd, pos, first_key, second_key, 0, 8192);
+
+    OPEN_RW_FLAG = O_RDWR;
+    CacheSweep sweep(&stripe);
+    REQUIRE(sweep.rebuild());
+    OPEN_RW_FLAG = O_RDONLY;
+
+    CHECK(sweep.stats.docs == 3);
+    CHECK(sweep.stats.inserted == 3);
+    CHECK(stripe._meta[0][0].write_pos == pos);
+
+    CacheDirEntry *e = find(stripe, first_key);
+    REQUIRE(e != nullptr);
+    CHECK(dir_head(e));
+    e = find(stripe, earliest_key);
+    REQUIRE(e != nullptr);
+    CHECK(dir_head(e));
+    e = find(stripe, second_key);
+    REQUIRE(e != nullptr);
+    CHECK_FALSE(dir_head(e));
+    CHECK(find(stripe, vector_key) == nullptr);
+  }
+
+  SECTION("alternates with data")
+  {
+    CryptoHash first_key = make_key(0x5555, 0x6666);
+    CryptoHash second_key;
+    next_CacheKey(&second_key, &first_key);
+
+    off_t pos = stripe._content.count();
+    pos       = write_doc(fd, pos, first_key, first_key, 1024, 8192);
+    pos       = write_doc(fd, pos, first_key, second_key, 0, 8192);
+
+    OPEN_RW_FLAG = O_RDWR;
+    CacheSweep sweep(&stripe);
+    REQUIRE(sweep.rebuild());
+    OPEN_RW_FLAG = O_RDONLY;
+
+    CHECK(sweep.stats.inserted == 2);
+    CacheDirEntry *e = find(stripe, first_key);
+    REQUIRE(e != nullptr);
+    CHECK(dir_head(e));
+    e = find(stripe, second_key);
+    REQUIRE(e != nullptr);
+    CHECK_FALSE(dir_head(e));
+  }
+
+  stripe.unloadDir();
+  free(stripe.freelist);
+}
@@ -38,3 +38,19 @@ CtrlEngine::storage_offline()
     }
   }
 }
+
+void
+CtrlEngine::storage_invalidate_tag()
+{
+  auto tags = arguments.get("invalidate-tag");
+  for (const auto &it : tags) {
+    TSMgmtError error;
+
+    error = TSCacheCmdInvalidateTag(it.c_str());
+    if (error != TS_ERR_OKAY) {
+      CtrlMgmtError(error, "failed to invalidate %s", it.c_str());
+      status_code = CTRL_EX_ERROR;
+      return;
+    }
+  }
+}
@@ -260,6 +260,10 @@ main(int argc, const char **argv)
     .add_command("offline", "Take one or more storage volumes offline", "", MORE_THAN_ONE_ARG_N,
                  [&]() { engine.storage_offline(); })
     .add_example_usage("storage offline DEVICE [DEVICE ...]");
+  storage_command
+    .add_command("invalidate-tag", "Remove the cached objects carrying one or more surrogate keys", "", MORE_THAN_ONE_ARG_N,
+                 [&]() { engine.storage_invalidate_tag(); })
+    .add_example_usage("storage invalidate-tag TAG [TAG ...]");
   storage_command.add_command("status", "Show the storage configuration", "", MORE_THAN_ZERO_ARG_N,
                               [&]() { engine.CtrlUnimplementedCommand("status"); }); // not implemented
 
@@ -217,4 +217,5 @@ struct CtrlEngine {
 
   // storage methods
   void storage_offline();
+  void storage_invalidate_tag();
 };
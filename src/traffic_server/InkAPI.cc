@@ -4811,6 +4811,18 @@ TSContThreadAffinityClear(TSCont contp)
   i->clearThreadAffinity();
 }
 
+void
+TSContThreadStealableSet(TSCont contp, bool stealable)
+{
+  sdk_assert(sdk_sanity_check_iocore_structure(contp) == TS_SUCCESS);
+
+  FORCE_PLUGIN_SCOPED_MUTEX(contp);
+
+  INKContInternal *i = reinterpret_cast<INKContInternal *>(contp);
+
+  i->thread_stealable = stealable;
+}
+
 TSAction
 TSHttpSchedule(TSCont contp, TSHttpTxn txnp, TSHRTime timeout)
 {
@@ -7472,6 +7484,17 @@ TSCacheRemove(TSCont contp, TSCacheKey key)
   return (TSAction)cacheProcessor.remove(i, &info->cache_key, info->frag_type, info->hostname, info->len);
 }
 
+int64_t
+TSCacheInvalidateTag(const char *tag, int tag_len)
+{
+  sdk_assert(sdk_sanity_check_null_ptr((void *)tag) == TS_SUCCESS);
+
+  if (tag_len < 0) {
+    tag_len = strlen(tag);
+  }
+  return cacheProcessor.invalidate_tag(tag, tag_len);
+}
+
 TSAction
 TSCacheScan(TSCont contp, TSCacheKey key, int KB_per_second)
 {
@@ -8325,7 +8348,7 @@ TSAIOWrite(int fd, off_t offset, char *buf, const size_t bufSize, TSCont contp)
 TSReturnCode
 TSAIOThreadNumSet(int thread_num)
 {
-#if AIO_MODE == AIO_MODE_NATIVE
+#if AIO_MODE == AIO_MODE_NATIVE || AIO_MODE == AIO_MODE_IO_URING
   (void)thread_num;
   return TS_SUCCESS;
 #else
@@ -129,6 +129,7 @@ static const long MAX_LOGIN = ink_login_name_max();
 static void mgmt_restart_shutdown_callback(ts::MemSpan<void>);
 static void mgmt_drain_callback(ts::MemSpan<void>);
 static void mgmt_storage_device_cmd_callback(int cmd, std::string_view const &arg);
+static void mgmt_cache_invalidate_tag_callback(ts::MemSpan<void>);
 static void mgmt_lifecycle_msg_callback(ts::MemSpan<void>);
 static void init_ssl_ctx_callback(void *ctx, bool server);
 static void load_ssl_file_callback(const char *ssl_file);
@@ -1819,6 +1820,14 @@ main(int /* argc ATS_UNUSED */, const char **argv)
   Debug("hugepages", "ats_pagesize reporting %zu", ats_pagesize());
   Debug("hugepages", "ats_hugepage_size reporting %zu", ats_hugepage_size());
 
+  // init the NUMA node arenas of the freelists, before the event threads pick their nodes
+  REC_ReadConfigInteger(enabled, "proxy.config.allocator.numa");
+  if (enabled) {
+    RecInt arena_size = 0;
+    REC_ReadConfigInteger(arena_size, "proxy.config.allocator.numa_arena_size");
+    ink_freelist_numa_init(0, arena_size);
+  }
+
   if (!num_accept_threads) {
     REC_ReadConfigInteger(num_accept_threads, "proxy.config.accept_threads");
   }
@@ -1980,6 +1989,7 @@ main(int /* argc ATS_UNUSED */, const char **argv)
   }
 
   REC_ReadConfigInteger(thread_max_heartbeat_mseconds, "proxy.config.thread.max_heartbeat_mseconds");
+  REC_ReadConfigInteger(thread_work_stealing, "proxy.config.exec_thread.work_stealing");
 
   ink_event_system_init(ts::ModuleVersion(1, 0, ts::ModuleVersion::PRIVATE));
   ink_net_init(ts::ModuleVersion(1, 0, ts::ModuleVersion::PRIVATE));
@@ -2183,6 +2193,7 @@ main(int /* argc ATS_UNUSED */, const char **argv)
     pmgmt->registerMgmtCallback(MGMT_EVENT_STORAGE_DEVICE_CMD_OFFLINE, [](ts::MemSpan<void> span) -> void {
       mgmt_storage_device_cmd_callback(MGMT_EVENT_STORAGE_DEVICE_CMD_OFFLINE, span.view());
     });
+    pmgmt->registerMgmtCallback(MGMT_EVENT_CACHE_INVALIDATE_TAG, &mgmt_cache_invalidate_tag_callback);
     pmgmt->registerMgmtCallback(MGMT_EVENT_LIFECYCLE_MESSAGE, &mgmt_lifecycle_msg_callback);
 
     ink_set_thread_name("[TS_MAIN]");
@@ -2242,6 +2253,15 @@ mgmt_storage_device_cmd_callback(int cmd, std::string_view const &arg)
   }
 }
 
+static void
+mgmt_cache_invalidate_tag_callback(ts::MemSpan<void> span)
+{
+  // data is the surrogate key, null terminated
+  char const *tag = span.rebind<char>().data();
+  int64_t n       = cacheProcessor.invalidate_tag(tag, strnlen(tag, span.size()));
+  Debug("server", "Invalidated %" PRId64 " documents tagged %s", n, tag);
+}
+
 static void
 mgmt_lifecycle_msg_callback(ts::MemSpan<void> span)
 {
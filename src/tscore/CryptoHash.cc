@@ -29,6 +29,7 @@
 #include "tscore/ink_code.h"
 #include "tscore/CryptoHash.h"
 #include "tscore/SHA256.h"
+#include "tscore/HashSip.h"
 
 #if TS_ENABLE_FIPS == 1
 CryptoContext::HashType CryptoContext::Setting = CryptoContext::SHA256;
@@ -38,9 +39,11 @@ CryptoContext::HashType CryptoContext::Setting = CryptoContext::SHA256;
 CryptoContext::HashType CryptoContext::Setting = CryptoContext::MD5;
 #endif
 
-CryptoContext::CryptoContext()
+CryptoContext::CryptoContext() : CryptoContext(Setting) {}
+
+CryptoContext::CryptoContext(HashType type)
 {
-  switch (Setting) {
+  switch (type) {
   case UNSPECIFIED:
 #if TS_ENABLE_FIPS == 0
   case MD5:
@@ -54,6 +57,9 @@ CryptoContext::CryptoContext()
     new (_obj) SHA256Context;
     break;
 #endif
+  case SIPHASH:
+    new (_obj) SipHashContext;
+    break;
   default:
     ink_release_assert(!"Invalid global URL hash context");
   };
@@ -63,6 +69,7 @@ CryptoContext::CryptoContext()
 #else
   static_assert(CryptoContext::OBJ_SIZE >= sizeof(SHA256Context), "bad OBJ_SIZE");
 #endif
+  static_assert(CryptoContext::OBJ_SIZE >= sizeof(SipHashContext), "bad OBJ_SIZE");
 }
 
 /**
@@ -9,6 +9,7 @@ https://github.com/floodyberry/siphash
  */
 
 #include "tscore/HashSip.h"
+#include <algorithm>
 #include <cstring>
 
 using namespace std;
@@ -139,3 +140,129 @@ ATSHash64Sip24::clear()
   total_len        = 0;
   block_buffer_len = 0;
 }
+
+ATSHash128Sip24::ATSHash128Sip24()
+{
+  this->clear();
+}
+
+ATSHash128Sip24::ATSHash128Sip24(uint64_t key0, uint64_t key1) : k0(key0), k1(key1)
+{
+  this->clear();
+}
+
+void
+ATSHash128Sip24::compress(uint64_t m)
+{
+  v3 ^= m;
+  SIPCOMPRESS(v0, v1, v2, v3);
+  SIPCOMPRESS(v0, v1, v2, v3);
+  v0 ^= m;
+}
+
+void
+ATSHash128Sip24::update(const void *data, size_t len)
+{
+  const unsigned char *m = static_cast<const unsigned char *>(data);
+  uint64_t mi;
+
+  if (finalized) {
+    return;
+  }
+  total_len += len;
+
+  if (block_buffer_len > 0) {
+    size_t n = std::min(len, static_cast<size_t>(SIP_BLOCK_SIZE - block_buffer_len));
+    memcpy(block_buffer + block_buffer_len, m, n);
+    block_buffer_len += n;
+    m += n;
+    len -= n;
+    if (block_buffer_len < SIP_BLOCK_SIZE) {
+      return;
+    }
+    memcpy(&mi, block_buffer, sizeof(mi));
+    compress(mi);
+    block_buffer_len = 0;
+  }
+  for (; len >= SIP_BLOCK_SIZE; m += SIP_BLOCK_SIZE, len -= SIP_BLOCK_SIZE) {
+    memcpy(&mi, m, sizeof(mi));
+    compress(mi);
+  }
+  memcpy(block_buffer, m, len);
+  block_buffer_len = len;
+}
+
+void
+ATSHash128Sip24::final()
+{
+  uint64_t last7;
+  int i;
+
+  if (!finalized) {
+    last7 = static_cast<uint64_t>(total_len & 0xff) << 56;
+
+    for (i = block_buffer_len - 1; i >= 0; i--) {
+      last7 |= static_cast<uint64_t>(block_buffer[i]) << (i * 8);
+    }
+
+    compress(last7);
+    v2 ^= 0xee;
+    SIPCOMPRESS(v0, v1, v2, v3);
+    SIPCOMPRESS(v0, v1, v2, v3);
+    SIPCOMPRESS(v0, v1, v2, v3);
+    SIPCOMPRESS(v0, v1, v2, v3);
+    hfinal[0] = v0 ^ v1 ^ v2 ^ v3;
+    v1 ^= 0xdd;
+    SIPCOMPRESS(v0, v1, v2, v3);
+    SIPCOMPRESS(v0, v1, v2, v3);
+    SIPCOMPRESS(v0, v1, v2, v3);
+    SIPCOMPRESS(v0, v1, v2, v3);
+    hfinal[1] = v0 ^ v1 ^ v2 ^ v3;
+    finalized = true;
+  }
+}
+
+const void *
+ATSHash128Sip24::get() const
+{
+  return finalized ? hfinal : nullptr;
+}
+
+size_t
+ATSHash128Sip24::size() const
+{
+  return sizeof(hfinal);
+}
+
+void
+ATSHash128Sip24::clear()
+{
+  v0               = k0 ^ 0x736f6d6570736575ull;
+  v1               = k1 ^ 0x646f72616e646f6dull ^ 0xee;
+  v2               = k0 ^ 0x6c7967656e657261ull;
+  v3               = k1 ^ 0x7465646279746573ull;
+  hfinal[0]        = 0;
+  hfinal[1]        = 0;
+  finalized        = false;
+  total_len        = 0;
+  block_buffer_len = 0;
+}
+
+bool
+SipHashContext::update(void const *data, int length)
+{
+  _hash.update(data, length);
+  return true;
+}
+
+bool
+SipHashContext::finalize(CryptoHash &hash)
+{
+  _hash.final();
+  // a wider CryptoHash is zero filled
+  hash = CRYPTO_HASH_ZERO;
+  memcpy(hash.u8, _hash.get(), _hash.size());
+  // ready for reuse, as the URL fast path is checked against the general path
+  _hash.clear();
+  return true;
+}
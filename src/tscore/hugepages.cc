@@ -32,7 +32,7 @@
 #define TOKEN "Hugepagesize:"
 #define TOKEN_SIZE (strlen(TOKEN))
 
-static int hugepage_size = -1;
+static int hugepage_size;
 static bool hugepage_enabled;
 #endif
 
@@ -67,11 +67,8 @@ ats_hugepage_init(int enabled)
 
   hugepage_size = 0;
 
-  if (!enabled) {
-    Debug(DEBUG_TAG "_init", "hugepages not enabled");
-    return;
-  }
-
+  // The size is found even if hugepages are not enabled for everything so that
+  // a dedicated pool can still use them.
   fp = fopen(MEMINFO_PATH, "r");
 
   if (fp == nullptr) {
@@ -96,11 +93,11 @@ ats_hugepage_init(int enabled)
 
   fclose(fp);
 
-  if (hugepage_size) {
+  if (hugepage_size && enabled) {
     hugepage_enabled = true;
   }
 
-  Debug(DEBUG_TAG "_init", "Hugepage size = %d", hugepage_size);
+  Debug(DEBUG_TAG "_init", "Hugepage size = %d, %s", hugepage_size, hugepage_enabled ? "enabled" : "not enabled");
 #else
   Debug(DEBUG_TAG "_init", "MAP_HUGETLB not defined");
 #endif
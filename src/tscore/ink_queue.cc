@@ -37,6 +37,8 @@
   ****************************************************************************/
 
 #include "tscore/ink_config.h"
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <memory.h>
 #include <cstdlib>
@@ -94,6 +96,55 @@ static const ink_freelist_ops *default_ops = &freelist_ops;
 static ink_freelist_list *freelists                = nullptr;
 static const ink_freelist_ops *freelist_global_ops = default_ops;
 
+int ink_freelist_numa_nodes = 0;
+
+// The node arenas are consecutive slices of one mapping, so the node of an item is its offset in it.
+static char *numa_arena           = nullptr;
+static size_t numa_arena_size     = 0;
+static thread_local int numa_node = -1;
+static std::atomic<size_t> numa_arena_used[INK_FREELIST_NODES];
+static std::atomic<bool> numa_arena_full[INK_FREELIST_NODES];
+
+static inline int
+numa_node_of(const void *item)
+{
+  size_t offset = static_cast<const char *>(item) - numa_arena;
+  return static_cast<const char *>(item) >= numa_arena && offset < ink_freelist_numa_nodes * numa_arena_size ?
+           offset / numa_arena_size :
+           -1;
+}
+
+static inline head_p *
+numa_list(InkFreeList *f, int node)
+{
+  return node >= 0 ? &f->nodes[node].head : &f->head;
+}
+
+// Carve size bytes for a chunk out of the arena of node, nullptr if it is full.
+static void *
+numa_chunk(int node, size_t size)
+{
+  if (numa_arena_full[node].load(std::memory_order_relaxed)) {
+    return nullptr;
+  }
+
+  size_t offset = numa_arena_used[node].fetch_add(size);
+
+  if (offset + size > numa_arena_size) {
+    if (!numa_arena_full[node].exchange(true)) {
+      Warning("freelist arena of NUMA node %d is full, allocating without node affinity", node);
+    }
+    return nullptr;
+  }
+
+  char *p = numa_arena + node * numa_arena_size + offset;
+  if (mprotect(p, size, PROT_READ | PROT_WRITE) != 0) {
+    Warning("unable to map %zu bytes of the freelist arena of NUMA node %d: %s", size, node, strerror(errno));
+    return nullptr;
+  }
+  return p;
+}
+
 const InkFreeListOps *
 ink_freelist_malloc_ops()
 {
@@ -124,7 +175,7 @@ ink_freelist_init(InkFreeList **fl, const char *name, uint32_t type_size, uint32
 
   /* its safe to add to this global list because ink_freelist_init()
      is only called from single-threaded initialization code. */
-  f = static_cast<InkFreeList *>(ats_memalign(alignment, sizeof(InkFreeList)));
+  f = static_cast<InkFreeList *>(ats_memalign(std::max<size_t>(alignment, alignof(InkFreeList)), sizeof(InkFreeList)));
   ink_zero(*f);
 
   fll       = static_cast<ink_freelist_list *>(ats_malloc(sizeof(ink_freelist_list)));
@@ -152,6 +203,9 @@ ink_freelist_init(InkFreeList **fl, const char *name, uint32_t type_size, uint32
   }
   Debug(DEBUG_TAG "_init", "<%s> Chunk Size request/actual (%" PRIu32 "/%" PRIu32 ")", name, chunk_size, f->chunk_size);
   SET_FREELIST_POINTER_VERSION(f->head, FROM_PTR(0), 0);
+  for (auto &node : f->nodes) {
+    SET_FREELIST_POINTER_VERSION(node.head, FROM_PTR(0), 0);
+  }
 
   *fl = f;
 }
@@ -173,6 +227,108 @@ ink_freelist_create(const char *name, uint32_t type_size, uint32_t chunk_size, u
   return f;
 }
 
+int
+ink_freelist_numa_init(int nodes, size_t arena_size)
+{
+  // Items are routed by address, which can not change once any are handed out.
+  ink_release_assert(numa_arena == nullptr);
+
+#if TS_USE_HWLOC
+  hwloc_topology_t topology = ink_get_topology();
+  int hw_nodes              = hwloc_get_nbobjs_by_type(topology, HWLOC_OBJ_NODE);
+
+  if (nodes == 0) {
+    nodes = hw_nodes;
+  }
+  for (int i = 0; arena_size == 0 && i < hw_nodes; i++) {
+    hwloc_obj_t obj = hwloc_get_obj_by_type(topology, HWLOC_OBJ_NODE, i);
+#if HWLOC_API_VERSION >= 0x20000
+    arena_size = std::max<size_t>(arena_size, obj->attr->numanode.local_memory);
+#else
+    arena_size = std::max<size_t>(arena_size, obj->memory.local_memory);
+#endif
+  }
+#endif // TS_USE_HWLOC
+
+  if (nodes < 2) {
+    Debug(DEBUG_TAG "_init", "%d NUMA nodes, freelist node arenas disabled", nodes);
+    return 0;
+  }
+  if (nodes > INK_FREELIST_NODES) {
+    Warning("freelists can only keep %d of the %d NUMA nodes apart", INK_FREELIST_NODES, nodes);
+    nodes = INK_FREELIST_NODES;
+  }
+  if (arena_size == 0) {
+    Warning("unable to size the freelist NUMA node arenas, they are disabled");
+    return 0;
+  }
+  arena_size = INK_ALIGN(arena_size, ats_pagesize());
+
+  // Reserve address space only, the chunks are made accessible (and charged) as they are carved out.
+  void *arena = mmap(nullptr, nodes * arena_size, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  if (arena == MAP_FAILED) {
+    Warning("unable to reserve %zu bytes for the freelist NUMA node arenas: %s", nodes * arena_size, strerror(errno));
+    return 0;
+  }
+
+#if TS_USE_HWLOC
+  for (int i = 0; i < nodes && i < hw_nodes; i++) {
+    hwloc_obj_t obj = hwloc_get_obj_by_type(topology, HWLOC_OBJ_NODE, i);
+    void *slice     = static_cast<char *>(arena) + i * arena_size;
+#if HWLOC_API_VERSION >= 0x20000
+    int ret = hwloc_set_area_membind(topology, slice, arena_size, obj->nodeset, HWLOC_MEMBIND_BIND, HWLOC_MEMBIND_BYNODESET);
+#else
+    int ret = hwloc_set_area_membind_nodeset(topology, slice, arena_size, obj->nodeset, HWLOC_MEMBIND_BIND, 0);
+#endif
+    if (ret != 0) {
+      Warning("unable to bind the freelist arena to NUMA node %d: %s", i, strerror(errno));
+    }
+  }
+#endif // TS_USE_HWLOC
+
+  numa_arena              = static_cast<char *>(arena);
+  numa_arena_size         = arena_size;
+  ink_freelist_numa_nodes = nodes;
+  Note("freelists allocate from %d NUMA node arenas of %zu bytes", nodes, arena_size);
+
+  return nodes;
+}
+
+void
+ink_freelist_set_thread_node(int node)
+{
+  numa_node = node >= 0 && node < ink_freelist_numa_nodes ? node : -1;
+}
+
+int
+ink_freelist_thread_node()
+{
+  return numa_node;
+}
+
+int
+ink_freelist_node_of(const void *item)
+{
+  return ink_freelist_numa_nodes ? numa_node_of(item) : -1;
+}
+
+int
+ink_freelist_numa_is_remote(const void *item)
+{
+  int node = numa_node_of(item);
+  return node >= 0 && numa_node >= 0 && node != numa_node;
+}
+
+uint64_t
+ink_freelists_numa_remote_frees()
+{
+  uint64_t total = 0;
+  for (ink_freelist_list *fll = freelists; fll; fll = fll->next) {
+    total += fll->fl->remote_frees;
+  }
+  return total;
+}
+
 #define ADDRESS_OF_NEXT(x, offset) ((void **)((char *)x + offset))
 
 #ifdef SANITY
@@ -196,17 +352,28 @@ freelist_new(InkFreeList *f)
 {
   head_p item;
   head_p next;
-  int result = 0;
+  int result   = 0;
+  head_p *list = numa_list(f, numa_node);
 
   do {
-    INK_QUEUE_LD(item, f->head);
+    INK_QUEUE_LD(item, *list);
     if (TO_PTR(FREELIST_POINTER(item)) == nullptr) {
       uint32_t i;
       void *newp        = nullptr;
       size_t alloc_size = f->chunk_size * f->type_size;
       size_t alignment  = 0;
 
-      if (ats_hugepage_enabled()) {
+      // The items are freed to the list of the memory they are in, which is the global one if the arena is full. Take
+      // those before allocating more, or every item of a full node would be a new one.
+      if (list != &f->head) {
+        alignment = ats_pagesize();
+        if ((newp = numa_chunk(numa_node, INK_ALIGN(alloc_size, alignment))) == nullptr) {
+          list = &f->head;
+          continue;
+        }
+      }
+
+      if (newp == nullptr && ats_hugepage_enabled()) {
         alignment = ats_hugepage_size();
         newp      = ats_alloc_hugepage(alloc_size);
       }
@@ -237,7 +404,7 @@ freelist_new(InkFreeList *f)
 
     } else {
       SET_FREELIST_POINTER_VERSION(next, *ADDRESS_OF_NEXT(TO_PTR(FREELIST_POINTER(item)), 0), FREELIST_VERSION(item) + 1);
-      result = ink_atomic_cas(&f->head.data, item.data, next.data);
+      result = ink_atomic_cas(&list->data, item.data, next.data);
 
 #ifdef SANITY
       if (result) {
@@ -283,14 +450,38 @@ ink_freelist_free(InkFreeList *f, void *item)
   }
 }
 
+// Push the items from head to tail, linked with FROM_PTR, on to list.
 static void
-freelist_free(InkFreeList *f, void *item)
+freelist_push(head_p *list, void *head, void *tail)
 {
-  void **adr_of_next = ADDRESS_OF_NEXT(item, 0);
+  void **adr_of_next = ADDRESS_OF_NEXT(tail, 0);
   head_p h;
   head_p item_pair;
   int result = 0;
 
+  while (!result) {
+    INK_QUEUE_LD(h, *list);
+#ifdef SANITY
+    if (TO_PTR(FREELIST_POINTER(h)) == head) {
+      ink_abort("ink_freelist_free: trying to free item twice");
+    }
+    if (((uintptr_t)(TO_PTR(FREELIST_POINTER(h)))) & 3) {
+      ink_abort("ink_freelist_free: bad list");
+    }
+    if (TO_PTR(FREELIST_POINTER(h))) {
+      fake_global_for_ink_queue = *static_cast<int *>(TO_PTR(FREELIST_POINTER(h)));
+    }
+#endif /* SANITY */
+    *adr_of_next = FREELIST_POINTER(h);
+    SET_FREELIST_POINTER_VERSION(item_pair, FROM_PTR(head), FREELIST_VERSION(h));
+    INK_MEMORY_BARRIER;
+    result = ink_atomic_cas(&list->data, h.data, item_pair.data);
+  }
+}
+
+static void
+freelist_free(InkFreeList *f, void *item)
+{
   // ink_assert(!((long)item&(f->alignment-1))); XXX - why is this no longer working? -bcall
 
 #ifdef DEADBEEF
@@ -304,24 +495,14 @@ freelist_free(InkFreeList *f, void *item)
   }
 #endif /* DEADBEEF */
 
-  while (!result) {
-    INK_QUEUE_LD(h, f->head);
-#ifdef SANITY
-    if (TO_PTR(FREELIST_POINTER(h)) == item) {
-      ink_abort("ink_freelist_free: trying to free item twice");
-    }
-    if (((uintptr_t)(TO_PTR(FREELIST_POINTER(h)))) & 3) {
-      ink_abort("ink_freelist_free: bad list");
-    }
-    if (TO_PTR(FREELIST_POINTER(h))) {
-      fake_global_for_ink_queue = *static_cast<int *>(TO_PTR(FREELIST_POINTER(h)));
+  int node = -1;
+  if (ink_freelist_numa_nodes) {
+    node = numa_node_of(item);
+    if (node >= 0 && numa_node >= 0 && node != numa_node) {
+      ink_atomic_increment(reinterpret_cast<int *>(&f->remote_frees), 1);
     }
-#endif /* SANITY */
-    *adr_of_next = FREELIST_POINTER(h);
-    SET_FREELIST_POINTER_VERSION(item_pair, FROM_PTR(item), FREELIST_VERSION(h));
-    INK_MEMORY_BARRIER;
-    result = ink_atomic_cas(&f->head.data, h.data, item_pair.data);
   }
+  freelist_push(numa_list(f, node), item, item);
 }
 
 static void
@@ -346,11 +527,6 @@ ink_freelist_free_bulk(InkFreeList *f, void *head, void *tail, size_t num_item)
 static void
 freelist_bulkfree(InkFreeList *f, void *head, void *tail, size_t num_item)
 {
-  void **adr_of_next = ADDRESS_OF_NEXT(tail, 0);
-  head_p h;
-  head_p item_pair;
-  int result = 0;
-
   // ink_assert(!((long)item&(f->alignment-1))); XXX - why is this no longer working? -bcall
 
 #ifdef DEADBEEF
@@ -369,24 +545,40 @@ freelist_bulkfree(InkFreeList *f, void *head, void *tail, size_t num_item)
   }
 #endif /* DEADBEEF */
 
-  while (!result) {
-    INK_QUEUE_LD(h, f->head);
-#ifdef SANITY
-    if (TO_PTR(FREELIST_POINTER(h)) == head) {
-      ink_abort("ink_freelist_free: trying to free item twice");
+  if (ink_freelist_numa_nodes) {
+    // Split the items by node and push each run on to the list of its node, the global one is last.
+    void *heads[INK_FREELIST_NODES + 1] = {nullptr};
+    void *tails[INK_FREELIST_NODES + 1] = {nullptr};
+    int remote                          = 0;
+    void *item                          = head;
+
+    for (size_t i = 0; i < num_item; i++) {
+      void *next = TO_PTR(*ADDRESS_OF_NEXT(item, 0));
+      int node   = numa_node_of(item);
+      int idx    = node >= 0 ? node : INK_FREELIST_NODES;
+
+      if (node >= 0 && numa_node >= 0 && node != numa_node) {
+        ++remote;
+      }
+      if (heads[idx] == nullptr) {
+        tails[idx] = item;
+      }
+      *ADDRESS_OF_NEXT(item, 0) = FROM_PTR(heads[idx]);
+      heads[idx]                = item;
+      item                      = next;
     }
-    if (((uintptr_t)(TO_PTR(FREELIST_POINTER(h)))) & 3) {
-      ink_abort("ink_freelist_free: bad list");
+    for (int idx = 0; idx <= INK_FREELIST_NODES; idx++) {
+      if (heads[idx]) {
+        freelist_push(numa_list(f, idx < INK_FREELIST_NODES ? idx : -1), heads[idx], tails[idx]);
+      }
     }
-    if (TO_PTR(FREELIST_POINTER(h))) {
-      fake_global_for_ink_queue = *static_cast<int *>(TO_PTR(FREELIST_POINTER(h)));
+    if (remote) {
+      ink_atomic_increment(reinterpret_cast<int *>(&f->remote_frees), remote);
     }
-#endif /* SANITY */
-    *adr_of_next = FREELIST_POINTER(h);
-    SET_FREELIST_POINTER_VERSION(item_pair, FROM_PTR(head), FREELIST_VERSION(h));
-    INK_MEMORY_BARRIER;
-    result = ink_atomic_cas(&f->head.data, h.data, item_pair.data);
+    return;
   }
+
+  freelist_push(&f->head, head, tail);
 }
 
 static void
@@ -474,6 +666,18 @@ ink_freelists_dump(FILE *f)
   }
   fprintf(f, " %18" PRIu64 " | %18" PRIu64 " |            | TOTAL\n", total_allocated, total_used);
   fprintf(f, "-----------------------------------------------------------------------------------------\n");
+
+  if (ink_freelist_numa_nodes) {
+    fprintf(f, "    NUMA Remote Frees   |   Free List Name\n");
+    fprintf(f, "------------------------|----------------------------------\n");
+    for (fll = freelists; fll; fll = fll->next) {
+      if (fll->fl->remote_frees) {
+        fprintf(f, " %22u | memory/%s\n", fll->fl->remote_frees, fll->fl->name ? fll->fl->name : "<unknown>");
+      }
+    }
+    fprintf(f, " %22" PRIu64 " | TOTAL\n", ink_freelists_numa_remote_frees());
+    fprintf(f, "-----------------------------------------------------------------------------------------\n");
+  }
 }
 
 void
@@ -0,0 +1,142 @@
+/** @file
+
+  Catch based unit tests for the freelist NUMA node arenas.
+
+  @section license License
+
+  Licensed to the Apache Software Foundation (ASF) under one
+  or more contributor license agreements.  See the NOTICE file
+  distributed with this work for additional information
+  regarding copyright ownership.  The ASF licenses this file
+  to you under the Apache License, Version 2.0 (the
+  "License"); you may not use this file except in compliance
+  with the License.  You may obtain a copy of the License at
+
+      http://www.apache.org/licenses/LICENSE-2.0
+
+  Unless required by applicable law or agreed to in writing, software
+  distributed under the License is distributed on an "AS IS" BASIS,
+  WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+  See the License for the specific language governing permissions and
+  limitations under the License.
+ */
+
+#include "catch.hpp"
+
+#include <thread>
+
+#include "tscore/ink_queue.h"
+#include "tscore/BaseLogFile.h"
+#include "tscore/Diags.h"
+
+#include <vector>
+
+namespace
+{
+constexpr size_t ARENA_SIZE = 16 * 1024 * 1024;
+
+// Two arenas whatever the machine has, the second is not bound to a node if there is only one. The
+// arenas can only be set up once, for all the test cases and their sections.
+int
+init_arenas()
+{
+  if (diags == nullptr) {
+    diags = new Diags("test_freelist", nullptr, nullptr, new BaseLogFile("stdout"));
+  }
+  static int nodes = ink_freelist_numa_init(2, ARENA_SIZE);
+  return nodes;
+}
+
+// Allocate an item as a thread of @a node.
+void *
+alloc_on(InkFreeList *fl, int node)
+{
+  void *item = nullptr;
+  std::thread([&]() {
+    ink_freelist_set_thread_node(node);
+    item = ink_freelist_new(fl);
+  }).join();
+  return item;
+}
+} // namespace
+
+TEST_CASE("freelist NUMA node arenas", "[libts][freelist]")
+{
+  static int nodes       = init_arenas();
+  static InkFreeList *fl = ink_freelist_create("test_freelist", 64, 16, 8);
+  uint32_t remote_frees  = fl->remote_frees;
+  REQUIRE(nodes == 2);
+
+  ink_freelist_set_thread_node(0);
+  REQUIRE(ink_freelist_thread_node() == 0);
+
+  void *local = ink_freelist_new(fl);
+  void *other = alloc_on(fl, 1);
+  REQUIRE(ink_freelist_node_of(local) == 0);
+  REQUIRE(ink_freelist_node_of(other) == 1);
+  REQUIRE(!ink_freelist_numa_remote(local));
+  REQUIRE(ink_freelist_numa_remote(other));
+
+  SECTION("free")
+  {
+    // Freed on node 0, the item goes back to node 1.
+    ink_freelist_free(fl, other);
+    REQUIRE(fl->remote_frees == remote_frees + 1);
+    REQUIRE(alloc_on(fl, 1) == other);
+    ink_freelist_free(fl, local);
+    REQUIRE(fl->remote_frees == remote_frees + 1);
+    ink_freelist_free(fl, other);
+  }
+
+  SECTION("bulk free")
+  {
+    *static_cast<void **>(local) = other;
+    *static_cast<void **>(other) = nullptr;
+    ink_freelist_free_bulk(fl, local, other, 2);
+    REQUIRE(fl->remote_frees == remote_frees + 1);
+    REQUIRE(ink_freelist_new(fl) == local);
+    REQUIRE(alloc_on(fl, 1) == other);
+    ink_freelist_free(fl, local);
+    ink_freelist_free(fl, other);
+  }
+
+  REQUIRE(ink_freelists_numa_remote_frees() >= 1);
+
+  // A thread with no node allocates from the global list.
+  ink_freelist_set_thread_node(-1);
+  void *global = ink_freelist_new(fl);
+  REQUIRE(ink_freelist_node_of(global) == -1);
+  REQUIRE(!ink_freelist_numa_remote(global));
+  ink_freelist_free(fl, global);
+}
+
+TEST_CASE("freelist full NUMA node arena", "[libts][freelist]")
+{
+  REQUIRE(init_arenas() == 2);
+  // One item per chunk, so a few fill the arena of node 0.
+  InkFreeList *fl = ink_freelist_create("test_freelist_full", 1024 * 1024, 1, 8);
+  std::vector<void *> items;
+
+  ink_freelist_set_thread_node(0);
+  void *item;
+  while ((item = ink_freelist_new(fl)) != nullptr && ink_freelist_node_of(item) == 0) {
+    items.push_back(item);
+    REQUIRE(items.size() <= ARENA_SIZE / fl->type_size);
+  }
+  REQUIRE(ink_freelist_node_of(item) == -1);
+
+  // The item goes to the global list, which is used again instead of allocating another chunk.
+  ink_freelist_free(fl, item);
+  uint32_t allocated = fl->allocated;
+  for (int i = 0; i < 8; ++i) {
+    item = ink_freelist_new(fl);
+    REQUIRE(ink_freelist_node_of(item) == -1);
+    ink_freelist_free(fl, item);
+  }
+  REQUIRE(fl->allocated == allocated);
+
+  for (void *p : items) {
+    ink_freelist_free(fl, p);
+  }
+  ink_freelist_set_thread_node(-1);
+}